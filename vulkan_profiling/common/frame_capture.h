@@ -0,0 +1,576 @@
+// Asynchronous frame capture shared by the rast and pbr renderers.
+//
+// A small ring of readback buffers is allocated at init, each with its own command buffer
+// and fence, and reallocated by resize() when the captured image changes size. capture()
+// records a copy of the rendered image into the next free buffer and submits it without
+// waiting; the copy is retired on a later capture() or flush()
+// once its fence is signaled. Retired frames are handed to a pool of worker threads
+// that encode them to disk, so the GPU, the readback and the compression of a sequence
+// of frames overlap instead of running one after the other.
+//
+// The output format follows the file extension: .ppm (binary P6), .exr (uncompressed
+// 32 bit float, linear) and PNG for anything else. Only 8 bit RGBA/BGRA color formats
+// are supported.
+//
+// Header only, C++17, depends on the Vulkan headers and stb_image_write.h.
+
+#ifndef VULKAN_PROFILING_FRAME_CAPTURE_H
+#define VULKAN_PROFILING_FRAME_CAPTURE_H
+
+#include <vulkan/vulkan.h>
+
+#include <stb_image_write.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vkprof {
+
+class FrameCapture {
+public:
+    // "out.png" -> "out_0003.png" when more than one frame is captured
+    static std::string sequencePath(const std::string& path, uint32_t index, uint32_t count) {
+        if (count <= 1) return path;
+        char suffix[16];
+        std::snprintf(suffix, sizeof(suffix), "_%04u", index);
+        const size_t slash = path.find_last_of("/\\");
+        const size_t dot = path.find_last_of('.');
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) return path + suffix;
+        return path.substr(0, dot) + suffix + path.substr(dot);
+    }
+
+    FrameCapture() = default;
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+    ~FrameCapture() { deinit(); }
+
+    // allocates slotCount readback buffers of width x height RGBA8 pixels and starts
+    // workerCount encoder threads (half the hardware threads when 0). queue must belong
+    // to queueFamily and be the queue the captured images are rendered on.
+    VkResult init(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamily, VkQueue queue,
+                  uint32_t width, uint32_t height, uint32_t slotCount = 3, uint32_t workerCount = 0) {
+        deinit();
+        m_device = device;
+        m_queue = queue;
+        m_width = width;
+        m_height = height;
+        m_next = 0;
+        m_captured = m_retired = m_written = m_failed = 0;
+        m_readbackMs = m_encodeMs = 0.0;
+        vkGetPhysicalDeviceMemoryProperties(physicalDevice, &m_memoryProps);
+
+        VkCommandPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        poolInfo.queueFamilyIndex = queueFamily;
+        VkResult result = vkCreateCommandPool(m_device, &poolInfo, nullptr, &m_commandPool);
+        if (result != VK_SUCCESS) return fail(result);
+
+        m_slots.resize(std::max(slotCount, 1u));
+        for (Slot& slot : m_slots) {
+            result = createSlot(slot);
+            if (result != VK_SUCCESS) return fail(result);
+        }
+
+        if (workerCount == 0) workerCount = std::max(1u, std::thread::hardware_concurrency() / 2);
+        m_stopWorkers = false;
+        for (uint32_t i = 0; i < workerCount; ++i) m_workers.emplace_back([this] { workerLoop(); });
+        return VK_SUCCESS;
+    }
+
+    // writes every pending frame and releases the buffers, the device must still be alive
+    void deinit() {
+        if (m_device == VK_NULL_HANDLE) return;
+        flush();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopWorkers = true;
+        }
+        m_jobAvailable.notify_all();
+        for (std::thread& worker : m_workers) worker.join();
+        m_workers.clear();
+
+        for (Slot& slot : m_slots) destroySlot(slot);
+        m_slots.clear();
+        vkDestroyCommandPool(m_device, m_commandPool, nullptr);
+        m_commandPool = VK_NULL_HANDLE;
+        m_device = VK_NULL_HANDLE;
+    }
+
+    // reallocates the readback buffers for images of width x height, e.g. after a swapchain
+    // recreation. The frames captured at the previous size are written first. The device must
+    // be idle, the semaphores handed out by capture() are destroyed.
+    VkResult resize(uint32_t width, uint32_t height) {
+        if (m_device == VK_NULL_HANDLE) return VK_ERROR_INITIALIZATION_FAILED;
+        if (width == m_width && height == m_height) return VK_SUCCESS;
+        flush();
+        for (Slot& slot : m_slots) {
+            destroySlot(slot);
+            slot = Slot();
+        }
+        m_width = width;
+        m_height = height;
+        m_next = 0;
+        for (Slot& slot : m_slots) {
+            const VkResult result = createSlot(slot);
+            if (result != VK_SUCCESS) return fail(result);
+        }
+        return VK_SUCCESS;
+    }
+
+    // copies image (currently in layout, and left in it) to the next free readback buffer and
+    // queues it for encoding to path. Waits only when every buffer is still in flight. The copy
+    // waits on waitSemaphore when given; when signalSemaphore is given it receives a semaphore
+    // signaled after the copy, e.g. for vkQueuePresentKHR to wait on instead of the render one.
+    VkResult capture(VkImage image, VkFormat format, VkImageLayout layout, const std::string& path,
+                     VkSemaphore waitSemaphore = VK_NULL_HANDLE, VkSemaphore* signalSemaphore = nullptr) {
+        if (!isSupported(format)) return VK_ERROR_FORMAT_NOT_SUPPORTED;
+        if (m_captured == 0) m_start = Clock::now();
+
+        retireCompleted(false);
+        Slot& slot = m_slots[m_next];
+        if (slot.pending) retire(slot, true);
+        m_next = (m_next + 1) % m_slots.size();
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        VkResult result = vkResetCommandBuffer(slot.commandBuffer, 0);
+        if (result == VK_SUCCESS) result = vkBeginCommandBuffer(slot.commandBuffer, &beginInfo);
+        if (result != VK_SUCCESS) return result;
+
+        VkImageMemoryBarrier imageBarrier{};
+        imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        imageBarrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+        imageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        imageBarrier.oldLayout = layout;
+        imageBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.image = image;
+        imageBarrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+        vkCmdPipelineBarrier(slot.commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+
+        VkBufferImageCopy region{};
+        region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+        region.imageExtent = {m_width, m_height, 1};
+        vkCmdCopyImageToBuffer(slot.commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot.buffer, 1, &region);
+
+        // back to the original layout, later rendering to the image waits for the copy
+        imageBarrier.srcAccessMask = 0;
+        imageBarrier.dstAccessMask = 0;
+        imageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        imageBarrier.newLayout = layout;
+        VkBufferMemoryBarrier bufferBarrier{};
+        bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        bufferBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        bufferBarrier.buffer = slot.buffer;
+        bufferBarrier.size = VK_WHOLE_SIZE;
+        vkCmdPipelineBarrier(slot.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_ALL_COMMANDS_BIT | VK_PIPELINE_STAGE_HOST_BIT,
+                             0, 0, nullptr, 1, &bufferBarrier, 1, &imageBarrier);
+        result = vkEndCommandBuffer(slot.commandBuffer);
+        if (result != VK_SUCCESS) return result;
+
+        const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.waitSemaphoreCount = waitSemaphore != VK_NULL_HANDLE ? 1 : 0;
+        submitInfo.pWaitSemaphores = &waitSemaphore;
+        submitInfo.pWaitDstStageMask = &waitStage;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &slot.commandBuffer;
+        submitInfo.signalSemaphoreCount = signalSemaphore ? 1 : 0;
+        submitInfo.pSignalSemaphores = &slot.done;
+        result = vkResetFences(m_device, 1, &slot.fence);
+        if (result == VK_SUCCESS) result = vkQueueSubmit(m_queue, 1, &submitInfo, slot.fence);
+        if (result != VK_SUCCESS) return result;
+
+        if (signalSemaphore) *signalSemaphore = slot.done;
+        slot.pending = true;
+        slot.swizzle = isBGR(format);
+        slot.srgb = isSRGB(format);
+        slot.path = path;
+        slot.submitted = Clock::now();
+        ++m_captured;
+        return VK_SUCCESS;
+    }
+
+    // waits until every captured frame is written to disk
+    void flush() {
+        for (Slot& slot : m_slots) {
+            if (slot.pending) retire(slot, true);
+        }
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_jobDone.wait(lock, [this] { return m_jobs.empty() && m_activeJobs == 0; });
+    }
+
+    uint64_t capturedFrames() const { return m_captured; }
+
+    uint64_t writtenFrames() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_written;
+    }
+
+    // frames written per second, from the first capture to the last file written
+    double framesPerSecond() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const double seconds = m_written ? std::chrono::duration<double>(m_lastWrite - m_start).count() : 0.0;
+        return seconds > 0.0 ? m_written / seconds : 0.0;
+    }
+
+    // one line report of the capture throughput and of the average cost of each stage
+    std::string summary() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const double seconds = m_written ? std::chrono::duration<double>(m_lastWrite - m_start).count() : 0.0;
+        const double fps = seconds > 0.0 ? m_written / seconds : 0.0;
+        const double retired = static_cast<double>(std::max<uint64_t>(m_retired, 1));
+        const double encoded = static_cast<double>(std::max<uint64_t>(m_written + m_failed, 1));
+        char line[256];
+        std::snprintf(line, sizeof(line),
+                      "Frame capture: %llu frames written in %.3f s (%.2f fps), readback %.2f ms, encode %.2f ms on average, "
+                      "%zu buffers, %zu encoder threads%s",
+                      static_cast<unsigned long long>(m_written), seconds, fps, m_readbackMs / retired,
+                      m_encodeMs / encoded, m_slots.size(), m_workers.size(), m_failed ? ", some frames failed" : "");
+        return line;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Slot {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        void* mapped = nullptr;
+        bool coherent = true;
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+        VkSemaphore done = VK_NULL_HANDLE;
+        bool pending = false;
+        bool swizzle = false;
+        bool srgb = false;
+        std::string path;
+        Clock::time_point submitted;
+    };
+
+    struct Job {
+        std::string path;
+        std::vector<uint8_t> pixels;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        bool srgb = false;
+    };
+
+    static bool isBGR(VkFormat format) {
+        return format == VK_FORMAT_B8G8R8A8_UNORM || format == VK_FORMAT_B8G8R8A8_SRGB;
+    }
+
+    static bool isSRGB(VkFormat format) {
+        return format == VK_FORMAT_R8G8B8A8_SRGB || format == VK_FORMAT_B8G8R8A8_SRGB;
+    }
+
+    static bool isSupported(VkFormat format) {
+        return isBGR(format) || format == VK_FORMAT_R8G8B8A8_UNORM || format == VK_FORMAT_R8G8B8A8_SRGB;
+    }
+
+    VkResult fail(VkResult result) {
+        deinit();
+        return result;
+    }
+
+    // host cached memory is much faster to read back, coherent is the fallback
+    bool findMemoryType(uint32_t typeBits, VkMemoryPropertyFlags properties, uint32_t& index) const {
+        for (uint32_t i = 0; i < m_memoryProps.memoryTypeCount; ++i) {
+            if ((typeBits & (1u << i)) && (m_memoryProps.memoryTypes[i].propertyFlags & properties) == properties) {
+                index = i;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    VkResult createSlot(Slot& slot) {
+        VkBufferCreateInfo bufferInfo{};
+        bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferInfo.size = VkDeviceSize(m_width) * m_height * 4;
+        bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        VkResult result = vkCreateBuffer(m_device, &bufferInfo, nullptr, &slot.buffer);
+        if (result != VK_SUCCESS) return result;
+
+        VkMemoryRequirements requirements;
+        vkGetBufferMemoryRequirements(m_device, slot.buffer, &requirements);
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = requirements.size;
+        uint32_t typeIndex = 0;
+        if (findMemoryType(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT, typeIndex)) {
+            slot.coherent = (m_memoryProps.memoryTypes[typeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+        } else if (findMemoryType(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, typeIndex)) {
+            slot.coherent = true;
+        } else {
+            return VK_ERROR_FEATURE_NOT_PRESENT;
+        }
+        allocInfo.memoryTypeIndex = typeIndex;
+        result = vkAllocateMemory(m_device, &allocInfo, nullptr, &slot.memory);
+        if (result == VK_SUCCESS) result = vkBindBufferMemory(m_device, slot.buffer, slot.memory, 0);
+        if (result == VK_SUCCESS) result = vkMapMemory(m_device, slot.memory, 0, VK_WHOLE_SIZE, 0, &slot.mapped);
+        if (result != VK_SUCCESS) return result;
+
+        VkCommandBufferAllocateInfo commandInfo{};
+        commandInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        commandInfo.commandPool = m_commandPool;
+        commandInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        commandInfo.commandBufferCount = 1;
+        result = vkAllocateCommandBuffers(m_device, &commandInfo, &slot.commandBuffer);
+        if (result != VK_SUCCESS) return result;
+
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        result = vkCreateFence(m_device, &fenceInfo, nullptr, &slot.fence);
+        if (result != VK_SUCCESS) return result;
+
+        VkSemaphoreCreateInfo semaphoreInfo{};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        return vkCreateSemaphore(m_device, &semaphoreInfo, nullptr, &slot.done);
+    }
+
+    void destroySlot(Slot& slot) {
+        if (slot.mapped) vkUnmapMemory(m_device, slot.memory);
+        if (slot.commandBuffer) vkFreeCommandBuffers(m_device, m_commandPool, 1, &slot.commandBuffer);
+        vkDestroyFence(m_device, slot.fence, nullptr);
+        vkDestroySemaphore(m_device, slot.done, nullptr);
+        vkDestroyBuffer(m_device, slot.buffer, nullptr);
+        vkFreeMemory(m_device, slot.memory, nullptr);
+    }
+
+    void retireCompleted(bool wait) {
+        for (Slot& slot : m_slots) {
+            if (slot.pending) retire(slot, wait);
+        }
+    }
+
+    // hands a finished copy over to the encoders, waiting for its fence if asked to
+    void retire(Slot& slot, bool wait) {
+        if (wait) {
+            vkWaitForFences(m_device, 1, &slot.fence, VK_TRUE, UINT64_MAX);
+        } else if (vkGetFenceStatus(m_device, slot.fence) != VK_SUCCESS) {
+            return;
+        }
+        const double readbackMs = std::chrono::duration<double, std::milli>(Clock::now() - slot.submitted).count();
+
+        if (!slot.coherent) {
+            VkMappedMemoryRange range{};
+            range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+            range.memory = slot.memory;
+            range.size = VK_WHOLE_SIZE;
+            vkInvalidateMappedMemoryRanges(m_device, 1, &range);
+        }
+        Job job;
+        job.path = slot.path;
+        job.srgb = slot.srgb;
+        job.width = m_width;
+        job.height = m_height;
+        job.pixels.resize(size_t(m_width) * m_height * 4);
+        std::memcpy(job.pixels.data(), slot.mapped, job.pixels.size());
+        if (slot.swizzle) {
+            for (size_t i = 0; i < job.pixels.size(); i += 4) std::swap(job.pixels[i], job.pixels[i + 2]);
+        }
+        slot.pending = false;
+
+        // bounded queue, the render thread is held back when the encoders fall behind
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_jobDone.wait(lock, [this] { return m_jobs.size() < m_workers.size() + m_slots.size(); });
+        m_readbackMs += readbackMs;
+        ++m_retired;
+        m_jobs.push_back(std::move(job));
+        lock.unlock();
+        m_jobAvailable.notify_one();
+    }
+
+    void workerLoop() {
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_jobAvailable.wait(lock, [this] { return m_stopWorkers || !m_jobs.empty(); });
+                if (m_jobs.empty()) return;
+                job = std::move(m_jobs.front());
+                m_jobs.pop_front();
+                ++m_activeJobs;
+            }
+            const Clock::time_point start = Clock::now();
+            const bool written = encode(job);
+            const Clock::time_point end = Clock::now();
+            if (!written) std::fprintf(stderr, "Frame capture: could not write %s\n", job.path.c_str());
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                --m_activeJobs;
+                m_encodeMs += std::chrono::duration<double, std::milli>(end - start).count();
+                if (written) {
+                    ++m_written;
+                    m_lastWrite = std::max(m_lastWrite, end);
+                } else {
+                    ++m_failed;
+                }
+            }
+            m_jobDone.notify_all();
+        }
+    }
+
+    static bool hasExtension(const std::string& path, const char* extension) {
+        const size_t length = std::strlen(extension);
+        if (path.size() < length) return false;
+        return std::equal(path.end() - length, path.end(), extension,
+                          [](char a, char b) { return std::tolower(static_cast<unsigned char>(a)) == b; });
+    }
+
+    bool encode(const Job& job) const {
+        if (hasExtension(job.path, ".ppm")) return writePPM(job);
+        if (hasExtension(job.path, ".exr")) return writeEXR(job);
+        return stbi_write_png(job.path.c_str(), job.width, job.height, 4, job.pixels.data(), job.width * 4) != 0;
+    }
+
+    bool writePPM(const Job& job) const {
+        std::ofstream file(job.path, std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+        file << "P6\n" << job.width << " " << job.height << "\n255\n";
+        std::vector<uint8_t> row(size_t(job.width) * 3);
+        for (uint32_t y = 0; y < job.height; ++y) {
+            const uint8_t* src = job.pixels.data() + size_t(y) * job.width * 4;
+            for (uint32_t x = 0; x < job.width; ++x) std::memcpy(&row[x * 3], &src[x * 4], 3);
+            file.write(reinterpret_cast<const char*>(row.data()), static_cast<std::streamsize>(row.size()));
+        }
+        return static_cast<bool>(file);
+    }
+
+    // scanline OpenEXR with one line per block and no compression, little endian hosts only
+    bool writeEXR(const Job& job) const {
+        std::vector<char> header;
+        auto put = [&header](const void* data, size_t size) {
+            header.insert(header.end(), static_cast<const char*>(data), static_cast<const char*>(data) + size);
+        };
+        auto putInt = [&put](int32_t value) { put(&value, sizeof(value)); };
+        auto putFloat = [&put](float value) { put(&value, sizeof(value)); };
+        auto putAttribute = [&put, &putInt](const char* name, const char* type, int32_t size) {
+            put(name, std::strlen(name) + 1);
+            put(type, std::strlen(type) + 1);
+            putInt(size);
+        };
+
+        const uint8_t magic[8] = {0x76, 0x2f, 0x31, 0x01, 2, 0, 0, 0};
+        put(magic, sizeof(magic));
+        // channels are stored in alphabetical order
+        const char* channels[4] = {"A", "B", "G", "R"};
+        putAttribute("channels", "chlist", 4 * (2 + 16) + 1);
+        for (const char* channel : channels) {
+            put(channel, 2);
+            putInt(2);  // FLOAT
+            const uint8_t linearAndReserved[4] = {0, 0, 0, 0};
+            put(linearAndReserved, sizeof(linearAndReserved));
+            putInt(1);
+            putInt(1);
+        }
+        header.push_back(0);
+        putAttribute("compression", "compression", 1);
+        header.push_back(0);
+        const int32_t window[4] = {0, 0, static_cast<int32_t>(job.width) - 1, static_cast<int32_t>(job.height) - 1};
+        putAttribute("dataWindow", "box2i", sizeof(window));
+        put(window, sizeof(window));
+        putAttribute("displayWindow", "box2i", sizeof(window));
+        put(window, sizeof(window));
+        putAttribute("lineOrder", "lineOrder", 1);
+        header.push_back(0);
+        putAttribute("pixelAspectRatio", "float", 4);
+        putFloat(1.0f);
+        putAttribute("screenWindowCenter", "v2f", 8);
+        putFloat(0.0f);
+        putFloat(0.0f);
+        putAttribute("screenWindowWidth", "float", 4);
+        putFloat(1.0f);
+        header.push_back(0);
+
+        // EXR holds linear values, sRGB encoded pixels are decoded first
+        float decode[256];
+        for (int i = 0; i < 256; ++i) {
+            const float v = i / 255.0f;
+            decode[i] = job.srgb ? (v <= 0.04045f ? v / 12.92f : std::pow((v + 0.055f) / 1.055f, 2.4f)) : v;
+        }
+
+        const uint64_t lineBytes = uint64_t(job.width) * 4 * sizeof(float);
+        const uint64_t blockBytes = 2 * sizeof(int32_t) + lineBytes;
+        const uint64_t firstBlock = header.size() + uint64_t(job.height) * sizeof(uint64_t);
+
+        std::ofstream file(job.path, std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+        file.write(header.data(), static_cast<std::streamsize>(header.size()));
+        for (uint32_t y = 0; y < job.height; ++y) {
+            const uint64_t offset = firstBlock + y * blockBytes;
+            file.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+        }
+
+        // A, B, G and R planes of each line, the alpha channel is not sRGB encoded
+        static const int sourceChannel[4] = {3, 2, 1, 0};
+        std::vector<float> line(size_t(job.width) * 4);
+        for (uint32_t y = 0; y < job.height; ++y) {
+            const uint8_t* src = job.pixels.data() + size_t(y) * job.width * 4;
+            for (int c = 0; c < 4; ++c) {
+                float* dst = line.data() + size_t(c) * job.width;
+                for (uint32_t x = 0; x < job.width; ++x) {
+                    const uint8_t value = src[x * 4 + sourceChannel[c]];
+                    dst[x] = c == 0 ? value / 255.0f : decode[value];
+                }
+            }
+            const int32_t lineHeader[2] = {static_cast<int32_t>(y), static_cast<int32_t>(lineBytes)};
+            file.write(reinterpret_cast<const char*>(lineHeader), sizeof(lineHeader));
+            file.write(reinterpret_cast<const char*>(line.data()), static_cast<std::streamsize>(lineBytes));
+        }
+        return static_cast<bool>(file);
+    }
+
+    VkDevice m_device = VK_NULL_HANDLE;
+    VkQueue m_queue = VK_NULL_HANDLE;
+    VkCommandPool m_commandPool = VK_NULL_HANDLE;
+    VkPhysicalDeviceMemoryProperties m_memoryProps{};
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    std::vector<Slot> m_slots;
+    size_t m_next = 0;
+    uint64_t m_captured = 0;
+
+    // shared with the encoder threads
+    mutable std::mutex m_mutex;
+    std::condition_variable m_jobAvailable;
+    std::condition_variable m_jobDone;
+    std::deque<Job> m_jobs;
+    std::vector<std::thread> m_workers;
+    uint32_t m_activeJobs = 0;
+    bool m_stopWorkers = false;
+    uint64_t m_retired = 0;
+    uint64_t m_written = 0;
+    uint64_t m_failed = 0;
+    double m_readbackMs = 0.0;
+    double m_encodeMs = 0.0;
+    Clock::time_point m_start;
+    Clock::time_point m_lastWrite;
+};
+
+}  // namespace vkprof
+
+#endif  // VULKAN_PROFILING_FRAME_CAPTURE_H
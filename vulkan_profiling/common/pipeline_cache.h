@@ -0,0 +1,216 @@
+// Persistent VkPipelineCache shared by the rast, pbr and vk_gaussian_splatting renderers.
+//
+// The cache is loaded from disk when the device is created and written back when the
+// device is destroyed, so that pipeline creation hits the driver cache from the second
+// run on. The file starts with a small header identifying the device and driver that
+// produced it; a file written by another GPU or driver version is ignored and the cache
+// starts empty. Plain vkGetPipelineCacheData dumps (as produced by other tools) are
+// accepted too, in which case only the Vulkan cache header is validated.
+//
+// Header only, C++17, depends on the Vulkan headers alone.
+
+#ifndef VULKAN_PROFILING_PIPELINE_CACHE_H
+#define VULKAN_PROFILING_PIPELINE_CACHE_H
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace vkprof {
+
+class PersistentPipelineCache {
+public:
+    // file used when the application does not provide one,
+    // overridden by the VK_PIPELINE_CACHE_PATH environment variable
+    static std::string defaultPath() {
+        const char* env = std::getenv("VK_PIPELINE_CACHE_PATH");
+        return (env && *env) ? std::string(env) : std::string("pipeline_cache.bin");
+    }
+
+    PersistentPipelineCache() = default;
+    PersistentPipelineCache(const PersistentPipelineCache&) = delete;
+    PersistentPipelineCache& operator=(const PersistentPipelineCache&) = delete;
+    ~PersistentPipelineCache() { deinit(); }
+
+    // creates the cache, seeded with the content of path if it was produced by this device
+    // and driver. An empty path disables both loading and saving. Returns the result of
+    // vkCreatePipelineCache.
+    VkResult init(VkPhysicalDevice physicalDevice, VkDevice device, const std::string& path) {
+        deinit();
+        m_device = device;
+        m_path = path;
+        vkGetPhysicalDeviceProperties(physicalDevice, &m_props);
+
+        std::vector<char> data;
+        if (!m_path.empty()) {
+            m_loadedBytes = load(data) ? data.size() : 0;
+            if (!m_loadedBytes) data.clear();
+        }
+
+        VkPipelineCacheCreateInfo info{};
+        info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        info.initialDataSize = data.size();
+        info.pInitialData = data.empty() ? nullptr : data.data();
+        VkResult result = vkCreatePipelineCache(m_device, &info, nullptr, &m_cache);
+        if (result != VK_SUCCESS && !data.empty()) {
+            // the driver rejected the blob, start from scratch
+            m_loadedBytes = 0;
+            info.initialDataSize = 0;
+            info.pInitialData = nullptr;
+            result = vkCreatePipelineCache(m_device, &info, nullptr, &m_cache);
+        }
+        if (result != VK_SUCCESS) m_cache = VK_NULL_HANDLE;
+        return result;
+    }
+
+    // writes the cache back to disk and destroys it, the device must still be alive
+    void deinit() {
+        if (m_cache == VK_NULL_HANDLE) return;
+        save();
+        vkDestroyPipelineCache(m_device, m_cache, nullptr);
+        m_cache = VK_NULL_HANDLE;
+        m_device = VK_NULL_HANDLE;
+    }
+
+    // writes the current content of the cache, through a temporary file
+    // so that a concurrent or interrupted run never leaves a truncated cache behind
+    bool save() const {
+        if (m_cache == VK_NULL_HANDLE || m_path.empty()) return false;
+
+        size_t size = 0;
+        if (vkGetPipelineCacheData(m_device, m_cache, &size, nullptr) != VK_SUCCESS || size == 0) return false;
+        std::vector<char> data(size);
+        if (vkGetPipelineCacheData(m_device, m_cache, &size, data.data()) != VK_SUCCESS) return false;
+        data.resize(size);
+
+        FileHeader header = makeHeader();
+        header.dataSize = size;
+        header.dataHash = hash(data.data(), size);
+
+        // unique per writer, two runs saving at the same time never write the same temporary file
+        char suffix[32];
+        std::snprintf(suffix, sizeof(suffix), ".%08x.tmp", static_cast<unsigned>(std::random_device{}()));
+        const std::string tmpPath = m_path + suffix;
+        {
+            std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+            if (!file) return false;
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(data.data(), static_cast<std::streamsize>(size));
+            if (!file) {
+                file.close();
+                std::remove(tmpPath.c_str());
+                return false;
+            }
+        }
+        // replaces the previous file atomically where rename allows it, so that the cache
+        // file is never missing for a concurrent reader
+        if (std::rename(tmpPath.c_str(), m_path.c_str()) == 0) return true;
+#ifdef _WIN32
+        // rename does not replace an existing file on Windows
+        std::remove(m_path.c_str());
+        if (std::rename(tmpPath.c_str(), m_path.c_str()) == 0) return true;
+#endif
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+
+    VkPipelineCache handle() const { return m_cache; }
+    operator VkPipelineCache() const { return m_cache; }
+    const std::string& path() const { return m_path; }
+    // bytes of cache data reused from disk, 0 on a cold start
+    size_t loadedBytes() const { return m_loadedBytes; }
+
+private:
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t vendorID;
+        uint32_t deviceID;
+        uint32_t driverVersion;
+        uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+        uint32_t reserved;
+        uint64_t dataSize;
+        uint64_t dataHash;
+    };
+    static constexpr char s_magic[4] = {'V', 'K', 'P', 'C'};
+    static constexpr uint32_t s_version = 1;
+
+    FileHeader makeHeader() const {
+        FileHeader header{};
+        std::memcpy(header.magic, s_magic, sizeof(s_magic));
+        header.version = s_version;
+        header.vendorID = m_props.vendorID;
+        header.deviceID = m_props.deviceID;
+        header.driverVersion = m_props.driverVersion;
+        std::memcpy(header.pipelineCacheUUID, m_props.pipelineCacheUUID, VK_UUID_SIZE);
+        return header;
+    }
+
+    // FNV-1a, only meant to catch truncated or partially written files
+    static uint64_t hash(const char* data, size_t size) {
+        uint64_t h = 14695981039346656037ull;
+        for (size_t i = 0; i < size; ++i) {
+            h ^= static_cast<uint8_t>(data[i]);
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    // checks the header vkGetPipelineCacheData puts in front of the data
+    bool matchesVulkanHeader(const std::vector<char>& data) const {
+        if (data.size() < sizeof(VkPipelineCacheHeaderVersionOne)) return false;
+        VkPipelineCacheHeaderVersionOne header;
+        std::memcpy(&header, data.data(), sizeof(header));
+        return header.headerSize >= sizeof(header) && header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+               && header.vendorID == m_props.vendorID && header.deviceID == m_props.deviceID
+               && std::memcmp(header.pipelineCacheUUID, m_props.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+    }
+
+    bool load(std::vector<char>& data) const {
+        std::ifstream file(m_path, std::ios::binary | std::ios::ate);
+        if (!file) return false;
+        const std::streamoff fileSize = file.tellg();
+        if (fileSize <= 0) return false;
+        file.seekg(0);
+
+        FileHeader header{};
+        if (static_cast<size_t>(fileSize) >= sizeof(header)) {
+            file.read(reinterpret_cast<char*>(&header), sizeof(header));
+            if (std::memcmp(header.magic, s_magic, sizeof(s_magic)) == 0) {
+                const FileHeader expected = makeHeader();
+                if (header.version != s_version || header.vendorID != expected.vendorID
+                    || header.deviceID != expected.deviceID || header.driverVersion != expected.driverVersion
+                    || std::memcmp(header.pipelineCacheUUID, expected.pipelineCacheUUID, VK_UUID_SIZE) != 0
+                    || header.dataSize != static_cast<uint64_t>(fileSize) - sizeof(header)) {
+                    return false;
+                }
+                data.resize(static_cast<size_t>(header.dataSize));
+                file.read(data.data(), static_cast<std::streamsize>(data.size()));
+                return file && hash(data.data(), data.size()) == header.dataHash && matchesVulkanHeader(data);
+            }
+            file.seekg(0);
+        }
+
+        // raw vkGetPipelineCacheData dump
+        data.resize(static_cast<size_t>(fileSize));
+        file.read(data.data(), fileSize);
+        return file && matchesVulkanHeader(data);
+    }
+
+    VkDevice m_device = VK_NULL_HANDLE;
+    VkPipelineCache m_cache = VK_NULL_HANDLE;
+    VkPhysicalDeviceProperties m_props{};
+    std::string m_path;
+    size_t m_loadedBytes = 0;
+};
+
+}  // namespace vkprof
+
+#endif  // VULKAN_PROFILING_PIPELINE_CACHE_H
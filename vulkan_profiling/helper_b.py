@@ -104,6 +104,33 @@ class Helper:
     return cmd
     
   
+  def write_views_file(self, vm, pm=np.array([]), app="vkgs"):
+    # one line per view for the --views batch mode of vkgs: name view[16] [proj[16]]
+    views_path = self.base_path + self.model + f"/dataset_val/{app}_views.txt"
+    with open(views_path, 'w') as f:
+      for key in vm.keys():
+        fname = key.split('/')[-1].split('.')[0]
+        line = f"{fname} {' '.join(map(str, vm[key]))}"
+        if pm.size > 0:
+          line += f" {' '.join(map(str, pm))}"
+        f.write(line + '\n')
+    return views_path
+
+  def get_batch_cmd(self, views_path, app="vkgs", warmup=10, timed=10, order="file"):
+    # renders all the views of views_path with a single launch and model load
+    # order is the splat order in memory (file, morton or hilbert), outputs go to a folder per order
+    pwd = os.getcwd()
+    opath = self.base_path + self.model + f"/{app}_output"
+    if order != "file":
+      opath += f"_{order}"
+    if not os.path.exists(opath):
+      os.makedirs(opath)
+    cmd = f"{pwd}/{self.vkgs_path} -i {self.get_ply_path()} --views {views_path} -o {opath}"
+    cmd += f" --warmup {warmup} --timed {timed}"
+    if order != "file":
+      cmd += f" --order {order}"
+    return cmd
+
   def get_ngfx_cmd(self, app="vkgs", vm=np.array([]), pm=np.array([]), mm=np.array([])):
     pwd = os.getcwd()
     cmd = self.ngfx_path
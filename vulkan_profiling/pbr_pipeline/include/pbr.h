@@ -125,7 +125,6 @@ class PBR: public VulkanExampleBase {
 	void prepareOffscreenFramebuffer(int index);
 	void prepareOffscreenPipeline();
 	void generateShadowMap();
-	void saveScreenshot(std::string filename, uint32_t currentImage);
 	// void saveScreenshotOffscreen(std::string filename, uint32_t currentImage);
 	void updateUniformBuffers();
 	void prepare();
@@ -140,6 +139,17 @@ class PBR: public VulkanExampleBase {
 		void SetMatrices(const float* view, const float* proj, const float* model, const float* camPos);
 		void SetModelPath(const std::string& model_p);
 		void SetOutputPath(const std::string& output_p);
+		void SetPipelineCachePath(const std::string& cache_p) {
+			pipelineCachePath = cache_p;
+		}
+		// Render into an offscreen image without any window, surface or swapchain
+		void SetHeadless(bool headless_mode = true) {
+			headless = headless_mode;
+		}
+		// Number of consecutive frames written to the output path, numbered when more than one
+		void SetCaptureFrames(uint32_t frames) {
+			captureFrames = std::max(frames, 1u);
+		}
 		void SetUseShadow(bool use_shadow = true, bool use_pcf = true) {
 			this->use_shadow = use_shadow;
 			this->use_pcf = use_pcf;
@@ -16,9 +16,12 @@ VkResult VulkanExampleBase::createInstance()
 {
 	// std::vector<const char*> instanceExtensions = { VK_KHR_SURFACE_EXTENSION_NAME };
 	uint32_t glfwExtensionCount = 0;
-	const char** glfwExtensions;
+	const char** glfwExtensions = nullptr;
 	enabledInstanceExtensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
-	glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+	// Headless mode has no surface, so none of the window system extensions are needed
+	if (!headless) {
+		glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+	}
 	// instanceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
 	std::vector<const char*> instanceExtensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
 
@@ -116,6 +119,25 @@ VkResult VulkanExampleBase::createInstance()
 
 void VulkanExampleBase::renderFrame()
 {
+	if (headless) {
+		// Nothing to acquire or present, the single command buffer is reused every frame
+		VK_CHECK_RESULT(vkWaitForFences(device, 1, &waitFences[0], VK_TRUE, UINT64_MAX));
+		VK_CHECK_RESULT(vkResetFences(device, 1, &waitFences[0]));
+		imageIndex = 0;
+		buildCommandBuffer(0);
+		submitInfo.waitSemaphoreCount = 0;
+		submitInfo.pWaitSemaphores = nullptr;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &drawCmdBuffers[0];
+		submitInfo.signalSemaphoreCount = 0;
+		submitInfo.pSignalSemaphores = nullptr;
+		VK_CHECK_RESULT(vkQueueSubmit(queue, 1, &submitInfo, waitFences[0]));
+		// Ordered after the frame on the same queue, the next frame waits for the copy
+		if (offScreen && frameCounter >= 5 && !screenshotSaved) {
+			captureFrame(headlessTarget.image, headlessTarget.format, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+		}
+		return;
+	}
 	// std::cout << "VulkanExampleBase::renderFrame() called" << std::endl;
 	VulkanExampleBase::prepareFrame();
 	// std::cout << "VulkanExampleBase::prepareFrame() done" << std::endl;
@@ -147,7 +169,7 @@ std::string VulkanExampleBase::getWindowTitle() const
 void VulkanExampleBase::createCommandBuffers()
 {
 	// Create one command buffer for each swap chain image
-	drawCmdBuffers.resize(swapChain.imageCount);
+	drawCmdBuffers.resize(headless ? 1 : swapChain.imageCount);
 	VkCommandBufferAllocateInfo cmdBufAllocateInfo = vks::initializers::commandBufferAllocateInfo(cmdPool, VK_COMMAND_BUFFER_LEVEL_PRIMARY, static_cast<uint32_t>(drawCmdBuffers.size()));
 	VK_CHECK_RESULT(vkAllocateCommandBuffers(device, &cmdBufAllocateInfo, drawCmdBuffers.data()));
 }
@@ -167,23 +189,31 @@ std::string VulkanExampleBase::getShadersPath() const
 
 void VulkanExampleBase::createPipelineCache()
 {
-	VkPipelineCacheCreateInfo pipelineCacheCreateInfo = {};
-	pipelineCacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
-	VK_CHECK_RESULT(vkCreatePipelineCache(device, &pipelineCacheCreateInfo, nullptr, &pipelineCache));
+	VK_CHECK_RESULT(persistentPipelineCache.init(physicalDevice, device, pipelineCachePath));
+	pipelineCache = persistentPipelineCache.handle();
+	std::cout << "Pipeline cache: " << persistentPipelineCache.loadedBytes() << " bytes reused from " << pipelineCachePath << std::endl;
 }
 
 void VulkanExampleBase::prepare()
 {
 	std::cout<<"VulkanExampleBase::prepare() called" << std::endl;
-	createSurface();
-	createCommandPool();
-	createSwapChain();
+	if (headless) {
+		createCommandPool();
+		setupHeadlessTarget();
+	} else {
+		createSurface();
+		createCommandPool();
+		createSwapChain();
+	}
 	createCommandBuffers();
 	createSynchronizationPrimitives();
 	setupDepthStencil();
 	setupRenderPass();
 	createPipelineCache();
 	setupFrameBuffer();
+	if (offScreen) {
+		VK_CHECK_RESULT(frameCapture.init(physicalDevice, device, headless ? vulkanDevice->queueFamilyIndices.graphics : swapChain.queueNodeIndex, queue, width, height));
+	}
 	std::cout << "VulkanExampleBase::prepare() done" << std::endl;
 }
 
@@ -205,18 +235,32 @@ VkPipelineShaderStageCreateInfo VulkanExampleBase::loadShader(std::string fileNa
 
 void VulkanExampleBase::renderLoop()
 {
-
-	while(!glfwWindowShouldClose(window))
+	if (headless) {
+		// No events to poll, render until the last captured frame (or the first frames without output)
+		while (offScreen ? !screenshotSaved : frameCounter <= 5)
+		{
+			render();
+			frameCounter++;
+		}
+	}
+	else
 	{
-		glfwPollEvents();
-		render();
-		frameCounter++;
-		if (offScreen) 
-			if(screenshotSaved) break;
+		while(!glfwWindowShouldClose(window))
+		{
+			glfwPollEvents();
+			render();
+			frameCounter++;
+			if (offScreen) 
+				if(screenshotSaved) break;
+		}
 	}
 	if (device != VK_NULL_HANDLE) {
 		vkDeviceWaitIdle(device);
 	}
+	if (offScreen) {
+		frameCapture.flush();
+		std::cout << frameCapture.summary() << std::endl;
+	}
 }
 
 void VulkanExampleBase::prepareFrame()
@@ -243,14 +287,13 @@ void VulkanExampleBase::prepareFrame()
 
 void VulkanExampleBase::submitFrame()
 {
-	VkResult result = swapChain.queuePresent(queue, imageIndex, semaphores.renderComplete[currentBuffer]);
-	// Recreate the swapchain if it's no longer compatible with the surface (OUT_OF_DATE) or no longer optimal for presentation (SUBOPTIMAL)
-	// save screenshot
-	if(offScreen&&frameCounter==5) {
-		// Render offscreen
-		vkQueueWaitIdle(queue);
-		saveScreenshot(output_path,imageIndex);
+	// The capture copy goes between rendering and presentation, which then waits for the copy
+	VkSemaphore presentWait = semaphores.renderComplete[currentBuffer];
+	if (offScreen && frameCounter >= 5 && !screenshotSaved) {
+		captureFrame(swapChain.images[imageIndex], swapChain.colorFormat, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, &presentWait);
 	}
+	VkResult result = swapChain.queuePresent(queue, imageIndex, presentWait);
+	// Recreate the swapchain if it's no longer compatible with the surface (OUT_OF_DATE) or no longer optimal for presentation (SUBOPTIMAL)
 	if ((result == VK_ERROR_OUT_OF_DATE_KHR) || (result == VK_SUBOPTIMAL_KHR)) {
 		windowResize();
 		if (result == VK_ERROR_OUT_OF_DATE_KHR) {
@@ -291,8 +334,18 @@ VulkanExampleBase::~VulkanExampleBase()
 	vkDestroyImageView(device, depthStencil.view, nullptr);
 	vkDestroyImage(device, depthStencil.image, nullptr);
 	vkFreeMemory(device, depthStencil.memory, nullptr);
+	if (headless) {
+		vkDestroyImageView(device, headlessTarget.view, nullptr);
+		vkDestroyImage(device, headlessTarget.image, nullptr);
+		vkFreeMemory(device, headlessTarget.memory, nullptr);
+	}
 
-	vkDestroyPipelineCache(device, pipelineCache, nullptr);
+	// Pending frames are written to disk before the buffers are released
+	frameCapture.deinit();
+
+	// Written back to disk before being destroyed
+	persistentPipelineCache.deinit();
+	pipelineCache = VK_NULL_HANDLE;
 
 	vkDestroyCommandPool(device, cmdPool, nullptr);
 
@@ -318,8 +371,10 @@ VulkanExampleBase::~VulkanExampleBase()
 		vks::debug::freeDebugCallback(instance);
 	}
 
-	glfwDestroyWindow(window);
-	glfwTerminate();
+	if (!headless) {
+		glfwDestroyWindow(window);
+		glfwTerminate();
+	}
 
 	vkDestroyInstance(instance, nullptr);
 
@@ -389,7 +444,8 @@ bool VulkanExampleBase::initVulkan()
 	// Derived examples can enable extensions based on the list of supported extensions read from the physical device
 	getEnabledExtensions();
 
-	result = vulkanDevice->createLogicalDevice(enabledFeatures, enabledDeviceExtensions, deviceCreatepNextChain, VK_QUEUE_COMPUTE_BIT | VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_TRANSFER_BIT);
+	// The swapchain extension is only requested when presenting, a headless device may not support it
+	result = vulkanDevice->createLogicalDevice(enabledFeatures, enabledDeviceExtensions, deviceCreatepNextChain, !headless);
 	if (result != VK_SUCCESS) {
 		vks::tools::exitFatal("Could not create Vulkan device: \n" + vks::tools::errorString(result), result);
 		return false;
@@ -434,7 +490,12 @@ void VulkanExampleBase::buildCommandBuffer(uint32_t currentImage) {
 	// Default implementation does nothing
 	// Derived examples can override this to build their command buffers
 }
-void VulkanExampleBase::saveScreenshot(std::string filename, uint32_t currentImage) {}
+void VulkanExampleBase::captureFrame(VkImage image, VkFormat format, VkImageLayout layout, VkSemaphore* presentWait)
+{
+	const std::string path = vkprof::FrameCapture::sequencePath(output_path, capturedFrames, captureFrames);
+	VK_CHECK_RESULT(frameCapture.capture(image, format, layout, path, presentWait ? *presentWait : VK_NULL_HANDLE, presentWait));
+	screenshotSaved = ++capturedFrames >= captureFrames;
+}
 
 void VulkanExampleBase::reCreateSynchronizationPrimitives() {
 	VkFenceCreateInfo fenceCreateInfo = vks::initializers::fenceCreateInfo(VK_FENCE_CREATE_SIGNALED_BIT);
@@ -454,27 +515,30 @@ void VulkanExampleBase::createSynchronizationPrimitives()
 		VK_CHECK_RESULT(vkCreateFence(device, &fenceCreateInfo, nullptr, &fence));
 	}
 	// Create synchronization objects
-	VkSemaphoreCreateInfo semaphoreCreateInfo = vks::initializers::semaphoreCreateInfo();
-	// Create a semaphore used to synchronize image presentation
-	// Ensures that the image is displayed before we start submitting new commands to the queue
-	semaphores.presentComplete.resize(drawCmdBuffers.size());
-	semaphores.renderComplete.resize(drawCmdBuffers.size());
-	for(auto& semaphore : semaphores.presentComplete) {
-		VK_CHECK_RESULT(vkCreateSemaphore(device, &semaphoreCreateInfo, nullptr, &semaphore));
-	}
-	// Create a semaphore used to synchronize command submission
-	// Ensures that the image is not presented until all commands have been submitted and executed
-	for(auto& semaphore : semaphores.renderComplete) {
-		VK_CHECK_RESULT(vkCreateSemaphore(device, &semaphoreCreateInfo, nullptr, &semaphore));
-	}
-
-	//sanity check
-	assert(semaphores.presentComplete[0] != VK_NULL_HANDLE);
-	assert(semaphores.presentComplete[1] != VK_NULL_HANDLE);
-	assert(semaphores.presentComplete[2] != VK_NULL_HANDLE);
-	assert(semaphores.renderComplete[1] != VK_NULL_HANDLE);
-	assert(semaphores.renderComplete[2] != VK_NULL_HANDLE);
-	assert(semaphores.renderComplete[0] != VK_NULL_HANDLE);
+	// Presentation semaphores are not needed in headless mode
+	if (!headless) {
+		VkSemaphoreCreateInfo semaphoreCreateInfo = vks::initializers::semaphoreCreateInfo();
+		// Create a semaphore used to synchronize image presentation
+		// Ensures that the image is displayed before we start submitting new commands to the queue
+		semaphores.presentComplete.resize(drawCmdBuffers.size());
+		semaphores.renderComplete.resize(drawCmdBuffers.size());
+		for(auto& semaphore : semaphores.presentComplete) {
+			VK_CHECK_RESULT(vkCreateSemaphore(device, &semaphoreCreateInfo, nullptr, &semaphore));
+		}
+		// Create a semaphore used to synchronize command submission
+		// Ensures that the image is not presented until all commands have been submitted and executed
+		for(auto& semaphore : semaphores.renderComplete) {
+			VK_CHECK_RESULT(vkCreateSemaphore(device, &semaphoreCreateInfo, nullptr, &semaphore));
+		}
+
+		//sanity check
+		assert(semaphores.presentComplete[0] != VK_NULL_HANDLE);
+		assert(semaphores.presentComplete[1] != VK_NULL_HANDLE);
+		assert(semaphores.presentComplete[2] != VK_NULL_HANDLE);
+		assert(semaphores.renderComplete[1] != VK_NULL_HANDLE);
+		assert(semaphores.renderComplete[2] != VK_NULL_HANDLE);
+		assert(semaphores.renderComplete[0] != VK_NULL_HANDLE);
+	}
 	
 	// Set up submit info structure
 	// Semaphores will stay the same during application lifetime
@@ -491,7 +555,7 @@ void VulkanExampleBase::createCommandPool()
 {
 	VkCommandPoolCreateInfo cmdPoolInfo = {};
 	cmdPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-	cmdPoolInfo.queueFamilyIndex = swapChain.queueNodeIndex;
+	cmdPoolInfo.queueFamilyIndex = headless ? vulkanDevice->queueFamilyIndices.graphics : swapChain.queueNodeIndex;
 	cmdPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
 	VK_CHECK_RESULT(vkCreateCommandPool(device, &cmdPoolInfo, nullptr, &cmdPool));
 }
@@ -540,11 +604,11 @@ void VulkanExampleBase::setupDepthStencil()
 void VulkanExampleBase::setupFrameBuffer()
 {
 	// Create frame buffers for every swap chain image
-	frameBuffers.resize(swapChain.imageCount);
+	frameBuffers.resize(headless ? 1 : swapChain.imageCount);
 	for (uint32_t i = 0; i < frameBuffers.size(); i++)
 	{
 		const VkImageView attachments[2] = {
-			swapChain.buffers[i].view,
+			headless ? headlessTarget.view : swapChain.buffers[i].view,
 			// Depth/Stencil attachment is the same for all frame buffers
 			depthStencil.view
 		};
@@ -564,14 +628,15 @@ void VulkanExampleBase::setupRenderPass()
 {
 	std::array<VkAttachmentDescription, 2> attachments = {};
 	// Color attachment
-	attachments[0].format = swapChain.colorFormat;
+	attachments[0].format = headless ? headlessTarget.format : swapChain.colorFormat;
 	attachments[0].samples = VK_SAMPLE_COUNT_1_BIT;
 	attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
 	attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
 	attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 	attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 	attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	attachments[0].finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	// The headless target is only read back, never presented
+	attachments[0].finalLayout = headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 	// Depth attachment
 	attachments[1].format = depthFormat;
 	attachments[1].samples = VK_SAMPLE_COUNT_1_BIT;
@@ -671,6 +736,11 @@ void VulkanExampleBase::windowResize() {
 	}
 	reCreateSynchronizationPrimitives();
 
+	// The readback buffers follow the size of the swapchain images
+	if (offScreen) {
+		VK_CHECK_RESULT(frameCapture.resize(width, height));
+	}
+
 	vkDeviceWaitIdle(device);
 
 	if ((width > 0.0f) && (height > 0.0f)) {
@@ -694,6 +764,46 @@ void VulkanExampleBase::createSwapChain() {
 	// std ::cout << "Swap chain created with " << swapChain.imageCount << " images" << std::endl;
 }
 
+void VulkanExampleBase::setupHeadlessTarget()
+{
+	// Same 8 bit sRGB encoding as the swapchain, in the RGBA order of the screenshots
+	headlessTarget.format = VK_FORMAT_R8G8B8A8_SRGB;
+
+	VkImageCreateInfo imageCI{};
+	imageCI.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageCI.imageType = VK_IMAGE_TYPE_2D;
+	imageCI.format = headlessTarget.format;
+	imageCI.extent = { width, height, 1 };
+	imageCI.mipLevels = 1;
+	imageCI.arrayLayers = 1;
+	imageCI.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageCI.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageCI.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+
+	VK_CHECK_RESULT(vkCreateImage(device, &imageCI, nullptr, &headlessTarget.image));
+	VkMemoryRequirements memReqs{};
+	vkGetImageMemoryRequirements(device, headlessTarget.image, &memReqs);
+
+	VkMemoryAllocateInfo memAllloc{};
+	memAllloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	memAllloc.allocationSize = memReqs.size;
+	memAllloc.memoryTypeIndex = vulkanDevice->getMemoryType(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	VK_CHECK_RESULT(vkAllocateMemory(device, &memAllloc, nullptr, &headlessTarget.memory));
+	VK_CHECK_RESULT(vkBindImageMemory(device, headlessTarget.image, headlessTarget.memory, 0));
+
+	VkImageViewCreateInfo imageViewCI{};
+	imageViewCI.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	imageViewCI.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	imageViewCI.image = headlessTarget.image;
+	imageViewCI.format = headlessTarget.format;
+	imageViewCI.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	imageViewCI.subresourceRange.baseMipLevel = 0;
+	imageViewCI.subresourceRange.levelCount = 1;
+	imageViewCI.subresourceRange.baseArrayLayer = 0;
+	imageViewCI.subresourceRange.layerCount = 1;
+	VK_CHECK_RESULT(vkCreateImageView(device, &imageViewCI, nullptr, &headlessTarget.view));
+}
+
 // void VulkanExampleBase::OnUpdateUIOverlay(vks::UIOverlay *overlay) {}
 
 // #if defined(_WIN32)
@@ -76,6 +76,8 @@
 #include "VulkanInitializers.hpp"
 #include "camera.hpp"
 #include "benchmark.hpp"
+#include "pipeline_cache.h"
+#include "frame_capture.h"
 
 class VulkanExampleBase
 {
@@ -93,6 +95,7 @@ private:
 	void reCreateSynchronizationPrimitives();
 	void createSurface();
 	void createSwapChain();
+	void setupHeadlessTarget();
 	void createCommandBuffers();
 	void destroyCommandBuffers();
 	std::string shaderDir = "glsl";
@@ -153,8 +156,12 @@ protected:
 	VkDescriptorPool descriptorPool{ VK_NULL_HANDLE };
 	// List of shader modules created (stored for cleanup)
 	std::vector<VkShaderModule> shaderModules;
-	// Pipeline cache object
+	// Pipeline cache object, persisted to pipelineCachePath between runs
 	VkPipelineCache pipelineCache{ VK_NULL_HANDLE };
+	vkprof::PersistentPipelineCache persistentPipelineCache;
+	// Asynchronous readback and encoding of the frames written to output_path
+	vkprof::FrameCapture frameCapture;
+	uint32_t capturedFrames = 0;
 	// Wraps the swap chain to present images (framebuffers) to the windowing system
 	VulkanSwapChain swapChain;
 	// Synchronization semaphores
@@ -173,8 +180,14 @@ public:
 	uint32_t width = 1600;
 	uint32_t height = 900;
 	bool offScreen = false;
+	// No window, surface or swapchain: frames go to headlessTarget
+	bool headless = false;
 	bool screenshotSaved{ false };
+	// Consecutive frames written to output_path once the first frames are rendered
+	uint32_t captureFrames = 1;
 	std::string output_path;
+	// Empty to disable loading and saving the pipeline cache
+	std::string pipelineCachePath = vkprof::PersistentPipelineCache::defaultPath();
 
 	// vks::UIOverlay ui;
 	CommandLineParser commandLineParser;
@@ -239,6 +252,14 @@ public:
 		VkImageView view;
 	} depthStencil{};
 
+	/** @brief Color attachment used in place of the swapchain images in headless mode */
+	struct {
+		VkImage image;
+		VkDeviceMemory memory;
+		VkImageView view;
+		VkFormat format;
+	} headlessTarget{};
+
 // 	/** @brief Default base class constructor */
 	VulkanExampleBase();
 	virtual ~VulkanExampleBase();
@@ -283,8 +304,8 @@ void setupWindow();
 	/** @brief Entry point for the main render loop */
 	void renderLoop();
 
-	
-	virtual void saveScreenshot(std::string filename, uint32_t currentImage);
+	/** @brief Queues a copy of image to the next file of the capture sequence, presentation then waits on *presentWait */
+	void captureFrame(VkImage image, VkFormat format, VkImageLayout layout, VkSemaphore* presentWait = nullptr);
 
 	/** @brief Adds the drawing commands for the ImGui overlay to the given command buffer */
 	// void drawUI(const VkCommandBuffer commandBuffer);
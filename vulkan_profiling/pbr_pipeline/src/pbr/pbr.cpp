@@ -20,298 +20,10 @@
 #include "generated/offscreen_frag.h"
 #include "generated/offscreen_vert.h"
 
-#include <stb_image_write.h>
-
 void PBR::getEnabledFeatures() {
 	enabledFeatures.samplerAnisotropy = deviceFeatures.samplerAnisotropy;
 }
 
-void PBR::saveScreenshot(std::string filename, uint32_t currentImage) {
-	// std::cout<<"saving screenshot"<<std::endl;
-	screenshotSaved = false;
-	bool supportsBlit = true;
-
-	// Check blit support for source and destination
-	VkFormatProperties formatProps;
-
-	// Check if the device supports blitting from optimal images (the swapchain images are in optimal format)
-	vkGetPhysicalDeviceFormatProperties(physicalDevice, swapChain.colorFormat, &formatProps);
-	if (!(formatProps.optimalTilingFeatures & VK_FORMAT_FEATURE_BLIT_SRC_BIT)) {
-		std::cerr << "Device does not support blitting from optimal tiled images, using copy instead of blit!" << std::endl;
-		supportsBlit = false;
-	}
-
-	// Check if the device supports blitting to linear images
-	vkGetPhysicalDeviceFormatProperties(physicalDevice, VK_FORMAT_R8G8B8A8_SRGB, &formatProps);
-	if (!(formatProps.linearTilingFeatures & VK_FORMAT_FEATURE_BLIT_DST_BIT)) {
-		std::cerr << "Device does not support blitting to linear tiled images, using copy instead of blit!" << std::endl;
-		supportsBlit = false;
-	}
-
-	// Source for the copy is the last rendered swapchain image
-	VkImage srcImage = swapChain.images[currentImage];
-
-	// Create the linear tiled destination image to copy to and to read the memory from
-	VkImageCreateInfo imageCreateCI{};
-			imageCreateCI.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-	imageCreateCI.imageType = VK_IMAGE_TYPE_2D;
-	// Note that vkCmdBlitImage (if supported) will also do format conversions if the swapchain color format would differ
-	imageCreateCI.format = VK_FORMAT_R8G8B8A8_SRGB;
-	imageCreateCI.extent.width = width;
-	imageCreateCI.extent.height = height;
-	imageCreateCI.extent.depth = 1;
-	imageCreateCI.arrayLayers = 1;
-	imageCreateCI.mipLevels = 1;
-	imageCreateCI.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	imageCreateCI.samples = VK_SAMPLE_COUNT_1_BIT;
-	imageCreateCI.tiling = VK_IMAGE_TILING_LINEAR;
-	imageCreateCI.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT;
-	// Create the image
-	VkImage dstImage;
-	if(vkCreateImage(device, &imageCreateCI, nullptr, &dstImage) != VK_SUCCESS){
-		throw std::runtime_error("failed to create image!");
-	}
-	// Create memory to back up the image
-	VkMemoryRequirements memRequirements;
-	VkMemoryAllocateInfo memAllocInfo{};
-			memAllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	VkDeviceMemory dstImageMemory;
-	vkGetImageMemoryRequirements(device, dstImage, &memRequirements);
-	memAllocInfo.allocationSize = memRequirements.size;
-	// Memory must be host visible to copy from
-	memAllocInfo.memoryTypeIndex = vulkanDevice->getMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-	if(vkAllocateMemory(device, &memAllocInfo, nullptr, &dstImageMemory) != VK_SUCCESS){
-		throw std::runtime_error("failed to allocate image memory!");
-	}
-	if(vkBindImageMemory(device, dstImage, dstImageMemory, 0) != VK_SUCCESS){
-		throw std::runtime_error("failed to bind image memory!");
-	}
-
-	// Do the actual blit from the swapchain image to our host visible destination image
-	// VkCommandBuffer copyCmd = vulkanDevice->createCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
-			VkCommandBuffer copyCmd = vulkanDevice->createCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
-
-	// Transition destination image to transfer destination layout
-	// vks::tools::insertImageMemoryBarrier(
-	// 	copyCmd,
-	// 	dstImage,
-	// 	0,
-	// 	VK_ACCESS_TRANSFER_WRITE_BIT,
-	// 	VK_IMAGE_LAYOUT_UNDEFINED,
-	// 	VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-	// 	VK_PIPELINE_STAGE_TRANSFER_BIT,
-	// 	VK_PIPELINE_STAGE_TRANSFER_BIT,
-	// 	VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 });
-			// std::cout<<"transitioning image"<<std::endl;
-			VkImageMemoryBarrier imageMemoryBarrier_1{};
-			imageMemoryBarrier_1.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-			imageMemoryBarrier_1.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-			imageMemoryBarrier_1.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-			imageMemoryBarrier_1.srcAccessMask = 0;
-			imageMemoryBarrier_1.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-			imageMemoryBarrier_1.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-			imageMemoryBarrier_1.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-			imageMemoryBarrier_1.image = dstImage;
-			imageMemoryBarrier_1.subresourceRange = VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
-			vkCmdPipelineBarrier(copyCmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier_1);
-
-	// Transition swapchain image from present to transfer source layout
-	// vks::tools::insertImageMemoryBarrier(
-	// 	copyCmd,
-	// 	srcImage,
-	// 	VK_ACCESS_MEMORY_READ_BIT,
-	// 	VK_ACCESS_TRANSFER_READ_BIT,
-	// 	VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-	// 	VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-	// 	VK_PIPELINE_STAGE_TRANSFER_BIT,
-	// 	VK_PIPELINE_STAGE_TRANSFER_BIT,
-	// 	VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 });
-			// std::cout<<"transition swapchain image"<<std::endl;
-			VkImageMemoryBarrier imageMemoryBarrier_2{};
-			imageMemoryBarrier_2.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-			imageMemoryBarrier_2.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-			imageMemoryBarrier_2.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-			imageMemoryBarrier_2.srcAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-			imageMemoryBarrier_2.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-			imageMemoryBarrier_2.oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-			imageMemoryBarrier_2.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-			imageMemoryBarrier_2.image = srcImage;
-			imageMemoryBarrier_2.subresourceRange = VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
-			vkCmdPipelineBarrier(copyCmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier_2);
-
-	// If source and destination support blit we'll blit as this also does automatic format conversion (e.g. from BGR to RGB)
-	if (supportsBlit)
-	{
-		// Define the region to blit (we will blit the whole swapchain image)
-		VkOffset3D blitSize;
-		blitSize.x = width;
-		blitSize.y = height;
-		blitSize.z = 1;
-		VkImageBlit imageBlitRegion{};
-		imageBlitRegion.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		imageBlitRegion.srcSubresource.layerCount = 1;
-		imageBlitRegion.srcOffsets[1] = blitSize;
-		imageBlitRegion.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		imageBlitRegion.dstSubresource.layerCount = 1;
-		imageBlitRegion.dstOffsets[1] = blitSize;
-
-		// Issue the blit command
-		vkCmdBlitImage(
-			copyCmd,
-			srcImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-			dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-			1,
-			&imageBlitRegion,
-			VK_FILTER_NEAREST);
-	}
-	else
-	{
-		// Otherwise use image copy (requires us to manually flip components)
-		VkImageCopy imageCopyRegion{};
-		imageCopyRegion.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		imageCopyRegion.srcSubresource.layerCount = 1;
-		imageCopyRegion.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		imageCopyRegion.dstSubresource.layerCount = 1;
-		imageCopyRegion.extent.width = width;
-		imageCopyRegion.extent.height = height;
-		imageCopyRegion.extent.depth = 1;
-
-		// Issue the copy command
-		vkCmdCopyImage(
-			copyCmd,
-			srcImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-			dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-			1,
-			&imageCopyRegion);
-	}
-
-	// Transition destination image to general layout, which is the required layout for mapping the image memory later on
-	// vks::tools::insertImageMemoryBarrier(
-	// 	copyCmd,
-	// 	dstImage,
-	// 	VK_ACCESS_TRANSFER_WRITE_BIT,
-	// 	VK_ACCESS_MEMORY_READ_BIT,
-	// 	VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-	// 	VK_IMAGE_LAYOUT_GENERAL,
-	// 	VK_PIPELINE_STAGE_TRANSFER_BIT,
-	// 	VK_PIPELINE_STAGE_TRANSFER_BIT,
-	// 	VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 });
-			// std::cout<<"transition destination image"<<std::endl;
-			VkImageMemoryBarrier imageMemoryBarrier_3{};
-			imageMemoryBarrier_3.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-			imageMemoryBarrier_3.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-			imageMemoryBarrier_3.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-			imageMemoryBarrier_3.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-			imageMemoryBarrier_3.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-			imageMemoryBarrier_3.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-			imageMemoryBarrier_3.newLayout = VK_IMAGE_LAYOUT_GENERAL;
-			imageMemoryBarrier_3.image = dstImage;
-			imageMemoryBarrier_3.subresourceRange = VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
-			vkCmdPipelineBarrier(copyCmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier_3);
-
-	// Transition back the swap chain image after the blit is done
-	// vks::tools::insertImageMemoryBarrier(
-	// 	copyCmd,
-	// 	srcImage,
-	// 	VK_ACCESS_TRANSFER_READ_BIT,
-	// 	VK_ACCESS_MEMORY_READ_BIT,
-	// 	VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-	// 	VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-	// 	VK_PIPELINE_STAGE_TRANSFER_BIT,
-	// 	VK_PIPELINE_STAGE_TRANSFER_BIT,
-	// 	VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 });
-			// std::cout<<"transition back swapchain image"<<std::endl;
-			VkImageMemoryBarrier imageMemoryBarrier_4{};
-			imageMemoryBarrier_4.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-			imageMemoryBarrier_4.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-			imageMemoryBarrier_4.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-			imageMemoryBarrier_4.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-			imageMemoryBarrier_4.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-			imageMemoryBarrier_4.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-			imageMemoryBarrier_4.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-			imageMemoryBarrier_4.image = srcImage;
-			imageMemoryBarrier_4.subresourceRange = VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
-			vkCmdPipelineBarrier(copyCmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier_4);
-
-	vulkanDevice->flushCommandBuffer(copyCmd, queue);
-
-	// Get layout of the image (including row pitch)
-	VkImageSubresource subResource { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0 };
-	VkSubresourceLayout subResourceLayout;
-	vkGetImageSubresourceLayout(device, dstImage, &subResource, &subResourceLayout);
-
-	// Map image memory so we can start copying from it
-	const char* data;
-	vkMapMemory(device, dstImageMemory, 0, VK_WHOLE_SIZE, 0, (void**)&data);
-	data += subResourceLayout.offset;
-
-			std::vector<unsigned char> imageData(width * height * 4);
-
-			for (uint32_t y = 0; y < height; y++)
-			{
-					memcpy(&imageData[y * width * 4],
-							data + y * subResourceLayout.rowPitch,
-							width * 4);
-			}
-
-	// std::ofstream file(filename, std::ios::out | std::ios::binary);
-
-	// ppm header
-	// file << "P6\n" << width << "\n" << height << "\n" << 255 << "\n";
-
-	// If source is BGR (destination is always RGB) and we can't use blit (which does automatic conversion), we'll have to manually swizzle color components
-	bool colorSwizzle = false;
-	// Check if source is BGR
-	// Note: Not complete, only contains most common and basic BGR surface formats for demonstration purposes
-	if (!supportsBlit)
-	{
-		std::vector<VkFormat> formatsBGR = { VK_FORMAT_B8G8R8A8_SRGB, VK_FORMAT_B8G8R8A8_UNORM, VK_FORMAT_B8G8R8A8_SNORM };
-		colorSwizzle = (std::find(formatsBGR.begin(), formatsBGR.end(), swapChain.colorFormat) != formatsBGR.end());
-	}
-
-			if (colorSwizzle)
-			{
-					for (size_t i = 0; i < imageData.size(); i += 4)
-							std::swap(imageData[i], imageData[i + 2]); // swap R and B
-			}
-	
-			stbi_write_png(filename.c_str(), width, height, 4, imageData.data(), width * 4);
-
-	// ppm binary pixel data
-	// for (uint32_t y = 0; y < HEIGHT; y++)
-	// {
-	// 	unsigned int *row = (unsigned int*)data;
-	// 	for (uint32_t x = 0; x < WIDTH; x++)
-	// 	{
-	// 		if (colorSwizzle)
-	// 		{
-	// 			file.write((char*)row+2, 1);
-	// 			file.write((char*)row+1, 1);
-	// 			file.write((char*)row, 1);
-			//             file.write((char*)row+3, 1);
-	// 		}
-	// 		else
-	// 		{
-	// 			file.write((char*)row, 4);
-	// 		}
-	// 		row++;
-	// 	}
-	// 	data += subResourceLayout.rowPitch;
-	// }
-	// file.close();
-
-	std::cout << "Screenshot saved to disk" << std::endl;
-
-	// Clean up resources
-	vkUnmapMemory(device, dstImageMemory);
-	vkFreeMemory(device, dstImageMemory, nullptr);
-	vkDestroyImage(device, dstImage, nullptr);
-
-	screenshotSaved = true;
-}
-
-
-
 void PBR::buildCommandBuffer(uint32_t currentBuffer)
 {
 	// static auto startTime = std::chrono::high_resolution_clock::now();
@@ -1273,7 +985,7 @@ void PBR::SetOutputPath(const std::string& output_p) {
 }
 
 void PBR::run() {
-	setupWindow();
+	if (!headless) setupWindow();
 	initVulkan();
 	prepare();
 	renderLoop();
@@ -34,6 +34,7 @@ int main(int argc, char** argv) {
   argparse::ArgumentParser parser("PBR");
   parser.add_argument("-i", "--input").help("input model 1 path.");
   parser.add_argument("-o", "--output").help("output image path.");
+  parser.add_argument("--pipelinecache").help("pipeline cache file, loaded at startup and saved at exit (empty to disable).");
   // parser.add_argument("-i2", "--input2").help("input model 2 path.");
   parser.add_argument("-v", "--view").nargs(16).help("View Matrix").scan<'g', float>().default_value(view_def);
   parser.add_argument("-p", "--proj").nargs(16).help("Projection Matrix").scan<'g', float>().default_value(proj_def);
@@ -41,6 +42,8 @@ int main(int argc, char** argv) {
   parser.add_argument("-c", "--camera").nargs(3).help("Camera Position").scan<'g', float>().default_value(cam_def);
   parser.add_argument("-S", "--shadow").default_value(false).implicit_value(true).help("Enable shadow mapping.");
   parser.add_argument("-P", "--pcf").default_value(false).implicit_value(true).help("Enable PCF shadow mapping.");
+  parser.add_argument("-H", "--headless").default_value(false).implicit_value(true).help("Render offscreen without a window or swapchain, the frame is written to --output.");
+  parser.add_argument("-n", "--frames").default_value(1u).help("Number of consecutive frames written to --output, numbered when more than one.").scan<'u', unsigned int>();
   parser.add_argument("-L", "--light").default_value(float(3.0)).help("Light Strength").scan<'g', float>();
   parser.add_argument("-A", "--ambient").default_value(float(0.01)).help("Ambient Light Strength").scan<'g', float>();
   try {
@@ -64,6 +67,9 @@ int main(int argc, char** argv) {
     std::cout << "output path: " << output_p << std::endl;
     pbr_pipe.SetOutputPath(output_p);
   }
+  if(parser.is_used("pipelinecache")) {
+    pbr_pipe.SetPipelineCachePath(parser.get<std::string>("pipelinecache"));
+  }
   if(parser.is_used("view")) {
     view_def = parser.get<std::vector<float>>("view");
   }
@@ -82,6 +88,8 @@ int main(int argc, char** argv) {
   float ambient_strength = parser.get<float>("ambient");
   pbr_pipe.SetMatrices(view_def.data(), proj_def.data(), model_def.data(), cam_def.data());
   pbr_pipe.SetUseShadow(use_shadow, use_pcf);
+  pbr_pipe.SetHeadless(parser.get<bool>("headless"));
+  pbr_pipe.SetCaptureFrames(parser.get<unsigned int>("frames"));
   std::cout <<"Setting light strength to " << light_strength << " and ambient strength to " << ambient_strength << std::endl;
   pbr_pipe.SetLightStrength(light_strength, ambient_strength);
   pbr_pipe.run();
@@ -33,6 +33,19 @@ def run_psnr_exec(helper:Helper, vm, pm, mm, app='vkgs'):
 		print(cmd)
 	
 
+def run_batch_exec(helper:Helper, vm, pm, app='vkgs'):
+	# a single launch for all the views, images and timings.csv in the output folder
+	views_path = helper.write_views_file(vm, pm, app)
+	cmd = helper.get_batch_cmd(views_path, app=app)
+	print(cmd)
+
+def run_order_exec(helper:Helper, vm, pm, app='vkgs'):
+	# one batch launch per splat order, compare the timings.csv of the output folders
+	views_path = helper.write_views_file(vm, pm, app)
+	for order in ['file', 'morton', 'hilbert']:
+		cmd = helper.get_batch_cmd(views_path, app=app, order=order)
+		print(cmd)
+
 def profile(model='trex',scale=1.0, app='vkgs',run='profile'):
 	helper = Helper(model=model)
 	helper.convert_matrices()
@@ -46,6 +59,10 @@ def profile(model='trex',scale=1.0, app='vkgs',run='profile'):
 		run_profiler(helper, view, proj, mm, app)
 	elif run == 'psnr':
 		run_psnr_exec(helper,view, proj, mm, app)
+	elif run == 'batch':
+		run_batch_exec(helper, view, proj, app)
+	elif run == 'order':
+		run_order_exec(helper, view, proj, app)
 	else:
 		raise Exception("Invalid run type")
 
@@ -1,5 +1,6 @@
 #include <string>
 #include <memory>
+#include <cstdint>
 
 #ifndef RAST_H
 #define RAST_H
@@ -11,6 +12,11 @@ class Rasterizer {
 		void SetMatrices(const float* view, const float* proj, const float* model);
 		void SetModelPath(const std::string& model_p);
 		void SetOutputPath(const std::string& output_p);
+		void SetPipelineCachePath(const std::string& cache_p);
+		// render into an offscreen image without any window, surface or swapchain
+		void SetHeadless(bool headless);
+		// number of consecutive frames written to the output path, numbered when more than one
+		void SetCaptureFrames(uint32_t frames);
 		void run();
 	private:
   	class Impl;
@@ -23,9 +23,9 @@
 #define TINYOBJLOADER_IMPLEMENTATION
 #include "tiny_obj_loader.h"
 
-#include <stb_image_write.h>
-
 #include "rast/gltf_scene.h"
+#include "pipeline_cache.h"
+#include "frame_capture.h"
 
 #include <iostream>
 #include <fstream>
@@ -188,6 +188,15 @@ public:
         output_path = output_p;
         offScreen = true;
     }
+    void SetPipelineCachePath(const std::string& cache_p) {
+        pipeline_cache_path = cache_p;
+    }
+    void SetHeadless(bool headless_mode) {
+        headless = headless_mode;
+    }
+    void SetCaptureFrames(uint32_t frames) {
+        capture_frames = std::max(frames, 1u);
+    }
     void run() {
         initWindow();
         initVulkan();
@@ -220,10 +229,15 @@ private:
     std::vector<VkImageView> swapChainImageViews;
     std::vector<VkFramebuffer> swapChainFramebuffers;
 
+    // headless mode renders into this image in place of the swapchain (its view is swapChainImageViews[0])
+    VkImage offscreenColorImage = VK_NULL_HANDLE;
+    VkDeviceMemory offscreenColorImageMemory = VK_NULL_HANDLE;
+
     VkRenderPass renderPass;
     VkDescriptorSetLayout descriptorSetLayout;
     VkPipelineLayout pipelineLayout;
     VkPipeline graphicsPipeline;
+    vkprof::PersistentPipelineCache pipelineCache;
 
     VkCommandPool commandPool;
 
@@ -286,18 +300,27 @@ private:
 
     //output path
     std::string output_path;
+    std::string pipeline_cache_path = vkprof::PersistentPipelineCache::defaultPath();
     bool screenshotSaved{ false }; 
     bool offScreen{ false };    
+    // consecutive frames written to output_path, numbered when more than one
+    uint32_t capture_frames = 1;
+    uint32_t capturedFrames = 0;
+    vkprof::FrameCapture frameCapture;
+    // no window, surface or swapchain: renders into offscreenColorImage
+    bool headless{ false };
 
     bool framebufferResized = false;
 
     void initWindow() {
+        camera_.SetWindowSize(WIDTH, HEIGHT);
+        if (headless) return;
+
         glfwInit();
 
         glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
 
         window = glfwCreateWindow(WIDTH, HEIGHT, "Vulkan", nullptr, nullptr);
-        camera_.SetWindowSize(WIDTH, HEIGHT);
         glfwSetWindowUserPointer(window, this);
         glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
     }
@@ -310,11 +333,16 @@ private:
     void initVulkan() {
         createInstance();
         setupDebugMessenger();
-        createSurface();
+        if (!headless) createSurface();
         pickPhysicalDevice();
         createLogicalDevice();
-        createSwapChain();
-        createImageViews();
+        createPipelineCache();
+        if (headless) {
+            createOffscreenTarget();
+        } else {
+            createSwapChain();
+            createImageViews();
+        }
         createRenderPass();
         createDescriptorSetLayout();
         createGraphicsPipeline();
@@ -329,328 +357,49 @@ private:
         glTFScene.createDescriptorSets(descriptorPool, descriptorSetLayout, MAX_FRAMES_IN_FLIGHT, uniformBuffers, sizeof(UniformBufferObject));
         createCommandBuffers();
         createSyncObjects();
+        if (offScreen) {
+            QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
+            if (frameCapture.init(physicalDevice, device, indices.graphicsFamily.value(), graphicsQueue, swapChainExtent.width, swapChainExtent.height) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create frame capture buffers!");
+            }
+        }
     }
 
     void mainLoop() {
-        // std::cout<<"os"<<offScreen<<"ss"<<screenshotSaved<<std::endl;
-        while (!glfwWindowShouldClose(window)) {
+        if (headless) {
+            // the captured frames, or a single one when there is no output_path
+            do {
+                drawFrameHeadless();
+            } while (offScreen && !screenshotSaved);
+        } else {
             // std::cout<<"os"<<offScreen<<"ss"<<screenshotSaved<<std::endl;
-            // std::cout<<"should clode"<<(offScreen && !screenshotSaved)<<std::endl;
-            glfwPollEvents();
-            drawFrame();
-            if (offScreen) 
-                if(screenshotSaved) break;
+            while (!glfwWindowShouldClose(window)) {
+                // std::cout<<"os"<<offScreen<<"ss"<<screenshotSaved<<std::endl;
+                // std::cout<<"should clode"<<(offScreen && !screenshotSaved)<<std::endl;
+                glfwPollEvents();
+                drawFrame();
+                if (offScreen) 
+                    if(screenshotSaved) break;
+            }
         }
 
         vkDeviceWaitIdle(device);
-    }
-
-    void saveScreenshot(std::string &filename, uint32_t currentImage)
-	{
-        std::cout<<"saving screenshot"<<std::endl;
-		screenshotSaved = false;
-		bool supportsBlit = true;
-
-		// Check blit support for source and destination
-		VkFormatProperties formatProps;
-
-		// Check if the device supports blitting from optimal images (the swapchain images are in optimal format)
-		vkGetPhysicalDeviceFormatProperties(physicalDevice, swapChainImageFormat, &formatProps);
-		if (!(formatProps.optimalTilingFeatures & VK_FORMAT_FEATURE_BLIT_SRC_BIT)) {
-			std::cerr << "Device does not support blitting from optimal tiled images, using copy instead of blit!" << std::endl;
-			supportsBlit = false;
-		}
-
-		// Check if the device supports blitting to linear images
-		vkGetPhysicalDeviceFormatProperties(physicalDevice, VK_FORMAT_R8G8B8A8_SRGB, &formatProps);
-		if (!(formatProps.linearTilingFeatures & VK_FORMAT_FEATURE_BLIT_DST_BIT)) {
-			std::cerr << "Device does not support blitting to linear tiled images, using copy instead of blit!" << std::endl;
-			supportsBlit = false;
-		}
-
-		// Source for the copy is the last rendered swapchain image
-		VkImage srcImage = swapChainImages[currentImage];
-
-		// Create the linear tiled destination image to copy to and to read the memory from
-		VkImageCreateInfo imageCreateCI{};
-        imageCreateCI.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-		imageCreateCI.imageType = VK_IMAGE_TYPE_2D;
-		// Note that vkCmdBlitImage (if supported) will also do format conversions if the swapchain color format would differ
-		imageCreateCI.format = VK_FORMAT_R8G8B8A8_SRGB;
-		imageCreateCI.extent.width = WIDTH;
-		imageCreateCI.extent.height = HEIGHT;
-		imageCreateCI.extent.depth = 1;
-		imageCreateCI.arrayLayers = 1;
-		imageCreateCI.mipLevels = 1;
-		imageCreateCI.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		imageCreateCI.samples = VK_SAMPLE_COUNT_1_BIT;
-		imageCreateCI.tiling = VK_IMAGE_TILING_LINEAR;
-		imageCreateCI.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT;
-		// Create the image
-		VkImage dstImage;
-		if(vkCreateImage(device, &imageCreateCI, nullptr, &dstImage) != VK_SUCCESS){
-            throw std::runtime_error("failed to create image!");
-        }
-		// Create memory to back up the image
-		VkMemoryRequirements memRequirements;
-		VkMemoryAllocateInfo memAllocInfo{};
-        memAllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		VkDeviceMemory dstImageMemory;
-		vkGetImageMemoryRequirements(device, dstImage, &memRequirements);
-		memAllocInfo.allocationSize = memRequirements.size;
-		// Memory must be host visible to copy from
-		memAllocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-		if(vkAllocateMemory(device, &memAllocInfo, nullptr, &dstImageMemory) != VK_SUCCESS){
-            throw std::runtime_error("failed to allocate image memory!");
-        }
-        if(vkBindImageMemory(device, dstImage, dstImageMemory, 0) != VK_SUCCESS){
-            throw std::runtime_error("failed to bind image memory!");
-        }
-
-		// Do the actual blit from the swapchain image to our host visible destination image
-		// VkCommandBuffer copyCmd = vulkanDevice->createCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
-        VkCommandBuffer copyCmd = createSingleCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY,commandPool,true);
-
-		// Transition destination image to transfer destination layout
-		// vks::tools::insertImageMemoryBarrier(
-		// 	copyCmd,
-		// 	dstImage,
-		// 	0,
-		// 	VK_ACCESS_TRANSFER_WRITE_BIT,
-		// 	VK_IMAGE_LAYOUT_UNDEFINED,
-		// 	VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-		// 	VK_PIPELINE_STAGE_TRANSFER_BIT,
-		// 	VK_PIPELINE_STAGE_TRANSFER_BIT,
-		// 	VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 });
-        // std::cout<<"transitioning image"<<std::endl;
-        VkImageMemoryBarrier imageMemoryBarrier_1{};
-        imageMemoryBarrier_1.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        imageMemoryBarrier_1.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        imageMemoryBarrier_1.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        imageMemoryBarrier_1.srcAccessMask = 0;
-        imageMemoryBarrier_1.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        imageMemoryBarrier_1.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        imageMemoryBarrier_1.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        imageMemoryBarrier_1.image = dstImage;
-        imageMemoryBarrier_1.subresourceRange = VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
-        vkCmdPipelineBarrier(copyCmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier_1);
-
-		// Transition swapchain image from present to transfer source layout
-		// vks::tools::insertImageMemoryBarrier(
-		// 	copyCmd,
-		// 	srcImage,
-		// 	VK_ACCESS_MEMORY_READ_BIT,
-		// 	VK_ACCESS_TRANSFER_READ_BIT,
-		// 	VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-		// 	VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-		// 	VK_PIPELINE_STAGE_TRANSFER_BIT,
-		// 	VK_PIPELINE_STAGE_TRANSFER_BIT,
-		// 	VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 });
-        // std::cout<<"transition swapchain image"<<std::endl;
-        VkImageMemoryBarrier imageMemoryBarrier_2{};
-        imageMemoryBarrier_2.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        imageMemoryBarrier_2.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        imageMemoryBarrier_2.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        imageMemoryBarrier_2.srcAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-        imageMemoryBarrier_2.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-        imageMemoryBarrier_2.oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-        imageMemoryBarrier_2.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-        imageMemoryBarrier_2.image = srcImage;
-        imageMemoryBarrier_2.subresourceRange = VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
-        vkCmdPipelineBarrier(copyCmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier_2);
-
-		// If source and destination support blit we'll blit as this also does automatic format conversion (e.g. from BGR to RGB)
-		if (supportsBlit)
-		{
-			// Define the region to blit (we will blit the whole swapchain image)
-			VkOffset3D blitSize;
-			blitSize.x = WIDTH;
-			blitSize.y = HEIGHT;
-			blitSize.z = 1;
-			VkImageBlit imageBlitRegion{};
-			imageBlitRegion.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			imageBlitRegion.srcSubresource.layerCount = 1;
-			imageBlitRegion.srcOffsets[1] = blitSize;
-			imageBlitRegion.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			imageBlitRegion.dstSubresource.layerCount = 1;
-			imageBlitRegion.dstOffsets[1] = blitSize;
-
-			// Issue the blit command
-			vkCmdBlitImage(
-				copyCmd,
-				srcImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-				dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-				1,
-				&imageBlitRegion,
-				VK_FILTER_NEAREST);
-		}
-		else
-		{
-			// Otherwise use image copy (requires us to manually flip components)
-			VkImageCopy imageCopyRegion{};
-			imageCopyRegion.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			imageCopyRegion.srcSubresource.layerCount = 1;
-			imageCopyRegion.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			imageCopyRegion.dstSubresource.layerCount = 1;
-			imageCopyRegion.extent.width = WIDTH;
-			imageCopyRegion.extent.height = HEIGHT;
-			imageCopyRegion.extent.depth = 1;
-
-			// Issue the copy command
-			vkCmdCopyImage(
-				copyCmd,
-				srcImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-				dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-				1,
-				&imageCopyRegion);
-		}
-
-		// Transition destination image to general layout, which is the required layout for mapping the image memory later on
-		// vks::tools::insertImageMemoryBarrier(
-		// 	copyCmd,
-		// 	dstImage,
-		// 	VK_ACCESS_TRANSFER_WRITE_BIT,
-		// 	VK_ACCESS_MEMORY_READ_BIT,
-		// 	VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-		// 	VK_IMAGE_LAYOUT_GENERAL,
-		// 	VK_PIPELINE_STAGE_TRANSFER_BIT,
-		// 	VK_PIPELINE_STAGE_TRANSFER_BIT,
-		// 	VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 });
-        // std::cout<<"transition destination image"<<std::endl;
-        VkImageMemoryBarrier imageMemoryBarrier_3{};
-        imageMemoryBarrier_3.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        imageMemoryBarrier_3.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        imageMemoryBarrier_3.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        imageMemoryBarrier_3.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        imageMemoryBarrier_3.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-        imageMemoryBarrier_3.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        imageMemoryBarrier_3.newLayout = VK_IMAGE_LAYOUT_GENERAL;
-        imageMemoryBarrier_3.image = dstImage;
-        imageMemoryBarrier_3.subresourceRange = VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
-        vkCmdPipelineBarrier(copyCmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier_3);
-
-		// Transition back the swap chain image after the blit is done
-		// vks::tools::insertImageMemoryBarrier(
-		// 	copyCmd,
-		// 	srcImage,
-		// 	VK_ACCESS_TRANSFER_READ_BIT,
-		// 	VK_ACCESS_MEMORY_READ_BIT,
-		// 	VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-		// 	VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-		// 	VK_PIPELINE_STAGE_TRANSFER_BIT,
-		// 	VK_PIPELINE_STAGE_TRANSFER_BIT,
-		// 	VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 });
-        // std::cout<<"transition back swapchain image"<<std::endl;
-        VkImageMemoryBarrier imageMemoryBarrier_4{};
-        imageMemoryBarrier_4.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        imageMemoryBarrier_4.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        imageMemoryBarrier_4.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        imageMemoryBarrier_4.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-        imageMemoryBarrier_4.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-        imageMemoryBarrier_4.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-        imageMemoryBarrier_4.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-        imageMemoryBarrier_4.image = srcImage;
-        imageMemoryBarrier_4.subresourceRange = VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
-        vkCmdPipelineBarrier(copyCmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier_4);
-
-		// vulkanDevice->flushCommandBuffer(copyCmd, queue);
-        if(vkEndCommandBuffer(copyCmd) != VK_SUCCESS){
-            throw std::runtime_error("failed to record command buffer!");
-        }   
-        VkSubmitInfo submitInfo{};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &copyCmd;
-
-        VkFenceCreateInfo fenceInfo{};
-        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-        fenceInfo.flags = 0;
-        VkFence ScFence;
-        if(vkCreateFence(device, &fenceInfo, nullptr, &ScFence) != VK_SUCCESS){
-            throw std::runtime_error("failed to create fence!");
+        if (offScreen) {
+            frameCapture.flush();
+            std::cout << frameCapture.summary() << std::endl;
         }
-        if(vkQueueSubmit(graphicsQueue, 1, &submitInfo, ScFence) != VK_SUCCESS){
-            throw std::runtime_error("failed to submit queue!");
-        }
-        if(vkWaitForFences(device, 1, &ScFence, VK_TRUE, std::numeric_limits<uint64_t>::max()) != VK_SUCCESS){
-            throw std::runtime_error("failed to wait for fence!");
-        }
-        vkDestroyFence(device, ScFence, nullptr);
-        vkFreeCommandBuffers(device, commandPool, 1, &copyCmd);
-
-		// Get layout of the image (including row pitch)
-		VkImageSubresource subResource { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0 };
-		VkSubresourceLayout subResourceLayout;
-		vkGetImageSubresourceLayout(device, dstImage, &subResource, &subResourceLayout);
-
-		// Map image memory so we can start copying from it
-		const char* data;
-		vkMapMemory(device, dstImageMemory, 0, VK_WHOLE_SIZE, 0, (void**)&data);
-		data += subResourceLayout.offset;
-
-        std::vector<uint8_t> imageData(WIDTH * HEIGHT * 4);
+    }
 
-        for (uint32_t y = 0; y < HEIGHT; y++)
-        {
-            memcpy(imageData.data() + (y * WIDTH * 4), data, WIDTH * 4);
-            data += subResourceLayout.rowPitch;
+    // queues a copy of image for the asynchronous capture to the next file of the sequence. When
+    // presentWait is given the copy waits on it and it is replaced by the semaphore to present after.
+    void captureFrame(VkImage image, VkImageLayout layout, VkSemaphore* presentWait = nullptr) {
+        const std::string path = vkprof::FrameCapture::sequencePath(output_path, capturedFrames, capture_frames);
+        VkSemaphore waitSemaphore = presentWait ? *presentWait : VK_NULL_HANDLE;
+        if (frameCapture.capture(image, swapChainImageFormat, layout, path, waitSemaphore, presentWait) != VK_SUCCESS) {
+            throw std::runtime_error("failed to capture frame!");
         }
-
-		// std::ofstream file(filename, std::ios::out | std::ios::binary);
-
-		// ppm header
-		// file << "P6\n" << WIDTH << "\n" << HEIGHT << "\n" << 255 << "\n";
-
-		// If source is BGR (destination is always RGB) and we can't use blit (which does automatic conversion), we'll have to manually swizzle color components
-		bool colorSwizzle = false;
-		// Check if source is BGR
-		// Note: Not complete, only contains most common and basic BGR surface formats for demonstration purposes
-		if (!supportsBlit)
-		{
-			std::vector<VkFormat> formatsBGR = { VK_FORMAT_B8G8R8A8_SRGB, VK_FORMAT_B8G8R8A8_UNORM, VK_FORMAT_B8G8R8A8_SNORM };
-			colorSwizzle = (std::find(formatsBGR.begin(), formatsBGR.end(), swapChainImageFormat) != formatsBGR.end());
-		}
-
-        if (colorSwizzle)
-        {
-            for (size_t i = 0; i < imageData.size(); i += 4)
-                std::swap(imageData[i], imageData[i + 2]); // swap R and B
-        }
-    
-        stbi_write_png(filename.c_str(), WIDTH, HEIGHT, 4, imageData.data(), WIDTH * 4);
-
-		// ppm binary pixel data
-		// for (uint32_t y = 0; y < HEIGHT; y++)
-		// {
-		// 	unsigned int *row = (unsigned int*)data;
-		// 	for (uint32_t x = 0; x < WIDTH; x++)
-		// 	{
-		// 		if (colorSwizzle)
-		// 		{
-		// 			file.write((char*)row+2, 1);
-		// 			file.write((char*)row+1, 1);
-		// 			file.write((char*)row, 1);
-        //             file.write((char*)row+3, 1);
-		// 		}
-		// 		else
-		// 		{
-		// 			file.write((char*)row, 4);
-		// 		}
-		// 		row++;
-		// 	}
-		// 	data += subResourceLayout.rowPitch;
-		// }
-		// file.close();
-
-		std::cout << "Screenshot saved to disk" << std::endl;
-
-		// Clean up resources
-		vkUnmapMemory(device, dstImageMemory);
-		vkFreeMemory(device, dstImageMemory, nullptr);
-		vkDestroyImage(device, dstImage, nullptr);
-
-		screenshotSaved = true;
-	}
+        screenshotSaved = ++capturedFrames >= capture_frames;
+    }
 
     void cleanupSwapChain() {
         vkDestroyImageView(device, depthImageView, nullptr);
@@ -665,7 +414,12 @@ private:
             vkDestroyImageView(device, imageView, nullptr);
         }
 
-        vkDestroySwapchainKHR(device, swapChain, nullptr);
+        if (headless) {
+            vkDestroyImage(device, offscreenColorImage, nullptr);
+            vkFreeMemory(device, offscreenColorImageMemory, nullptr);
+        } else {
+            vkDestroySwapchainKHR(device, swapChain, nullptr);
+        }
     }
 
     void cleanup() {
@@ -713,15 +467,19 @@ private:
 
         vkDestroyCommandPool(device, commandPool, nullptr);
 
+        frameCapture.deinit();
+        pipelineCache.deinit();
         vkDestroyDevice(device, nullptr);
 
         if (enableValidationLayers) {
             DestroyDebugUtilsMessengerEXT(instance, debugMessenger, nullptr);
         }
 
-        vkDestroySurfaceKHR(instance, surface, nullptr);
+        if (!headless) vkDestroySurfaceKHR(instance, surface, nullptr);
         vkDestroyInstance(instance, nullptr);
 
+        if (headless) return;
+
         glfwDestroyWindow(window);
 
         glfwTerminate();
@@ -744,6 +502,11 @@ private:
         createImageViews();
         createDepthResources();
         createFramebuffers();
+
+        // the readback buffers follow the size of the swapchain images
+        if (offScreen && frameCapture.resize(swapChainExtent.width, swapChainExtent.height) != VK_SUCCESS) {
+            throw std::runtime_error("failed to resize frame capture buffers!");
+        }
     }
 
     void createInstance() {
@@ -860,8 +623,9 @@ private:
 
         createInfo.pEnabledFeatures = &deviceFeatures;
 
-        createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-        createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+        // the swapchain extension is not needed (nor maybe supported) without presentation
+        createInfo.enabledExtensionCount = headless ? 0 : static_cast<uint32_t>(deviceExtensions.size());
+        createInfo.ppEnabledExtensionNames = headless ? nullptr : deviceExtensions.data();
 
         if (enableValidationLayers) {
             createInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
@@ -882,6 +646,19 @@ private:
 
     }
 
+    void createOffscreenTarget() {
+        swapChainImageFormat = findSupportedFormat(
+            {VK_FORMAT_R8G8B8A8_SRGB, VK_FORMAT_B8G8R8A8_SRGB},
+            VK_IMAGE_TILING_OPTIMAL,
+            VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BLEND_BIT | VK_FORMAT_FEATURE_TRANSFER_SRC_BIT
+        );
+        swapChainExtent = {WIDTH, HEIGHT};
+
+        createImage(WIDTH, HEIGHT, swapChainImageFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, offscreenColorImage, offscreenColorImageMemory);
+        swapChainImages = {offscreenColorImage};
+        swapChainImageViews = {createImageView(offscreenColorImage, swapChainImageFormat, VK_IMAGE_ASPECT_COLOR_BIT)};
+    }
+
     void createSwapChain() {
         SwapChainSupportDetails swapChainSupport = querySwapChainSupport(physicalDevice);
 
@@ -959,7 +736,8 @@ private:
         colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
         colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
         colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        // the headless target is only ever copied to the readback buffer
+        colorAttachment.finalLayout = headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
         VkAttachmentDescription depthAttachment{};
         depthAttachment.format = findDepthFormat();
@@ -1034,6 +812,13 @@ private:
         }
     }
 
+    void createPipelineCache() {
+        if (pipelineCache.init(physicalDevice, device, pipeline_cache_path) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create pipeline cache!");
+        }
+        std::cout << "pipeline cache: " << pipelineCache.loadedBytes() << " bytes reused from " << pipeline_cache_path << std::endl;
+    }
+
     void createGraphicsPipeline() {
         // auto vertShaderCode = readFile("shaders/vert.spv");
         // auto fragShaderCode = readFile("shaders/frag.spv");
@@ -1156,7 +941,7 @@ private:
         pipelineInfo.subpass = 0;
         pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-        if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
+        if (vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
             throw std::runtime_error("failed to create graphics pipeline!");
         }
 
@@ -2025,19 +1810,7 @@ private:
         memcpy(uniformBuffersMapped[currentImage], &ubo, sizeof(ubo));
     }
 
-    void drawFrame() {
-        vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
-
-        uint32_t imageIndex;
-        VkResult result = vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
-
-        if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-            recreateSwapChain();
-            return;
-        } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
-            throw std::runtime_error("failed to acquire swap chain image!");
-        }
-
+    glm::mat4 modelMatrix() {
         //adding Imgui
         static glm::vec3 lt(0.f);
         static glm::vec3 gt(0.f);
@@ -2051,7 +1824,49 @@ private:
         model = ToScaleMatrix4(scale_ * scale) * glm::toMat4(gq) *
               ToTranslationMatrix4(translation_ + gt) *
               glm::toMat4(rotation_ * lq) * ToTranslationMatrix4(lt);
-        updateUniformBuffer(currentFrame,model);
+        return model;
+    }
+
+    void drawFrameHeadless() {
+        vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+        updateUniformBuffer(currentFrame, modelMatrix());
+
+        vkResetFences(device, 1, &inFlightFences[currentFrame]);
+        vkResetCommandBuffer(commandBuffers[currentFrame], 0);
+        recordCommandBuffer(commandBuffers[currentFrame], 0, currentFrame);
+
+        // nothing to acquire or present, so no semaphores
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &commandBuffers[currentFrame];
+
+        if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) {
+            throw std::runtime_error("failed to submit draw command buffer!");
+        }
+
+        // ordered after the frame on the same queue, the next frame's render pass waits for the copy
+        if (offScreen) {
+            captureFrame(offscreenColorImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+        }
+
+        currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+    }
+
+    void drawFrame() {
+        vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+
+        uint32_t imageIndex;
+        VkResult result = vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+
+        if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+            recreateSwapChain();
+            return;
+        } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+            throw std::runtime_error("failed to acquire swap chain image!");
+        }
+
+        updateUniformBuffer(currentFrame,modelMatrix());
 
         vkResetFences(device, 1, &inFlightFences[currentFrame]);
 
@@ -2078,11 +1893,17 @@ private:
             throw std::runtime_error("failed to submit draw command buffer!");
         }
 
+        // the copy goes between rendering and presentation, which then waits for the copy
+        VkSemaphore presentWait = renderFinishedSemaphores[currentFrame];
+        if (offScreen && !screenshotSaved) {
+            captureFrame(swapChainImages[imageIndex], VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, &presentWait);
+        }
+
         VkPresentInfoKHR presentInfo{};
         presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 
         presentInfo.waitSemaphoreCount = 1;
-        presentInfo.pWaitSemaphores = signalSemaphores;
+        presentInfo.pWaitSemaphores = &presentWait;
 
         VkSwapchainKHR swapChains[] = {swapChain};
         presentInfo.swapchainCount = 1;
@@ -2094,14 +1915,6 @@ private:
         
         // std::cout<<"Image Index "<<imageIndex<<std::endl;
         // std::cout<<"save image"<<offScreen<<std::endl;
-        if(offScreen) {
-            // Render offscreen
-            vkQueueWaitIdle(presentQueue);
-            saveScreenshot(output_path,imageIndex);
-            // renderOffscreen();
-            // return;
-        }
-            
 
         if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || framebufferResized) {
             framebufferResized = false;
@@ -2197,10 +2010,11 @@ private:
         std::cout << "Graphics Family Index: " << indices.graphicsFamily.value() << std::endl;
         std::cout << "Present Family Index: " << indices.presentFamily.value() << std::endl;
 
-        bool extensionsSupported = checkDeviceExtensionSupport(device);
+        // headless mode neither presents nor needs the swapchain extension
+        bool extensionsSupported = headless || checkDeviceExtensionSupport(device);
 
-        bool swapChainAdequate = false;
-        if (extensionsSupported) {
+        bool swapChainAdequate = headless;
+        if (!headless && extensionsSupported) {
             SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device);
             swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
         }
@@ -2242,11 +2056,16 @@ private:
                 indices.graphicsFamily = i;
             }
 
-            VkBool32 presentSupport = false;
-            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+            if (headless) {
+                // there is no surface, the present queue is never used
+                indices.presentFamily = indices.graphicsFamily;
+            } else {
+                VkBool32 presentSupport = false;
+                vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
 
-            if (presentSupport) {
-                indices.presentFamily = i;
+                if (presentSupport) {
+                    indices.presentFamily = i;
+                }
             }
 
             if (indices.isComplete()) {
@@ -2260,11 +2079,14 @@ private:
     }
 
     std::vector<const char*> getRequiredExtensions() {
-        uint32_t glfwExtensionCount = 0;
-        const char** glfwExtensions;
-        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        std::vector<const char*> extensions;
+        if (!headless) {
+            uint32_t glfwExtensionCount = 0;
+            const char** glfwExtensions;
+            glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
 
-        std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+            extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+        }
 
         if (enableValidationLayers) {
             extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -2339,6 +2161,18 @@ void Rasterizer::SetOutputPath(const std::string& output_p) {
     impl_ -> SetOutputPath(output_p);
 }
 
+void Rasterizer::SetPipelineCachePath(const std::string& cache_p) {
+    impl_ -> SetPipelineCachePath(cache_p);
+}
+
+void Rasterizer::SetHeadless(bool headless) {
+    impl_ -> SetHeadless(headless);
+}
+
+void Rasterizer::SetCaptureFrames(uint32_t frames) {
+    impl_ -> SetCaptureFrames(frames);
+}
+
 Rasterizer::Rasterizer() : impl_(std::make_shared<Impl>()) {}
 Rasterizer::~Rasterizer() = default;
 // int main() {
@@ -29,6 +29,9 @@ int main(int argc, char** argv) {
   argparse::ArgumentParser parser("rast");
   parser.add_argument("-i", "--input1").help("input model 1 path.");
   parser.add_argument("-o", "--output").help("output image path.");
+  parser.add_argument("--pipelinecache").help("pipeline cache file, loaded at startup and saved at exit (empty to disable).");
+  parser.add_argument("-H", "--headless").help("render offscreen without a window or swapchain, the frame is written to --output.").default_value(false).implicit_value(true);
+  parser.add_argument("-n", "--frames").help("number of consecutive frames written to --output, numbered when more than one.").default_value(1u).scan<'u', unsigned int>();
   // parser.add_argument("-i2", "--input2").help("input model 2 path.");
   parser.add_argument("-v", "--view").nargs(16).help("View Matrix").scan<'g', float>().default_value(view_def);
   parser.add_argument("-p", "--proj").nargs(16).help("Projection Matrix").scan<'g', float>().default_value(proj_def);
@@ -54,6 +57,11 @@ int main(int argc, char** argv) {
       std::cout << "output path: " << output_p << std::endl;
       app.SetOutputPath(output_p);
     }
+    if(parser.is_used("pipelinecache")) {
+      app.SetPipelineCachePath(parser.get<std::string>("pipelinecache"));
+    }
+    app.SetHeadless(parser.get<bool>("headless"));
+    app.SetCaptureFrames(parser.get<unsigned int>("frames"));
 		std::cout<<"reading matrices into vectors"<<std::endl;
 		std::vector<float> view = parser.get<std::vector<float>>("view");
 		std::vector<float> proj = parser.get<std::vector<float>>("proj");
@@ -0,0 +1,193 @@
+"""Fills the SPIR-V variant cache of the 3DGS shaders ahead of time.
+
+Enumerates the permutations of the defines that GaussianSplatting::initShaders
+prepends to the shaders, compiles them with glslangValidator and stores them
+under the names ShaderVariantCache::variantFilename computes, so that the
+application loads them instead of compiling GLSL at startup or when a setting
+changes. Permutations not built here are still compiled at runtime and added
+to the cache by the application.
+
+By default the defaults of the application and every permutation differing from
+them by one define are built, --depth 2 also builds the pairs of changes.
+"""
+
+import argparse
+import itertools
+import os
+import subprocess
+import sys
+import tempfile
+from concurrent.futures import ThreadPoolExecutor
+
+# must match ShaderVariantCache::s_version
+CACHE_VERSION = "vkgs-spirv-1"
+
+# shader files, glslang stages and defines added to the permutation ones, as created by initShaders
+SHADERS = [
+    ("dist.comp.glsl", "comp", ""),
+    ("chunks.comp.glsl", "comp", ""),
+    ("raster.vert.glsl", "vert", ""),
+    ("raster.mesh.glsl", "mesh", ""),
+    ("raster.frag.glsl", "frag", ""),
+    ("tile_keys.comp.glsl", "comp", "#define TILE_KEYS_PASS 0\n"),
+    ("tile_keys.comp.glsl", "comp", "#define TILE_KEYS_PASS 1\n"),
+    ("tile_scan.comp.glsl", "comp", "#define TILE_SCAN_PASS 0\n"),
+    ("tile_scan.comp.glsl", "comp", "#define TILE_SCAN_PASS 1\n"),
+    ("tile_ranges.comp.glsl", "comp", ""),
+    ("tile_blend.comp.glsl", "comp", ""),
+]
+
+# defines of initShaders with their possible values, the first one is the default of the application
+# (ShaderDefines in gaussian_splatting.h). None stands for a define that is not emitted.
+DEFINES = [
+    ("DISABLE_OPACITY_GAUSSIAN", [None, ""]),
+    ("FRUSTUM_CULLING_MODE", [1, 0, 2]),
+    ("CHUNK_CULLING_MODE", [2, 0, 1]),
+    ("LOD_ENABLED", [0, 1]),
+    ("STREAMING_ENABLED", [0, 1]),
+    ("ORTHOGRAPHIC_MODE", [0]),
+    ("SHOW_SH_ONLY", [0, 1]),
+    ("MAX_SH_DEGREE", [3, 0, 1, 2]),
+    ("DATA_STORAGE", [0, 1]),
+    ("SH_FORMAT", [0, 1, 2, 3]),
+    ("CENTERS_FORMAT", [0, 4]),
+    ("COVARIANCES_FORMAT", [0, 1]),
+    ("COLORS_FORMAT", [0, 2]),
+    ("POINT_CLOUD_MODE", [0, 1]),
+    ("USE_BARYCENTRIC", [1, 0]),
+]
+
+FNV_OFFSET = 14695981039346656037
+FNV_PRIME = 1099511628211
+
+
+def fnv1a(h, data):
+    # same as fnv1a in shader_variant_cache.cpp, the terminating zero is hashed too
+    for byte in data:
+        h = ((h ^ byte) * FNV_PRIME) & 0xFFFFFFFFFFFFFFFF
+    return (h * FNV_PRIME) & 0xFFFFFFFFFFFFFFFF
+
+
+def hash_sources(folder):
+    h = FNV_OFFSET
+    names = sorted(n for n in os.listdir(folder)
+                   if n.endswith((".glsl", ".h")) and os.path.isfile(os.path.join(folder, n)))
+    for name in names:
+        with open(os.path.join(folder, name), "rb") as f:
+            content = f.read()
+        h = fnv1a(h, name.encode())
+        h = fnv1a(h, content)
+    return h
+
+
+def variant_filename(filename, prepend, source_hash):
+    lines = sorted(line for line in prepend.split("\n") if line)
+    defines = "".join(line + "\n" for line in lines)
+    h = fnv1a(FNV_OFFSET, CACHE_VERSION.encode())
+    h = fnv1a(h, filename.encode())
+    h = fnv1a(h, defines.encode())
+    h = fnv1a(h, "{:016x}".format(source_hash).encode())
+    return "{:016x}.spv".format(h)
+
+
+def is_reachable(values):
+    # combinations the application never produces, see chunkCullingMode and streamingEnabled
+    if values["FRUSTUM_CULLING_MODE"] == 0 and values["CHUNK_CULLING_MODE"] != 0:
+        return False
+    if values["DATA_STORAGE"] == 1 and values["STREAMING_ENABLED"] == 1:
+        return False
+    return True
+
+
+def enumerate_permutations(depth):
+    defaults = {name: choices[0] for name, choices in DEFINES}
+    seen = set()
+    for count in range(depth + 1):
+        for changed in itertools.combinations(range(len(DEFINES)), count):
+            alternatives = [DEFINES[i][1][1:] for i in changed]
+            for picked in itertools.product(*alternatives):
+                values = dict(defaults)
+                for i, value in zip(changed, picked):
+                    values[DEFINES[i][0]] = value
+                # chunk culling follows frustum culling as in the application
+                if values["FRUSTUM_CULLING_MODE"] == 0:
+                    values["CHUNK_CULLING_MODE"] = 0
+                if not is_reachable(values):
+                    continue
+                key = tuple(sorted(values.items(), key=lambda item: item[0]))
+                if key in seen:
+                    continue
+                seen.add(key)
+                yield values
+
+
+def make_prepend(values):
+    prepend = ""
+    for name, _ in DEFINES:
+        value = values[name]
+        if value is None:
+            continue
+        prepend += "#define {} {}\n".format(name, value) if value != "" else "#define {}\n".format(name)
+    return prepend
+
+
+def compile_variant(glslang, shader_dir, filename, stage, prepend, output):
+    # the defines go right after the #version line, as the shader manager does
+    with open(os.path.join(shader_dir, filename), "r", encoding="utf-8") as f:
+        lines = f.read().split("\n")
+    for i, line in enumerate(lines):
+        if line.strip().startswith("#version"):
+            lines.insert(i + 1, prepend.rstrip("\n"))
+            break
+    else:
+        lines.insert(0, prepend.rstrip("\n"))
+
+    with tempfile.TemporaryDirectory() as tmp:
+        source = os.path.join(tmp, filename)
+        with open(source, "w", encoding="utf-8") as f:
+            f.write("\n".join(lines))
+        tmp_output = output + ".tmp"
+        command = [glslang, "-V", "--target-env", "vulkan1.2", "-S", stage, "-I" + shader_dir, "-o", tmp_output, source]
+        result = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+        if result.returncode != 0:
+            if os.path.exists(tmp_output):
+                os.remove(tmp_output)
+            return "{}: {}".format(filename, result.stdout.strip())
+        os.replace(tmp_output, output)
+    return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Builds the SPIR-V variant cache of the 3DGS shaders.")
+    parser.add_argument("--shaders", default=os.path.join(os.path.dirname(os.path.abspath(__file__)), "shaders"),
+                        help="folder of the GLSL sources")
+    parser.add_argument("--output", required=True, help="cache folder, spirv_cache next to the executable by default in the application")
+    parser.add_argument("--glslang", default="glslangValidator", help="glslangValidator executable")
+    parser.add_argument("--depth", type=int, default=1, help="number of defines changed at once from the defaults")
+    parser.add_argument("--jobs", type=int, default=os.cpu_count() or 1, help="concurrent compilations")
+    args = parser.parse_args()
+
+    os.makedirs(args.output, exist_ok=True)
+    source_hash = hash_sources(args.shaders)
+
+    tasks = {}
+    for values in enumerate_permutations(args.depth):
+        prepend = make_prepend(values)
+        for filename, stage, extra in SHADERS:
+            output = os.path.join(args.output, variant_filename(filename, prepend + extra, source_hash))
+            if output not in tasks and not os.path.exists(output):
+                tasks[output] = (filename, stage, prepend + extra)
+
+    print("{} shader variants to build in {}".format(len(tasks), args.output))
+    with ThreadPoolExecutor(max_workers=max(1, args.jobs)) as pool:
+        futures = [pool.submit(compile_variant, args.glslang, args.shaders, f, s, p, o) for o, (f, s, p) in tasks.items()]
+        errors = [error for error in (future.result() for future in futures) if error]
+
+    for error in errors:
+        print(error, file=sys.stderr)
+    print("{} built, {} failed".format(len(tasks) - len(errors), len(errors)))
+    return 1 if errors else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2023-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#version 460
+
+#extension GL_GOOGLE_include_directive : enable
+#include "shaderio.h"
+
+// First culling level, one thread per chunk of SPLAT_CHUNK_SIZE consecutive splats.
+// Appends the chunks whose bounding box intersects the dilated frustum to the
+// visible chunks buffer and sets the indirect dispatch of the distance shader,
+// which then only visits the splats of these chunks.
+
+// scalar prevents alignment issues
+layout(set = 0, binding = BINDING_FRAME_INFO_UBO, scalar) uniform FrameInfo_
+{
+  FrameInfo frameInfo;
+};
+
+layout(local_size_x = CHUNK_COMPUTE_WORKGROUP_SIZE) in;
+
+layout(set = 0, binding = BINDING_CHUNK_BOUNDS_BUFFER, scalar) readonly buffer _chunkBounds
+{
+  float chunkBounds[];
+};
+layout(set = 0, binding = BINDING_VISIBLE_CHUNKS_BUFFER, scalar) writeonly buffer _visibleChunks
+{
+  uint32_t visibleChunks[];
+};
+layout(set = 0, binding = BINDING_INDIRECT_BUFFER, scalar) buffer _indirect
+{
+  IndirectParams indirect;
+};
+
+// true if the box is fully outside of one of the planes of the dilated
+// frustum, same homogeneous test as the per splat culling at raster stage
+bool isBoxOutside(mat4 viewProj, vec3 bmin, vec3 bmax)
+{
+  const float clip = 1.0 + frameInfo.frustumDilation;
+  // one bit per plane, cleared by the first corner inside the plane
+  uint outside = 0x3F;
+  for(int corner = 0; corner < 8; ++corner)
+  {
+    const vec3 p = vec3((corner & 1) != 0 ? bmax.x : bmin.x, (corner & 2) != 0 ? bmax.y : bmin.y,
+                        (corner & 4) != 0 ? bmax.z : bmin.z);
+    const vec4 c = viewProj * vec4(p, 1.0);
+    uint       o = 0;
+    o |= c.x > clip * c.w ? 0x01 : 0;
+    o |= c.x < -clip * c.w ? 0x02 : 0;
+    o |= c.y > clip * c.w ? 0x04 : 0;
+    o |= c.y < -clip * c.w ? 0x08 : 0;
+    o |= c.z < -frameInfo.frustumDilation * c.w ? 0x10 : 0;
+    o |= c.z > c.w ? 0x20 : 0;
+    outside &= o;
+  }
+  return outside != 0;
+}
+
+void main()
+{
+  const uint chunk      = gl_GlobalInvocationID.x;
+  const uint chunkCount = (frameInfo.splatCount + SPLAT_CHUNK_SIZE - 1) / SPLAT_CHUNK_SIZE;
+  if(chunk >= chunkCount)
+    return;
+
+  const uint base = chunk * CHUNK_BOUNDS_FLOATS;
+  const vec3 bmin = vec3(chunkBounds[base + 0], chunkBounds[base + 1], chunkBounds[base + 2]);
+  const vec3 bmax = vec3(chunkBounds[base + 3], chunkBounds[base + 4], chunkBounds[base + 5]);
+
+  if(isBoxOutside(frameInfo.projectionMatrix * frameInfo.viewMatrix, bmin, bmax))
+    return;
+
+  const uint slot     = atomicAdd(indirect.visibleChunkCount, 1);
+  visibleChunks[slot] = chunk;
+  atomicAdd(indirect.distGroupCountX, SPLAT_CHUNK_SIZE / DISTANCE_COMPUTE_WORKGROUP_SIZE);
+}
@@ -24,20 +24,37 @@
 layout(set = 0, binding = BINDING_CENTERS_TEXTURE) uniform sampler2D centersTexture;
 layout(set = 0, binding = BINDING_COLORS_TEXTURE) uniform sampler2D colorsTexture;
 layout(set = 0, binding = BINDING_COVARIANCES_TEXTURE) uniform sampler2D covariancesTexture;
+#if SH_FORMAT == FORMAT_VQ
+// one code per texel
+layout(set = 0, binding = BINDING_SH_TEXTURE) uniform usampler2D sphericalHarmonicsTexture;
+#else
 layout(set = 0, binding = BINDING_SH_TEXTURE) uniform sampler2D sphericalHarmonicsTexture;
+#endif
 #else
 // buffers describing the 3DGS model (alternative to textures)
 layout(set = 0, binding = BINDING_CENTERS_BUFFER) buffer _centersBuffer
 {
+#if CENTERS_FORMAT == FORMAT_UNORM16
+  uint16_t centersBuffer[];
+#else
   float centersBuffer[];
+#endif
 };
 layout(set = 0, binding = BINDING_COLORS_BUFFER) buffer _colorsBuffer
 {
+#if COLORS_FORMAT == FORMAT_UINT8
+  uint colorsBuffer[];  // one RGBA8 per splat
+#else
   float colorsBuffer[];
+#endif
 };
 layout(set = 0, binding = BINDING_COVARIANCES_BUFFER) buffer _covariancesBuffer
 {
+#if COVARIANCES_FORMAT == FORMAT_FLOAT16
+  float16_t covariancesBuffer[];
+#else
   float covariancesBuffer[];
+#endif
 };
 layout(set = 0, binding = BINDING_SH_BUFFER) buffer _sphericalHarmonicsBuffer
 {
@@ -50,13 +67,72 @@ layout(set = 0, binding = BINDING_SH_BUFFER) buffer _sphericalHarmonicsBuffer
 #if SH_FORMAT == FORMAT_UINT8
   uint8_t sphericalHarmonicsBuffer[];
 #else
+#if SH_FORMAT == FORMAT_VQ
+  uint16_t sphericalHarmonicsBuffer[];  // one code per splat
+#else
 #error "Unsupported SH format"
 #endif
 #endif
 #endif
+#endif
 };
 #endif
 
+#if SH_FORMAT == FORMAT_VQ
+// SH codebook, SH_VQ_ENTRY_FLOATS floats per entry, used with both storages
+layout(set = 0, binding = BINDING_SH_CODEBOOK_BUFFER) buffer _sphericalHarmonicsCodebook
+{
+  float sphericalHarmonicsCodebook[];
+};
+#endif
+
+#if CENTERS_FORMAT == FORMAT_UNORM16
+// bounds of the chunks of CENTERS_CHUNK_SIZE splats, used with both storages
+layout(set = 0, binding = BINDING_CENTERS_BOUNDS_BUFFER) buffer _centersBoundsBuffer
+{
+  float centersBoundsBuffer[];
+};
+
+// maps normalized coordinates in [0,1] to the bounds of the chunk of the splat
+vec3 dequantizeCenter(in uint splatIndex, in vec3 normalized)
+{
+  const uint offset = (splatIndex / CENTERS_CHUNK_SIZE) * CENTERS_BOUNDS_FLOATS;
+  const vec3 minimum = vec3(centersBoundsBuffer[offset + 0], centersBoundsBuffer[offset + 1], centersBoundsBuffer[offset + 2]);
+  const vec3 extent  = vec3(centersBoundsBuffer[offset + 3], centersBoundsBuffer[offset + 4], centersBoundsBuffer[offset + 5]);
+  return minimum + extent * normalized;
+}
+#endif
+
+#if STREAMING_ENABLED
+// out of core streaming, see splat_residency.h. Slot of each chunk of SPLAT_CHUNK_SIZE splats
+// in the pools of covariances, colors and SH, or CHUNK_NOT_RESIDENT. Centers are always resident.
+layout(set = 0, binding = BINDING_CHUNK_SLOTS_BUFFER) buffer _chunkSlotsBuffer
+{
+  uint chunkSlots[];
+};
+
+bool isSplatResident(in uint splatIndex)
+{
+  return chunkSlots[splatIndex / SPLAT_CHUNK_SIZE] != CHUNK_NOT_RESIDENT;
+}
+
+// index of the splat in the pools
+uint residentIndex(in uint splatIndex)
+{
+  return chunkSlots[splatIndex / SPLAT_CHUNK_SIZE] * SPLAT_CHUNK_SIZE + splatIndex % SPLAT_CHUNK_SIZE;
+}
+#else
+bool isSplatResident(in uint splatIndex)
+{
+  return true;
+}
+
+uint residentIndex(in uint splatIndex)
+{
+  return splatIndex;
+}
+#endif
+
 ////////////
 // constants
 
@@ -86,13 +162,24 @@ ivec2 getDataPosF(in uint splatIndex, in float stride, in uint offset, in ivec2
 // fetch center value from texture map
 vec3 fetchCenter(in uint splatIndex)
 {
-  return vec3(texelFetch(centersTexture, getDataPos(splatIndex, 1, 0, textureSize(centersTexture, 0)), 0));
+  const vec3 center = vec3(texelFetch(centersTexture, getDataPos(splatIndex, 1, 0, textureSize(centersTexture, 0)), 0));
+#if CENTERS_FORMAT == FORMAT_UNORM16
+  // unorm texture, already normalized
+  return dequantizeCenter(splatIndex, center);
+#else
+  return center;
+#endif
 }
 #else
 // fetch center value from data buffer
 vec3 fetchCenter(in uint splatIndex)
 {
-  return vec3(centersBuffer[splatIndex * 3 + 0], centersBuffer[splatIndex * 3 + 1], centersBuffer[splatIndex * 3 + 2]);
+  const vec3 center = vec3(centersBuffer[splatIndex * 3 + 0], centersBuffer[splatIndex * 3 + 1], centersBuffer[splatIndex * 3 + 2]);
+#if CENTERS_FORMAT == FORMAT_UNORM16
+  return dequantizeCenter(splatIndex, center * (1.0 / 65535.0));
+#else
+  return center;
+#endif
 }
 #endif
 
@@ -103,15 +190,65 @@ vec4 fetchColor(in uint splatIndex)
   return texelFetch(colorsTexture, getDataPos(splatIndex, 1, 0, textureSize(colorsTexture, 0)), 0);
 }
 #else
-// fetch center value from data buffer
-vec4 fetchColor(in uint splatIndex)
+// fetch color value from data buffer
+vec4 fetchColor(in uint splatIndexIn)
 {
+  const uint splatIndex = residentIndex(splatIndexIn);
+#if COLORS_FORMAT == FORMAT_UINT8
+  return unpackUnorm4x8(colorsBuffer[splatIndex]);
+#else
   return vec4(colorsBuffer[splatIndex * 4 + 0], colorsBuffer[splatIndex * 4 + 1], colorsBuffer[splatIndex * 4 + 2],
               colorsBuffer[splatIndex * 4 + 3]);
+#endif
 }
 #endif
 
+#if SH_FORMAT == FORMAT_VQ
+// fetch the codebook entry of the splat
+void fetchSh(in uint  splatIndex,
+             out vec3 shd1[3]
+#if MAX_SH_DEGREE >= 2
+             , out vec3 shd2[5]
+#endif
+#if MAX_SH_DEGREE >= 3
+             , out vec3 shd3[7]
+#endif
+)
+{
 #if DATA_STORAGE == STORAGE_TEXTURES
+  const uint code = texelFetch(sphericalHarmonicsTexture, getDataPos(splatIndex, 1, 0, textureSize(sphericalHarmonicsTexture, 0)), 0).r;
+#else
+  const uint code = uint(sphericalHarmonicsBuffer[residentIndex(splatIndex)]);
+#endif
+  const uint entry = code * SH_VQ_ENTRY_FLOATS;
+
+  // fetching degree 1
+  for(int i = 0; i < 3; ++i)
+  {
+    const uint offset = entry + 3 * i;
+    shd1[i] = vec3(sphericalHarmonicsCodebook[offset + 0], sphericalHarmonicsCodebook[offset + 1],
+                   sphericalHarmonicsCodebook[offset + 2]);
+  }
+  // fetching degree 2
+#if MAX_SH_DEGREE >= 2
+  for(int i = 0; i < 5; ++i)
+  {
+    const uint offset = entry + 3 * (3 + i);
+    shd2[i] = vec3(sphericalHarmonicsCodebook[offset + 0], sphericalHarmonicsCodebook[offset + 1],
+                   sphericalHarmonicsCodebook[offset + 2]);
+  }
+#endif
+  // fetching degree 3
+#if MAX_SH_DEGREE >= 3
+  for(int i = 0; i < 7; ++i)
+  {
+    const uint offset = entry + 3 * (8 + i);
+    shd3[i] = vec3(sphericalHarmonicsCodebook[offset + 0], sphericalHarmonicsCodebook[offset + 1],
+                   sphericalHarmonicsCodebook[offset + 2]);
+  }
+#endif
+}
+#elif DATA_STORAGE == STORAGE_TEXTURES
 // fetch from data textures
 void fetchSh(in uint  splatIndex,
              out vec3 shd1[3]
@@ -225,7 +362,7 @@ void fetchSh(in uint  splatIndex,
 #else
 // fetch from data buffers
 void fetchSh(
-  in uint splatIndex ,out vec3 shd1[3] 
+  in uint splatIndexIn ,out vec3 shd1[3] 
 #if MAX_SH_DEGREE >= 2
   ,out vec3 shd2[5]
 #endif
@@ -234,6 +371,7 @@ void fetchSh(
 #endif
 )
 {
+  const uint splatIndex  = residentIndex(splatIndexIn);
   const uint splatStride = 45;
 
   const float SphericalHarmonics8BitCompressionRange     = 2.0;
@@ -380,8 +518,9 @@ mat3 fetchCovariance(in uint splatIndex)
               cov3D_M22_M23_M33.y, cov3D_M11_M12_M13.z, cov3D_M22_M23_M33.y, cov3D_M22_M23_M33.z);
 }
 #else
-mat3 fetchCovariance(in uint splatIndex)
+mat3 fetchCovariance(in uint splatIndexIn)
 {
+  const uint splatIndex = residentIndex(splatIndexIn);
   // Use RGBA texture map to store sets of 3 elements requires some offset shifting depending on splatIndex
   const vec3 cov3D_M11_M12_M13 = vec3(covariancesBuffer[splatIndex * 6 + 0], covariancesBuffer[splatIndex * 6 + 1],
                                       covariancesBuffer[splatIndex * 6 + 2]);
@@ -391,4 +530,31 @@ mat3 fetchCovariance(in uint splatIndex)
   return mat3(cov3D_M11_M12_M13.x, cov3D_M11_M12_M13.y, cov3D_M11_M12_M13.z, cov3D_M11_M12_M13.y, cov3D_M22_M23_M33.x,
               cov3D_M22_M23_M33.y, cov3D_M11_M12_M13.z, cov3D_M22_M23_M33.y, cov3D_M22_M23_M33.z);
 }
-#endif
\ No newline at end of file
+#endif
+#if LOD_ENABLED
+// level of detail hierarchy, see splat_lod.h. One node per splat, the
+// radius of its bounding sphere (as float bits) and the index of its parent
+layout(set = 0, binding = BINDING_LOD_NODES_BUFFER) buffer _lodNodesBuffer
+{
+  uvec2 lodNodes[];
+};
+
+// projected radius in pixels of the bounding sphere of a node, from the closest point of the sphere
+float lodProjectedSize(in vec3 center, in float radius, in vec3 cameraPosition, in float focal)
+{
+  return radius * focal / max(distance(center, cameraPosition) - radius, 1e-6);
+}
+
+// true if the node is part of the cut for threshold: fine enough (or a leaf) while its parent is not.
+// Nested spheres ensure that each leaf is covered by exactly one selected node.
+bool isLodSelected(in uint splatIndex, in vec3 center, in vec3 cameraPosition, in float focal, in float threshold, in uint leafCount)
+{
+  const uvec2 node = lodNodes[splatIndex];
+  if(splatIndex >= leafCount && lodProjectedSize(center, uintBitsToFloat(node.x), cameraPosition, focal) > threshold)
+    return false;
+  if(node.y == LOD_NO_PARENT)
+    return true;
+  const float parentRadius = uintBitsToFloat(lodNodes[node.y].x);
+  return lodProjectedSize(fetchCenter(node.y), parentRadius, cameraPosition, focal) > threshold;
+}
+#endif
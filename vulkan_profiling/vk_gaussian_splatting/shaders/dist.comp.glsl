@@ -43,6 +43,13 @@ layout(set = 0, binding = BINDING_INDIRECT_BUFFER, scalar) writeonly buffer _ind
 {
   IndirectParams indirect;
 };
+#if CHUNK_CULLING_MODE != CHUNK_CULLING_NONE
+// chunks of SPLAT_CHUNK_SIZE splats that passed the first culling level
+layout(set = 0, binding = BINDING_VISIBLE_CHUNKS_BUFFER, scalar) readonly buffer _visibleChunks
+{
+  uint32_t visibleChunks[];
+};
+#endif
 
 // encodes an fp32 into a uint32 that can be ordered
 uint encodeMinMaxFp32(float val)
@@ -54,16 +61,36 @@ uint encodeMinMaxFp32(float val)
 
 void main()
 {
+#if CHUNK_CULLING_MODE != CHUNK_CULLING_NONE
+  // the dispatch only covers the visible chunks, each one processed by consecutive workgroups
+  const uint groupsPerChunk = SPLAT_CHUNK_SIZE / DISTANCE_COMPUTE_WORKGROUP_SIZE;
+  const uint chunk          = visibleChunks[gl_WorkGroupID.x / groupsPerChunk];
+  const uint id = chunk * SPLAT_CHUNK_SIZE + (gl_WorkGroupID.x % groupsPerChunk) * DISTANCE_COMPUTE_WORKGROUP_SIZE
+                  + gl_LocalInvocationID.x;
+#else
   const uint id = gl_GlobalInvocationID.x;
+#endif
   // each workgroup (but the last one if splat count is not a multiple)
   // processes DISTANCE_COMPUTE_WORKGROUP_SIZE points
   if(id >= frameInfo.splatCount)
     return;
 
-  vec4 pos          = vec4(fetchCenter(id), 1.0);
-  pos               = frameInfo.projectionMatrix * frameInfo.viewMatrix * pos;
-  pos               = pos / pos.w;
-  const float depth = pos.z;
+  const vec3 center  = fetchCenter(id);
+  const vec4 viewPos = frameInfo.viewMatrix * vec4(center, 1.0);
+  vec4       pos     = frameInfo.projectionMatrix * viewPos;
+  pos                = pos / pos.w;
+
+  // distance used for back to front ordering, see SplatSorterAsync for the CPU counterpart.
+  // the view looks toward -z, radial distance is squared since only the order matters.
+  float dist;
+  if(frameInfo.sortKeyMode == SORT_KEY_PLANE_DISTANCE)
+    dist = abs(viewPos.z);
+  else if(frameInfo.sortKeyMode == SORT_KEY_VIEW_DEPTH)
+    dist = -viewPos.z;
+  else if(frameInfo.sortKeyMode == SORT_KEY_RADIAL_DISTANCE)
+    dist = dot(viewPos.xyz, viewPos.xyz);
+  else
+    dist = pos.z;
 
   // valid only when center is inside NDC clip space.
   // Note: when culling between x=[-1,1] y=[-1,1], which is NDC extent,
@@ -75,10 +102,23 @@ void main()
     return;
 #endif
 
+#if LOD_ENABLED
+  // keeps only the nodes of the cut through the hierarchy, orthographic views use the leaves
+  if(!isLodSelected(id, center, frameInfo.cameraPosition, abs(frameInfo.focal.x),
+                    frameInfo.orthographicMode == 0 ? frameInfo.lodThreshold : 0.0, frameInfo.lodLeafCount))
+    return;
+#endif
+
+#if STREAMING_ENABLED
+  // the chunk of the splat is not in the device pools yet
+  if(!isSplatResident(id))
+    return;
+#endif
+
   // increments the visible splat counter in the indirect buffer 
   const uint instance_index = atomicAdd(indirect.instanceCount, 1);
-  // stores the distance
-  distances[instance_index] = encodeMinMaxFp32(-depth);
+  // stores the distance, farthest first
+  distances[instance_index] = encodeMinMaxFp32(-dist);
   // stores the base index
   indices[instance_index] = id;
   // set the workgroup count for the mesh shading pipeline
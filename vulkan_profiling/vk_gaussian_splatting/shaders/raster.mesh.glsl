@@ -86,13 +86,9 @@ layout(set = 0, binding = BINDING_INDIRECT_BUFFER, scalar) buffer _indirect
 void main()
 {
   const uint32_t baseIndex  = gl_GlobalInvocationID.x;
-#if FRUSTUM_CULLING_MODE == FRUSTUM_CULLING_AT_DIST
-  // if culling is already performed we use the subset of splats
-  const uint splatCount = indirect.instanceCount;
-#else
-  // otherwise we use all the splats
-  const uint splatCount = frameInfo.splatCount;
-#endif
+  // the distance shader of the GPU sort outputs the subset of splats that passed its
+  // culling (frustum, chunks, level of detail), otherwise we use all the splats
+  const uint splatCount = frameInfo.sortingMethod == SORTING_GPU_SYNC_RADIX ? indirect.instanceCount : frameInfo.splatCount;
   const uint outputQuadCount = min(RASTER_MESH_WORKGROUP_SIZE, splatCount - gl_WorkGroupID.x * RASTER_MESH_WORKGROUP_SIZE);
 
   if(gl_LocalInvocationIndex == 0)
@@ -131,6 +127,34 @@ void main()
     }
 #endif
 
+#if LOD_ENABLED
+    // the GPU sort only outputs the selected nodes, the CPU sort outputs all of them
+    if(frameInfo.sortingMethod != SORTING_GPU_SYNC_RADIX
+       && !isLodSelected(splatIndex, splatCenter, frameInfo.cameraPosition, abs(frameInfo.focal.x),
+                         frameInfo.orthographicMode == 0 ? frameInfo.lodThreshold : 0.0, frameInfo.lodLeafCount))
+    {
+      // emit same vertex to get degenerate triangle
+      gl_MeshVerticesEXT[gl_LocalInvocationIndex * 4 + 0].gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+      gl_MeshVerticesEXT[gl_LocalInvocationIndex * 4 + 1].gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+      gl_MeshVerticesEXT[gl_LocalInvocationIndex * 4 + 2].gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+      gl_MeshVerticesEXT[gl_LocalInvocationIndex * 4 + 3].gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+      return;
+    }
+#endif
+
+#if STREAMING_ENABLED
+    // the GPU sort only outputs resident splats, the CPU sort outputs all of them
+    if(frameInfo.sortingMethod != SORTING_GPU_SYNC_RADIX && !isSplatResident(splatIndex))
+    {
+      // emit same vertex to get degenerate triangle
+      gl_MeshVerticesEXT[gl_LocalInvocationIndex * 4 + 0].gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+      gl_MeshVerticesEXT[gl_LocalInvocationIndex * 4 + 1].gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+      gl_MeshVerticesEXT[gl_LocalInvocationIndex * 4 + 2].gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+      gl_MeshVerticesEXT[gl_LocalInvocationIndex * 4 + 3].gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+      return;
+    }
+#endif
+
     // the vertices of the quad
     const vec2 positions[4] = {{-1.0, -1.0}, {1.0, -1.0}, {1.0, 1.0}, {-1.0, 1.0}};
 
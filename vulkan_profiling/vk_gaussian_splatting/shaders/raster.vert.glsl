@@ -90,6 +90,28 @@ void main()
   }
 #endif
 
+#if LOD_ENABLED
+  // the GPU sort only outputs the selected nodes, the CPU sort outputs all of them
+  if(frameInfo.sortingMethod != SORTING_GPU_SYNC_RADIX
+     && !isLodSelected(splatIndex, splatCenter, frameInfo.cameraPosition, abs(frameInfo.focal.x),
+                       frameInfo.orthographicMode == 0 ? frameInfo.lodThreshold : 0.0, frameInfo.lodLeafCount))
+  {
+    // emit same vertex to get degenerate triangle
+    gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+    return;
+  }
+#endif
+
+#if STREAMING_ENABLED
+  // the GPU sort only outputs resident splats, the CPU sort outputs all of them
+  if(frameInfo.sortingMethod != SORTING_GPU_SYNC_RADIX && !isSplatResident(splatIndex))
+  {
+    // emit same vertex to get degenerate triangle
+    gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+    return;
+  }
+#endif
+
   const vec2 fragPos = inPosition.xy;
 #if !USE_BARYCENTRIC
   // emit as early as possible
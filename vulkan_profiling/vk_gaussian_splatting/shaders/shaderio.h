@@ -25,6 +25,12 @@
 #define SORTING_CPU_ASYNC_MONO 1
 #define SORTING_CPU_ASYNC_MULTI 2
 
+// key used to sort the splats back to front, same for CPU and GPU sorting
+#define SORT_KEY_PLANE_DISTANCE 0   // absolute distance to the camera plane
+#define SORT_KEY_VIEW_DEPTH 1       // signed view space depth
+#define SORT_KEY_RADIAL_DISTANCE 2  // distance to the center of projection
+#define SORT_KEY_NDC_DEPTH 3        // post projection depth, sorted on CPU with the view depth
+
 // type of model storage
 #define STORAGE_BUFFERS 0
 #define STORAGE_TEXTURES 1
@@ -33,17 +39,50 @@
 #define FORMAT_FLOAT32 0
 #define FORMAT_FLOAT16 1
 #define FORMAT_UINT8 2
+#define FORMAT_VQ 3  // 16 bit code per splat into a codebook of SH_VQ_ENTRY_FLOATS floats per entry
+
+// floats per entry of the SH codebook, all the coefficients of degree 1 to 3 in fetchSh order
+#define SH_VQ_ENTRY_FLOATS 45
+
+// formats for centers, covariances and colors storage
+// centers: FORMAT_FLOAT32 or FORMAT_UNORM16
+// covariances: FORMAT_FLOAT32 or FORMAT_FLOAT16
+// colors: FORMAT_STORAGE_DEFAULT, FORMAT_FLOAT32 or FORMAT_UINT8 (RGBA8 unorm)
+#define FORMAT_UNORM16 4  // 16 bit fixed point relative to the bounds of the chunk of the splat
+#define FORMAT_STORAGE_DEFAULT 5  // float32 colors with data buffers, truncated RGBA8 colors with textures
+
+// consecutive splats sharing the same bounds for FORMAT_UNORM16 centers
+#define CENTERS_CHUNK_SIZE 256
+// floats per chunk bounds, minimum then extent
+#define CENTERS_BOUNDS_FLOATS 6
 
 // type of pipeline used
 #define PIPELINE_MESH 0
 #define PIPELINE_VERT 1
 #define PIPELINE_RTX 2
+#define PIPELINE_COMPUTE 3  // tile based compute rasterization, see tile_keys.comp.glsl
 
 // type of frustum culling
 #define FRUSTUM_CULLING_NONE 0
 #define FRUSTUM_CULLING_AT_DIST 1
 #define FRUSTUM_CULLING_AT_RASTER 2
 
+// where whole chunks of splats are culled before the distance compute shader (GPU sorting only)
+#define CHUNK_CULLING_NONE 0
+#define CHUNK_CULLING_CPU 1  // list of visible chunks computed on host and uploaded at each frame
+#define CHUNK_CULLING_GPU 2  // list of visible chunks computed by chunks.comp.glsl, indirect dispatch
+
+// consecutive splats per culling chunk, a multiple of DISTANCE_COMPUTE_WORKGROUP_SIZE
+#define SPLAT_CHUNK_SIZE 256
+// floats per chunk bounding box, minimum then maximum of the splat centers
+#define CHUNK_BOUNDS_FLOATS 6
+
+// level of detail hierarchy, see splat_lod.h
+#define LOD_BRANCHING 8                 // children merged into each parent node
+#define LOD_NO_PARENT 0xFFFFFFFFu       // parent of the root nodes
+// out of core streaming, see splat_residency.h
+#define CHUNK_NOT_RESIDENT 0xFFFFFFFFu  // slot of the chunks that are not resident
+
 // bindings for set 0
 #define BINDING_FRAME_INFO_UBO 0
 #define BINDING_CENTERS_TEXTURE 1
@@ -57,6 +96,20 @@
 #define BINDING_COLORS_BUFFER 9
 #define BINDING_COVARIANCES_BUFFER 10
 #define BINDING_SH_BUFFER 11
+#define BINDING_SH_CODEBOOK_BUFFER 12
+#define BINDING_CENTERS_BOUNDS_BUFFER 13
+#define BINDING_CHUNK_BOUNDS_BUFFER 14
+#define BINDING_VISIBLE_CHUNKS_BUFFER 15
+#define BINDING_LOD_NODES_BUFFER 16
+#define BINDING_CHUNK_SLOTS_BUFFER 17
+#define BINDING_TILE_SPLATS_BUFFER 18
+#define BINDING_TILE_KEYS_BUFFER 19
+#define BINDING_TILE_VALUES_BUFFER 20
+#define BINDING_TILE_RANGES_BUFFER 21
+#define BINDING_TILE_OUTPUT_IMAGE 22
+#define BINDING_TILE_COUNTS_BUFFER 23
+#define BINDING_TILE_OFFSETS_BUFFER 24
+#define BINDING_TILE_BLOCK_SUMS_BUFFER 25
 
 // location for vertex attributes
 // (only for vertex shader mode)
@@ -66,10 +119,27 @@
 // Distance shader workgroup size
 #define DISTANCE_COMPUTE_WORKGROUP_SIZE 256
 
+// Chunk culling shader workgroup size
+#define CHUNK_COMPUTE_WORKGROUP_SIZE 64
+
 // Mesh shader workgroup size
 // This configuration is optimized for NVIDIA hardware
 #define RASTER_MESH_WORKGROUP_SIZE 32
 
+// compute pipeline (PIPELINE_COMPUTE), the image is split in tiles of TILE_SIZE x TILE_SIZE pixels,
+// each one blended by a workgroup of as many invocations
+#define TILE_SIZE 16
+#define TILE_KEYS_WORKGROUP_SIZE 256
+#define TILE_RANGES_WORKGROUP_SIZE 256
+// the exclusive scan of the tile counts of the splats works on blocks of TILE_SCAN_BLOCK_SIZE
+// splats, one workgroup per block and TILE_SCAN_BLOCK_SIZE / TILE_SCAN_WORKGROUP_SIZE splats per thread
+#define TILE_SCAN_WORKGROUP_SIZE 256
+#define TILE_SCAN_BLOCK_SIZE 1024
+// initial capacity of the tile key and value buffers per splat, grown when a frame overflows it
+#define TILE_ENTRIES_PER_SPLAT 4
+// transmittance below which a pixel is saturated, the remaining splats would change it by less than half a unit of 8 bits
+#define TILE_SATURATION_TRANSMITTANCE (1.0 / 512.0)
+
 #ifdef __cplusplus
 #include <glm/glm.hpp>
 // used to assign fields defaults
@@ -107,6 +177,25 @@ struct FrameInfo
   int sortingMethod        DEFAULT(SORTING_GPU_SYNC_RADIX);
   float frustumDilation    DEFAULT(0.2f);           // for frustum culling, 2% scale
   float alphaCullThreshold DEFAULT(1.0f / 255.0f);  // for alpha culling
+  int sortKeyMode          DEFAULT(SORT_KEY_NDC_DEPTH);
+
+  int lodLeafCount   DEFAULT(0);     // the first lodLeafCount splats are the leaves of the lod hierarchy
+  float lodThreshold DEFAULT(1.0f);  // in pixels, projected node radius below which a node replaces its children
+  int tileCountX     DEFAULT(0);     // tiles covering the color image, PIPELINE_COMPUTE only
+  int tileCountY     DEFAULT(0);     //
+
+  vec2 viewport;                            // size of the color image in pixels, PIPELINE_COMPUTE only
+  uint32_t tileScanBlockCount DEFAULT(0);  // blocks of TILE_SCAN_BLOCK_SIZE splats of the tile count scan
+  uint32_t tileEntryCapacity  DEFAULT(0);  // entries of the tile key and value buffers
+};
+
+// splat projected by tile_keys.comp.glsl for the tile blending, stored at its rank in the sorted indices
+struct TileSplat
+{
+  vec4  color;    // rgb clamped to [0,1] as by the blending of the raster pipelines, opacity in alpha
+  vec3  conic;    // xx, xy and yy terms of the quadratic form in pixels, 8 on the border of the splat
+  vec2  center;   // in pixels
+  uvec2 tileBox;  // first and end tiles overlapped, x in the low 16 bits and y in the high ones
 };
 
 // TODO will be used for model transformation
@@ -117,7 +206,9 @@ struct PushConstant
 
 // indirect parameters for
 // - vkCmdDrawIndexedIndirect (first 6 attr)
-// - vkCmdDrawMeshTasksIndirectEXT (last 3 attr)
+// - vkCmdDrawMeshTasksIndirectEXT (next 3 attr)
+// - vkCmdDispatchIndirect of the distance shader after chunk culling (next 4 attr)
+// - vkCmdDispatchIndirect of the tile ranges shader of the compute pipeline (last 5 attr)
 struct IndirectParams
 {
   // for vkCmdDrawIndexedIndirect
@@ -131,6 +222,19 @@ struct IndirectParams
   uint32_t groupCountX DEFAULT(0);  // Will be incremented by the distance compute shader
   uint32_t groupCountY DEFAULT(1);  // Allways one workgroup on Y
   uint32_t groupCountZ DEFAULT(1);  // Allways one workgroup on Z
+
+  // for vkCmdDispatchIndirect
+  uint32_t distGroupCountX   DEFAULT(0);  // will be incremented by the chunk culling compute shader
+  uint32_t distGroupCountY   DEFAULT(1);  // Allways one workgroup on Y
+  uint32_t distGroupCountZ   DEFAULT(1);  // Allways one workgroup on Z
+  uint32_t visibleChunkCount DEFAULT(0);  // entries of the visible chunks buffer, for statistics
+
+  // for the compute pipeline
+  uint32_t tileEntryCount        DEFAULT(0);  // tile entries of the tile keys shader, may exceed the capacity
+  uint32_t tileSortCount         DEFAULT(0);  // tile entries stored, sorted and ranged, at most the capacity
+  uint32_t tileRangesGroupCountX DEFAULT(0);  // will be set by the tile scan shader
+  uint32_t tileRangesGroupCountY DEFAULT(1);  // Allways one workgroup on Y
+  uint32_t tileRangesGroupCountZ DEFAULT(1);  // Allways one workgroup on Z
 };
 
 #ifdef __cplusplus
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2023-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#version 460
+
+#extension GL_GOOGLE_include_directive : enable
+#include "shaderio.h"
+
+// Last pass of the compute pipeline (PIPELINE_COMPUTE), one workgroup per tile and one
+// thread per pixel. The entries of the tile are walked front to back by batches loaded
+// in shared memory, each pixel accumulates the splats weighted by its transmittance as
+// the back to front blending of the raster pipelines would, and stops once saturated.
+// The whole workgroup stops when all its pixels are saturated. The result is composited
+// over the content of the image, cleared beforehand.
+
+// scalar prevents alignment issues
+layout(set = 0, binding = BINDING_FRAME_INFO_UBO, scalar) uniform FrameInfo_
+{
+  FrameInfo frameInfo;
+};
+
+layout(local_size_x = TILE_SIZE, local_size_y = TILE_SIZE) in;
+
+layout(set = 0, binding = BINDING_TILE_SPLATS_BUFFER, scalar) readonly buffer _tileSplats
+{
+  TileSplat tileSplats[];
+};
+layout(set = 0, binding = BINDING_TILE_VALUES_BUFFER, scalar) readonly buffer _tileValues
+{
+  uint32_t tileValues[];
+};
+layout(set = 0, binding = BINDING_TILE_RANGES_BUFFER, scalar) readonly buffer _tileRanges
+{
+  uvec2 tileRanges[];
+};
+layout(set = 0, binding = BINDING_TILE_OUTPUT_IMAGE, rgba8) uniform image2D outputImage;
+
+const uint BATCH_SIZE = TILE_SIZE * TILE_SIZE;
+
+shared vec4 batchColor[BATCH_SIZE];
+shared vec3 batchConic[BATCH_SIZE];
+shared vec2 batchCenter[BATCH_SIZE];
+shared uint saturatedCount;
+
+void main()
+{
+  const ivec2 pixel  = ivec2(gl_GlobalInvocationID.xy);
+  const bool  inside = pixel.x < int(frameInfo.viewport.x) && pixel.y < int(frameInfo.viewport.y);
+  const vec2  pixelCenter = vec2(pixel) + 0.5;
+
+  const uvec2 range = tileRanges[gl_WorkGroupID.y * frameInfo.tileCountX + gl_WorkGroupID.x];
+
+  vec3  color         = vec3(0.0);
+  float transmittance = 1.0;
+  bool  saturated     = !inside;
+
+  // entries are sorted back to front, batches are taken from the end of the range
+  for(uint batchEnd = range.y; batchEnd > range.x; batchEnd -= min(batchEnd - range.x, BATCH_SIZE))
+  {
+    // the previous batch is consumed by all the threads
+    barrier();
+    if(gl_LocalInvocationIndex == 0)
+      saturatedCount = 0;
+    barrier();
+    if(saturated)
+      atomicAdd(saturatedCount, 1);
+
+    const uint batchCount = min(batchEnd - range.x, BATCH_SIZE);
+    if(gl_LocalInvocationIndex < batchCount)
+    {
+      const TileSplat splat = tileSplats[tileValues[batchEnd - 1 - gl_LocalInvocationIndex]];
+      batchColor[gl_LocalInvocationIndex]  = splat.color;
+      batchConic[gl_LocalInvocationIndex]  = splat.conic;
+      batchCenter[gl_LocalInvocationIndex] = splat.center;
+    }
+    barrier();
+
+    // same value for the whole workgroup
+    if(saturatedCount == BATCH_SIZE)
+      break;
+
+    for(uint i = 0; i < batchCount && !saturated; ++i)
+    {
+      const vec2  d = pixelCenter - batchCenter[i];
+      const vec3  q = batchConic[i];
+      const float A = q.x * d.x * d.x + 2.0 * q.y * d.x * d.y + q.z * d.y * d.y;
+      // outside of the ellipse of the quad, see raster.frag.glsl
+      if(A > 8.0)
+        continue;
+
+#ifdef DISABLE_OPACITY_GAUSSIAN
+      const float opacity = 1.0;
+#else
+      const float opacity = min(exp(-0.5 * A) * batchColor[i].a, 1.0);
+#endif
+      color += batchColor[i].rgb * (opacity * transmittance);
+      transmittance *= 1.0 - opacity;
+      saturated = transmittance < TILE_SATURATION_TRANSMITTANCE;
+    }
+  }
+
+  if(!inside)
+    return;
+
+  const vec4 background = imageLoad(outputImage, pixel);
+  imageStore(outputImage, pixel, vec4(color + background.rgb * transmittance, 1.0 - (1.0 - background.a) * transmittance));
+}
@@ -0,0 +1,300 @@
+/*
+ * Copyright (c) 2023-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#version 460
+
+#extension GL_GOOGLE_include_directive : enable
+#include "shaderio.h"
+#include "common.glsl"
+
+// First pass of the compute pipeline (PIPELINE_COMPUTE), one thread per sorted splat,
+// compiled twice:
+// - TILE_KEYS_PASS 0 projects the splat as the raster shaders do, stores it at its rank
+//   in the sorted indices with the tiles of TILE_SIZE x TILE_SIZE pixels it overlaps,
+//   and writes the count of these tiles, left to zero by the clear for culled splats.
+// - TILE_KEYS_PASS 1 runs after tile_scan.comp.glsl and emits one entry per overlapped
+//   tile at the scanned offset of the splat. The key is the tile and the value the rank.
+// The entries are thus written in rank order, and once stably sorted by tile, the
+// entries of each tile are contiguous and back to front whatever the splat count.
+
+// scalar prevents alignment issues
+layout(set = 0, binding = BINDING_FRAME_INFO_UBO, scalar) uniform FrameInfo_
+{
+  FrameInfo frameInfo;
+};
+
+layout(local_size_x = TILE_KEYS_WORKGROUP_SIZE) in;
+
+#if TILE_KEYS_PASS == 0
+
+// sorted indices, farthest first
+layout(set = 0, binding = BINDING_INDICES_BUFFER, scalar) readonly buffer _indices
+{
+  uint32_t indices[];
+};
+layout(set = 0, binding = BINDING_INDIRECT_BUFFER, scalar) readonly buffer _indirect
+{
+  IndirectParams indirect;
+};
+layout(set = 0, binding = BINDING_TILE_SPLATS_BUFFER, scalar) writeonly buffer _tileSplats
+{
+  TileSplat tileSplats[];
+};
+layout(set = 0, binding = BINDING_TILE_COUNTS_BUFFER, scalar) writeonly buffer _tileCounts
+{
+  uint32_t tileCounts[];
+};
+
+void main()
+{
+  const uint rank = gl_GlobalInvocationID.x;
+  // the distance shader of the GPU sort outputs the subset of splats that passed its
+  // culling (frustum, chunks, level of detail), otherwise we use all the splats
+  const uint splatCount = frameInfo.sortingMethod == SORTING_GPU_SYNC_RADIX ? indirect.instanceCount : frameInfo.splatCount;
+  if(rank >= splatCount)
+    return;
+
+  const uint splatIndex = indices[rank];
+
+  // work on splat position
+  const vec3 splatCenter = fetchCenter(splatIndex);
+
+  const mat4 transformModelViewMatrix = frameInfo.viewMatrix;
+  const vec4 viewCenter               = transformModelViewMatrix * vec4(splatCenter, 1.0);
+  const vec4 clipCenter               = frameInfo.projectionMatrix * viewCenter;
+
+  // splats behind the camera do not project, rejected whatever the frustum culling mode
+  if(clipCenter.w <= 0.0)
+    return;
+
+#if FRUSTUM_CULLING_MODE == FRUSTUM_CULLING_AT_RASTER
+  const float clip = (1.0 + frameInfo.frustumDilation) * clipCenter.w;
+  if(abs(clipCenter.x) > clip || abs(clipCenter.y) > clip
+     || clipCenter.z < (0.f - frameInfo.frustumDilation) * clipCenter.w || clipCenter.z > clipCenter.w)
+    return;
+#endif
+
+#if LOD_ENABLED
+  // the GPU sort only outputs the selected nodes, the CPU sort outputs all of them
+  if(frameInfo.sortingMethod != SORTING_GPU_SYNC_RADIX
+     && !isLodSelected(splatIndex, splatCenter, frameInfo.cameraPosition, abs(frameInfo.focal.x),
+                       frameInfo.orthographicMode == 0 ? frameInfo.lodThreshold : 0.0, frameInfo.lodLeafCount))
+    return;
+#endif
+
+#if STREAMING_ENABLED
+  // the GPU sort only outputs resident splats, the CPU sort outputs all of them
+  if(frameInfo.sortingMethod != SORTING_GPU_SYNC_RADIX && !isSplatResident(splatIndex))
+    return;
+#endif
+
+  vec4 splatColor = fetchColor(splatIndex);
+
+#if SHOW_SH_ONLY == 1
+  splatColor.r = 0.5;
+  splatColor.g = 0.5;
+  splatColor.b = 0.5;
+#endif
+
+#if MAX_SH_DEGREE >= 1
+  // SH coefficients for degree 1 (1,2,3)
+  vec3 shd1[3];
+#if MAX_SH_DEGREE >= 2
+  // SH coefficients for degree 2 (4 5 6 7 8)
+  vec3 shd2[5];
+#endif
+#if MAX_SH_DEGREE >= 3
+  // SH coefficients for degree 3 (9,10,11,12,13,14,15)
+  vec3 shd3[7];
+#endif
+  // fetch the data (only what is needed according to degree)
+  fetchSh(splatIndex, shd1
+#if MAX_SH_DEGREE >= 2
+    , shd2
+#endif
+#if MAX_SH_DEGREE >= 3
+    , shd3
+#endif
+  );
+
+  const vec3  worldViewDir = normalize(splatCenter - frameInfo.cameraPosition);
+  const float x            = worldViewDir.x;
+  const float y            = worldViewDir.y;
+  const float z            = worldViewDir.z;
+  splatColor.rgb += SH_C1 * (-shd1[0] * y + shd1[1] * z - shd1[2] * x);
+
+#if MAX_SH_DEGREE >= 2
+  const float xx = x * x;
+  const float yy = y * y;
+  const float zz = z * z;
+  const float xy = x * y;
+  const float yz = y * z;
+  const float xz = x * z;
+
+  splatColor.rgb += (SH_C2[0] * xy) * shd2[0] + (SH_C2[1] * yz) * shd2[1] + (SH_C2[2] * (2.0 * zz - xx - yy)) * shd2[2]
+                    + (SH_C2[3] * xz) * shd2[3] + (SH_C2[4] * (xx - yy)) * shd2[4];
+#endif
+#if MAX_SH_DEGREE >= 3
+  // Degree 3 contributions
+  splatColor.rgb += SH_C3[0] * shd3[0] * (3.0 * x * x - y * y) * y + SH_C3[1] * shd3[1] * x * y * z
+                    + SH_C3[2] * shd3[2] * (4.0 * z * z - x * x - y * y) * y
+                    + SH_C3[3] * shd3[3] * z * (2.0 * z * z - 3.0 * x * x - 3.0 * y * y)
+                    + SH_C3[4] * shd3[4] * x * (4.0 * z * z - x * x - y * y)
+                    + SH_C3[5] * shd3[5] * (x * x - y * y) * z + SH_C3[6] * shd3[6] * x * (x * x - 3.0 * y * y);
+#endif
+#endif
+
+  // alpha based culling
+  if(splatColor.a < frameInfo.alphaCullThreshold)
+    return;
+
+  // Fetch and construct the 3D covariance matrix
+  const mat3 Vrk = fetchCovariance(splatIndex);
+
+#if ORTHOGRAPHIC_MODE == 1
+  const mat3 J = transpose(mat3(frameInfo.orthoZoom, 0.0, 0.0, 0.0, frameInfo.orthoZoom, 0.0, 0.0, 0.0, 0.0));
+#else
+  // Jacobian of the affine approximation of the projection, see raster.vert.glsl
+  const float s = 1.0 / (viewCenter.z * viewCenter.z);
+  const mat3  J = mat3(frameInfo.focal.x / viewCenter.z, 0., -(frameInfo.focal.x * viewCenter.x) * s, 0.,
+                       frameInfo.focal.y / viewCenter.z, -(frameInfo.focal.y * viewCenter.y) * s, 0., 0., 0.);
+#endif
+
+  const mat3 W = transpose(mat3(transformModelViewMatrix));
+  const mat3 T = W * J;
+
+  // 2D covariance matrix
+  mat3 cov2Dm = transpose(T) * Vrk * T;
+  cov2Dm[0][0] += 0.3;
+  cov2Dm[1][1] += 0.3;
+
+  const vec3 cov2Dv = vec3(cov2Dm[0][0], cov2Dm[0][1], cov2Dm[1][1]);
+
+  const vec3 ndcCenter = clipCenter.xyz / clipCenter.w;
+
+  // eigen values and vectors of the 2D covariance, same basis as the quad of the raster shaders
+  const float a           = cov2Dv.x;
+  const float d           = cov2Dv.z;
+  const float b           = cov2Dv.y;
+  const float D           = a * d - b * b;
+  const float trace       = a + d;
+  const float traceOver2  = 0.5 * trace;
+  const float term2       = sqrt(max(0.1f, traceOver2 * traceOver2 - D));
+  float       eigenValue1 = traceOver2 + term2;
+  float       eigenValue2 = traceOver2 - term2;
+
+  if(eigenValue2 <= 0.0)
+    return;
+
+#if POINT_CLOUD_MODE
+  eigenValue1 = eigenValue2 = 0.2;
+#endif
+
+  const vec2 eigenVector1 = normalize(vec2(b, eigenValue1 - a));
+  const vec2 eigenVector2 = vec2(eigenVector1.y, -eigenVector1.x);
+
+  const vec2 basisVector1 = eigenVector1 * frameInfo.splatScale * min(sqrt8 * sqrt(eigenValue1), 2048.0);
+  const vec2 basisVector2 = eigenVector2 * frameInfo.splatScale * min(sqrt8 * sqrt(eigenValue2), 2048.0);
+
+  // the raster shaders offset the quad corners by basisVector * basisViewport * 2 in NDC,
+  // that is basisViewport * viewport in pixels of the color image
+  const vec2 toPixels = frameInfo.basisViewport * frameInfo.viewport * frameInfo.inverseFocalAdjustment;
+  const mat2 axes     = mat2(basisVector1 * toPixels, basisVector2 * toPixels);
+  const float det     = determinant(axes);
+  if(det == 0.0)
+    return;
+
+  // a pixel at offset p from the center has quad coordinates inverse(axes) * p, scaled by
+  // sqrt(8) in raster.frag.glsl, hence the quadratic form 8 * transpose(inverse(axes)) * inverse(axes)
+  const mat2 invAxes = inverse(axes);
+  const mat2 conic   = 8.0 * transpose(invAxes) * invAxes;
+  const vec2 center  = (ndcCenter.xy * 0.5 + 0.5) * frameInfo.viewport;
+
+  // bounding box of the ellipse in tiles, hi excluded
+  const vec2  radius   = vec2(length(vec2(axes[0].x, axes[1].x)), length(vec2(axes[0].y, axes[1].y)));
+  const ivec2 tiles    = ivec2(frameInfo.tileCountX, frameInfo.tileCountY);
+  const ivec2 tileLo   = clamp(ivec2(floor((center - radius) / TILE_SIZE)), ivec2(0), tiles);
+  const ivec2 tileHi   = clamp(ivec2(floor((center + radius) / TILE_SIZE)) + 1, ivec2(0), tiles);
+  const uint  tileArea = uint(max(tileHi.x - tileLo.x, 0) * max(tileHi.y - tileLo.y, 0));
+  if(tileArea == 0)
+    return;
+
+  tileSplats[rank].color   = vec4(clamp(splatColor.rgb, 0.0, 1.0), splatColor.a);
+  tileSplats[rank].conic   = vec3(conic[0][0], conic[0][1], conic[1][1]);
+  tileSplats[rank].center  = center;
+  tileSplats[rank].tileBox = uvec2(tileLo) | (uvec2(tileHi) << 16);
+  tileCounts[rank]         = tileArea;
+}
+
+#else
+
+layout(set = 0, binding = BINDING_TILE_SPLATS_BUFFER, scalar) readonly buffer _tileSplats
+{
+  TileSplat tileSplats[];
+};
+layout(set = 0, binding = BINDING_TILE_COUNTS_BUFFER, scalar) readonly buffer _tileCounts
+{
+  uint32_t tileCounts[];
+};
+layout(set = 0, binding = BINDING_TILE_OFFSETS_BUFFER, scalar) readonly buffer _tileOffsets
+{
+  uint32_t tileOffsets[];
+};
+layout(set = 0, binding = BINDING_TILE_BLOCK_SUMS_BUFFER, scalar) readonly buffer _tileBlockSums
+{
+  uint32_t tileBlockSums[];
+};
+layout(set = 0, binding = BINDING_TILE_KEYS_BUFFER, scalar) writeonly buffer _tileKeys
+{
+  uint32_t tileKeys[];
+};
+layout(set = 0, binding = BINDING_TILE_VALUES_BUFFER, scalar) writeonly buffer _tileValues
+{
+  uint32_t tileValues[];
+};
+
+void main()
+{
+  const uint rank = gl_GlobalInvocationID.x;
+  if(rank >= uint(frameInfo.splatCount) || tileCounts[rank] == 0)
+    return;
+
+  // the entries beyond the capacity are dropped, the tile scan
+  // shader reported the total so that the host grows the buffers
+  const uint  capacity = frameInfo.tileEntryCapacity;
+  const uvec2 box      = tileSplats[rank].tileBox;
+  const ivec2 tileLo   = ivec2(box & 0xffffu);
+  const ivec2 tileHi   = ivec2(box >> 16);
+
+  // offset of the block of the splat plus its offset in the block
+  uint entry = tileBlockSums[rank / TILE_SCAN_BLOCK_SIZE] + tileOffsets[rank];
+  for(int ty = tileLo.y; ty < tileHi.y; ++ty)
+  {
+    for(int tx = tileLo.x; tx < tileHi.x; ++tx, ++entry)
+    {
+      if(entry >= capacity)
+        return;
+      tileKeys[entry]   = uint(ty * frameInfo.tileCountX + tx);
+      tileValues[entry] = rank;
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2023-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#version 460
+
+#extension GL_GOOGLE_include_directive : enable
+#include "shaderio.h"
+
+// Second pass of the compute pipeline (PIPELINE_COMPUTE), one thread per sorted tile entry.
+// Finds the first and last entries of each tile in the sorted keys, which are the tiles
+// themselves. The range of the tiles without entries is left to zero by the clear of the buffer.
+
+// scalar prevents alignment issues
+layout(set = 0, binding = BINDING_FRAME_INFO_UBO, scalar) uniform FrameInfo_
+{
+  FrameInfo frameInfo;
+};
+
+layout(local_size_x = TILE_RANGES_WORKGROUP_SIZE) in;
+
+layout(set = 0, binding = BINDING_INDIRECT_BUFFER, scalar) readonly buffer _indirect
+{
+  IndirectParams indirect;
+};
+layout(set = 0, binding = BINDING_TILE_KEYS_BUFFER, scalar) readonly buffer _tileKeys
+{
+  uint32_t tileKeys[];
+};
+// first entry and end of the entries of each tile
+layout(set = 0, binding = BINDING_TILE_RANGES_BUFFER, scalar) writeonly buffer _tileRanges
+{
+  uvec2 tileRanges[];
+};
+
+void main()
+{
+  const uint entry = gl_GlobalInvocationID.x;
+  const uint count = indirect.tileSortCount;
+  if(entry >= count)
+    return;
+
+  const uint tile = tileKeys[entry];
+  if(entry == 0)
+  {
+    tileRanges[tile].x = 0;
+  }
+  else
+  {
+    const uint previousTile = tileKeys[entry - 1];
+    if(previousTile != tile)
+    {
+      tileRanges[previousTile].y = entry;
+      tileRanges[tile].x         = entry;
+    }
+  }
+  if(entry == count - 1)
+  {
+    tileRanges[tile].y = count;
+  }
+}
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2023-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#version 460
+
+#extension GL_GOOGLE_include_directive : enable
+#include "shaderio.h"
+
+// Exclusive scan of the tile counts written by the first pass of tile_keys.comp.glsl,
+// gives the offset of the first tile entry of each splat. Compiled twice:
+// - TILE_SCAN_PASS 0 runs one workgroup per block of TILE_SCAN_BLOCK_SIZE splats, writes
+//   the offsets of the splats within their block and the total of the block.
+// - TILE_SCAN_PASS 1 runs a single workgroup that scans the totals of the blocks in place,
+//   then sets the entry counts and the workgroups of the tile ranges shader.
+// The second pass of tile_keys.comp.glsl adds the offset of the block to the one in the block.
+
+// scalar prevents alignment issues
+layout(set = 0, binding = BINDING_FRAME_INFO_UBO, scalar) uniform FrameInfo_
+{
+  FrameInfo frameInfo;
+};
+
+layout(local_size_x = TILE_SCAN_WORKGROUP_SIZE) in;
+
+layout(set = 0, binding = BINDING_TILE_BLOCK_SUMS_BUFFER, scalar) buffer _tileBlockSums
+{
+  uint32_t tileBlockSums[];
+};
+
+#if TILE_SCAN_PASS == 0
+layout(set = 0, binding = BINDING_TILE_COUNTS_BUFFER, scalar) readonly buffer _tileCounts
+{
+  uint32_t tileCounts[];
+};
+layout(set = 0, binding = BINDING_TILE_OFFSETS_BUFFER, scalar) writeonly buffer _tileOffsets
+{
+  uint32_t tileOffsets[];
+};
+#else
+layout(set = 0, binding = BINDING_INDIRECT_BUFFER, scalar) buffer _indirect
+{
+  IndirectParams indirect;
+};
+#endif
+
+shared uint threadSums[TILE_SCAN_WORKGROUP_SIZE];
+
+// exclusive scan of the values of the threads of the workgroup, returns the
+// sum of the values of the previous threads and sets total to the sum of all
+uint workgroupExclusiveAdd(uint value, out uint total)
+{
+  const uint thread = gl_LocalInvocationIndex;
+  threadSums[thread] = value;
+  barrier();
+  for(uint stride = 1; stride < TILE_SCAN_WORKGROUP_SIZE; stride *= 2)
+  {
+    const uint previous = thread >= stride ? threadSums[thread - stride] : 0;
+    barrier();
+    threadSums[thread] += previous;
+    barrier();
+  }
+  total = threadSums[TILE_SCAN_WORKGROUP_SIZE - 1];
+  return threadSums[thread] - value;
+}
+
+uint divUp(uint value, uint divisor)
+{
+  return (value + divisor - 1) / divisor;
+}
+
+void main()
+{
+#if TILE_SCAN_PASS == 0
+  // each thread scans a contiguous run of the block, the runs are then offset by the workgroup scan
+  const uint perThread = TILE_SCAN_BLOCK_SIZE / TILE_SCAN_WORKGROUP_SIZE;
+  const uint count     = uint(frameInfo.splatCount);
+  const uint first     = gl_WorkGroupID.x * TILE_SCAN_BLOCK_SIZE + gl_LocalInvocationIndex * perThread;
+  const uint end       = min(first + perThread, count);
+
+  uint runSum = 0;
+  for(uint i = first; i < end; ++i)
+    runSum += tileCounts[i];
+
+  uint blockSum;
+  uint offset = workgroupExclusiveAdd(runSum, blockSum);
+  for(uint i = first; i < end; ++i)
+  {
+    const uint tileCount = tileCounts[i];
+    tileOffsets[i]       = offset;
+    offset += tileCount;
+  }
+  if(gl_LocalInvocationIndex == 0)
+    tileBlockSums[gl_WorkGroupID.x] = blockSum;
+#else
+  // same scheme on the totals of the blocks, in place
+  const uint count     = frameInfo.tileScanBlockCount;
+  const uint perThread = divUp(count, TILE_SCAN_WORKGROUP_SIZE);
+  const uint first     = gl_LocalInvocationIndex * perThread;
+  const uint end       = min(first + perThread, count);
+
+  uint runSum = 0;
+  for(uint i = first; i < end; ++i)
+    runSum += tileBlockSums[i];
+
+  uint total;
+  uint offset = workgroupExclusiveAdd(runSum, total);
+  for(uint i = first; i < end; ++i)
+  {
+    const uint blockSum = tileBlockSums[i];
+    tileBlockSums[i]    = offset;
+    offset += blockSum;
+  }
+
+  // the entries beyond the capacity are dropped by tile_keys.comp.glsl, the total
+  // is kept in tileEntryCount so that the host grows the buffers for the next frames
+  if(gl_LocalInvocationIndex == 0)
+  {
+    const uint stored              = min(total, frameInfo.tileEntryCapacity);
+    indirect.tileEntryCount        = total;
+    indirect.tileSortCount         = stored;
+    indirect.tileRangesGroupCountX = divUp(stored, TILE_RANGES_WORKGROUP_SIZE);
+  }
+#endif
+}
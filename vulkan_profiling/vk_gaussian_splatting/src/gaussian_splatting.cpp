@@ -22,6 +22,8 @@
 
 #include "gaussian_splatting.h"
 #include "utilities.h"
+#include "sh_packing.h"
+#include "splat_quantization.h"
 
 #include <nvh/misc.hpp>
 #include <glm/gtc/packing.hpp>  // Required for half-float operations
@@ -35,7 +37,7 @@ GaussianSplatting::GaussianSplatting(std::shared_ptr<nvvkhl::ElementProfiler>
   // Register command line arguments
   // Done in this class instead of in main() so private members can be registered for direct modification
 //   benchmark->parameterLists().addFilename(".ply|load a ply file", &m_sceneToLoadFilename);
-//   benchmark->parameterLists().add("pipeline|0=mesh 1=vert", &m_selectedPipeline);
+//   benchmark->parameterLists().add("pipeline|0=mesh 1=vert 3=compute", &m_selectedPipeline);
 //   benchmark->parameterLists().add("shformat|0=fp32 1=fp16 2=uint8", &m_defines.shFormat);
 //   benchmark->parameterLists().add("updateData|1=triggers an update of data buffers or textures, used for benchmarking", &m_updateData);
 //   benchmark->parameterLists().add("maxShDegree|max sh degree used for rendering in [0,1,2,3]", &m_defines.maxShDegree);
@@ -52,6 +54,96 @@ GaussianSplatting::GaussianSplatting(std::shared_ptr<nvvkhl::ElementProfiler>
     m_outputFilename = parser->get<std::string>("output");
     m_outputScreenshot = true;
   }
+  if (parser->get<bool>("nocache")) {
+    m_useSplatCache = false;
+  }
+  if (parser->get<bool>("lod")) {
+    m_lodEnabled = true;
+  }
+  if (parser->is_used("streaming")) {
+    m_streamingPoolSize = std::max(0, parser->get<int>("streaming"));
+  }
+  m_shaderCacheFolder = NVPSystem::exePath() + "spirv_cache";
+  if (parser->is_used("shadercache")) {
+    m_shaderCacheFolder = parser->get<std::string>("shadercache");
+  }
+  if (parser->is_used("pipelinecache")) {
+    m_pipelineCacheFilename = parser->get<std::string>("pipelinecache");
+  }
+  if (parser->is_used("views")) {
+    const std::string viewsFilename = parser->get<std::string>("views");
+    if (m_viewBatch.load(viewsFilename)) {
+      // -o is the output folder in batch mode, defaults to the folder of the views file
+      m_viewBatch.setOutput(m_outputScreenshot ? m_outputFilename : std::filesystem::path(viewsFilename).parent_path().string());
+      m_viewBatch.setFrameCounts(parser->get<int>("warmup"), parser->get<int>("timed"));
+      m_useViewBatch     = true;
+      m_outputScreenshot = false;
+      // the stage times go next to timings.csv by default
+      m_stageTimesFilename = (std::filesystem::path(m_viewBatch.outputDir()) / "stage_times.csv").string();
+    }
+  }
+  if (parser->is_used("stagetimes")) {
+    m_stageTimesFilename = parser->get<std::string>("stagetimes");
+  }
+  if (parser->is_used("order")) {
+    const std::string order = parser->get<std::string>("order");
+    if (order == "morton") {
+      m_spatialOrder = E_ORDER_MORTON;
+    } else if (order == "hilbert") {
+      m_spatialOrder = E_ORDER_HILBERT;
+    } else if (order != "file") {
+      std::cout << "Error: unknown splat order " << order << ", using file" << std::endl;
+    }
+  }
+  if (parser->is_used("centersformat")) {
+    const std::string format = parser->get<std::string>("centersformat");
+    if (format == "unorm16") {
+      m_defines.centersFormat = FORMAT_UNORM16;
+    } else if (format != "fp32") {
+      std::cout << "Error: unknown centers format " << format << ", using fp32" << std::endl;
+    }
+  }
+  if (parser->is_used("covformat")) {
+    const std::string format = parser->get<std::string>("covformat");
+    if (format == "fp16") {
+      m_defines.covariancesFormat = FORMAT_FLOAT16;
+    } else if (format != "fp32") {
+      std::cout << "Error: unknown covariances format " << format << ", using fp32" << std::endl;
+    }
+  }
+  if (parser->is_used("colorsformat")) {
+    const std::string format = parser->get<std::string>("colorsformat");
+    if (format == "rgba8") {
+      m_defines.colorsFormat = FORMAT_UINT8;
+    } else if (format == "fp32") {
+      m_defines.colorsFormat = FORMAT_FLOAT32;
+    } else {
+      std::cout << "Error: unknown colors format " << format << ", using the storage default" << std::endl;
+    }
+  }
+  if (parser->is_used("chunkculling")) {
+    const std::string culling = parser->get<std::string>("chunkculling");
+    if (culling == "none") {
+      m_defines.chunkCulling = CHUNK_CULLING_NONE;
+    } else if (culling == "cpu") {
+      m_defines.chunkCulling = CHUNK_CULLING_CPU;
+    } else if (culling != "gpu") {
+      std::cout << "Error: unknown chunk culling " << culling << ", using gpu" << std::endl;
+    }
+  }
+  if (parser->is_used("statsformat")) {
+    const std::string format = parser->get<std::string>("statsformat");
+    if (format == "json") {
+      m_statsFormat = STATS_FORMAT_JSON;
+    } else if (format == "csv") {
+      m_statsFormat = STATS_FORMAT_CSV;
+    } else if (format != "text") {
+      std::cout << "Error: unknown stats format " << format << ", using text" << std::endl;
+    }
+  }
+  if (parser->is_used("maxshdegree")) {
+    m_defines.maxShDegree = std::clamp(parser->get<int>("maxshdegree"), 0, 3);
+  }
   if (parser->is_used("view")) {
     std::vector<float> view = parser->get<std::vector<float>>("view");
     if (view.size() == 16) {
@@ -71,8 +163,21 @@ GaussianSplatting::GaussianSplatting(std::shared_ptr<nvvkhl::ElementProfiler>
   // m_defines.maxShDegree = 3;
   // m_defines.shFormat    = FORMAT_FLOAT32;
   m_selectedPipeline    = PIPELINE_VERT;
+  if (parser->is_used("pipeline")) {
+    const std::string pipeline = parser->get<std::string>("pipeline");
+    if (pipeline == "mesh") {
+      m_selectedPipeline = PIPELINE_MESH;
+    } else if (pipeline == "compute") {
+      m_selectedPipeline = PIPELINE_COMPUTE;
+    } else if (pipeline != "vert") {
+      std::cout << "Error: unknown pipeline " << pipeline << ", using vert" << std::endl;
+    }
+  }
+  m_checkCompute = parser->get<bool>("checkcompute");
   // m_defines.dataStorage = STORAGE_BUFFERS;
   // m_defines.frustumCulling = FRUSTUM_CULLING_AT_DIST;
+  // the render settings modified by the command line survive resetRenderSettings
+  m_defaultDefines = m_defines;
 };
 
 GaussianSplatting::~GaussianSplatting(){
@@ -92,6 +197,8 @@ void GaussianSplatting::onAttach(nvvkhl::Application* app)
   // shortcuts
   m_app    = app;
   m_device = m_app->getDevice();
+  // the host rings (staging, readbacks) have one slice per frame the application can have in flight
+  m_framesInFlight = std::max(1u, m_app->getFrameCycleSize());
 
   m_depthFormat = nvvk::findDepthFormat(app->getPhysicalDevice());
   // Debug utility
@@ -117,6 +224,28 @@ void GaussianSplatting::onAttach(nvvkhl::Application* app)
   shaderSearchPaths.push_back(NVPSystem::exePath() + std::string(PROJECT_RELDIRECTORY) + "shaders");
   shaderSearchPaths.push_back(NVPSystem::exePath() + std::string(PROJECT_RELDIRECTORY) + "nvpro_core");
 
+  // splat data uploads, main.cpp gives the transfer queue after the graphics one
+  m_uploader.init(m_device, app->getPhysicalDevice(), m_alloc.get(), m_app->getQueue(1).queue, m_app->getQueue(1).familyIndex,
+                  m_app->getQueue(0).queue, m_app->getQueue(0).familyIndex);
+  m_renderMemoryStats.hostAllocUpload = m_uploader.stagingBytes();
+
+  // GPU stage times, on the queue the frames are submitted to
+  if(m_stageProfiler.init(m_device, app->getPhysicalDevice(), m_app->getQueue(0).familyIndex))
+  {
+    m_stageProfiler.setStepCallback([this](const StageProfiler::Step& step) {
+      StageProfiler::printStep(step, (uint32_t)m_stageProfiler.steps().size());
+      if(!m_stageTimesFilename.empty())
+        m_stageProfiler.writeFile(m_stageTimesFilename);
+    });
+  }
+
+  // pipelines are rebuilt at each scene load and shader reload, all through the same cache
+  if(m_pipelineCache.init(app->getPhysicalDevice(), m_device, m_pipelineCacheFilename) == VK_SUCCESS)
+  {
+    std::cout << "Pipeline cache: " << m_pipelineCache.loadedBytes() << " bytes reused from "
+              << m_pipelineCacheFilename << std::endl;
+  }
+
   m_shaderManager.init(m_device, 1, 2);
   m_shaderManager.m_filetype        = nvh::ShaderFileManager::FILETYPE_GLSL;
   m_shaderManager.m_keepModuleSPIRV = true;
@@ -124,6 +253,7 @@ void GaussianSplatting::onAttach(nvvkhl::Application* app)
   {
     m_shaderManager.addDirectory(path);
   }
+  m_shaderVariantCache.init(m_shaderCacheFolder, shaderSearchPaths, m_shaderManager);
 };
 
 void GaussianSplatting::onDetach()
@@ -131,8 +261,20 @@ void GaussianSplatting::onDetach()
   // stops the threads
   m_plyLoader.shutdown();
   m_cpuSorter.shutdown();
+  // reads back the last frames and reports the stage times of the whole run
+  vkDeviceWaitIdle(m_device);
+  m_stageProfiler.flush();
+  if(m_stageProfiler.isEnabled())
+  {
+    StageProfiler::printStep(m_stageProfiler.summary(), 0);
+    if(!m_stageTimesFilename.empty() && m_stageProfiler.writeFile(m_stageTimesFilename))
+      std::cout << "Stage times written to " << m_stageTimesFilename << std::endl;
+  }
+  m_stageProfiler.deinit();
   // release resources
   deinitAll();
+  m_uploader.deinit();
+  m_pipelineCache.deinit();
   m_dset->deinit();
   m_dset_pbr->deinit();
   deinitGbuffers();
@@ -140,7 +282,11 @@ void GaussianSplatting::onDetach()
 
 void GaussianSplatting::onResize(VkCommandBuffer cmd, const VkExtent2D& size)
 {
+  // the copies of a running measure would not match the new size
+  cancelPsnrMeasure();
   initGbuffers({size.width, size.height});
+  // the compute pipeline writes the new color image
+  m_tileDescriptorsDirty = true;
 }
 
 void GaussianSplatting::setCameraMatrices(const float* view, const float* proj, const float* model)
@@ -176,9 +322,20 @@ void GaussianSplatting::onRender(VkCommandBuffer cmd)
 
   const nvvk::DebugUtil::ScopedCmdLabel sdbg = m_dutil->DBG_SCOPE(cmd);
 
+  // used to track the host buffers read by the frames in flight
+  m_frameIndex++;
+
+  // reads back the stage times of an earlier frame and starts timing this one
+  m_stageProfiler.beginFrame(cmd);
+
   // collect readback results from previous frame if any
   collectReadBackValuesIfNeeded();
 
+  if(m_sortCheckStep == SORT_CHECK_WAIT && m_frameIndex >= m_sortCheckReadyAt)
+  {
+    compareSortOrders();
+  }
+
   // 0 if not ready so the rendering does not
   // touch the splat set while loading
   uint32_t splatCount = 0;
@@ -187,17 +344,55 @@ void GaussianSplatting::onRender(VkCommandBuffer cmd)
     splatCount = (uint32_t)m_splatSet.size();
   }
 
+  // a pipeline PSNR measure renders its frames with the pipelines it compares
+  applyPsnrMeasurePipeline();
+
+  // a sort order check sorts its frame on the GPU, the CPU sorting method is restored at the end of the frame
+  const int  sortingMethod  = m_frameInfo.sortingMethod;
+  const bool sortCheckFrame = m_sortCheckStep == SORT_CHECK_REQUESTED && splatCount;
+  if(sortCheckFrame)
+  {
+    m_frameInfo.sortingMethod = SORTING_GPU_SYNC_RADIX;
+  }
+
+  // before anything is recorded, the device may be idled to grow the buffers
+  if(m_selectedPipeline == PIPELINE_COMPUTE && splatCount)
+  {
+    updateTileBuffers(splatCount);
+  }
+
+  // sets the viewpoint of the batch before the frame info update
+  if(m_useViewBatch && splatCount)
+  {
+    processViewBatch();
+  }
+
   // Handle device-host data update and sorting if a scene exist
   if(splatCount)
   {
     updateAndUploadFrameInfoUBO(cmd, splatCount);
 
+    if(streamingEnabled())
+    {
+      updateSplatResidency(cmd);
+    }
+
+    // set by cullChunksOnCPU if used by this frame
+    m_chunkCullTime = 0.0;
+
     if(m_frameInfo.sortingMethod == SORTING_GPU_SYNC_RADIX)
     {
-      // resets CPU sorting time info
-      m_distTime = m_sortTime = 0.0;
+      // resets CPU sorting time info, kept if the CPU sort is checked
+      if(!sortCheckFrame)
+      {
+        m_distTime = m_sortTime = 0.0;
+        m_cpuSortConsumed       = false;
+      }
 
       processSortingOnGPU(cmd, splatCount);
+
+      if(sortCheckFrame)
+        readBackGpuSortOrder(cmd, splatCount);
     }
     else
     {
@@ -205,8 +400,14 @@ void GaussianSplatting::onRender(VkCommandBuffer cmd)
     }
   }
   // Drawing the primitives in the G-Buffer if any
+  if(m_selectedPipeline == PIPELINE_COMPUTE)
+  {
+    // writes the color image from compute shaders, it stays in general layout
+    rasterizeSplatTiles(cmd, splatCount);
+  }
+  else
   {
-    // auto timerSection = m_profiler->timeRecurring("Rendering", cmd);
+    auto timerSection = m_stageProfiler.section(cmd, "Rendering");
 
     nvvk::createRenderingInfo r_info({{0, 0}, m_gBuffers->getSize()}, {m_gBuffers->getColorImageView()},
                                      m_gBuffers->getDepthImageView(), VK_ATTACHMENT_LOAD_OP_CLEAR,
@@ -229,7 +430,16 @@ void GaussianSplatting::onRender(VkCommandBuffer cmd)
 
   readBackIndirectParametersIfNeeded(cmd);
 
+  if(splatCount)
+  {
+    processPsnrMeasure(cmd);
+  }
+
   updateRenderingMemoryStatistics(cmd, splatCount);
+  m_stageProfiler.endFrame(cmd);
+
+  m_frameInfo.sortingMethod = sortingMethod;
+
   if(m_outputScreenshot && splatCount > 0) {
     fc++;
     if (fc == 10) 
@@ -240,6 +450,70 @@ void GaussianSplatting::onRender(VkCommandBuffer cmd)
     }
   }
 
+  // --checkcompute, measures once the rendering is settled as for the screenshot, on the -v/-p view
+  // then with the camera moved inside the splat cloud, exits with the result
+  if(m_checkCompute && splatCount > 0)
+  {
+    ++m_checkComputeFrames;
+    if(m_checkComputeFrames == 10)
+      startPsnrMeasure(PSNR_MEASURE_PIPELINE);
+    else if(m_checkComputeFrames > 10 && m_psnrStep == PSNR_IDLE)
+    {
+      m_checkComputePassed = m_checkComputePassed && m_pipelinePsnrPassed;
+      if(m_checkComputeInside)
+      {
+        m_app->close();
+      }
+      else
+      {
+        // the camera keeps its orientation and moves to the mean of the splat centers,
+        // so that splats surround it and some lie behind it
+        glm::dvec3 mean(0.0);
+        for(size_t i = 0; i < m_splatSet.size(); ++i)
+          mean += glm::dvec3(m_splatSet.positions[i * 3 + 0], m_splatSet.positions[i * 3 + 1],
+                             m_splatSet.positions[i * 3 + 2]);
+        mean /= double(m_splatSet.size());
+        glm::mat4 cameraToWorld = glm::inverse(glm::transpose(view_cust));
+        cameraToWorld[3]        = glm::vec4(glm::vec3(mean), 1.0f);
+        view_cust               = glm::transpose(glm::inverse(cameraToWorld));
+        eye_cust                = glm::vec3(mean);
+        std::cout << "Compute check with the camera inside the splat cloud" << std::endl;
+        m_checkComputeInside = true;
+        m_checkComputeFrames = 0;
+      }
+    }
+  }
+
+}
+
+void GaussianSplatting::processViewBatch()
+{
+  // the CPU sort stats are the ones of the previous frame, sorted before the batch sets the pose
+  switch(m_viewBatch.frame(m_cpuSortConsumed, m_distTime, m_sortTime))
+  {
+    case ViewBatch::E_SET_POSE: {
+      const ViewBatch::Pose& pose = m_viewBatch.currentPose();
+      view_cust                   = pose.view;
+      if(pose.hasProj)
+        proj_cust = pose.proj;
+      glm::mat4 temp = glm::inverse(view_cust);
+      eye_cust       = glm::vec3(temp[0][3], temp[1][3], temp[2][3]);
+      break;
+    }
+    case ViewBatch::E_BEGIN_TIMING:
+      m_stageProfiler.beginStep(m_viewBatch.currentPose().name);
+      break;
+    case ViewBatch::E_SCREENSHOT:
+      m_stageProfiler.endStep();
+      m_app->screenShot(m_viewBatch.currentImageFilename(), 100);
+      break;
+    case ViewBatch::E_DONE:
+      m_useViewBatch = false;
+      m_app->close();
+      break;
+    default:
+      break;
+  }
 }
 
 void GaussianSplatting::onLastHeadlessFrame()
@@ -257,7 +531,7 @@ void GaussianSplatting::onLastHeadlessFrame()
 
 void GaussianSplatting::updateAndUploadFrameInfoUBO(VkCommandBuffer cmd, const uint32_t splatCount)
 {
-  // auto timerSection = m_profiler->timeRecurring("UBO update", cmd);
+  auto timerSection = m_stageProfiler.section(cmd, "UBO update");
 
   CameraManip.getLookat(m_eye, m_center, m_up);
 
@@ -285,9 +559,25 @@ void GaussianSplatting::updateAndUploadFrameInfoUBO(VkCommandBuffer cmd, const u
   m_frameInfo.basisViewport          = glm::vec2(1.0f / m_viewSize.x, 1.0f / m_viewSize.y);
   m_frameInfo.focal                  = glm::vec2(focalLengthX, focalLengthY);
   m_frameInfo.inverseFocalAdjustment = 1.0f / focalAdjustment;
+  m_frameInfo.lodLeafCount           = m_splatSet.lodLeafCount;
+
+  // tiles of the compute pipeline
+  const VkExtent2D imageSize     = m_gBuffers->getSize();
+  m_frameInfo.viewport           = glm::vec2(imageSize.width, imageSize.height);
+  m_frameInfo.tileCountX         = (imageSize.width + TILE_SIZE - 1) / TILE_SIZE;
+  m_frameInfo.tileCountY         = (imageSize.height + TILE_SIZE - 1) / TILE_SIZE;
+  m_frameInfo.tileEntryCapacity  = m_tileEntryCapacity;
+  m_frameInfo.tileScanBlockCount = (splatCount + TILE_SCAN_BLOCK_SIZE - 1) / TILE_SCAN_BLOCK_SIZE;
+
+  // the reference frame of the level of detail PSNR measure is rendered at full detail
+  const float lodThreshold = m_frameInfo.lodThreshold;
+  if(m_psnrMeasure == PSNR_MEASURE_LOD && m_psnrStep == PSNR_REFERENCE)
+    m_frameInfo.lodThreshold = 0.0f;
 
   vkCmdUpdateBuffer(cmd, m_frameInfoBuffer.buffer, 0, sizeof(shaderio::FrameInfo), &m_frameInfo);
 
+  m_frameInfo.lodThreshold = lodThreshold;
+
   // sync with end of copy to device
   VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
   barrier.srcAccessMask   = VK_ACCESS_TRANSFER_WRITE_BIT;
@@ -303,6 +593,10 @@ void GaussianSplatting::tryConsumeAndUploadCpuSortingResult(VkCommandBuffer cmd,
 {
   // upload CPU sorted indices to the GPU if needed
   bool newIndexAvailable = false;
+  m_cpuSortConsumed      = false;
+
+  // the host buffer that is not holding the indices in use
+  const int otherIdx = m_splatIndicesCurrent == 0 ? 1 : 0;
 
   if(!m_defines.opacityGaussianDisabled)
   {
@@ -314,47 +608,72 @@ void GaussianSplatting::tryConsumeAndUploadCpuSortingResult(VkCommandBuffer cmd,
       // we take into account the result of the sort
       if(status == SplatSorterAsync::E_SORTED)
       {
-        m_cpuSorter.consume(m_splatIndices, m_distTime, m_sortTime);
-        newIndexAvailable = true;
+        m_cpuSorter.consume(m_distTime, m_sortTime);
+        m_cpuSortConsumed     = true;
+        m_splatIndicesCurrent = m_splatIndicesSorting;
+        m_splatIndicesSorting = -1;
+        m_cpuSortedView       = m_cpuSortRequestedView;
+        newIndexAvailable     = true;
       }
 
       // let's wakeup the sorting thread to run a new sort if needed
       // will start work only if camera direction or position has changed
-      m_cpuSorter.sortAsync(glm::normalize(m_center - m_eye), m_eye, m_splatSet.positions, m_cpuLazySort);
+      // the sort is written in the host buffer not in use, if no frame in flight reads it
+      // MULTI uses the multi-threaded radix sort, MONO the single threaded std::sort
+      const int targetIdx = m_splatIndicesCurrent == 0 ? 1 : 0;
+      if(isSplatIndicesHostAvailable(targetIdx))
+      {
+        const auto method = m_frameInfo.sortingMethod == SORTING_CPU_ASYNC_MONO ? SplatSorterAsync::E_STD_SORT :
+                                                                                    SplatSorterAsync::E_RADIX_SORT;
+        // the camera is taken from the view matrix used by the GPU, so that
+        // both sorts use the same viewpoint and the same key (m_frameInfo.sortKeyMode)
+        const glm::mat4& view = m_frameInfo.viewMatrix;
+        const glm::vec3  dir  = -glm::vec3(view[0][2], view[1][2], view[2][2]);
+        const glm::vec3  cop  = glm::vec3(glm::inverse(view)[3]);
+        m_cpuSorter.setCoherence(m_cpuSortCoherence);
+        if(m_cpuSorter.sortAsync(dir, cop, m_splatSet.positions, m_splatIndicesHostMapped[targetIdx], m_cpuLazySort,
+                                 method, m_frameInfo.sortKeyMode))
+        {
+          m_splatIndicesSorting  = targetIdx;
+          m_cpuSortRequestedView = view;
+        }
+      }
     }
   }
-  else
+  else if(m_splatIndicesCurrent < 0 && isSplatIndicesHostAvailable(otherIdx))
   {
     // splatting off, we disable the sorting
     // indices would not be needed for non splatted points
     // however, using the same mechanism allows to use exactly the same shader
     // so if splatting/blending is off we provide an ordered table of indices
     // if not already filled by any other previous frames (sorted or not)
-    bool refill = (m_splatIndices.size() != splatCount);
-    if(refill)
+    uint32_t* indices = m_splatIndicesHostMapped[otherIdx];
+    for(uint32_t i = 0; i < splatCount; ++i)
     {
-      m_splatIndices.resize(splatCount);
-      for(uint32_t i = 0; i < splatCount; ++i)
-      {
-        m_splatIndices[i] = i;
-      }
-      newIndexAvailable = true;
+      indices[i] = i;
     }
+    m_splatIndicesCurrent = otherIdx;
+    newIndexAvailable     = true;
   }
 
+  // the device indices were overwritten by the GPU sort of a sort order check
+  if(m_cpuIndicesStale && m_splatIndicesCurrent >= 0)
+  {
+    newIndexAvailable = true;
+  }
+  m_cpuIndicesStale = false;
+
   // 2. upload to GPU is needed
   {
-    // auto timerSection = m_profiler->timeRecurring("Copy indices to GPU", cmd);
+    auto timerSection = m_stageProfiler.section(cmd, "Copy indices to GPU");
 
     if(newIndexAvailable)
     {
-      // Prepare buffer on host using sorted indices
-      uint32_t* hostBuffer = static_cast<uint32_t*>(m_alloc->map(m_splatIndicesHost));
-      memcpy(hostBuffer, m_splatIndices.data(), m_splatIndices.size() * sizeof(uint32_t));
-      m_alloc->unmap(m_splatIndicesHost);
+      // host buffers are persistently mapped and coherent, the indices are already in place
       // copy buffer to device
       VkBufferCopy bc{.srcOffset = 0, .dstOffset = 0, .size = splatCount * sizeof(uint32_t)};
-      vkCmdCopyBuffer(cmd, m_splatIndicesHost.buffer, m_splatIndicesDevice.buffer, 1, &bc);
+      vkCmdCopyBuffer(cmd, m_splatIndicesHost[m_splatIndicesCurrent].buffer, m_splatIndicesDevice.buffer, 1, &bc);
+      m_splatIndicesHostFreeAt[m_splatIndicesCurrent] = m_frameIndex + m_framesInFlight;
       // sync with end of copy to device
       VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
       barrier.srcAccessMask   = VK_ACCESS_TRANSFER_WRITE_BIT;
@@ -367,18 +686,155 @@ void GaussianSplatting::tryConsumeAndUploadCpuSortingResult(VkCommandBuffer cmd,
   }
 }
 
+void GaussianSplatting::checkCpuSortOrder()
+{
+  if(m_sortCheckStep != SORT_CHECK_IDLE)
+    return;
+
+  const uint32_t splatCount = (uint32_t)m_splatSet.positions.size() / 3;
+  if(m_frameInfo.sortingMethod == SORTING_GPU_SYNC_RADIX || m_defines.opacityGaussianDisabled
+     || m_splatIndicesCurrent < 0 || splatCount < 2)
+  {
+    m_cpuSortCheckResult = "No CPU sorted order";
+    return;
+  }
+
+  // visible count then sorted indices, the copy of the next frame is read by compareSortOrders
+  m_sortCheckReadbackHost = m_alloc->createBuffer((splatCount + 1) * sizeof(uint32_t), VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+                                                      | VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+  m_dutil->DBG_NAME(m_sortCheckReadbackHost.buffer);
+
+  m_sortCheckStep      = SORT_CHECK_REQUESTED;
+  m_cpuSortCheckResult = "Running";
+}
+
+void GaussianSplatting::readBackGpuSortOrder(VkCommandBuffer cmd, const uint32_t splatCount)
+{
+  // ensures the visible count and the indices written by the GPU sort are available for transfer
+  VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+  barrier.srcAccessMask   = VK_ACCESS_SHADER_WRITE_BIT;
+  barrier.dstAccessMask   = VK_ACCESS_TRANSFER_READ_BIT;
+
+  vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0,
+                       NULL, 0, NULL);
+
+  VkBufferCopy countCopy{.srcOffset = offsetof(shaderio::IndirectParams, instanceCount), .dstOffset = 0,
+                         .size = sizeof(uint32_t)};
+  vkCmdCopyBuffer(cmd, m_indirect.buffer, m_sortCheckReadbackHost.buffer, 1, &countCopy);
+  VkBufferCopy indicesCopy{.srcOffset = 0, .dstOffset = sizeof(uint32_t), .size = splatCount * sizeof(uint32_t)};
+  vkCmdCopyBuffer(cmd, m_splatIndicesDevice.buffer, m_sortCheckReadbackHost.buffer, 1, &indicesCopy);
+
+  m_sortCheckView       = m_frameInfo.viewMatrix;
+  m_sortCheckProjection = m_frameInfo.projectionMatrix;
+  m_sortCheckKeyMode    = m_frameInfo.sortKeyMode;
+  m_sortCheckReadyAt    = m_frameIndex + m_framesInFlight;
+  m_sortCheckStep       = SORT_CHECK_WAIT;
+  m_cpuIndicesStale     = true;
+}
+
+void GaussianSplatting::compareSortOrders()
+{
+  m_sortCheckStep = SORT_CHECK_IDLE;
+
+  const uint32_t  splatCount = (uint32_t)m_splatSet.positions.size() / 3;
+  const uint32_t* readback   = static_cast<const uint32_t*>(m_alloc->map(m_sortCheckReadbackHost));
+  const uint32_t  gpuCount   = std::min(readback[0], splatCount);
+  const uint32_t* gpuIndices = readback + 1;
+
+  // the CPU order must be the one of the GPU sorted frame, the sorter does not sort again a still view
+  if(m_frameInfo.sortingMethod == SORTING_GPU_SYNC_RADIX || m_splatIndicesCurrent < 0
+     || m_cpuSortedView != m_sortCheckView || m_frameInfo.sortKeyMode != m_sortCheckKeyMode)
+  {
+    m_cpuSortCheckResult = "Camera or sorting changed during the check";
+  }
+  else
+  {
+    // the distances sorted by the GPU, computed as in dist.comp.glsl
+    std::vector<float>   distances(splatCount);
+    std::vector<uint8_t> compared(splatCount, 0);
+    START_PAR_LOOP(splatCount, splatIdx)
+    {
+      const glm::vec3 center = glm::make_vec3(&m_splatSet.positions[splatIdx * 3]);
+      distances[splatIdx] =
+          SplatSorterAsync::referenceDistance(m_sortCheckKeyMode, m_sortCheckView, m_sortCheckProjection, center);
+      // the NDC depth only gives the order of the CPU key in front of the camera
+      const bool inFront = (m_sortCheckView * glm::vec4(center, 1.0f)).z < 0.0f;
+      compared[splatIdx] = m_sortCheckKeyMode != SORT_KEY_NDC_DEPTH || inFront;
+    }
+    END_PAR_LOOP()
+
+    // the GPU only sorts the splats it does not cull, the CPU order is reduced to these splats
+    std::vector<uint32_t> gpuOrder;
+    gpuOrder.reserve(gpuCount);
+    std::vector<uint8_t> sortedOnGpu(splatCount, 0);
+    for(uint32_t i = 0; i < gpuCount; ++i)
+    {
+      const uint32_t splatIdx = gpuIndices[i];
+      if(splatIdx < splatCount && compared[splatIdx] && !sortedOnGpu[splatIdx])
+      {
+        sortedOnGpu[splatIdx] = 1;
+        gpuOrder.push_back(splatIdx);
+      }
+    }
+    std::vector<uint32_t> cpuOrder;
+    cpuOrder.reserve(gpuOrder.size());
+    const uint32_t* cpuIndices = m_splatIndicesHostMapped[m_splatIndicesCurrent];
+    for(uint32_t i = 0; i < splatCount; ++i)
+    {
+      if(sortedOnGpu[cpuIndices[i]])
+        cpuOrder.push_back(cpuIndices[i]);
+    }
+
+    if(cpuOrder.size() != gpuOrder.size())
+    {
+      m_cpuSortCheckResult = "CPU order is not a permutation of the splats";
+    }
+    else
+    {
+      float maxDistance = 0.0f;
+      for(const uint32_t splatIdx : gpuOrder)
+        maxDistance = std::max(maxDistance, std::abs(distances[splatIdx]));
+
+      // both orders must have the same distance at each position, splats whose distances differ
+      // by less than the float precision of the keys are tied and may come in any order
+      const float tolerance  = 1e-5f * maxDistance;
+      size_t      mismatches = 0;
+      for(size_t i = 0; i < gpuOrder.size(); ++i)
+      {
+        if(std::abs(distances[gpuOrder[i]] - distances[cpuOrder[i]]) > tolerance)
+          mismatches++;
+      }
+
+      m_cpuSortCheckResult = mismatches == 0 ? "CPU and GPU orders agree" :
+                                               std::to_string(mismatches) + " mismatches out of "
+                                                   + std::to_string(gpuOrder.size());
+    }
+  }
+  std::cout << "Sort order check: " << m_cpuSortCheckResult << std::endl;
+
+  m_alloc->unmap(m_sortCheckReadbackHost);
+  m_alloc->destroy(m_sortCheckReadbackHost);
+}
+
 void GaussianSplatting::processSortingOnGPU(VkCommandBuffer cmd, const uint32_t splatCount)
 {
   // when GPU sorting, we sort at each frame, all buffer in device memory, no copy from RAM
+  // but the list of visible chunks if they are culled on CPU
+  const int chunkCulling = chunkCullingMode();
 
-  // 1. reset the draw indirect parameters and counters, will be updated by compute shader
+  // 1. reset the draw indirect parameters and counters, will be updated by compute shaders
   {
-    const shaderio::IndirectParams drawIndexedIndirectParams;
+    shaderio::IndirectParams drawIndexedIndirectParams;
+    if(chunkCulling == CHUNK_CULLING_CPU)
+    {
+      cullChunksOnCPU(cmd, drawIndexedIndirectParams);
+    }
     vkCmdUpdateBuffer(cmd, m_indirect.buffer, 0, sizeof(shaderio::IndirectParams), (void*)&drawIndexedIndirectParams);
 
     VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
     barrier.srcAccessMask   = VK_ACCESS_TRANSFER_WRITE_BIT;
-    barrier.dstAccessMask   = VK_ACCESS_SHADER_READ_BIT;
+    barrier.dstAccessMask   = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
 
     vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
                          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_MESH_SHADER_BIT_EXT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
@@ -389,23 +845,54 @@ void GaussianSplatting::processSortingOnGPU(VkCommandBuffer cmd, const uint32_t
   barrier.srcAccessMask   = VK_ACCESS_SHADER_WRITE_BIT;
   barrier.dstAccessMask   = VK_ACCESS_SHADER_READ_BIT;
 
-  // 2. invoke the distance compute shader
+  // 2. invoke the chunk culling compute shader, first culling level
+  if(chunkCulling == CHUNK_CULLING_GPU)
+  {
+    auto timerSection = m_stageProfiler.section(cmd, "GPU Chunk culling");
+
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_chunkCullPipeline);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_dset->getPipeLayout(), 0, 1, m_dset->getSets(), 0, nullptr);
+
+    vkCmdDispatch(cmd, (splatChunkCount(splatCount) + CHUNK_COMPUTE_WORKGROUP_SIZE - 1) / CHUNK_COMPUTE_WORKGROUP_SIZE, 1, 1);
+
+    // the distance shader reads the visible chunks and is dispatched from the indirect buffer
+    VkMemoryBarrier chunkBarrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    chunkBarrier.srcAccessMask   = VK_ACCESS_SHADER_WRITE_BIT;
+    chunkBarrier.dstAccessMask   = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 1,
+                         &chunkBarrier, 0, NULL, 0, NULL);
+  }
+
+  // 3. invoke the distance compute shader, on the visible chunks only if chunk culling is enabled
   {
-    // auto timerSection = m_profiler->timeRecurring("GPU Dist", cmd);
+    auto timerSection = m_stageProfiler.section(cmd, "GPU Dist");
 
     vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_computePipeline);
     vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_dset->getPipeLayout(), 0, 1, m_dset->getSets(), 0, nullptr);
 
-    vkCmdDispatch(cmd, (splatCount + DISTANCE_COMPUTE_WORKGROUP_SIZE - 1) / DISTANCE_COMPUTE_WORKGROUP_SIZE, 1, 1);
+    if(chunkCulling == CHUNK_CULLING_GPU)
+    {
+      vkCmdDispatchIndirect(cmd, m_indirect.buffer, offsetof(shaderio::IndirectParams, distGroupCountX));
+    }
+    else if(chunkCulling == CHUNK_CULLING_CPU)
+    {
+      vkCmdDispatch(cmd, m_cpuVisibleChunkCount * (SPLAT_CHUNK_SIZE / DISTANCE_COMPUTE_WORKGROUP_SIZE), 1, 1);
+    }
+    else
+    {
+      vkCmdDispatch(cmd, (splatCount + DISTANCE_COMPUTE_WORKGROUP_SIZE - 1) / DISTANCE_COMPUTE_WORKGROUP_SIZE, 1, 1);
+    }
 
     vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
                          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_MESH_SHADER_BIT_EXT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
                          0, 1, &barrier, 0, NULL, 0, NULL);
   }
 
-  // 3. invoke the radix sort from vrdx lib
+  // 4. invoke the radix sort from vrdx lib
   {
-    // auto timerSection = m_profiler->timeRecurring("GPU Sort", cmd);
+    auto timerSection = m_stageProfiler.section(cmd, "GPU Sort");
 
     vrdxCmdSortKeyValueIndirect(cmd, m_gpuSorter, splatCount, m_indirect.buffer,
                                 offsetof(shaderio::IndirectParams, instanceCount), m_splatDistancesDevice.buffer, 0,
@@ -417,6 +904,106 @@ void GaussianSplatting::processSortingOnGPU(VkCommandBuffer cmd, const uint32_t
   }
 }
 
+void GaussianSplatting::cullChunksOnCPU(VkCommandBuffer cmd, shaderio::IndirectParams& params)
+{
+  auto startTime = std::chrono::high_resolution_clock::now();
+
+  // the slice of the frame is not read by the frames still in flight
+  const uint32_t chunkCount = splatChunkCount((uint32_t)m_splatSet.size());
+  const uint64_t slice      = m_frameIndex % m_framesInFlight;
+  uint32_t*      visible    = m_visibleChunksHostMapped + slice * chunkCount;
+
+  const glm::mat4 viewProj = m_frameInfo.projectionMatrix * m_frameInfo.viewMatrix;
+  m_cpuVisibleChunkCount   = cullChunks(m_chunkBounds, viewProj, m_frameInfo.frustumDilation, visible);
+
+  params.visibleChunkCount = m_cpuVisibleChunkCount;
+  params.distGroupCountX   = m_cpuVisibleChunkCount * (SPLAT_CHUNK_SIZE / DISTANCE_COMPUTE_WORKGROUP_SIZE);
+
+  if(m_cpuVisibleChunkCount)
+  {
+    // host buffer is persistently mapped and coherent, the barrier after the update of m_indirect covers this copy
+    VkBufferCopy bc{.srcOffset = slice * chunkCount * sizeof(uint32_t), .dstOffset = 0, .size = m_cpuVisibleChunkCount * sizeof(uint32_t)};
+    vkCmdCopyBuffer(cmd, m_visibleChunksHost.buffer, m_visibleChunksDevice.buffer, 1, &bc);
+  }
+
+  auto endTime    = std::chrono::high_resolution_clock::now();
+  m_chunkCullTime = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+}
+
+void GaussianSplatting::updateSplatResidency(VkCommandBuffer cmd)
+{
+  auto startTime = std::chrono::high_resolution_clock::now();
+
+  const uint32_t maxUploads = uint32_t(std::clamp(m_streamingUploadsPerFrame, 1, int(s_streamingMaxUploads)));
+  const glm::mat4 viewProj  = m_frameInfo.projectionMatrix * m_frameInfo.viewMatrix;
+
+  std::vector<SplatResidency::Upload> uploads;
+  std::vector<uint32_t>               changedChunks;
+  m_residency.update(m_chunkBounds, viewProj, m_frameInfo.cameraPosition, m_frameInfo.frustumDilation, maxUploads,
+                     uploads, changedChunks);
+
+  if(!changedChunks.empty())
+  {
+    auto timerSection = m_stageProfiler.section(cmd, "Streaming uploads");
+
+    // the slice of the frame is not read by the frames still in flight
+    const uint64_t slice       = m_frameIndex % m_framesInFlight;
+    const uint64_t sliceOffset = slice * m_streamingSliceSize;
+    uint8_t*       staging     = m_streamingStagingHostMapped + sliceOffset;
+
+    // the slots of the evicted chunks may still be read by the previous frames
+    vkCmdPipelineBarrier(cmd,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT
+                             | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_MESH_SHADER_BIT_EXT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 0, NULL);
+
+    // payloads of the uploaded chunks, one copy per chunk into the slot of each pool
+    const nvvk::Buffer* pools[SplatResidency::E_ATTRIBUTE_COUNT] = {&m_covariancesDevice, &m_colorsDevice,
+                                                                     &m_sphericalHarmonicsDevice};
+    uint64_t                  offset = 0;
+    std::vector<VkBufferCopy> copies(uploads.size());
+    for(uint32_t attribute = 0; attribute < SplatResidency::E_ATTRIBUTE_COUNT; ++attribute)
+    {
+      const uint64_t chunkBytes = m_residency.chunkBytes(SplatResidency::Attribute(attribute));
+      if(chunkBytes == 0)
+        continue;
+      for(size_t i = 0; i < uploads.size(); ++i)
+      {
+        m_residency.copyChunk(SplatResidency::Attribute(attribute), uploads[i].chunk, staging + offset);
+        copies[i] = {.srcOffset = sliceOffset + offset, .dstOffset = uploads[i].slot * chunkBytes, .size = chunkBytes};
+        offset += chunkBytes;
+      }
+      if(!copies.empty())
+        vkCmdCopyBuffer(cmd, m_streamingStagingHost.buffer, pools[attribute]->buffer, uint32_t(copies.size()), copies.data());
+    }
+
+    // then the new slots of the uploaded and evicted chunks
+    offset = s_streamingMaxUploads * m_residency.chunkPayloadBytes();
+    uint32_t* slots = reinterpret_cast<uint32_t*>(staging + offset);
+    copies.resize(changedChunks.size());
+    for(size_t i = 0; i < changedChunks.size(); ++i)
+    {
+      slots[i]  = m_residency.slotOf(changedChunks[i]);
+      copies[i] = {.srcOffset = sliceOffset + offset + i * sizeof(uint32_t),
+                   .dstOffset = changedChunks[i] * sizeof(uint32_t),
+                   .size      = sizeof(uint32_t)};
+    }
+    vkCmdCopyBuffer(cmd, m_streamingStagingHost.buffer, m_chunkSlotsDevice.buffer, uint32_t(copies.size()), copies.data());
+
+    // host buffer is persistently mapped and coherent, sync with end of copy to device
+    VkMemoryBarrier barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT
+                             | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_MESH_SHADER_BIT_EXT,
+                         0, 1, &barrier, 0, NULL, 0, NULL);
+  }
+
+  auto endTime    = std::chrono::high_resolution_clock::now();
+  m_streamingTime = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+}
+
 void GaussianSplatting::drawSplatPrimitives(VkCommandBuffer cmd, const uint32_t splatCount)
 {
   if(m_selectedPipeline == PIPELINE_VERT)
@@ -463,9 +1050,226 @@ void GaussianSplatting::drawSplatPrimitives(VkCommandBuffer cmd, const uint32_t
   }
 }
 
+void GaussianSplatting::rasterizeSplatTiles(VkCommandBuffer cmd, const uint32_t splatCount)
+{
+  const VkExtent2D size       = m_gBuffers->getSize();
+  const uint32_t   tileCountX = (size.width + TILE_SIZE - 1) / TILE_SIZE;
+  const uint32_t   tileCountY = (size.height + TILE_SIZE - 1) / TILE_SIZE;
+  const bool       hasTiles   = splatCount && m_tileKeysDevice.buffer != VK_NULL_HANDLE;
+
+  // 1. clear the image the tiles are blended over, reset the tile counters, the counts of the culled splats
+  //    and the ranges of the empty tiles
+  {
+    // the sorted indices and the indirect buffer (GPU or CPU sorting), and the previous uses of the image
+    VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    barrier.srcAccessMask   = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask   = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0, 1, &barrier, 0, NULL, 0, NULL);
+
+    const VkImageSubresourceRange range{VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    vkCmdClearColorImage(cmd, m_gBuffers->getColorImage(), VK_IMAGE_LAYOUT_GENERAL, &m_clearColor, 1, &range);
+
+    if(hasTiles)
+    {
+      const shaderio::IndirectParams params;
+      const VkDeviceSize             offset = offsetof(shaderio::IndirectParams, tileEntryCount);
+      vkCmdUpdateBuffer(cmd, m_indirect.buffer, offset, sizeof(shaderio::IndirectParams) - offset,
+                        reinterpret_cast<const uint8_t*>(&params) + offset);
+      vkCmdFillBuffer(cmd, m_tileRangesDevice.buffer, 0, VK_WHOLE_SIZE, 0);
+      vkCmdFillBuffer(cmd, m_tileCountsDevice.buffer, 0, VK_WHOLE_SIZE, 0);
+    }
+
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0,
+                         NULL, 0, NULL);
+  }
+
+  VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+  barrier.srcAccessMask   = VK_ACCESS_SHADER_WRITE_BIT;
+  barrier.dstAccessMask   = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+
+  if(hasTiles)
+  {
+    // 2. project the sorted splats and count the tiles they overlap, scan the counts
+    //    and emit one entry per overlapped tile, in the order of the sorted splats
+    {
+      auto timerSection = m_stageProfiler.section(cmd, "Tile keys");
+
+      auto dispatchPass = [&](VkPipeline pipeline, uint32_t groupCount) {
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+        vkCmdDispatch(cmd, groupCount, 1, 1);
+
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 1,
+                             &barrier, 0, NULL, 0, NULL);
+      };
+
+      const uint32_t splatGroupCount = (splatCount + TILE_KEYS_WORKGROUP_SIZE - 1) / TILE_KEYS_WORKGROUP_SIZE;
+      const uint32_t blockCount      = (splatCount + TILE_SCAN_BLOCK_SIZE - 1) / TILE_SCAN_BLOCK_SIZE;
+
+      vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_dset->getPipeLayout(), 0, 1, m_dset->getSets(), 0, nullptr);
+      dispatchPass(m_tileKeysPipeline, splatGroupCount);
+      dispatchPass(m_tileScanBlocksPipeline, blockCount);
+      dispatchPass(m_tileScanSumsPipeline, 1);
+      dispatchPass(m_tileEmitPipeline, splatGroupCount);
+    }
+
+    // 3. sort the entries by tile with the radix sort from vrdx lib, a stable LSD
+    //    sort, so the entries of each tile keep the order of the sorted splats
+    {
+      auto timerSection = m_stageProfiler.section(cmd, "Tile sort");
+
+      vrdxCmdSortKeyValueIndirect(cmd, m_gpuSorter, m_tileEntryCapacity, m_indirect.buffer,
+                                  offsetof(shaderio::IndirectParams, tileSortCount), m_tileKeysDevice.buffer, 0,
+                                  m_tileValuesDevice.buffer, 0, m_vrdxTileStorageDevice.buffer, 0, 0, 0);
+
+      vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                           VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 1, &barrier,
+                           0, NULL, 0, NULL);
+    }
+
+    // 4. find the entries of each tile
+    {
+      auto timerSection = m_stageProfiler.section(cmd, "Tile ranges");
+
+      vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_tileRangesPipeline);
+      vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_dset->getPipeLayout(), 0, 1, m_dset->getSets(), 0, nullptr);
+      vkCmdDispatchIndirect(cmd, m_indirect.buffer, offsetof(shaderio::IndirectParams, tileRangesGroupCountX));
+
+      vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1,
+                           &barrier, 0, NULL, 0, NULL);
+    }
+  }
+
+  // 5. blend the tiles front to back
+  {
+    auto timerSection = m_stageProfiler.section(cmd, "Rendering");
+
+    if(hasTiles)
+    {
+      vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_tileBlendPipeline);
+      vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_dset->getPipeLayout(), 0, 1, m_dset->getSets(), 0, nullptr);
+      vkCmdDispatch(cmd, tileCountX, tileCountY, 1);
+    }
+
+    // the image is then displayed, copied for the screenshots and the PSNR measures
+    VkMemoryBarrier imageBarrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    imageBarrier.srcAccessMask   = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    imageBarrier.dstAccessMask   = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &imageBarrier, 0,
+                         NULL, 0, NULL);
+  }
+}
+
+void GaussianSplatting::updateTileBuffers(const uint32_t splatCount)
+{
+  const VkExtent2D size      = m_gBuffers->getSize();
+  const uint32_t   tileCount = ((size.width + TILE_SIZE - 1) / TILE_SIZE) * ((size.height + TILE_SIZE - 1) / TILE_SIZE);
+
+  // the entries of a previous frame overflowed, grows with some margin for the next views
+  uint64_t entryCount = std::max<uint64_t>(m_tileEntryCapacity, uint64_t(splatCount) * TILE_ENTRIES_PER_SPLAT);
+  if(m_canCollectReadback && m_indirectReadback.tileEntryCount > m_tileEntryCapacity)
+    entryCount = std::max(entryCount, uint64_t(m_indirectReadback.tileEntryCount) * 5 / 4);
+  entryCount = std::min(entryCount, uint64_t(1) << 30);
+
+  const bool fits = m_tileKeysDevice.buffer != VK_NULL_HANDLE && entryCount <= m_tileEntryCapacity
+                    && tileCount <= m_tileRangesCapacity && splatCount <= m_tileSplatsCapacity;
+  if(fits && !m_tileDescriptorsDirty)
+    return;
+
+  // the descriptor set and the buffers may be used by the frames in flight
+  vkDeviceWaitIdle(m_device);
+
+  if(!fits)
+  {
+    deinitTileBuffers();
+
+    m_tileSplatsCapacity = splatCount;
+    m_tileEntryCapacity  = uint32_t(entryCount);
+    m_tileRangesCapacity = tileCount;
+
+    const VkBufferUsageFlags usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT
+                                     | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+    m_tileSplatsDevice = m_alloc->createBuffer(uint64_t(m_tileSplatsCapacity) * sizeof(shaderio::TileSplat), usage,
+                                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    const uint32_t blockCount = (m_tileSplatsCapacity + TILE_SCAN_BLOCK_SIZE - 1) / TILE_SCAN_BLOCK_SIZE;
+    m_tileCountsDevice = m_alloc->createBuffer(uint64_t(m_tileSplatsCapacity) * sizeof(uint32_t), usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    m_tileOffsetsDevice = m_alloc->createBuffer(uint64_t(m_tileSplatsCapacity) * sizeof(uint32_t), usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    m_tileBlockSumsDevice = m_alloc->createBuffer(uint64_t(blockCount) * sizeof(uint32_t), usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    m_tileKeysDevice = m_alloc->createBuffer(uint64_t(m_tileEntryCapacity) * sizeof(uint32_t), usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    m_tileValuesDevice = m_alloc->createBuffer(uint64_t(m_tileEntryCapacity) * sizeof(uint32_t), usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    m_tileRangesDevice = m_alloc->createBuffer(uint64_t(m_tileRangesCapacity) * 2 * sizeof(uint32_t), usage,
+                                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    VrdxSorterStorageRequirements requirements;
+    vrdxGetSorterKeyValueStorageRequirements(m_gpuSorter, m_tileEntryCapacity, &requirements);
+    m_vrdxTileStorageDevice = m_alloc->createBuffer(requirements.size, requirements.usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    m_dutil->DBG_NAME(m_tileSplatsDevice.buffer);
+    m_dutil->DBG_NAME(m_tileCountsDevice.buffer);
+    m_dutil->DBG_NAME(m_tileOffsetsDevice.buffer);
+    m_dutil->DBG_NAME(m_tileBlockSumsDevice.buffer);
+    m_dutil->DBG_NAME(m_tileKeysDevice.buffer);
+    m_dutil->DBG_NAME(m_tileValuesDevice.buffer);
+    m_dutil->DBG_NAME(m_tileRangesDevice.buffer);
+    m_dutil->DBG_NAME(m_vrdxTileStorageDevice.buffer);
+
+    m_renderMemoryStats.allocTiles = uint64_t(m_tileSplatsCapacity) * (sizeof(shaderio::TileSplat) + 2 * sizeof(uint32_t))
+                                     + uint64_t(blockCount) * sizeof(uint32_t)
+                                     + uint64_t(m_tileEntryCapacity) * 2 * sizeof(uint32_t)
+                                     + uint64_t(m_tileRangesCapacity) * 2 * sizeof(uint32_t) + requirements.size;
+
+    std::cout << "Compute pipeline buffers allocated for " << m_tileEntryCapacity << " tile entries" << std::endl;
+  }
+
+  const VkDescriptorBufferInfo tileSplats_desc{m_tileSplatsDevice.buffer, 0, VK_WHOLE_SIZE};
+  const VkDescriptorBufferInfo tileCounts_desc{m_tileCountsDevice.buffer, 0, VK_WHOLE_SIZE};
+  const VkDescriptorBufferInfo tileOffsets_desc{m_tileOffsetsDevice.buffer, 0, VK_WHOLE_SIZE};
+  const VkDescriptorBufferInfo tileBlockSums_desc{m_tileBlockSumsDevice.buffer, 0, VK_WHOLE_SIZE};
+  const VkDescriptorBufferInfo tileKeys_desc{m_tileKeysDevice.buffer, 0, VK_WHOLE_SIZE};
+  const VkDescriptorBufferInfo tileValues_desc{m_tileValuesDevice.buffer, 0, VK_WHOLE_SIZE};
+  const VkDescriptorBufferInfo tileRanges_desc{m_tileRangesDevice.buffer, 0, VK_WHOLE_SIZE};
+  const VkDescriptorImageInfo  outputImage_desc = m_gBuffers->getDescriptorImageInfo();
+
+  std::vector<VkWriteDescriptorSet> writes;
+  writes.emplace_back(m_dset->makeWrite(0, BINDING_TILE_SPLATS_BUFFER, &tileSplats_desc));
+  writes.emplace_back(m_dset->makeWrite(0, BINDING_TILE_COUNTS_BUFFER, &tileCounts_desc));
+  writes.emplace_back(m_dset->makeWrite(0, BINDING_TILE_OFFSETS_BUFFER, &tileOffsets_desc));
+  writes.emplace_back(m_dset->makeWrite(0, BINDING_TILE_BLOCK_SUMS_BUFFER, &tileBlockSums_desc));
+  writes.emplace_back(m_dset->makeWrite(0, BINDING_TILE_KEYS_BUFFER, &tileKeys_desc));
+  writes.emplace_back(m_dset->makeWrite(0, BINDING_TILE_VALUES_BUFFER, &tileValues_desc));
+  writes.emplace_back(m_dset->makeWrite(0, BINDING_TILE_RANGES_BUFFER, &tileRanges_desc));
+  writes.emplace_back(m_dset->makeWrite(0, BINDING_TILE_OUTPUT_IMAGE, &outputImage_desc));
+  vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+  m_tileDescriptorsDirty = false;
+}
+
+void GaussianSplatting::deinitTileBuffers()
+{
+  m_alloc->destroy(m_tileSplatsDevice);
+  m_alloc->destroy(m_tileCountsDevice);
+  m_alloc->destroy(m_tileOffsetsDevice);
+  m_alloc->destroy(m_tileBlockSumsDevice);
+  m_alloc->destroy(m_tileKeysDevice);
+  m_alloc->destroy(m_tileValuesDevice);
+  m_alloc->destroy(m_tileRangesDevice);
+  m_alloc->destroy(m_vrdxTileStorageDevice);
+  m_tileSplatsCapacity = m_tileEntryCapacity = m_tileRangesCapacity = 0;
+  // the descriptors would reference the destroyed buffers
+  m_tileDescriptorsDirty         = true;
+  m_renderMemoryStats.allocTiles = 0;
+  // a readback of an earlier scene would not apply to the next buffers
+  m_indirectReadback.tileEntryCount = 0;
+}
+
 void GaussianSplatting::collectReadBackValuesIfNeeded(void)
 {
-  if(m_indirectReadbackHost.buffer != VK_NULL_HANDLE && m_frameInfo.sortingMethod == SORTING_GPU_SYNC_RADIX && m_canCollectReadback)
+  if(m_indirectReadbackHost.buffer != VK_NULL_HANDLE
+     && (m_frameInfo.sortingMethod == SORTING_GPU_SYNC_RADIX || m_selectedPipeline == PIPELINE_COMPUTE) && m_canCollectReadback)
   {
     uint32_t* hostBuffer = static_cast<uint32_t*>(m_alloc->map(m_indirectReadbackHost));
     std::memcpy((void*)&m_indirectReadback, (void*)hostBuffer, sizeof(shaderio::IndirectParams));
@@ -475,9 +1279,11 @@ void GaussianSplatting::collectReadBackValuesIfNeeded(void)
 
 void GaussianSplatting::readBackIndirectParametersIfNeeded(VkCommandBuffer cmd)
 {
-  if(m_indirectReadbackHost.buffer != VK_NULL_HANDLE && m_frameInfo.sortingMethod == SORTING_GPU_SYNC_RADIX)
+  // the compute pipeline needs the tile entry count whatever the sorting
+  if(m_indirectReadbackHost.buffer != VK_NULL_HANDLE
+     && (m_frameInfo.sortingMethod == SORTING_GPU_SYNC_RADIX || m_selectedPipeline == PIPELINE_COMPUTE))
   {
-    // auto timerSection = m_profiler->timeRecurring("Indirect readback", cmd);
+    auto timerSection = m_stageProfiler.section(cmd, "Indirect readback");
 
     // ensures m_indirect buffer modified by GPU sort is available for transfer
     VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
@@ -495,12 +1301,117 @@ void GaussianSplatting::readBackIndirectParametersIfNeeded(VkCommandBuffer cmd)
   }
 }
 
+void GaussianSplatting::startPsnrMeasure(PsnrMeasure measure)
+{
+  if(m_psnrStep != PSNR_IDLE)
+    return;
+  m_psnrMeasure = measure;
+  m_psnrStep    = PSNR_REFERENCE;
+  if(measure == PSNR_MEASURE_PIPELINE)
+  {
+    // compared with the raster pipeline in use, the vertex one if the compute pipeline is in use
+    m_psnrUserPipeline      = m_selectedPipeline;
+    m_psnrReferencePipeline = m_selectedPipeline == PIPELINE_MESH ? PIPELINE_MESH : PIPELINE_VERT;
+    // a measure that does not complete fails --checkcompute
+    m_pipelinePsnrPassed = false;
+  }
+}
+
+void GaussianSplatting::applyPsnrMeasurePipeline()
+{
+  if(m_psnrMeasure != PSNR_MEASURE_PIPELINE)
+    return;
+  if(m_psnrStep == PSNR_REFERENCE)
+    m_selectedPipeline = m_psnrReferencePipeline;
+  else if(m_psnrStep == PSNR_TEST)
+    m_selectedPipeline = PIPELINE_COMPUTE;
+}
+
+void GaussianSplatting::processPsnrMeasure(VkCommandBuffer cmd)
+{
+  if(m_psnrStep == PSNR_IDLE)
+    return;
+
+  const VkExtent2D size       = m_gBuffers->getSize();
+  const uint64_t   pixelCount = uint64_t(size.width) * size.height;
+
+  if(m_psnrStep == PSNR_REFERENCE || m_psnrStep == PSNR_TEST)
+  {
+    // copy the color image of this frame, R8G8B8A8 left in general layout by the rendering
+    const int target     = m_psnrStep == PSNR_REFERENCE ? 0 : 1;
+    m_psnrImages[target] = m_alloc->createBuffer(pixelCount * 4, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    m_dutil->DBG_NAME(m_psnrImages[target].buffer);
+
+    // written by the raster pipelines or by the compute one
+    VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    barrier.srcAccessMask   = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask   = VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, NULL, 0, NULL);
+
+    VkBufferImageCopy region{};
+    region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    region.imageExtent      = {size.width, size.height, 1};
+    vkCmdCopyImageToBuffer(cmd, m_gBuffers->getColorImage(), VK_IMAGE_LAYOUT_GENERAL, m_psnrImages[target].buffer, 1, &region);
+
+    m_psnrStep    = target == 0 ? PSNR_TEST : PSNR_WAIT;
+    m_psnrReadyAt = m_frameIndex + m_framesInFlight;
+    // the next frames are rendered with the pipeline of the user again
+    if(m_psnrStep == PSNR_WAIT && m_psnrMeasure == PSNR_MEASURE_PIPELINE)
+      m_selectedPipeline = m_psnrUserPipeline;
+    return;
+  }
+
+  // PSNR_WAIT, the frames that copied the images are completed
+  if(m_frameIndex < m_psnrReadyAt)
+    return;
+
+  const uint8_t* reference = static_cast<const uint8_t*>(m_alloc->map(m_psnrImages[0]));
+  const uint8_t* image     = static_cast<const uint8_t*>(m_alloc->map(m_psnrImages[1]));
+  const double   psnr      = computeMaskedPsnr(reference, image, pixelCount);
+  m_alloc->unmap(m_psnrImages[0]);
+  m_alloc->unmap(m_psnrImages[1]);
+  m_alloc->destroy(m_psnrImages[0]);
+  m_alloc->destroy(m_psnrImages[1]);
+  m_psnrStep = PSNR_IDLE;
+
+  if(m_psnrMeasure == PSNR_MEASURE_PIPELINE)
+  {
+    // a negative PSNR stands for identical images
+    m_pipelinePsnrPassed = psnr < 0.0 || psnr >= s_pipelinePsnrThreshold;
+    m_pipelinePsnrResult = (psnr < 0.0 ? std::string("identical") : nvh::stringFormat("%.2f dB", psnr))
+                           + nvh::stringFormat(" against %s, %s (threshold %.0f dB)",
+                                               m_psnrReferencePipeline == PIPELINE_MESH ? "mesh" : "vert",
+                                               m_pipelinePsnrPassed ? "passed" : "FAILED", s_pipelinePsnrThreshold);
+    (m_pipelinePsnrPassed ? std::cout : std::cerr) << "Compute pipeline PSNR: " << m_pipelinePsnrResult << std::endl;
+    return;
+  }
+
+  // size of the cut, frustum culling not included
+  const uint32_t selected = countLodSelection(m_splatSet, m_frameInfo.cameraPosition, std::abs(m_frameInfo.focal.x),
+                                              m_frameInfo.lodThreshold);
+  m_lodPsnrResult = (psnr < 0.0 ? std::string("identical to full detail") : nvh::stringFormat("%.2f dB", psnr))
+                    + nvh::stringFormat(", %u nodes for %u leaves", selected, m_splatSet.lodLeafCount);
+  std::cout << "Level of detail PSNR at threshold " << m_frameInfo.lodThreshold << " pixels: " << m_lodPsnrResult << std::endl;
+}
+
+void GaussianSplatting::cancelPsnrMeasure()
+{
+  for(auto& buffer : m_psnrImages)
+    m_alloc->destroy(buffer);
+  // a pipeline measure interrupted before its test frame copy
+  if(m_psnrMeasure == PSNR_MEASURE_PIPELINE && (m_psnrStep == PSNR_REFERENCE || m_psnrStep == PSNR_TEST))
+    m_selectedPipeline = m_psnrUserPipeline;
+  m_psnrStep = PSNR_IDLE;
+}
+
 void GaussianSplatting::updateRenderingMemoryStatistics(VkCommandBuffer cmd, const uint32_t splatCount)
 {
   // update rendering memory statistics
   if(m_frameInfo.sortingMethod != SORTING_GPU_SYNC_RADIX)
   {
-    m_renderMemoryStats.hostAllocIndices   = splatCount * sizeof(uint32_t);
+    m_renderMemoryStats.hostAllocIndices   = 2 * uint64_t(splatCount) * sizeof(uint32_t);  // double buffered
     m_renderMemoryStats.hostAllocDistances = splatCount * sizeof(uint32_t);
     m_renderMemoryStats.allocIndices       = splatCount * sizeof(uint32_t);
     m_renderMemoryStats.usedIndices        = splatCount * sizeof(uint32_t);
@@ -513,9 +1424,9 @@ void GaussianSplatting::updateRenderingMemoryStatistics(VkCommandBuffer cmd, con
     m_renderMemoryStats.hostAllocDistances = 0;
     m_renderMemoryStats.hostAllocIndices   = 0;
     m_renderMemoryStats.allocDistances     = splatCount * sizeof(uint32_t);
-    m_renderMemoryStats.usedDistances      = m_indirectReadback.instanceCount * sizeof(uint32_t);
+    m_renderMemoryStats.usedDistances      = uint64_t(m_indirectReadback.instanceCount) * sizeof(uint32_t);
     m_renderMemoryStats.allocIndices       = splatCount * sizeof(uint32_t);
-    m_renderMemoryStats.usedIndices        = m_indirectReadback.instanceCount * sizeof(uint32_t);
+    m_renderMemoryStats.usedIndices        = uint64_t(m_indirectReadback.instanceCount) * sizeof(uint32_t);
     if(m_selectedPipeline == PIPELINE_VERT)
     {
       m_renderMemoryStats.usedIndirect = 5 * sizeof(uint32_t);
@@ -527,22 +1438,39 @@ void GaussianSplatting::updateRenderingMemoryStatistics(VkCommandBuffer cmd, con
   }
   m_renderMemoryStats.usedUboFrameInfo = sizeof(shaderio::FrameInfo);
 
-  m_renderMemoryStats.hostTotal =
-      m_renderMemoryStats.hostAllocIndices + m_renderMemoryStats.hostAllocDistances + m_renderMemoryStats.usedUboFrameInfo;
+  // chunk bounds and visible chunks list, used only by the GPU sort with chunk culling
+  if(m_frameInfo.sortingMethod == SORTING_GPU_SYNC_RADIX && chunkCullingMode() != CHUNK_CULLING_NONE)
+  {
+    m_renderMemoryStats.usedChunks = uint64_t(splatChunkCount(splatCount)) * CHUNK_BOUNDS_FLOATS * sizeof(float)
+                                     + uint64_t(m_indirectReadback.visibleChunkCount) * sizeof(uint32_t);
+  }
+  else
+  {
+    m_renderMemoryStats.usedChunks = 0;
+  }
+
+  m_renderMemoryStats.hostTotal = m_renderMemoryStats.hostAllocIndices + m_renderMemoryStats.hostAllocDistances
+                                  + m_renderMemoryStats.hostAllocChunks + m_renderMemoryStats.hostAllocStaging
+                                  + m_renderMemoryStats.hostAllocUpload + m_renderMemoryStats.usedUboFrameInfo;
 
-  uint32_t vrdxSize = m_frameInfo.sortingMethod != SORTING_GPU_SYNC_RADIX ? 0 : m_renderMemoryStats.allocVdrxInternal;
+  uint64_t vrdxSize = m_frameInfo.sortingMethod != SORTING_GPU_SYNC_RADIX ? 0 : m_renderMemoryStats.allocVdrxInternal;
 
   m_renderMemoryStats.deviceUsedTotal = m_renderMemoryStats.usedIndices + m_renderMemoryStats.usedDistances + vrdxSize
-                                        + m_renderMemoryStats.usedIndirect + m_renderMemoryStats.usedUboFrameInfo;
+                                        + m_renderMemoryStats.usedIndirect + m_renderMemoryStats.usedUboFrameInfo
+                                        + m_renderMemoryStats.usedChunks + m_renderMemoryStats.allocLod
+                                        + m_renderMemoryStats.allocChunkSlots + m_renderMemoryStats.allocTiles;
 
   m_renderMemoryStats.deviceAllocTotal = m_renderMemoryStats.allocIndices + m_renderMemoryStats.allocDistances + vrdxSize
-                                         + m_renderMemoryStats.usedIndirect + m_renderMemoryStats.usedUboFrameInfo;
+                                         + m_renderMemoryStats.usedIndirect + m_renderMemoryStats.usedUboFrameInfo
+                                         + m_renderMemoryStats.allocChunks + m_renderMemoryStats.allocLod
+                                         + m_renderMemoryStats.allocChunkSlots + m_renderMemoryStats.allocTiles;
 }
 
 void GaussianSplatting::deinitAll()
 {
   m_canCollectReadback = false;
   vkDeviceWaitIdle(m_device);
+  cancelPsnrMeasure();
   deinitScene();
   deinitDataTextures();
   deinitDataBuffers();
@@ -562,8 +1490,16 @@ void GaussianSplatting::deinitAll()
 
 void GaussianSplatting::initAll()
 {
-  // resize the CPU sorter indices buffer
-  m_splatIndices.resize(m_splatIndices.size());
+  // the CPU sorter shall rebuild its copy of the centers
+  m_cpuSorter.positionsChanged();
+  // bounds of the chunks of splats for the two level frustum culling
+  {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    m_chunkBounds  = computeChunkBounds(m_splatSet.positions);
+    auto      endTime   = std::chrono::high_resolution_clock::now();
+    long long buildTime = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
+    std::cout << "Chunk bounds computed in " << buildTime << "ms" << std::endl;
+  }
   // TODO: use BBox of point cloud to set far plane, eye and center
   CameraManip.setClipPlanes({0.1F, 2000.0F});
   // we know that most INRIA models are upside down so we set the up vector to 0,-1,0
@@ -626,7 +1562,10 @@ void GaussianSplatting::reinitShaders()
 void GaussianSplatting::deinitScene()
 {
   m_splatSet            = {};
+  m_chunkBounds         = {};
   m_loadedSceneFilename = "";
+  m_shCodebookKey       = {};
+  m_shCodebook          = {};
   m_gltfSceneVk->destroy();
   m_gltfScene->destroy();
 }
@@ -643,19 +1582,42 @@ bool GaussianSplatting::initShaders(void)
   if(m_defines.opacityGaussianDisabled)
     prepends += "#define DISABLE_OPACITY_GAUSSIAN\n";
   prepends += nvh::stringFormat("#define FRUSTUM_CULLING_MODE %d\n", m_defines.frustumCulling);
+  prepends += nvh::stringFormat("#define CHUNK_CULLING_MODE %d\n", chunkCullingMode());
+  prepends += nvh::stringFormat("#define LOD_ENABLED %d\n", int(m_splatSet.lodLeafCount != 0));
+  prepends += nvh::stringFormat("#define STREAMING_ENABLED %d\n", int(streamingEnabled()));
   prepends += "#define ORTHOGRAPHIC_MODE 0\n";  // Disabled, TODO do we enable ortho cam in the UI/camera controller
   prepends += nvh::stringFormat("#define SHOW_SH_ONLY %d\n", m_defines.showShOnly);
   prepends += nvh::stringFormat("#define MAX_SH_DEGREE %d\n", m_defines.maxShDegree);
   prepends += nvh::stringFormat("#define DATA_STORAGE %d\n", m_defines.dataStorage);
   prepends += nvh::stringFormat("#define SH_FORMAT %d\n", m_defines.shFormat);
+  prepends += nvh::stringFormat("#define CENTERS_FORMAT %d\n", m_defines.centersFormat);
+  prepends += nvh::stringFormat("#define COVARIANCES_FORMAT %d\n", m_defines.covariancesFormat);
+  prepends += nvh::stringFormat("#define COLORS_FORMAT %d\n", colorsBufferFormat());
   prepends += nvh::stringFormat("#define POINT_CLOUD_MODE %d\n", m_defines.pointCloudModeEnabled);
   prepends += nvh::stringFormat("#define USE_BARYCENTRIC %d\n", m_defines.fragmentBarycentric);
 
-  // generate the 3dgs shader modules
-  m_shaders.distShader   = m_shaderManager.createShaderModule(VK_SHADER_STAGE_COMPUTE_BIT, "dist.comp.glsl", prepends);
-  m_shaders.vertexShader = m_shaderManager.createShaderModule(VK_SHADER_STAGE_VERTEX_BIT, "raster.vert.glsl", prepends);
-  m_shaders.meshShader = m_shaderManager.createShaderModule(VK_SHADER_STAGE_MESH_BIT_EXT, "raster.mesh.glsl", prepends);
-  m_shaders.fragmentShader = m_shaderManager.createShaderModule(VK_SHADER_STAGE_FRAGMENT_BIT, "raster.frag.glsl", prepends);
+  // generate the 3dgs shader modules, from the SPIR-V variant cache when this permutation was already compiled
+  // keep the defines above in sync with build_shader_variants.py for the offline build to be used
+  m_shaderVariantCache.refreshSources();
+  m_shaderVariantCache.resetStats();
+  auto createShader = [&](VkShaderStageFlagBits stage, const char* filename, const char* passDefine = "") {
+    return m_shaderVariantCache.createShaderModule(m_shaderManager, stage, filename, prepends + passDefine);
+  };
+  m_shaders.distShader     = createShader(VK_SHADER_STAGE_COMPUTE_BIT, "dist.comp.glsl");
+  m_shaders.chunkShader    = createShader(VK_SHADER_STAGE_COMPUTE_BIT, "chunks.comp.glsl");
+  m_shaders.vertexShader   = createShader(VK_SHADER_STAGE_VERTEX_BIT, "raster.vert.glsl");
+  m_shaders.meshShader     = createShader(VK_SHADER_STAGE_MESH_BIT_EXT, "raster.mesh.glsl");
+  m_shaders.fragmentShader = createShader(VK_SHADER_STAGE_FRAGMENT_BIT, "raster.frag.glsl");
+  m_shaders.tileKeysShader =
+      createShader(VK_SHADER_STAGE_COMPUTE_BIT, "tile_keys.comp.glsl", "#define TILE_KEYS_PASS 0\n");
+  m_shaders.tileEmitShader =
+      createShader(VK_SHADER_STAGE_COMPUTE_BIT, "tile_keys.comp.glsl", "#define TILE_KEYS_PASS 1\n");
+  m_shaders.tileScanBlocksShader =
+      createShader(VK_SHADER_STAGE_COMPUTE_BIT, "tile_scan.comp.glsl", "#define TILE_SCAN_PASS 0\n");
+  m_shaders.tileScanSumsShader =
+      createShader(VK_SHADER_STAGE_COMPUTE_BIT, "tile_scan.comp.glsl", "#define TILE_SCAN_PASS 1\n");
+  m_shaders.tileRangesShader = createShader(VK_SHADER_STAGE_COMPUTE_BIT, "tile_ranges.comp.glsl");
+  m_shaders.tileBlendShader  = createShader(VK_SHADER_STAGE_COMPUTE_BIT, "tile_blend.comp.glsl");
 
   // generate the pbr shader modules
   m_shaders.pbrVertexShader = m_shaderManager.createShaderModule(VK_SHADER_STAGE_VERTEX_BIT, "pbr.vert.glsl", "");
@@ -668,7 +1630,10 @@ bool GaussianSplatting::initShaders(void)
   }
   auto      endTime   = std::chrono::high_resolution_clock::now();
   long long buildTime = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
-  std::cout << "Shaders updated in " << buildTime << "ms" << std::endl;
+  std::cout << "Shaders updated in " << buildTime << "ms";
+  if(m_shaderVariantCache.isEnabled())
+    std::cout << ", " << m_shaderVariantCache.hits() << " from the SPIR-V cache, " << m_shaderVariantCache.fills() << " added to it";
+  std::cout << std::endl;
 
   return true;
 }
@@ -691,6 +1656,9 @@ void GaussianSplatting::initPipelines()
   m_dset->addBinding(BINDING_DISTANCES_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL);
   m_dset->addBinding(BINDING_INDICES_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL);
   m_dset->addBinding(BINDING_INDIRECT_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL);
+  m_dset->addBinding(BINDING_CHUNK_BOUNDS_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL);
+  m_dset->addBinding(BINDING_VISIBLE_CHUNKS_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL);
+  m_dset->addBinding(BINDING_LOD_NODES_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL);
   if(m_defines.dataStorage == STORAGE_TEXTURES)
   {
     m_dset->addBinding(BINDING_SH_TEXTURE, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_ALL);
@@ -705,6 +1673,27 @@ void GaussianSplatting::initPipelines()
     m_dset->addBinding(BINDING_COVARIANCES_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL);
     m_dset->addBinding(BINDING_SH_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL);
   }
+  if(m_defines.shFormat == FORMAT_VQ)
+  {
+    m_dset->addBinding(BINDING_SH_CODEBOOK_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL);
+  }
+  if(m_defines.centersFormat == FORMAT_UNORM16)
+  {
+    m_dset->addBinding(BINDING_CENTERS_BOUNDS_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL);
+  }
+  if(streamingEnabled())
+  {
+    m_dset->addBinding(BINDING_CHUNK_SLOTS_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL);
+  }
+  // compute pipeline, written by updateTileBuffers once the pipeline is used
+  m_dset->addBinding(BINDING_TILE_SPLATS_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL);
+  m_dset->addBinding(BINDING_TILE_KEYS_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL);
+  m_dset->addBinding(BINDING_TILE_VALUES_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL);
+  m_dset->addBinding(BINDING_TILE_RANGES_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL);
+  m_dset->addBinding(BINDING_TILE_OUTPUT_IMAGE, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_ALL);
+  m_dset->addBinding(BINDING_TILE_COUNTS_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL);
+  m_dset->addBinding(BINDING_TILE_OFFSETS_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL);
+  m_dset->addBinding(BINDING_TILE_BLOCK_SUMS_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL);
 
   // bindinbgs for PBR
   m_dset_pbr->setBindings(empty);
@@ -731,6 +1720,12 @@ void GaussianSplatting::initPipelines()
   writes.emplace_back(m_dset->makeWrite(0, BINDING_INDICES_BUFFER, &cpuKeys_desc));
   const VkDescriptorBufferInfo indirect_desc{m_indirect.buffer, 0, VK_WHOLE_SIZE};
   writes.emplace_back(m_dset->makeWrite(0, BINDING_INDIRECT_BUFFER, &indirect_desc));
+  const VkDescriptorBufferInfo chunkBounds_desc{m_chunkBoundsDevice.buffer, 0, VK_WHOLE_SIZE};
+  writes.emplace_back(m_dset->makeWrite(0, BINDING_CHUNK_BOUNDS_BUFFER, &chunkBounds_desc));
+  const VkDescriptorBufferInfo visibleChunks_desc{m_visibleChunksDevice.buffer, 0, VK_WHOLE_SIZE};
+  writes.emplace_back(m_dset->makeWrite(0, BINDING_VISIBLE_CHUNKS_BUFFER, &visibleChunks_desc));
+  const VkDescriptorBufferInfo lodNodes_desc{m_lodNodesDevice.buffer, 0, VK_WHOLE_SIZE};
+  writes.emplace_back(m_dset->makeWrite(0, BINDING_LOD_NODES_BUFFER, &lodNodes_desc));
 
   if(m_defines.dataStorage == STORAGE_TEXTURES)
   {
@@ -752,9 +1747,25 @@ void GaussianSplatting::initPipelines()
     const VkDescriptorBufferInfo sh_desc{m_sphericalHarmonicsDevice.buffer, 0, VK_WHOLE_SIZE};
     writes.emplace_back(m_dset->makeWrite(0, BINDING_SH_BUFFER, &sh_desc));
   }
+  const VkDescriptorBufferInfo shCodebook_desc{m_shCodebookDevice.buffer, 0, VK_WHOLE_SIZE};
+  if(m_defines.shFormat == FORMAT_VQ)
+  {
+    writes.emplace_back(m_dset->makeWrite(0, BINDING_SH_CODEBOOK_BUFFER, &shCodebook_desc));
+  }
+  const VkDescriptorBufferInfo centersBounds_desc{m_centersBoundsDevice.buffer, 0, VK_WHOLE_SIZE};
+  if(m_defines.centersFormat == FORMAT_UNORM16)
+  {
+    writes.emplace_back(m_dset->makeWrite(0, BINDING_CENTERS_BOUNDS_BUFFER, &centersBounds_desc));
+  }
+  const VkDescriptorBufferInfo chunkSlots_desc{m_chunkSlotsDevice.buffer, 0, VK_WHOLE_SIZE};
+  if(streamingEnabled())
+  {
+    writes.emplace_back(m_dset->makeWrite(0, BINDING_CHUNK_SLOTS_BUFFER, &chunkSlots_desc));
+  }
 
   // write
   vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+  m_tileDescriptorsDirty = true;
 
   // Create the pipeline to run the compute shader for distance & culling
   {
@@ -771,7 +1782,25 @@ void GaussianSplatting::initPipelines()
             },
         .layout = pipelineLayout,
     };
-    vkCreateComputePipelines(m_device, {}, 1, &pipelineInfo, nullptr, &m_computePipeline);
+    vkCreateComputePipelines(m_device, m_pipelineCache, 1, &pipelineInfo, nullptr, &m_computePipeline);
+
+    // same layout for the pipeline culling the chunks of splats
+    pipelineInfo.stage.module = m_shaderManager.get(m_shaders.chunkShader);
+    vkCreateComputePipelines(m_device, m_pipelineCache, 1, &pipelineInfo, nullptr, &m_chunkCullPipeline);
+
+    // and for the passes of the compute pipeline
+    pipelineInfo.stage.module = m_shaderManager.get(m_shaders.tileKeysShader);
+    vkCreateComputePipelines(m_device, m_pipelineCache, 1, &pipelineInfo, nullptr, &m_tileKeysPipeline);
+    pipelineInfo.stage.module = m_shaderManager.get(m_shaders.tileScanBlocksShader);
+    vkCreateComputePipelines(m_device, m_pipelineCache, 1, &pipelineInfo, nullptr, &m_tileScanBlocksPipeline);
+    pipelineInfo.stage.module = m_shaderManager.get(m_shaders.tileScanSumsShader);
+    vkCreateComputePipelines(m_device, m_pipelineCache, 1, &pipelineInfo, nullptr, &m_tileScanSumsPipeline);
+    pipelineInfo.stage.module = m_shaderManager.get(m_shaders.tileEmitShader);
+    vkCreateComputePipelines(m_device, m_pipelineCache, 1, &pipelineInfo, nullptr, &m_tileEmitPipeline);
+    pipelineInfo.stage.module = m_shaderManager.get(m_shaders.tileRangesShader);
+    vkCreateComputePipelines(m_device, m_pipelineCache, 1, &pipelineInfo, nullptr, &m_tileRangesPipeline);
+    pipelineInfo.stage.module = m_shaderManager.get(m_shaders.tileBlendShader);
+    vkCreateComputePipelines(m_device, m_pipelineCache, 1, &pipelineInfo, nullptr, &m_tileBlendPipeline);
   }
   // Create the two rasterization pipelines
   {
@@ -808,7 +1837,7 @@ void GaussianSplatting::initPipelines()
       nvvk::GraphicsPipelineGenerator pgen(m_device, m_dset->getPipeLayout(), prend_info, pstate);
       pgen.addShader(m_shaderManager.get(m_shaders.meshShader), VK_SHADER_STAGE_MESH_BIT_EXT);
       pgen.addShader(m_shaderManager.get(m_shaders.fragmentShader), VK_SHADER_STAGE_FRAGMENT_BIT);
-      m_graphicsPipelineMesh = pgen.createPipeline();
+      m_graphicsPipelineMesh = pgen.createPipeline(m_pipelineCache);
       m_dutil->setObjectName(m_graphicsPipelineMesh, "PipelineMeshShader");
     }
 
@@ -826,7 +1855,7 @@ void GaussianSplatting::initPipelines()
       nvvk::GraphicsPipelineGenerator pgen(m_device, m_dset->getPipeLayout(), prend_info, pstate);
       pgen.addShader(m_shaderManager.get(m_shaders.vertexShader), VK_SHADER_STAGE_VERTEX_BIT);
       pgen.addShader(m_shaderManager.get(m_shaders.fragmentShader), VK_SHADER_STAGE_FRAGMENT_BIT);
-      m_graphicsPipeline = pgen.createPipeline();
+      m_graphicsPipeline = pgen.createPipeline(m_pipelineCache);
       m_dutil->setObjectName(m_graphicsPipeline, "PipelineVertexShader");
     }
   }
@@ -841,6 +1870,13 @@ void GaussianSplatting::deinitPipelines()
   vkDestroyPipeline(m_device, m_graphicsPipeline, nullptr);
   vkDestroyPipeline(m_device, m_graphicsPipelineMesh, nullptr);
   vkDestroyPipeline(m_device, m_computePipeline, nullptr);
+  vkDestroyPipeline(m_device, m_chunkCullPipeline, nullptr);
+  vkDestroyPipeline(m_device, m_tileKeysPipeline, nullptr);
+  vkDestroyPipeline(m_device, m_tileScanBlocksPipeline, nullptr);
+  vkDestroyPipeline(m_device, m_tileScanSumsPipeline, nullptr);
+  vkDestroyPipeline(m_device, m_tileEmitPipeline, nullptr);
+  vkDestroyPipeline(m_device, m_tileRangesPipeline, nullptr);
+  vkDestroyPipeline(m_device, m_tileBlendPipeline, nullptr);
 }
 
 void GaussianSplatting::initRendererBuffers()
@@ -850,15 +1886,25 @@ void GaussianSplatting::initRendererBuffers()
   // All this block for the sorting
   {
     // Vrdx sorter
-    VrdxSorterCreateInfo gpuSorterInfo{.physicalDevice = m_app->getPhysicalDevice(), .device = m_app->getDevice()};
+    VrdxSorterCreateInfo gpuSorterInfo{
+        .physicalDevice = m_app->getPhysicalDevice(), .device = m_app->getDevice(), .pipelineCache = m_pipelineCache};
     vrdxCreateSorter(&gpuSorterInfo, &m_gpuSorter);
 
     {  // Create some buffer for GPU and/or CPU sorting
 
       const VkDeviceSize bufferSize = splatCount * sizeof(uint32_t);
 
-      m_splatIndicesHost = m_alloc->createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+      // host cached since the CPU sorter scatters its results in place and reads them back for coherent sorting
+      for(int i = 0; i < 2; ++i)
+      {
+        m_splatIndicesHost[i] =
+            m_alloc->createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+        m_splatIndicesHostMapped[i]  = static_cast<uint32_t*>(m_alloc->map(m_splatIndicesHost[i]));
+        m_splatIndicesHostFreeAt[i]  = 0;
+      }
+      m_splatIndicesCurrent = -1;
+      m_splatIndicesSorting = -1;
 
       m_splatIndicesDevice =
           m_alloc->createBuffer(bufferSize,
@@ -875,10 +1921,11 @@ void GaussianSplatting::initRendererBuffers()
       VrdxSorterStorageRequirements requirements;
       vrdxGetSorterKeyValueStorageRequirements(m_gpuSorter, splatCount, &requirements);
       m_vrdxStorageDevice = m_alloc->createBuffer(requirements.size, requirements.usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-      m_renderMemoryStats.allocVdrxInternal = (uint32_t)requirements.size;  // for stats reporting only
+      m_renderMemoryStats.allocVdrxInternal = requirements.size;  // for stats reporting only
 
       // generate debug information for buffers
-      m_dutil->DBG_NAME(m_splatIndicesHost.buffer);
+      m_dutil->DBG_NAME(m_splatIndicesHost[0].buffer);
+      m_dutil->DBG_NAME(m_splatIndicesHost[1].buffer);
       m_dutil->DBG_NAME(m_splatIndicesDevice.buffer);
       m_dutil->DBG_NAME(m_splatDistancesDevice.buffer);
       m_dutil->DBG_NAME(m_vrdxStorageDevice.buffer);
@@ -898,9 +1945,53 @@ void GaussianSplatting::initRendererBuffers()
   m_dutil->DBG_NAME(m_indirect.buffer);
   m_dutil->DBG_NAME(m_indirectReadbackHost.buffer);
 
+  // the list of visible chunks, on host one slice per frame in flight for CPU chunk culling
+  {
+    const VkDeviceSize chunkCount = std::max(1u, splatChunkCount(splatCount));
+
+    m_visibleChunksDevice = m_alloc->createBuffer(chunkCount * sizeof(uint32_t),
+                                                  VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    m_visibleChunksHost =
+        m_alloc->createBuffer(m_framesInFlight * chunkCount * sizeof(uint32_t), VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    m_visibleChunksHostMapped = static_cast<uint32_t*>(m_alloc->map(m_visibleChunksHost));
+
+    m_renderMemoryStats.hostAllocChunks = m_framesInFlight * chunkCount * sizeof(uint32_t);
+    m_renderMemoryStats.allocChunks     = chunkCount * (sizeof(uint32_t) + CHUNK_BOUNDS_FLOATS * sizeof(float));
+
+    m_dutil->DBG_NAME(m_visibleChunksDevice.buffer);
+    m_dutil->DBG_NAME(m_visibleChunksHost.buffer);
+  }
+
   // We create a command buffer in order to perform the copy to VRAM
   VkCommandBuffer cmd = m_app->createTempCmdBuffer();
 
+  // the bounds of the chunks, at least one entry so that the buffer is valid without scene
+  const std::vector<float> noChunkBounds(CHUNK_BOUNDS_FLOATS, 0.0f);
+  m_chunkBoundsDevice =
+      m_alloc->createBuffer(cmd, m_chunkBounds.empty() ? noChunkBounds : m_chunkBounds, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+  m_dutil->DBG_NAME(m_chunkBoundsDevice.buffer);
+
+  // the level of detail nodes, at least one entry so that the buffer is valid without hierarchy
+  {
+    std::vector<uint32_t> lodNodes(2, LOD_NO_PARENT);
+    if(m_splatSet.lodLeafCount != 0)
+    {
+      lodNodes.resize(size_t(splatCount) * 2);
+      START_PAR_LOOP(splatCount, splatIdx)
+      {
+        std::memcpy(&lodNodes[splatIdx * 2 + 0], &m_splatSet.lodRadius[splatIdx], sizeof(float));
+        lodNodes[splatIdx * 2 + 1] = m_splatSet.lodParent[splatIdx];
+      }
+      END_PAR_LOOP()
+    }
+    m_lodNodesDevice = m_alloc->createBuffer(cmd, lodNodes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    m_dutil->DBG_NAME(m_lodNodesDevice.buffer);
+
+    m_renderMemoryStats.allocLod = m_splatSet.lodLeafCount != 0 ? lodNodes.size() * sizeof(uint32_t) : 0;
+  }
+
   // The Quad
   const std::vector<uint16_t> indices  = {0, 2, 1, 2, 0, 3};
   const std::vector<float>    vertices = {-1.0, -1.0, 0.0, 1.0, -1.0, 0.0, 1.0, 1.0, 0.0, -1.0, 1.0, 0.0};
@@ -930,24 +2021,44 @@ void GaussianSplatting::deinitRendererBuffers()
 
   m_alloc->destroy(const_cast<nvvk::Buffer&>(m_splatDistancesDevice));
   m_alloc->destroy(const_cast<nvvk::Buffer&>(m_splatIndicesDevice));
-  m_alloc->destroy(const_cast<nvvk::Buffer&>(m_splatIndicesHost));
+  // the CPU sorter may still be writing in a host buffer, or about to start
+  m_cpuSorter.cancelAndWait();
+  double distTime, sortTime;
+  m_cpuSorter.consume(distTime, sortTime);
+  m_cpuSorter.positionsChanged();  // the result is dropped, forces next sort
+  for(int i = 0; i < 2; ++i)
+  {
+    if(m_splatIndicesHostMapped[i] != nullptr)
+      m_alloc->unmap(m_splatIndicesHost[i]);
+    m_splatIndicesHostMapped[i] = nullptr;
+    m_alloc->destroy(m_splatIndicesHost[i]);
+  }
+  m_splatIndicesCurrent = -1;
+  m_splatIndicesSorting = -1;
   m_alloc->destroy(const_cast<nvvk::Buffer&>(m_vrdxStorageDevice));
+  deinitTileBuffers();
 
   m_alloc->destroy(const_cast<nvvk::Buffer&>(m_indirect));
   m_alloc->destroy(const_cast<nvvk::Buffer&>(m_indirectReadbackHost));
 
+  // a sort order check still running is dropped
+  m_alloc->destroy(m_sortCheckReadbackHost);
+  m_sortCheckStep = SORT_CHECK_IDLE;
+
+  if(m_visibleChunksHostMapped != nullptr)
+    m_alloc->unmap(m_visibleChunksHost);
+  m_visibleChunksHostMapped = nullptr;
+  m_alloc->destroy(m_visibleChunksHost);
+  m_alloc->destroy(m_visibleChunksDevice);
+  m_alloc->destroy(m_chunkBoundsDevice);
+  m_alloc->destroy(m_lodNodesDevice);
+
   m_alloc->destroy(const_cast<nvvk::Buffer&>(m_quadVertices));
   m_alloc->destroy(const_cast<nvvk::Buffer&>(m_quadIndices));
 
   m_alloc->destroy(const_cast<nvvk::Buffer&>(m_frameInfoBuffer));
 }
 
-inline uint8_t toUint8(float v, float rangeMin, float rangeMax)
-{
-  float normalized = (v - rangeMin) / (rangeMax - rangeMin);
-  return static_cast<uint8_t>(std::clamp(std::round(normalized * 255.0f), 0.0f, 255.0f));
-};
-
 inline int formatSize(uint32_t format)
 {
   if(format == FORMAT_FLOAT32)
@@ -959,14 +2070,67 @@ inline int formatSize(uint32_t format)
   return 0;
 }
 
-inline void storeSh(int format, float* srcBuffer, uint32_t srcIndex, void* dstBuffer, uint32_t dstIndex)
+// covariance of a splat from its scale and rotation, upper triangle of the symmetric matrix
+inline void splatCovariance(const SplatAttributeView& srcScale, const SplatAttributeView& srcRotation, uint64_t splatIdx, float covariance[6])
 {
-  if(format == FORMAT_FLOAT32)
-    static_cast<float*>(dstBuffer)[dstIndex] = srcBuffer[srcIndex];
-  else if(format == FORMAT_FLOAT16)
-    static_cast<uint16_t*>(dstBuffer)[dstIndex] = glm::packHalf1x16(srcBuffer[srcIndex]);
-  else if(format == FORMAT_UINT8)
-    static_cast<uint8_t*>(dstBuffer)[dstIndex] = toUint8(srcBuffer[srcIndex], -1., 1.);
+  glm::vec3 scale{std::exp(srcScale.get(splatIdx, 0)), std::exp(srcScale.get(splatIdx, 1)), std::exp(srcScale.get(splatIdx, 2))};
+
+  glm::quat rotation{srcRotation.get(splatIdx, 0), srcRotation.get(splatIdx, 1), srcRotation.get(splatIdx, 2),
+                     srcRotation.get(splatIdx, 3)};
+  rotation = glm::normalize(rotation);
+
+  // computes the covariance
+  const glm::mat3 scaleMatrix           = glm::mat3(glm::scale(scale));
+  const glm::mat3 rotationMatrix        = glm::mat3_cast(rotation);  // where rotation is a quaternion
+  const glm::mat3 covarianceMatrix      = rotationMatrix * scaleMatrix;
+  glm::mat3       transformedCovariance = covarianceMatrix * glm::transpose(covarianceMatrix);
+
+  covariance[0] = glm::value_ptr(transformedCovariance)[0];
+  covariance[1] = glm::value_ptr(transformedCovariance)[3];
+  covariance[2] = glm::value_ptr(transformedCovariance)[6];
+  covariance[3] = glm::value_ptr(transformedCovariance)[4];
+  covariance[4] = glm::value_ptr(transformedCovariance)[7];
+  covariance[5] = glm::value_ptr(transformedCovariance)[8];
+}
+
+// base color of a splat, SH degree 0 is not view dependent, and its opacity
+inline void splatColor(const SplatAttributeView& srcDc, const SplatAttributeView& srcOpacity, uint64_t splatIdx, float color[4])
+{
+  const float SH_C0 = 0.28209479177387814f;
+  color[0]          = glm::clamp(0.5f + SH_C0 * srcDc.get(splatIdx, 0), 0.0f, 1.0f);
+  color[1]          = glm::clamp(0.5f + SH_C0 * srcDc.get(splatIdx, 1), 0.0f, 1.0f);
+  color[2]          = glm::clamp(0.5f + SH_C0 * srcDc.get(splatIdx, 2), 0.0f, 1.0f);
+  color[3]          = glm::clamp(1.0f / (1.0f + std::exp(-srcOpacity.get(splatIdx, 0))), 0.0f, 1.0f);
+}
+
+// writes the bytes [offset, offset + size) of a payload of splatCount splats of splatBytes bytes each,
+// the bytes past the last splat are zeroed. convert(first, count, dst) writes whole splats, the ones
+// straddling the bounds of the block (rows of data textures) are converted aside
+template <typename Convert>
+void fillSplats(uint8_t* dst, uint64_t offset, uint64_t size, uint64_t splatBytes, uint64_t splatCount, Convert&& convert)
+{
+  memset(dst, 0, size);
+
+  const uint64_t end        = offset + size;
+  const uint64_t firstWhole = std::min(splatCount, (offset + splatBytes - 1) / splatBytes);
+  const uint64_t endWhole   = std::min(splatCount, end / splatBytes);
+  if(endWhole > firstWhole)
+  {
+    convert(firstWhole, endWhole - firstWhole, dst + (firstWhole * splatBytes - offset));
+  }
+
+  std::vector<uint8_t> splat;
+  for(const uint64_t splatIdx : {offset / splatBytes, end / splatBytes})
+  {
+    const uint64_t splatBegin = splatIdx * splatBytes;
+    if(splatIdx >= splatCount || splatBegin >= end || (splatBegin >= offset && splatBegin + splatBytes <= end))
+      continue;
+    splat.assign(splatBytes, 0);
+    convert(splatIdx, 1, splat.data());
+    const uint64_t copyBegin = std::max(offset, splatBegin);
+    const uint64_t copyEnd   = std::min(end, splatBegin + splatBytes);
+    memcpy(dst + (copyBegin - offset), splat.data() + (copyBegin - splatBegin), copyEnd - copyBegin);
+  }
 }
 
 ///////////////////
@@ -977,7 +2141,6 @@ void GaussianSplatting::initDataBuffers(void)
   auto       startTime  = std::chrono::high_resolution_clock::now();
   const auto splatCount = (uint32_t)m_splatSet.positions.size() / 3;
 
-  VkCommandBuffer    cmd                  = m_app->createTempCmdBuffer();
   VkBufferUsageFlags hostBufferUsageFlags = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
   VkMemoryPropertyFlags hostMemoryPropertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
 
@@ -986,31 +2149,149 @@ void GaussianSplatting::initDataBuffers(void)
                                               | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
   VkMemoryPropertyFlags deviceMemoryPropertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 
-  // set of buffer to be freed after command execution
-  std::vector<nvvk::Buffer> buffersToDestroy;
+  m_uploader.resetStats();
+
+  // the preprocessed payloads are read from the splat cache if up to date,
+  // otherwise they are computed and the cache is rewritten on the fly
+  SplatCache                    cache;
+  const SplatCache::Description cacheDesc{splatCount,
+                                          (uint32_t)m_defines.shFormat,
+                                          m_splatSet.shComponentCount(),
+                                          (uint32_t)m_defines.centersFormat,
+                                          (uint32_t)m_defines.covariancesFormat,
+                                          (uint32_t)colorsBufferFormat(),
+                                          (uint32_t)m_spatialOrder,
+                                          m_splatSet.lodLeafCount};
+  if(m_useSplatCache && !m_loadedSceneFilename.empty() && !cache.openForRead(m_loadedSceneFilename, cacheDesc))
+  {
+    cache.openForWrite(m_loadedSceneFilename, cacheDesc);
+  }
+  if(cache.isReading())
+  {
+    std::cout << "Using splat cache " << SplatCache::cacheFilename(m_loadedSceneFilename) << std::endl;
+  }
 
-  // Centers
+  // out of core streaming, the covariances, colors and SH payloads are kept in the stores of the residency
+  // instead of being uploaded and their device buffers are pools of slots, see updateSplatResidency
+  const bool streaming = streamingEnabled();
+  // per streamed attribute, true if its payload is accessed in place in the cache file
+  std::array<bool, SplatResidency::E_ATTRIBUTE_COUNT> streamedFromCache{};
+  if(streaming)
   {
-    const uint32_t bufferSize = splatCount * 3 * sizeof(float);
+    const uint32_t shCoefficients = m_splatSet.shComponentCount() / 3;
+    const uint32_t shStride = (shCoefficients >= 3 ? 9 : 0) + (shCoefficients >= 8 ? 15 : 0) + (shCoefficients == 15 ? 21 : 0);
+    m_residency.init(splatCount,
+                     {uint32_t(6 * (m_defines.covariancesFormat == FORMAT_FLOAT16 ? sizeof(uint16_t) : sizeof(float))),
+                      uint32_t(4 * (colorsBufferFormat() == FORMAT_UINT8 ? sizeof(uint8_t) : sizeof(float))),
+                      m_defines.shFormat == FORMAT_VQ ? uint32_t(sizeof(uint16_t)) : shStride * formatSize(m_defines.shFormat)},
+                     uint64_t(m_streamingPoolSize) << 20);
+    std::cout << "Streaming " << m_residency.chunkCount() << " chunks through " << m_residency.slotCount() << " slots"
+              << std::endl;
+  }
+  // device buffer of a streamed attribute, the pool of its slots when streaming
+  auto createStreamedBuffer = [&](SplatResidency::Attribute attribute, uint64_t bufferSize) {
+    return m_alloc->createBuffer(streaming ? m_residency.poolBytes(attribute) : bufferSize, deviceBufferUsageFlags,
+                                 deviceMemoryPropertyFlags);
+  };
+  // uploads a payload to its device buffer block by block through the staging ring of the uploader,
+  // each block is read from the splat cache or produced by convert(first, count, dst) then appended to the cache
+  auto uploadPayload = [&](SplatCache::Section section, const nvvk::Buffer& deviceBuffer, uint64_t bufferSize,
+                           uint64_t splatBytes, auto&& convert) {
+    bool fromCache = cache.beginSection(section, bufferSize);
+    m_uploader.uploadBuffer(deviceBuffer.buffer, 0, bufferSize, splatBytes, [&](void* dst, uint64_t offset, uint64_t size) {
+      fromCache = fromCache && cache.readBlock(dst, size);
+      if(!fromCache)
+      {
+        fillSplats(static_cast<uint8_t*>(dst), offset, size, splatBytes, splatCount, convert);
+        cache.writeBlock(dst, size);
+      }
+    });
+    cache.endSection();
+  };
+  // a streamed attribute goes to the store of the residency when streaming, or is accessed in place
+  // in the cache file once closed if present, it is uploaded to its device buffer otherwise
+  auto preparePayload = [&](SplatResidency::Attribute attribute, SplatCache::Section section, const nvvk::Buffer& deviceBuffer,
+                            uint64_t bufferSize, uint64_t splatBytes, auto&& convert) {
+    if(!streaming)
+    {
+      uploadPayload(section, deviceBuffer, bufferSize, splatBytes, convert);
+      return;
+    }
+    streamedFromCache[attribute] = cache.skipSection(section, bufferSize);
+    if(!streamedFromCache[attribute])
+    {
+      void* store = m_residency.allocateStore(attribute);
+      convert(0, splatCount, store);
+      cache.writeSection(section, store, bufferSize);
+    }
+  };
 
-    // allocate host and device buffers
-    nvvk::Buffer hostBuffer = m_alloc->createBuffer(bufferSize, hostBufferUsageFlags, hostMemoryPropertyFlags);
+  // Centers quantized relative to the bounds of their chunk
+  if(m_defines.centersFormat == FORMAT_UNORM16)
+  {
+    const uint64_t codesSize  = (uint64_t(splatCount) * 3 * sizeof(uint16_t) + 3) & ~uint64_t(3);
+    const uint64_t boundsSize = uint64_t(centersChunkCount(splatCount)) * CENTERS_BOUNDS_FLOATS * sizeof(float);
+    // the codes followed by the chunk bounds, as stored in the splat cache
+    const uint64_t bufferSize = codesSize + boundsSize;
 
-    m_centersDevice = m_alloc->createBuffer(bufferSize, deviceBufferUsageFlags, deviceMemoryPropertyFlags);
+    m_centersDevice = m_alloc->createBuffer(codesSize, deviceBufferUsageFlags, deviceMemoryPropertyFlags);
     m_dutil->DBG_NAME(m_centersDevice.buffer);
+    m_centersBoundsDevice = m_alloc->createBuffer(boundsSize, deviceBufferUsageFlags, deviceMemoryPropertyFlags);
+    m_dutil->DBG_NAME(m_centersBoundsDevice.buffer);
+
+    // the bounds of the chunks are computed along their codes, blocks are made of whole chunks
+    std::vector<float> bounds(boundsSize / sizeof(float), 0.0f);
+    float              maxError  = 0.0f;
+    bool               fromCache = cache.beginSection(SplatCache::E_CENTERS, bufferSize);
+    bool               codesRead = false;
+    m_uploader.uploadBuffer(m_centersDevice.buffer, 0, codesSize, uint64_t(CENTERS_CHUNK_SIZE) * 3 * sizeof(uint16_t),
+                            [&](void* dst, uint64_t offset, uint64_t size) {
+                              fromCache = fromCache && cache.readBlock(dst, size);
+                              codesRead = codesRead || fromCache;
+                              if(fromCache)
+                                return;
+                              fillSplats(static_cast<uint8_t*>(dst), offset, size, 3 * sizeof(uint16_t), splatCount,
+                                         [&](uint64_t first, uint64_t count, void* codes) {
+                                           const float error =
+                                               quantizeCenters(m_splatSet.positions.data() + first * 3, uint32_t(count),
+                                                               static_cast<uint16_t*>(codes), 3,
+                                                               bounds.data() + first / CENTERS_CHUNK_SIZE * CENTERS_BOUNDS_FLOATS);
+                                           maxError = std::max(maxError, error);
+                                         });
+                              cache.writeBlock(dst, size);
+                            });
+    const bool boundsRead = fromCache && cache.readBlock(bounds.data(), boundsSize);
+    if(!boundsRead && codesRead)
+    {
+      // some codes were read from the cache, their bounds are computed again
+      std::vector<uint16_t> codes(size_t(splatCount) * 3);
+      quantizeCenters(m_splatSet.positions.data(), splatCount, codes.data(), 3, bounds.data());
+    }
+    if(!boundsRead)
+    {
+      std::cout << "Centers quantized to 16 bits, max error " << maxError << std::endl;
+      cache.writeBlock(bounds.data(), boundsSize);
+    }
+    cache.endSection();
 
-    // map and fill host buffer
-    float* hostBufferMapped = static_cast<float*>(m_alloc->map(hostBuffer));
-    memcpy(hostBufferMapped, m_splatSet.positions.data(), bufferSize);
-    m_alloc->unmap(hostBuffer);
+    m_uploader.uploadBuffer(m_centersBoundsDevice.buffer, bounds.data(), boundsSize);
+
+    // memory statistics
+    m_modelMemoryStats.srcCenters  = uint64_t(splatCount) * 3 * sizeof(float);
+    m_modelMemoryStats.odevCenters = uint64_t(splatCount) * 3 * sizeof(uint16_t) + boundsSize;
+    m_modelMemoryStats.devCenters  = bufferSize;
+  }
+  // Centers
+  else
+  {
+    const uint64_t bufferSize = uint64_t(splatCount) * 3 * sizeof(float);
 
-    // copy from host buffer to device buffer
-    // barrier at the end of this method.
-    VkBufferCopy bc{.srcOffset = 0, .dstOffset = 0, .size = bufferSize};
-    vkCmdCopyBuffer(cmd, hostBuffer.buffer, m_centersDevice.buffer, 1, &bc);
+    m_centersDevice = m_alloc->createBuffer(bufferSize, deviceBufferUsageFlags, deviceMemoryPropertyFlags);
+    m_dutil->DBG_NAME(m_centersDevice.buffer);
 
-    // free host buffer after command execution
-    buffersToDestroy.push_back(hostBuffer);
+    uploadPayload(SplatCache::E_CENTERS, m_centersDevice, bufferSize, 3 * sizeof(float), [&](uint64_t first, uint64_t count, void* dst) {
+      memcpy(dst, m_splatSet.positions.data() + first * 3, count * 3 * sizeof(float));
+    });
 
     // memory statistics
     m_modelMemoryStats.srcCenters  = bufferSize;
@@ -1020,109 +2301,143 @@ void GaussianSplatting::initDataBuffers(void)
 
   // covariances
   {
-    const uint32_t bufferSize = splatCount * 2 * 3 * sizeof(float);
+    const bool     useHalf    = m_defines.covariancesFormat == FORMAT_FLOAT16;
+    const uint64_t splatBytes = 2 * 3 * (useHalf ? sizeof(uint16_t) : sizeof(float));
+    const uint64_t bufferSize = uint64_t(splatCount) * splatBytes;
 
-    // allocate host and device buffers
-    nvvk::Buffer hostBuffer = m_alloc->createBuffer(bufferSize, hostBufferUsageFlags, hostMemoryPropertyFlags);
-
-    m_covariancesDevice = m_alloc->createBuffer(bufferSize, deviceBufferUsageFlags, deviceMemoryPropertyFlags);
+    m_covariancesDevice = createStreamedBuffer(SplatResidency::E_COVARIANCES, bufferSize);
     m_dutil->DBG_NAME(m_covariancesDevice.buffer);
 
-    // map and fill host buffer
-    float* hostBufferMapped = static_cast<float*>(m_alloc->map(hostBuffer));
+    const SplatAttributeView srcScale    = m_splatSet.scaleView();
+    const SplatAttributeView srcRotation = m_splatSet.rotationView();
+
+    preparePayload(SplatResidency::E_COVARIANCES, SplatCache::E_COVARIANCES, m_covariancesDevice, bufferSize, splatBytes,
+                   [&](uint64_t first, uint64_t count, void* dst) {
+                     //for(uint32_t i = 0; i < count; ++i)
+                     START_PAR_LOOP(count, i)
+                     {
+                       float covariance[6];
+                       splatCovariance(srcScale, srcRotation, first + i, covariance);
+                       for(uint32_t cmp = 0; cmp < 6; ++cmp)
+                       {
+                         if(useHalf)
+                           static_cast<uint16_t*>(dst)[i * 6 + cmp] = glm::packHalf1x16(covariance[cmp]);
+                         else
+                           static_cast<float*>(dst)[i * 6 + cmp] = covariance[cmp];
+                       }
+                     }
+                     END_PAR_LOOP()
+                   });
 
-    //for(uint32_t splatIdx = 0; splatIdx < splatCount; ++splatIdx)
-    START_PAR_LOOP(splatCount, splatIdx)
-    {
-      const auto stride3 = splatIdx * 3;
-      const auto stride4 = splatIdx * 4;
-      const auto stride6 = splatIdx * 6;
-      glm::vec3  scale{std::exp(m_splatSet.scale[stride3 + 0]), std::exp(m_splatSet.scale[stride3 + 1]),
-                      std::exp(m_splatSet.scale[stride3 + 2])};
-
-      glm::quat rotation{m_splatSet.rotation[stride4 + 0], m_splatSet.rotation[stride4 + 1],
-                         m_splatSet.rotation[stride4 + 2], m_splatSet.rotation[stride4 + 3]};
-      rotation = glm::normalize(rotation);
-
-      // computes the covariance
-      const glm::mat3 scaleMatrix           = glm::mat3(glm::scale(scale));
-      const glm::mat3 rotationMatrix        = glm::mat3_cast(rotation);  // where rotation is a quaternion
-      const glm::mat3 covarianceMatrix      = rotationMatrix * scaleMatrix;
-      glm::mat3       transformedCovariance = covarianceMatrix * glm::transpose(covarianceMatrix);
-
-      hostBufferMapped[stride6 + 0] = glm::value_ptr(transformedCovariance)[0];
-      hostBufferMapped[stride6 + 1] = glm::value_ptr(transformedCovariance)[3];
-      hostBufferMapped[stride6 + 2] = glm::value_ptr(transformedCovariance)[6];
-
-      hostBufferMapped[stride6 + 3] = glm::value_ptr(transformedCovariance)[4];
-      hostBufferMapped[stride6 + 4] = glm::value_ptr(transformedCovariance)[7];
-      hostBufferMapped[stride6 + 5] = glm::value_ptr(transformedCovariance)[8];
-    }
-    END_PAR_LOOP();
+    // memory statistics
+    const uint64_t deviceSize  = streaming ? m_residency.poolBytes(SplatResidency::E_COVARIANCES) : bufferSize;
+    m_modelMemoryStats.srcCov  = uint64_t(splatCount) * (4 + 3) * sizeof(float);
+    m_modelMemoryStats.odevCov = deviceSize;
+    m_modelMemoryStats.devCov  = deviceSize;  // covariance takes less space than rotation + scale
+  }
 
-    m_alloc->unmap(hostBuffer);
+  // Colors. SH degree 0 is not view dependent, so we directly transform to base color
+  // this will make some economy of processing in the shader at each frame
+  {
+    const bool     useUnorm8  = colorsBufferFormat() == FORMAT_UINT8;
+    const uint64_t splatBytes = 4 * (useUnorm8 ? sizeof(uint8_t) : sizeof(float));
+    const uint64_t bufferSize = uint64_t(splatCount) * splatBytes;
 
-    // copy from host buffer to device buffer
-    // barrier at the end of this method.
-    VkBufferCopy bc{.srcOffset = 0, .dstOffset = 0, .size = bufferSize};
-    vkCmdCopyBuffer(cmd, hostBuffer.buffer, m_covariancesDevice.buffer, 1, &bc);
+    m_colorsDevice = createStreamedBuffer(SplatResidency::E_COLORS, bufferSize);
+    m_dutil->DBG_NAME(m_colorsDevice.buffer);
 
-    // free host buffer after command execution
-    buffersToDestroy.push_back(hostBuffer);
+    const SplatAttributeView srcDc      = m_splatSet.f_dcView();
+    const SplatAttributeView srcOpacity = m_splatSet.opacityView();
+
+    preparePayload(SplatResidency::E_COLORS, SplatCache::E_COLORS, m_colorsDevice, bufferSize, splatBytes,
+                   [&](uint64_t first, uint64_t count, void* dst) {
+                     //for(uint32_t i = 0; i < count; ++i)
+                     START_PAR_LOOP(count, i)
+                     {
+                       float color[4];
+                       splatColor(srcDc, srcOpacity, first + i, color);
+                       for(uint32_t cmp = 0; cmp < 4; ++cmp)
+                       {
+                         if(useUnorm8)
+                           static_cast<uint8_t*>(dst)[i * 4 + cmp] = toUnorm8(color[cmp]);
+                         else
+                           static_cast<float*>(dst)[i * 4 + cmp] = color[cmp];
+                       }
+                     }
+                     END_PAR_LOOP()
+                   });
 
     // memory statistics
-    m_modelMemoryStats.srcCov  = (splatCount * (4 + 3)) * sizeof(float);
-    m_modelMemoryStats.odevCov = bufferSize;  // no compression
-    m_modelMemoryStats.devCov  = bufferSize;  // covariance takes less space than rotation + scale
+    const uint64_t deviceSize  = streaming ? m_residency.poolBytes(SplatResidency::E_COLORS) : bufferSize;
+    m_modelMemoryStats.srcSh0  = uint64_t(splatCount) * 4 * sizeof(float);  // original sh0 and opacity are floats
+    m_modelMemoryStats.odevSh0 = deviceSize;
+    m_modelMemoryStats.devSh0  = deviceSize;
   }
 
-  // Colors. SH degree 0 is not view dependent, so we directly transform to base color
-  // this will make some economy of processing in the shader at each frame
+  // Spherical harmonics of degree 1 to 3, vector quantized
+  if(m_defines.shFormat == FORMAT_VQ)
   {
-    const uint32_t bufferSize = splatCount * 4 * sizeof(float);
-
-    // allocate host and device buffers
-    nvvk::Buffer hostBuffer = m_alloc->createBuffer(bufferSize, hostBufferUsageFlags, hostMemoryPropertyFlags);
+    const SplatAttributeView srcSh       = m_splatSet.f_restView();
+    const uint32_t           entryCount  = shCodebookEntryCount(ShCodebook::s_defaultSize);
+    const uint64_t           codesSize   = (uint64_t(splatCount) * sizeof(uint16_t) + 3) & ~uint64_t(3);
+    const uint64_t           entriesSize = uint64_t(entryCount) * ShCodebook::s_entryFloats * sizeof(float);
+    // the codes followed by the codebook entries, as stored in the splat cache
+    const uint64_t bufferSize = codesSize + entriesSize;
+
+    m_sphericalHarmonicsDevice = createStreamedBuffer(SplatResidency::E_SH, codesSize);
+    m_dutil->DBG_NAME(m_sphericalHarmonicsDevice.buffer);
+    m_shCodebookDevice = m_alloc->createBuffer(entriesSize, deviceBufferUsageFlags, deviceMemoryPropertyFlags);
+    m_dutil->DBG_NAME(m_shCodebookDevice.buffer);
 
-    m_colorsDevice = m_alloc->createBuffer(bufferSize, deviceBufferUsageFlags, deviceMemoryPropertyFlags);
-    m_dutil->DBG_NAME(m_colorsDevice.buffer);
+    // small enough to be prepared at once, the codebook needs all the splats anyway
+    std::vector<uint8_t> section(bufferSize, 0);
 
-    // fill host buffer
-    float* hostBufferMapped = static_cast<float*>(m_alloc->map(hostBuffer));
+    auto startShTime = std::chrono::high_resolution_clock::now();
 
-    //for(uint32_t splatIdx = 0; splatIdx < splatCount; ++splatIdx)
-    START_PAR_LOOP(splatCount, splatIdx)
+    if(!cache.readSection(SplatCache::E_SH, section.data(), bufferSize))
     {
-      const auto  stride3           = splatIdx * 3;
-      const auto  stride4           = splatIdx * 4;
-      const float SH_C0             = 0.28209479177387814f;
-      hostBufferMapped[stride4 + 0] = glm::clamp(0.5f + SH_C0 * m_splatSet.f_dc[stride3 + 0], 0.0f, 1.0f);
-      hostBufferMapped[stride4 + 1] = glm::clamp(0.5f + SH_C0 * m_splatSet.f_dc[stride3 + 1], 0.0f, 1.0f);
-      hostBufferMapped[stride4 + 2] = glm::clamp(0.5f + SH_C0 * m_splatSet.f_dc[stride3 + 2], 0.0f, 1.0f);
-      hostBufferMapped[stride4 + 3] = glm::clamp(1.0f / (1.0f + std::exp(-m_splatSet.opacity[splatIdx])), 0.0f, 1.0f);
+      const ShCodebook* codebook = nullptr;
+      if(acquireShCodebook(srcSh, splatCount, codebook))
+      {
+        memcpy(section.data(), codebook->codes.data(), codebook->codes.size() * sizeof(uint16_t));
+        memcpy(section.data() + codesSize, codebook->entries.data(), codebook->entriesBytes());
+      }
+      cache.writeSection(SplatCache::E_SH, section.data(), bufferSize);
+    }
+    else
+    {
+      m_shCodebookReport = "SH codebook read from the splat cache";
+      // the codes are small, still accessed in place in the cache to share its mapping
+      streamedFromCache[SplatResidency::E_SH] = streaming;
     }
-    END_PAR_LOOP()
-
-    m_alloc->unmap(hostBuffer);
 
-    // copy from host buffer to device buffer
-    // barrier at the end of this method.
-    VkBufferCopy bc{.srcOffset = 0, .dstOffset = 0, .size = bufferSize};
-    vkCmdCopyBuffer(cmd, hostBuffer.buffer, m_colorsDevice.buffer, 1, &bc);
+    auto      endShTime   = std::chrono::high_resolution_clock::now();
+    long long buildShTime = std::chrono::duration_cast<std::chrono::milliseconds>(endShTime - startShTime).count();
+    std::cout << "Sh codebook updated in " << buildShTime << "ms" << std::endl;
 
-    // free host buffer after command execution
-    buffersToDestroy.push_back(hostBuffer);
+    // the codes are streamed, the codebook stays resident
+    if(streaming && !streamedFromCache[SplatResidency::E_SH])
+    {
+      memcpy(m_residency.allocateStore(SplatResidency::E_SH), section.data(), uint64_t(splatCount) * sizeof(uint16_t));
+    }
+    if(!streaming)
+    {
+      m_uploader.uploadBuffer(m_sphericalHarmonicsDevice.buffer, section.data(), codesSize);
+    }
+    m_uploader.uploadBuffer(m_shCodebookDevice.buffer, section.data() + codesSize, entriesSize);
 
     // memory statistics
-    m_modelMemoryStats.srcSh0  = bufferSize;
-    m_modelMemoryStats.odevSh0 = bufferSize;
-    m_modelMemoryStats.devSh0  = bufferSize;
+    const uint64_t deviceSize      = (streaming ? m_residency.poolBytes(SplatResidency::E_SH) : codesSize) + entriesSize;
+    m_modelMemoryStats.srcShOther  = uint64_t(splatCount) * srcSh.components * sizeof(float);
+    m_modelMemoryStats.odevShOther = deviceSize;
+    m_modelMemoryStats.devShOther  = deviceSize;
   }
-
   // Spherical harmonics of degree 1 to 3
+  else
   {
-    const uint32_t totalSphericalHarmonicsComponentCount    = (uint32_t)m_splatSet.f_rest.size() / splatCount;
-    const uint32_t sphericalHarmonicsCoefficientsPerChannel = totalSphericalHarmonicsComponentCount / 3;
+    const SplatAttributeView srcSh                                    = m_splatSet.f_restView();
+    const uint32_t           totalSphericalHarmonicsComponentCount    = srcSh.components;
+    const uint32_t           sphericalHarmonicsCoefficientsPerChannel = totalSphericalHarmonicsComponentCount / 3;
     // find the maximum SH degree stored in the file
     int sphericalHarmonicsDegree = 0;
     int splatStride              = 0;
@@ -1144,97 +2459,78 @@ void GaussianSplatting::initDataBuffers(void)
 
     int targetSplatStride = splatStride;  // same for the time beeing, would be less if we do not upload all src degrees
 
-    // allocate host and device buffers
-    const uint32_t bufferSize = splatCount * splatStride * formatSize(m_defines.shFormat);
+    const uint64_t splatBytes = uint64_t(splatStride) * formatSize(m_defines.shFormat);
+    const uint64_t bufferSize = uint64_t(splatCount) * splatBytes;
 
-    nvvk::Buffer hostBuffer = m_alloc->createBuffer(bufferSize, hostBufferUsageFlags, hostMemoryPropertyFlags);
-
-    m_sphericalHarmonicsDevice = m_alloc->createBuffer(bufferSize, deviceBufferUsageFlags, deviceMemoryPropertyFlags);
+    m_sphericalHarmonicsDevice = createStreamedBuffer(SplatResidency::E_SH, bufferSize);
     m_dutil->DBG_NAME(m_sphericalHarmonicsDevice.buffer);
 
-    // fill host buffer
-    void* hostBufferMapped = m_alloc->map(hostBuffer);
-
     auto startShTime = std::chrono::high_resolution_clock::now();
 
-    // for(uint32_t splatIdx = 0; splatIdx < splatCount; ++splatIdx)
-    START_PAR_LOOP(splatCount, splatIdx)
-    {
-      const auto srcBase   = splatStride * splatIdx;
-      const auto destBase  = targetSplatStride * splatIdx;
-      int        dstOffset = 0;
-      // degree 1, three coefs per component
-      for(auto i = 0; i < 3; i++)
-      {
-        for(auto rgb = 0; rgb < 3; rgb++)
-        {
-          const auto srcIndex = srcBase + (sphericalHarmonicsCoefficientsPerChannel * rgb + i);
-          const auto dstIndex = destBase + dstOffset++;  // inc after add
-
-          storeSh(m_defines.shFormat, m_splatSet.f_rest.data(), srcIndex, hostBufferMapped, dstIndex);
-        }
-      }
-      // degree 2, five coefs per component
-      for(auto i = 0; i < 5; i++)
-      {
-        for(auto rgb = 0; rgb < 3; rgb++)
-        {
-          const auto srcIndex = srcBase + (sphericalHarmonicsCoefficientsPerChannel * rgb + 3 + i);
-          const auto dstIndex = destBase + dstOffset++;  // inc after add
-
-          storeSh(m_defines.shFormat, m_splatSet.f_rest.data(), srcIndex, hostBufferMapped, dstIndex);
-        }
-      }
-      // degree 3, seven coefs per component
-      for(auto i = 0; i < 7; i++)
-      {
-        for(auto rgb = 0; rgb < 3; rgb++)
-        {
-          const auto srcIndex = srcBase + (sphericalHarmonicsCoefficientsPerChannel * rgb + 3 + 5 + i);
-          const auto dstIndex = destBase + dstOffset++;  // inc after add
-
-          storeSh(m_defines.shFormat, m_splatSet.f_rest.data(), srcIndex, hostBufferMapped, dstIndex);
-        }
-      }
-    }
-    END_PAR_LOOP()
+    preparePayload(SplatResidency::E_SH, SplatCache::E_SH, m_sphericalHarmonicsDevice, bufferSize, splatBytes,
+                   [&](uint64_t first, uint64_t count, void* dst) {
+                     SplatAttributeView block = srcSh;
+                     block.data += first * srcSh.stride;
+                     packSphericalHarmonics(m_defines.shFormat, sphericalHarmonicsDegree, block, uint32_t(count), dst, targetSplatStride);
+                   });
 
     auto      endShTime   = std::chrono::high_resolution_clock::now();
     long long buildShTime = std::chrono::duration_cast<std::chrono::milliseconds>(endShTime - startShTime).count();
     std::cout << "Sh data updated in " << buildShTime << "ms" << std::endl;
 
-    m_alloc->unmap(hostBuffer);
-
-    // copy from host buffer to device buffer
-    // barrier at the end of this method.
-    VkBufferCopy bc{.srcOffset = 0, .dstOffset = 0, .size = bufferSize};
-    vkCmdCopyBuffer(cmd, hostBuffer.buffer, m_sphericalHarmonicsDevice.buffer, 1, &bc);
-
-    // free host buffer after command execution
-    buffersToDestroy.push_back(hostBuffer);
-
     // memory statistics
-    m_modelMemoryStats.srcShOther  = (uint32_t)m_splatSet.f_rest.size() * sizeof(float);
-    m_modelMemoryStats.odevShOther = bufferSize;  // no compression or quantization
-    m_modelMemoryStats.devShOther  = bufferSize;
+    const uint64_t deviceSize      = streaming ? m_residency.poolBytes(SplatResidency::E_SH) : bufferSize;
+    m_modelMemoryStats.srcShOther  = uint64_t(splatCount) * totalSphericalHarmonicsComponentCount * sizeof(float);
+    m_modelMemoryStats.odevShOther = deviceSize;  // no compression or quantization
+    m_modelMemoryStats.devShOther  = deviceSize;
   }
 
-  // sync with end of copy to device
-  VkMemoryBarrier barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
-  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-  barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-  vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
-                       VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_MESH_SHADER_BIT_EXT,
-                       0, 1, &barrier, 0, NULL, 0, NULL);
-
-  m_app->submitAndWaitTempCmdBuffer(cmd);
+  // makes a newly written cache visible
+  const bool cacheWritten = cache.isWriting();
+  if(cache.close() && cacheWritten)
+  {
+    streamedFromCache.fill(true);
+  }
 
-  // free temp buffers
-  for(auto& buffer : buffersToDestroy)
+  if(streaming)
   {
-    m_alloc->destroy(buffer);
+    // the streamed payloads present in the cache are accessed in place, memory mapped if possible
+    const SplatCache::Section sections[SplatResidency::E_ATTRIBUTE_COUNT] = {SplatCache::E_COVARIANCES, SplatCache::E_COLORS,
+                                                                             SplatCache::E_SH};
+    for(uint32_t attribute = 0; attribute < SplatResidency::E_ATTRIBUTE_COUNT; ++attribute)
+    {
+      if(streamedFromCache[attribute])
+        m_residency.attachFile(SplatResidency::Attribute(attribute), SplatCache::cacheFilename(m_loadedSceneFilename),
+                               cache.sectionOffset(sections[attribute]));
+    }
+
+    // no chunk resident yet
+    const uint64_t slotsSize = uint64_t(m_residency.chunkCount()) * sizeof(uint32_t);
+    m_chunkSlotsDevice       = m_alloc->createBuffer(slotsSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    m_dutil->DBG_NAME(m_chunkSlotsDevice.buffer);
+    m_uploader.uploadBuffer(m_chunkSlotsDevice.buffer, 0, slotsSize, sizeof(uint32_t), [](void* dst, uint64_t, uint64_t size) {
+      std::fill_n(static_cast<uint32_t*>(dst), size / sizeof(uint32_t), CHUNK_NOT_RESIDENT);
+    });
+
+    // per frame in flight, the payloads of s_streamingMaxUploads chunks then the slots of the chunks they evict and replace
+    m_streamingSliceSize   = s_streamingMaxUploads * (m_residency.chunkPayloadBytes() + 2 * sizeof(uint32_t));
+    m_streamingStagingHost = m_alloc->createBuffer(m_framesInFlight * m_streamingSliceSize, hostBufferUsageFlags,
+                                                   hostMemoryPropertyFlags);
+    m_dutil->DBG_NAME(m_streamingStagingHost.buffer);
+    m_streamingStagingHostMapped = static_cast<uint8_t*>(m_alloc->map(m_streamingStagingHost));
+
+    m_renderMemoryStats.hostAllocStaging = m_framesInFlight * m_streamingSliceSize;
+    m_renderMemoryStats.allocChunkSlots  = uint64_t(m_residency.chunkCount()) * sizeof(uint32_t);
   }
 
+  // the next frames wait for the end of the copies on the device, not here
+  m_uploader.flush();
+  const SplatUploader::Stats& uploadStats = m_uploader.stats();
+  std::cout << "Uploaded " << (uploadStats.bytes >> 20) << "MB in " << uploadStats.blocks << " blocks on the "
+            << (m_uploader.isAsynchronous() ? "transfer" : "graphics") << " queue, " << uploadStats.hostWaitTime
+            << "ms waiting for staging slots" << std::endl;
+
   // update statistics totals
   m_modelMemoryStats.srcShAll  = m_modelMemoryStats.srcSh0 + m_modelMemoryStats.srcShOther;
   m_modelMemoryStats.odevShAll = m_modelMemoryStats.odevSh0 + m_modelMemoryStats.odevShOther;
@@ -1258,30 +2554,75 @@ void GaussianSplatting::deinitDataBuffers()
   m_alloc->destroy(m_colorsDevice);
   m_alloc->destroy(m_covariancesDevice);
   m_alloc->destroy(m_sphericalHarmonicsDevice);
+  m_alloc->destroy(m_shCodebookDevice);
+  m_alloc->destroy(m_centersBoundsDevice);
+
+  if(m_streamingStagingHostMapped != nullptr)
+    m_alloc->unmap(m_streamingStagingHost);
+  m_streamingStagingHostMapped = nullptr;
+  m_alloc->destroy(m_streamingStagingHost);
+  m_alloc->destroy(m_chunkSlotsDevice);
+  m_residency.reset();
+  m_renderMemoryStats.hostAllocStaging = 0;
+  m_renderMemoryStats.allocChunkSlots  = 0;
 }
 
 ///////////////////
 // using texture maps to store splatset in VRAM
 
-void GaussianSplatting::initTexture(uint32_t         width,
-                                    uint32_t         height,
-                                    uint32_t         bufsize,
-                                    void*            data,
-                                    VkFormat         format,
-                                    const VkSampler& sampler,
-                                    nvvk::Texture&   texture)
+bool GaussianSplatting::acquireShCodebook(const SplatAttributeView& srcSh, uint32_t splatCount, const ShCodebook*& codebook)
+{
+  const ShCodebookKey key{m_loadedSceneFilename, splatCount, srcSh.components, (uint32_t)m_spatialOrder,
+                          ShCodebook::s_defaultSize};
+
+  // the k-means is the longest step of a FORMAT_VQ init, it only runs for a new key
+  if(key != m_shCodebookKey)
+  {
+    m_shCodebookKey         = key;
+    m_shCodebook            = {};
+    m_shCodebookBuildReport = "";
+    if(buildShCodebook(srcSh, splatCount, ShCodebook::s_defaultSize, m_shCodebook))
+    {
+      m_shCodebookBuildReport = evaluateShCodebook(srcSh, splatCount, m_shCodebook).toString();
+      std::cout << m_shCodebookBuildReport << std::endl;
+    }
+    else
+    {
+      m_shCodebook = {};
+    }
+  }
+  else if(!m_shCodebook.codes.empty())
+  {
+    std::cout << "Sh codebook reused" << std::endl;
+  }
+
+  if(m_shCodebook.codes.empty())
+    return false;
+
+  m_shCodebookReport = m_shCodebookBuildReport;
+  codebook           = &m_shCodebook;
+  return true;
+}
+
+void GaussianSplatting::initTexture(uint32_t                        width,
+                                    uint32_t                        height,
+                                    uint32_t                        texelBytes,
+                                    const SplatUploader::FillFunc& fill,
+                                    VkFormat                        format,
+                                    const VkSampler&                sampler,
+                                    nvvk::Texture&                  texture)
 {
   const VkSamplerCreateInfo sampler_info{VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
   const VkExtent2D          size        = {width, height};
   const VkImageCreateInfo   create_info = nvvk::makeImage2DCreateInfo(size, format, VK_IMAGE_USAGE_SAMPLED_BIT, false);
 
-  nvvk::CommandPool cpool(m_device, m_app->getQueue(0).familyIndex);
-  VkCommandBuffer   cmd = cpool.createCommandBuffer();
+  // the texels are produced block by block in the staging ring of the uploader
+  nvvk::Image image = m_alloc->createImage(create_info);
+  m_uploader.uploadImage(image.image, size, texelBytes, fill);
 
-  texture = m_alloc->createTexture(cmd, bufsize, data, create_info, sampler_info);
-  cpool.submitAndWait(cmd);
-
-  texture.descriptor.sampler = sampler;
+  const VkImageViewCreateInfo view_info = nvvk::makeImageViewCreateInfo(image.image, create_info);
+  texture                               = m_alloc->createTexture(image, view_info, sampler_info);
+  texture.descriptor.sampler            = sampler;
 }
 
 void GaussianSplatting::deinitTexture(nvvk::Texture& texture)
@@ -1295,6 +2636,8 @@ void GaussianSplatting::initDataTextures(void)
 
   const auto splatCount = (uint32_t)m_splatSet.positions.size() / 3;
 
+  m_uploader.resetStats();
+
   // will create a texture sampler using nearest filtering mode foe each texture map
   // samplers will be released by texture destruction.
   VkSamplerCreateInfo sampler_info{VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
@@ -1302,103 +2645,187 @@ void GaussianSplatting::initDataTextures(void)
   sampler_info.minFilter  = VK_FILTER_NEAREST;
   sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
 
+  // the storage buffers of the chunk bounds and of the SH codebook
+  const VkBufferUsageFlags bufferUsageFlags = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+  // the splats are converted by blocks of rows of the texture maps, splatBytes per splat including padding
+  auto fillBlock = [&](uint64_t splatBytes, auto&& convert) {
+    return [&, splatBytes](void* dst, uint64_t offset, uint64_t size) {
+      fillSplats(static_cast<uint8_t*>(dst), offset, size, splatBytes, splatCount, convert);
+    };
+  };
+
+  // centers quantized relative to the bounds of their chunk, the bounds are a storage buffer as with data buffers
+  if(m_defines.centersFormat == FORMAT_UNORM16)
+  {
+    glm::ivec2         mapSize = computeDataTextureSize(4, 4, splatCount);  // includes some padding and unused w channel
+    std::vector<float> bounds(size_t(centersChunkCount(splatCount)) * CENTERS_BOUNDS_FLOATS);
+
+    // rows hold a multiple of CENTERS_CHUNK_SIZE splats, blocks are made of whole chunks
+    float maxError = 0.0f;
+    initTexture(mapSize.x, mapSize.y, 4 * sizeof(uint16_t),
+                fillBlock(4 * sizeof(uint16_t),
+                          [&](uint64_t first, uint64_t count, void* dst) {
+                            const float error = quantizeCenters(m_splatSet.positions.data() + first * 3, uint32_t(count),
+                                                                static_cast<uint16_t*>(dst), 4,
+                                                                bounds.data() + first / CENTERS_CHUNK_SIZE * CENTERS_BOUNDS_FLOATS);
+                            maxError = std::max(maxError, error);
+                          }),
+                VK_FORMAT_R16G16B16A16_UNORM, m_alloc->acquireSampler(sampler_info), m_centersMap);
+    std::cout << "Centers quantized to 16 bits, max error " << maxError << std::endl;
+
+    m_centersBoundsDevice = m_alloc->createBuffer(bounds.size() * sizeof(float), bufferUsageFlags, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    m_dutil->DBG_NAME(m_centersBoundsDevice.buffer);
+    m_uploader.uploadBuffer(m_centersBoundsDevice.buffer, bounds.data(), bounds.size() * sizeof(float));
+
+    // memory statistics
+    m_modelMemoryStats.srcCenters  = uint64_t(splatCount) * 3 * sizeof(float);
+    m_modelMemoryStats.odevCenters = uint64_t(splatCount) * 3 * sizeof(uint16_t) + bounds.size() * sizeof(float);
+    m_modelMemoryStats.devCenters  = uint64_t(mapSize.x) * mapSize.y * 4 * sizeof(uint16_t) + bounds.size() * sizeof(float);
+  }
   // centers (3 components but texture map is only allowed with 4 components)
   // TODO: May pack as done for covariances not to waste alpha chanel ? but must
   // compare performance (1 lookup vs 2 lookups due to packing)
+  else
   {
-    glm::ivec2         mapSize = computeDataTextureSize(3, 3, splatCount);
-    std::vector<float> centers(mapSize.x * mapSize.y * 4);  // includes some padding and unused w channel
-    //for(uint32_t i = 0; i < splatCount; ++i)
-    START_PAR_LOOP(splatCount, splatIdx)
-    {
-      // we skip the alpha channel that is left undefined and not used in the shader
-      for(uint32_t cmp = 0; cmp < 3; ++cmp)
-      {
-        centers[splatIdx * 4 + cmp] = m_splatSet.positions[splatIdx * 3 + cmp];
-      }
-    }
-    END_PAR_LOOP()
+    glm::ivec2 mapSize = computeDataTextureSize(3, 3, splatCount);  // includes some padding and unused w channel
 
     // place the result in the dedicated texture map
-    initTexture(mapSize.x, mapSize.y, (uint32_t)centers.size() * sizeof(float), (void*)centers.data(),
+    initTexture(mapSize.x, mapSize.y, 4 * sizeof(float),
+                fillBlock(4 * sizeof(float),
+                          [&](uint64_t first, uint64_t count, void* dst) {
+                            //for(uint32_t i = 0; i < count; ++i)
+                            START_PAR_LOOP(count, i)
+                            {
+                              // we skip the alpha channel that is left undefined and not used in the shader
+                              for(uint32_t cmp = 0; cmp < 3; ++cmp)
+                              {
+                                static_cast<float*>(dst)[i * 4 + cmp] = m_splatSet.positions[(first + i) * 3 + cmp];
+                              }
+                            }
+                            END_PAR_LOOP()
+                          }),
                 VK_FORMAT_R32G32B32A32_SFLOAT, m_alloc->acquireSampler(sampler_info), m_centersMap);
     // memory statistics
-    m_modelMemoryStats.srcCenters  = splatCount * 3 * sizeof(float);
-    m_modelMemoryStats.odevCenters = splatCount * 3 * sizeof(float);  // no compression or quantization yet
-    m_modelMemoryStats.devCenters  = mapSize.x * mapSize.y * 4 * sizeof(float);
+    m_modelMemoryStats.srcCenters  = uint64_t(splatCount) * 3 * sizeof(float);
+    m_modelMemoryStats.odevCenters = uint64_t(splatCount) * 3 * sizeof(float);  // no compression or quantization yet
+    m_modelMemoryStats.devCenters  = uint64_t(mapSize.x) * mapSize.y * 4 * sizeof(float);
   }
   // covariances
   {
-    glm::ivec2         mapSize = computeDataTextureSize(4, 6, splatCount);
-    std::vector<float> covariances(mapSize.x * mapSize.y * 4, 0.0f);
-    //for(uint32_t splatIdx = 0; splatIdx < splatCount; ++splatIdx)
-    START_PAR_LOOP(splatCount, splatIdx)
-    {
-      const auto stride3 = splatIdx * 3;
-      const auto stride4 = splatIdx * 4;
-      const auto stride6 = splatIdx * 6;
-      glm::vec3  scale{std::exp(m_splatSet.scale[stride3 + 0]), std::exp(m_splatSet.scale[stride3 + 1]),
-                      std::exp(m_splatSet.scale[stride3 + 2])};
-
-      glm::quat rotation{m_splatSet.rotation[stride4 + 0], m_splatSet.rotation[stride4 + 1],
-                         m_splatSet.rotation[stride4 + 2], m_splatSet.rotation[stride4 + 3]};
-      rotation = glm::normalize(rotation);
-
-      // computes the covariance
-      const glm::mat3 scaleMatrix           = glm::mat3(glm::scale(scale));
-      const glm::mat3 rotationMatrix        = glm::mat3_cast(rotation);  // where rotation is a quaternion
-      const glm::mat3 covarianceMatrix      = rotationMatrix * scaleMatrix;
-      glm::mat3       transformedCovariance = covarianceMatrix * glm::transpose(covarianceMatrix);
-
-      covariances[stride6 + 0] = glm::value_ptr(transformedCovariance)[0];
-      covariances[stride6 + 1] = glm::value_ptr(transformedCovariance)[3];
-      covariances[stride6 + 2] = glm::value_ptr(transformedCovariance)[6];
-
-      covariances[stride6 + 3] = glm::value_ptr(transformedCovariance)[4];
-      covariances[stride6 + 4] = glm::value_ptr(transformedCovariance)[7];
-      covariances[stride6 + 5] = glm::value_ptr(transformedCovariance)[8];
-    }
-    END_PAR_LOOP()
-
-    // place the result in the dedicated texture map
-    initTexture(mapSize.x, mapSize.y, (uint32_t)covariances.size() * sizeof(float), (void*)covariances.data(),
-                VK_FORMAT_R32G32B32A32_SFLOAT, m_alloc->acquireSampler(sampler_info), m_covariancesMap);
+    const bool     useHalf     = m_defines.covariancesFormat == FORMAT_FLOAT16;
+    const uint64_t elementSize = useHalf ? sizeof(uint16_t) : sizeof(float);
+    glm::ivec2     mapSize     = computeDataTextureSize(4, 6, splatCount);
+
+    const SplatAttributeView srcScale    = m_splatSet.scaleView();
+    const SplatAttributeView srcRotation = m_splatSet.rotationView();
+
+    // place the result in the dedicated texture map, a splat straddles two texels
+    initTexture(mapSize.x, mapSize.y, uint32_t(4 * elementSize),
+                fillBlock(6 * elementSize,
+                          [&](uint64_t first, uint64_t count, void* dst) {
+                            //for(uint32_t i = 0; i < count; ++i)
+                            START_PAR_LOOP(count, i)
+                            {
+                              float covariance[6];
+                              splatCovariance(srcScale, srcRotation, first + i, covariance);
+                              for(uint32_t cmp = 0; cmp < 6; ++cmp)
+                              {
+                                if(useHalf)
+                                  static_cast<uint16_t*>(dst)[i * 6 + cmp] = glm::packHalf1x16(covariance[cmp]);
+                                else
+                                  static_cast<float*>(dst)[i * 6 + cmp] = covariance[cmp];
+                              }
+                            }
+                            END_PAR_LOOP()
+                          }),
+                useHalf ? VK_FORMAT_R16G16B16A16_SFLOAT : VK_FORMAT_R32G32B32A32_SFLOAT,
+                m_alloc->acquireSampler(sampler_info), m_covariancesMap);
     // memory statistics
-    m_modelMemoryStats.srcCov  = (splatCount * (4 + 3)) * sizeof(float);
-    m_modelMemoryStats.odevCov = splatCount * 6 * sizeof(float);  // covariance takes less space than rotation + scale
-    m_modelMemoryStats.devCov  = mapSize.x * mapSize.y * 4 * sizeof(float);
+    m_modelMemoryStats.srcCov  = uint64_t(splatCount) * (4 + 3) * sizeof(float);
+    m_modelMemoryStats.odevCov = uint64_t(splatCount) * 6 * elementSize;  // covariance takes less space than rotation + scale
+    m_modelMemoryStats.devCov  = uint64_t(mapSize.x) * mapSize.y * 4 * elementSize;
   }
   // SH degree 0 is not view dependent, so we directly transform to base color
   // this will make some economy of processing in the shader at each frame
   {
-    glm::ivec2           mapSize = computeDataTextureSize(4, 4, splatCount);
-    std::vector<uint8_t> colors(mapSize.x * mapSize.y * 4);  // includes some padding
-    //for(uint32_t splatIdx = 0; splatIdx < splatCount; ++splatIdx)
-    START_PAR_LOOP(splatCount, splatIdx)
-    {
-      const auto  stride3 = splatIdx * 3;
-      const auto  stride4 = splatIdx * 4;
-      const float SH_C0   = 0.28209479177387814f;
-      colors[stride4 + 0] = (uint8_t)glm::clamp(std::floor((0.5f + SH_C0 * m_splatSet.f_dc[stride3 + 0]) * 255), 0.0f, 255.0f);
-      colors[stride4 + 1] = (uint8_t)glm::clamp(std::floor((0.5f + SH_C0 * m_splatSet.f_dc[stride3 + 1]) * 255), 0.0f, 255.0f);
-      colors[stride4 + 2] = (uint8_t)glm::clamp(std::floor((0.5f + SH_C0 * m_splatSet.f_dc[stride3 + 2]) * 255), 0.0f, 255.0f);
-      colors[stride4 + 3] =
-          (uint8_t)glm::clamp(std::floor((1.0f / (1.0f + std::exp(-m_splatSet.opacity[splatIdx]))) * 255), 0.0f, 255.0f);
-    }
-    END_PAR_LOOP()
+    // textures store RGBA8 colors by default, truncated as they always were, FORMAT_UINT8 rounds them
+    const bool     useUnorm8   = m_defines.colorsFormat != FORMAT_FLOAT32;
+    const bool     truncate    = m_defines.colorsFormat == FORMAT_STORAGE_DEFAULT;
+    const uint64_t elementSize = useUnorm8 ? sizeof(uint8_t) : sizeof(float);
+    glm::ivec2     mapSize     = computeDataTextureSize(4, 4, splatCount);  // includes some padding
+
+    const SplatAttributeView srcDc      = m_splatSet.f_dcView();
+    const SplatAttributeView srcOpacity = m_splatSet.opacityView();
+
     // place the result in the dedicated texture map
-    initTexture(mapSize.x, mapSize.y, (uint32_t)colors.size(), (void*)colors.data(), VK_FORMAT_R8G8B8A8_UNORM,
+    initTexture(mapSize.x, mapSize.y, uint32_t(4 * elementSize),
+                fillBlock(4 * elementSize,
+                          [&](uint64_t first, uint64_t count, void* dst) {
+                            //for(uint32_t i = 0; i < count; ++i)
+                            START_PAR_LOOP(count, i)
+                            {
+                              float color[4];
+                              splatColor(srcDc, srcOpacity, first + i, color);
+                              for(uint32_t cmp = 0; cmp < 4; ++cmp)
+                              {
+                                if(truncate)
+                                  static_cast<uint8_t*>(dst)[i * 4 + cmp] = uint8_t(std::floor(color[cmp] * 255.0f));
+                                else if(useUnorm8)
+                                  static_cast<uint8_t*>(dst)[i * 4 + cmp] = toUnorm8(color[cmp]);
+                                else
+                                  static_cast<float*>(dst)[i * 4 + cmp] = color[cmp];
+                              }
+                            }
+                            END_PAR_LOOP()
+                          }),
+                useUnorm8 ? VK_FORMAT_R8G8B8A8_UNORM : VK_FORMAT_R32G32B32A32_SFLOAT,
                 m_alloc->acquireSampler(sampler_info), m_colorsMap);
     // memory statistics
-    m_modelMemoryStats.srcSh0  = splatCount * 4 * sizeof(float);  // original sh0 and opacity are floats
-    m_modelMemoryStats.odevSh0 = splatCount * 4 * sizeof(uint8_t);
-    m_modelMemoryStats.devSh0  = mapSize.x * mapSize.y * 4 * sizeof(uint8_t);
+    m_modelMemoryStats.srcSh0  = uint64_t(splatCount) * 4 * sizeof(float);  // original sh0 and opacity are floats
+    m_modelMemoryStats.odevSh0 = uint64_t(splatCount) * 4 * elementSize;
+    m_modelMemoryStats.devSh0  = uint64_t(mapSize.x) * mapSize.y * 4 * elementSize;
+  }
+  // Prepare the spherical harmonics of degree 1 to 3, vector quantized
+  if(m_defines.shFormat == FORMAT_VQ)
+  {
+    // one code per texel, the codebook is a storage buffer as with data buffers
+    const SplatAttributeView srcSh = m_splatSet.f_restView();
+    const ShCodebook*        cached = nullptr;
+    ShCodebook               empty;
+    if(!acquireShCodebook(srcSh, splatCount, cached))
+    {
+      empty.codes.assign(splatCount, 0);
+      empty.entries.assign(size_t(shCodebookEntryCount(ShCodebook::s_defaultSize)) * ShCodebook::s_entryFloats, 0.0f);
+      cached = &empty;
+    }
+    const ShCodebook& codebook = *cached;
+
+    glm::ivec2 mapSize = computeDataTextureSize(1, 1, splatCount);
+
+    initTexture(mapSize.x, mapSize.y, sizeof(uint16_t),
+                fillBlock(sizeof(uint16_t),
+                          [&](uint64_t first, uint64_t count, void* dst) {
+                            memcpy(dst, codebook.codes.data() + first, count * sizeof(uint16_t));
+                          }),
+                VK_FORMAT_R16_UINT, m_alloc->acquireSampler(sampler_info), m_sphericalHarmonicsMap);
+
+    m_shCodebookDevice = m_alloc->createBuffer(codebook.entriesBytes(), bufferUsageFlags, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    m_dutil->DBG_NAME(m_shCodebookDevice.buffer);
+    m_uploader.uploadBuffer(m_shCodebookDevice.buffer, codebook.entries.data(), codebook.entriesBytes());
+
+    // memory statistics
+    m_modelMemoryStats.srcShOther  = uint64_t(splatCount) * srcSh.components * sizeof(float);
+    m_modelMemoryStats.odevShOther = uint64_t(splatCount) * sizeof(uint16_t) + codebook.entriesBytes();
+    m_modelMemoryStats.devShOther  = uint64_t(mapSize.x) * mapSize.y * sizeof(uint16_t) + codebook.entriesBytes();
   }
   // Prepare the spherical harmonics of degree 1 to 3
+  else
   {
-    const uint32_t sphericalHarmonicsElementsPerTexel       = 4;
-    const uint32_t totalSphericalHarmonicsComponentCount    = (uint32_t)m_splatSet.f_rest.size() / splatCount;
-    const uint32_t sphericalHarmonicsCoefficientsPerChannel = totalSphericalHarmonicsComponentCount / 3;
+    const uint32_t           sphericalHarmonicsElementsPerTexel       = 4;
+    const SplatAttributeView srcSh                                    = m_splatSet.f_restView();
+    const uint32_t           totalSphericalHarmonicsComponentCount    = srcSh.components;
+    const uint32_t           sphericalHarmonicsCoefficientsPerChannel = totalSphericalHarmonicsComponentCount / 3;
     // find the maximum SH degree stored in the file
     int sphericalHarmonicsDegree = 0;
     if(sphericalHarmonicsCoefficientsPerChannel >= 3)
@@ -1424,78 +2851,38 @@ void GaussianSplatting::initDataTextures(void)
     glm::ivec2 mapSize =
         computeDataTextureSize(sphericalHarmonicsElementsPerTexel, paddedSphericalHarmonicsComponentCount, splatCount);
 
-    const uint32_t bufferSize = mapSize.x * mapSize.y * sphericalHarmonicsElementsPerTexel * formatSize(m_defines.shFormat);
-
-    std::vector<uint8_t> paddedSHArray(bufferSize, 0);
-
-    void* data = (void*)paddedSHArray.data();
-
-    //for(uint32_t splatIdx = 0; splatIdx < splatCount; ++splatIdx)
-    START_PAR_LOOP(splatCount, splatIdx)
-    {
-      const auto srcBase   = totalSphericalHarmonicsComponentCount * splatIdx;
-      const auto destBase  = paddedSphericalHarmonicsComponentCount * splatIdx;
-      int        dstOffset = 0;
-      // degree 1, three coefs per component
-      for(auto i = 0; i < 3; i++)
-      {
-        for(auto rgb = 0; rgb < 3; rgb++)
-        {
-          const auto srcIndex = srcBase + (sphericalHarmonicsCoefficientsPerChannel * rgb + i);
-          const auto dstIndex = destBase + dstOffset++;  // inc after add
-
-          storeSh(m_defines.shFormat, m_splatSet.f_rest.data(), srcIndex, data, dstIndex);
-        }
-      }
-
-      // degree 2, five coefs per component
-      for(auto i = 0; i < 5; i++)
-      {
-        for(auto rgb = 0; rgb < 3; rgb++)
-        {
-          const auto srcIndex = srcBase + (sphericalHarmonicsCoefficientsPerChannel * rgb + 3 + i);
-          const auto dstIndex = destBase + dstOffset++;  // inc after add
-
-          storeSh(m_defines.shFormat, m_splatSet.f_rest.data(), srcIndex, data, dstIndex);
-        }
-      }
-      // degree 3, seven coefs per component
-      for(auto i = 0; i < 7; i++)
-      {
-        for(auto rgb = 0; rgb < 3; rgb++)
-        {
-          const auto srcIndex = srcBase + (sphericalHarmonicsCoefficientsPerChannel * rgb + 3 + 5 + i);
-          const auto dstIndex = destBase + dstOffset++;  // inc after add
-
-          storeSh(m_defines.shFormat, m_splatSet.f_rest.data(), srcIndex, data, dstIndex);
-        }
-      }
-    }
-    END_PAR_LOOP()
+    const uint64_t bufferSize = uint64_t(mapSize.x) * mapSize.y * sphericalHarmonicsElementsPerTexel * formatSize(m_defines.shFormat);
 
     // place the result in the dedicated texture map
-    if(m_defines.shFormat == FORMAT_FLOAT32)
-    {
-      initTexture(mapSize.x, mapSize.y, bufferSize, data, VK_FORMAT_R32G32B32A32_SFLOAT,
-                  m_alloc->acquireSampler(sampler_info), m_sphericalHarmonicsMap);
-    }
-    else if(m_defines.shFormat == FORMAT_FLOAT16)
-    {
-      initTexture(mapSize.x, mapSize.y, bufferSize, data, VK_FORMAT_R16G16B16A16_SFLOAT,
-                  m_alloc->acquireSampler(sampler_info), m_sphericalHarmonicsMap);
-    }
+    VkFormat format = VK_FORMAT_R32G32B32A32_SFLOAT;
+    if(m_defines.shFormat == FORMAT_FLOAT16)
+      format = VK_FORMAT_R16G16B16A16_SFLOAT;
     else if(m_defines.shFormat == FORMAT_UINT8)
-    {
-      initTexture(mapSize.x, mapSize.y, bufferSize, data, VK_FORMAT_R8G8B8A8_UNORM,
-                  m_alloc->acquireSampler(sampler_info), m_sphericalHarmonicsMap);
-    }
+      format = VK_FORMAT_R8G8B8A8_UNORM;
+
+    initTexture(mapSize.x, mapSize.y, sphericalHarmonicsElementsPerTexel * formatSize(m_defines.shFormat),
+                fillBlock(uint64_t(paddedSphericalHarmonicsComponentCount) * formatSize(m_defines.shFormat),
+                          [&](uint64_t first, uint64_t count, void* dst) {
+                            SplatAttributeView block = srcSh;
+                            block.data += first * srcSh.stride;
+                            packSphericalHarmonics(m_defines.shFormat, sphericalHarmonicsDegree, block, uint32_t(count),
+                                                   dst, paddedSphericalHarmonicsComponentCount);
+                          }),
+                format, m_alloc->acquireSampler(sampler_info), m_sphericalHarmonicsMap);
 
     // memory statistics
-    m_modelMemoryStats.srcShOther  = (uint32_t)m_splatSet.f_rest.size() * sizeof(float);
-    m_modelMemoryStats.odevShOther = (uint32_t)m_splatSet.f_rest.size() * formatSize(m_defines.shFormat);
+    m_modelMemoryStats.srcShOther  = uint64_t(splatCount) * totalSphericalHarmonicsComponentCount * sizeof(float);
+    m_modelMemoryStats.odevShOther = uint64_t(splatCount) * totalSphericalHarmonicsComponentCount * formatSize(m_defines.shFormat);
     m_modelMemoryStats.devShOther  = bufferSize;
   }
 
+  // the next frames wait for the end of the copies on the device, not here
+  m_uploader.flush();
+  const SplatUploader::Stats& uploadStats = m_uploader.stats();
+  std::cout << "Uploaded " << (uploadStats.bytes >> 20) << "MB in " << uploadStats.blocks << " blocks on the "
+            << (m_uploader.isAsynchronous() ? "transfer" : "graphics") << " queue, " << uploadStats.hostWaitTime
+            << "ms waiting for staging slots" << std::endl;
+
   // update statistics totals
   m_modelMemoryStats.srcShAll  = m_modelMemoryStats.srcSh0 + m_modelMemoryStats.srcShOther;
   m_modelMemoryStats.odevShAll = m_modelMemoryStats.odevSh0 + m_modelMemoryStats.odevShOther;
@@ -1519,6 +2906,52 @@ void GaussianSplatting::deinitDataTextures()
   deinitTexture(m_colorsMap);
   deinitTexture(m_covariancesMap);
   deinitTexture(m_sphericalHarmonicsMap);
+  m_alloc->destroy(m_shCodebookDevice);
+  m_alloc->destroy(m_centersBoundsDevice);
+}
+
+std::vector<std::pair<const char*, uint64_t>> GaussianSplatting::memoryStatsEntries() const
+{
+  const ModelMemoryStats&  model  = m_modelMemoryStats;
+  const RenderMemoryStats& render = m_renderMemoryStats;
+  return {{"srcAll", model.srcAll},
+          {"srcCenters", model.srcCenters},
+          {"srcCov", model.srcCov},
+          {"srcShAll", model.srcShAll},
+          {"srcSh0", model.srcSh0},
+          {"srcShOther", model.srcShOther},
+          {"devAll", model.devAll},
+          {"devCenters", model.devCenters},
+          {"devCov", model.devCov},
+          {"devShAll", model.devShAll},
+          {"devSh0", model.devSh0},
+          {"devShOther", model.devShOther},
+          {"odevAll", model.odevAll},
+          {"odevCenters", model.odevCenters},
+          {"odevCov", model.odevCov},
+          {"odevShAll", model.odevShAll},
+          {"odevSh0", model.odevSh0},
+          {"odevShOther", model.odevShOther},
+          {"usedUboFrameInfo", render.usedUboFrameInfo},
+          {"usedIndirect", render.usedIndirect},
+          {"hostAllocDistances", render.hostAllocDistances},
+          {"hostAllocIndices", render.hostAllocIndices},
+          {"allocIndices", render.allocIndices},
+          {"usedIndices", render.usedIndices},
+          {"allocDistances", render.allocDistances},
+          {"usedDistances", render.usedDistances},
+          {"allocVdrxInternal", render.allocVdrxInternal},
+          {"hostAllocChunks", render.hostAllocChunks},
+          {"allocChunks", render.allocChunks},
+          {"usedChunks", render.usedChunks},
+          {"allocLod", render.allocLod},
+          {"hostAllocStaging", render.hostAllocStaging},
+          {"allocChunkSlots", render.allocChunkSlots},
+          {"hostAllocUpload", render.hostAllocUpload},
+          {"allocTiles", render.allocTiles},
+          {"hostTotal", render.hostTotal},
+          {"deviceUsedTotal", render.deviceUsedTotal},
+          {"deviceAllocTotal", render.deviceAllocTotal}};
 }
 
 void GaussianSplatting::benchmarkAdvance()
@@ -1531,5 +2964,44 @@ void GaussianSplatting::benchmarkAdvance()
   std::cout << " Memory Rendering; Host used \t" << m_renderMemoryStats.hostTotal << "; Device Used \t"
             << m_renderMemoryStats.deviceUsedTotal << "; Device Allocated \t" << m_renderMemoryStats.deviceAllocTotal
             << "; (bytes)" << std::endl;
+  const SplatResidency::Stats& streaming = m_residency.stats();
+  if(streamingEnabled())
+  {
+    std::cout << " Streaming; Resident chunks \t" << m_residency.residentCount() << "; Slots \t" << m_residency.slotCount()
+              << "; Missing chunks \t" << streaming.missingChunks << "; Uploads \t" << streaming.totalUploads
+              << "; Evictions \t" << streaming.totalEvictions << "; Uploaded \t" << streaming.totalUploadedBytes
+              << "; (chunks, bytes)" << std::endl;
+  }
   std::cout << "}" << std::endl;
+
+  // machine readable lines, all the stats in bytes, the text above is kept for benchmark.py
+  // the streaming counters are zero when the whole model is resident
+  auto entries = memoryStatsEntries();
+  entries.insert(entries.end(), {{"streamResidentChunks", m_residency.residentCount()},
+                                 {"streamMissingChunks", streaming.missingChunks},
+                                 {"streamUploads", streaming.totalUploads},
+                                 {"streamEvictions", streaming.totalEvictions},
+                                 {"streamUploadedBytes", streaming.totalUploadedBytes}});
+  if(m_statsFormat == STATS_FORMAT_JSON)
+  {
+    std::cout << "BENCHMARK_ADV_JSON {\"id\": " << m_benchmarkId;
+    for(const auto& [name, value] : entries)
+      std::cout << ", \"" << name << "\": " << value;
+    std::cout << "}" << std::endl;
+  }
+  else if(m_statsFormat == STATS_FORMAT_CSV)
+  {
+    // header once, before the first line
+    if(m_benchmarkId == 1)
+    {
+      std::cout << "BENCHMARK_ADV_CSV id";
+      for(const auto& entry : entries)
+        std::cout << "," << entry.first;
+      std::cout << std::endl;
+    }
+    std::cout << "BENCHMARK_ADV_CSV " << m_benchmarkId;
+    for(const auto& entry : entries)
+      std::cout << "," << entry.second;
+    std::cout << std::endl;
+  }
 }
\ No newline at end of file
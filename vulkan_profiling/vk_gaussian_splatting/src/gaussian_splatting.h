@@ -83,7 +83,17 @@
 
 #include "splat_set.h"
 #include "ply_async_loader.h"
+#include "splat_cache.h"
+#include "sh_codebook.h"
 #include "splat_sorter_async.h"
+#include "splat_chunks.h"
+#include "splat_lod.h"
+#include "splat_residency.h"
+#include "splat_uploader.h"
+#include "view_batch.h"
+#include "stage_profiler.h"
+#include "shader_variant_cache.h"
+#include "pipeline_cache.h"
 #include <argparse/argparse.hpp>
 
 //
@@ -116,6 +126,9 @@ public:  // Methods specializing IAppElement
   // handle recent files save/load at imgui level
   void registerRecentFilesHandler();
 
+  // process exit code, non zero when the --checkcompute measure failed
+  int exitCode() const { return m_checkComputePassed ? 0 : 1; }
+
 private:  // Methods
   void initGbuffers(const glm::vec2& size);
 
@@ -151,6 +164,12 @@ private:  // Methods
   // release buffers at next frame
   void deinitDataBuffers(void);
 
+  // format of the colors with data buffers, FORMAT_FLOAT32 or FORMAT_UINT8
+  inline int colorsBufferFormat() const
+  {
+    return m_defines.colorsFormat == FORMAT_UINT8 ? FORMAT_UINT8 : FORMAT_FLOAT32;
+  }
+
   // create the texture maps on the device and upload
   // the splat set data from host to device
   void initDataTextures(void);
@@ -158,6 +177,10 @@ private:  // Methods
   // release textures at next frame
   void deinitDataTextures(void);
 
+  // the SH codebook of the splat set for FORMAT_VQ, built on first use and reused by the next
+  // inits of the data buffers or textures with the same key, returns false if it cannot be built
+  bool acquireShCodebook(const SplatAttributeView& srcSh, uint32_t splatCount, const ShCodebook*& codebook);
+
   void initPipelines();
 
   void deinitPipelines();
@@ -170,9 +193,15 @@ private:  // Methods
 
   void deinitShaders(void);
 
-  // Create texture, upload data and assign sampler
-  // sampler will be released by deinitTexture
-  void initTexture(uint32_t width, uint32_t height, uint32_t bufsize, void* data, VkFormat format, const VkSampler& sampler, nvvk::Texture& texture);
+  // Create texture, upload the texels of texelBytes bytes produced by fill and assign sampler
+  // sampler will be released by deinitTexture, the texture is usable once m_uploader is flushed
+  void initTexture(uint32_t                        width,
+                   uint32_t                        height,
+                   uint32_t                        texelBytes,
+                   const SplatUploader::FillFunc& fill,
+                   VkFormat                        format,
+                   const VkSampler&                sampler,
+                   nvvk::Texture&                  texture);
 
   // Destroy texture at once, texture must not be in use
   void deinitTexture(nvvk::Texture& texture);
@@ -191,8 +220,9 @@ private:  // Methods
   inline void resetRenderSettings()
   {
     m_frameInfo   = {};
-    m_defines     = {};
+    m_defines     = m_defaultDefines;
     m_cpuLazySort = true;
+    m_cpuSortCoherence = {};
   }
 
   // reset the memory usage stats
@@ -206,10 +236,78 @@ private:  // Methods
 
   void tryConsumeAndUploadCpuSortingResult(VkCommandBuffer cmd, const uint32_t splatCount);
 
+  // true if the host indices buffer is neither written by the CPU sorter nor read by a frame in flight
+  inline bool isSplatIndicesHostAvailable(int bufferIdx) const
+  {
+    return bufferIdx != m_splatIndicesSorting && m_frameIndex >= m_splatIndicesHostFreeAt[bufferIdx];
+  }
+
+  // requests a sort order check, the next frame is sorted on the GPU and its
+  // sorted indices are read back, see readBackGpuSortOrder
+  void checkCpuSortOrder();
+
+  // copies the visible count and the sorted indices of the GPU sort to m_sortCheckReadbackHost
+  void readBackGpuSortOrder(VkCommandBuffer cmd, const uint32_t splatCount);
+
+  // compares the GPU sorted indices read back with the last CPU sorted order,
+  // reports in m_cpuSortCheckResult
+  void compareSortOrders();
+
   void processSortingOnGPU(VkCommandBuffer cmd, const uint32_t splatCount);
 
+  // chunk culling in use, CHUNK_CULLING_NONE if frustum culling is disabled
+  inline int chunkCullingMode() const
+  {
+    return m_defines.frustumCulling == FRUSTUM_CULLING_NONE ? CHUNK_CULLING_NONE : m_defines.chunkCulling;
+  }
+
+  // first culling level of processSortingOnGPU with CHUNK_CULLING_CPU. Writes the visible chunks
+  // in the slice of m_visibleChunksHost of the frame, records the copy to m_visibleChunksDevice
+  // and sets the chunk counts of params, which are uploaded to m_indirect afterward.
+  void cullChunksOnCPU(VkCommandBuffer cmd, shaderio::IndirectParams& params);
+
+  // out of core streaming in use, the pools only exist with data buffers
+  inline bool streamingEnabled() const { return m_streamingPoolSize > 0 && m_defines.dataStorage == STORAGE_BUFFERS; }
+
+  // updates the residency of the chunks for the view of the frame, see splat_residency.h. Writes
+  // the payloads of the uploaded chunks and the changed slots in the slice of m_streamingStagingHost
+  // of the frame and records the copies to the pools and to m_chunkSlotsDevice.
+  void updateSplatResidency(VkCommandBuffer cmd);
+
   void drawSplatPrimitives(VkCommandBuffer cmd, const uint32_t splatCount);
 
+  // compute pipeline (PIPELINE_COMPUTE), emits the tile keys of the sorted splats, sorts them,
+  // finds the range of each tile and blends the tiles front to back into the color image
+  void rasterizeSplatTiles(VkCommandBuffer cmd, const uint32_t splatCount);
+
+  // (re)allocates the buffers of the compute pipeline when the image, the splats or the tile entries
+  // of a previous frame (see IndirectParams::tileEntryCount) do not fit anymore, and writes their
+  // descriptors if needed. Idles the device when doing so.
+  void updateTileBuffers(const uint32_t splatCount);
+  // the device must be idle
+  void deinitTileBuffers();
+
+  // what a PSNR measure compares
+  enum PsnrMeasure
+  {
+    PSNR_MEASURE_LOD,      // current level of detail threshold against full detail
+    PSNR_MEASURE_PIPELINE  // compute pipeline against a raster pipeline
+  };
+  // starts a PSNR measure, rendered by the next two frames
+  void startPsnrMeasure(PsnrMeasure measure);
+  // selects the pipeline of the frame when a pipeline PSNR measure is running,
+  // called before anything depending on the pipeline is recorded
+  void applyPsnrMeasurePipeline();
+  // advances the PSNR measure started from the UI or the command line. Copies the color
+  // image of the reference frame and of the next one (test) to host, then compares them
+  // once the copies are completed. For PSNR_MEASURE_LOD the reference is rendered at full
+  // detail and the test with the current threshold, see m_lodPsnrResult. For PSNR_MEASURE_PIPELINE
+  // the reference is rendered with a raster pipeline and the test with the compute pipeline,
+  // see m_pipelinePsnrResult.
+  void processPsnrMeasure(VkCommandBuffer cmd);
+  // stops a running measure and releases its copies, the device must be idle
+  void cancelPsnrMeasure();
+
   // for statistics display in the UI
   // copy form m_indirectReadbackHost updated at previous frame to m_indirectReadback
   void collectReadBackValuesIfNeeded(void);
@@ -224,17 +322,30 @@ private:  // Methods
 
   void benchmarkAdvance();
 
+  // all the memory statistics by name, for the json and csv exports
+  std::vector<std::pair<const char*, uint64_t>> memoryStatsEntries() const;
+
+  // advances the --views batch by one frame, applies the poses
+  // and requests the screenshots, closes the app when done
+  void processViewBatch();
+
   ////////
   // UI
 
   // for multiple choice selectors in the UI
   enum GuiEnums
   {
-    GUI_STORAGE,          // model storage in VRAM (in texture or buffer)
-    GUI_SORTING,          // the sorting method to use
-    GUI_PIPELINE,         // the rendering pipeline to use
-    GUI_FRUSTUM_CULLING,  // where to perform frustum culling (or disabled)
-    GUI_SH_FORMAT         // data format for storage of SH in VRAM
+    GUI_STORAGE,             // model storage in VRAM (in texture or buffer)
+    GUI_SORTING,             // the sorting method to use
+    GUI_SORT_KEY,            // the distance used as sorting key
+    GUI_PIPELINE,            // the rendering pipeline to use
+    GUI_FRUSTUM_CULLING,     // where to perform frustum culling (or disabled)
+    GUI_SH_FORMAT,           // data format for storage of SH in VRAM
+    GUI_CENTERS_FORMAT,      // data format for storage of centers in VRAM
+    GUI_COVARIANCES_FORMAT,  // data format for storage of covariances in VRAM
+    GUI_COLORS_FORMAT,       // data format for storage of colors in VRAM
+    GUI_SPATIAL_ORDER,       // order of the splats in VRAM
+    GUI_CHUNK_CULLING        // where to cull the chunks of splats (or disabled)
   };
 
   // initialize UI specifics
@@ -255,6 +366,27 @@ private:  // Attributes
   std::string m_outputFilename;
   bool       m_outputScreenshot = false;
   int fc = 0;  // frame count for screenshot
+  // batch rendering of the viewpoints of a --views file
+  ViewBatch m_viewBatch;
+  bool      m_useViewBatch = false;
+  // GPU time of the stages of onRender, per viewpoint of the batch and for the whole run
+  StageProfiler m_stageProfiler;
+  // stage times file written at exit and after each timed viewpoint, csv or json by extension
+  std::string m_stageTimesFilename;
+  // read/write preprocessed data buffers from/to a .splatcache file next to the ply
+  bool m_useSplatCache = true;
+  // order of the splats in memory, a SpatialOrder applied at load time
+  int m_spatialOrder = E_ORDER_FILE;
+  // build the level of detail hierarchy at load time
+  bool m_lodEnabled = false;
+  // size in MB of the device pools of the streamed attributes, 0 keeps the whole model resident
+  int m_streamingPoolSize = 0;
+  // folder of the SPIR-V variant cache, empty to disable, spirv_cache next to the executable by default
+  std::string m_shaderCacheFolder;
+  // pipeline cache file shared with the other renderers, empty to disable
+  std::string m_pipelineCacheFilename = vkprof::PersistentPipelineCache::defaultPath();
+  // chunks uploaded per frame at most, up to s_streamingMaxUploads
+  int m_streamingUploadsPerFrame = 64;
   // do we load a default scene at startup if none is provided through CLI
   bool m_enableDefaultScene = true;
   // Recent files list
@@ -266,14 +398,28 @@ private:  // Attributes
 
   // counting benchmark steps
   int m_benchmarkId = 0;
+  // additional machine readable report of the stats by benchmarkAdvance
+  enum StatsFormat
+  {
+    STATS_FORMAT_TEXT,  // BENCHMARK_ADV text block only
+    STATS_FORMAT_JSON,  // plus one BENCHMARK_ADV_JSON line per step
+    STATS_FORMAT_CSV    // plus one BENCHMARK_ADV_CSV line per step, header at first step
+  };
+  StatsFormat m_statsFormat = STATS_FORMAT_TEXT;
 
   // hide/show ui elements
   bool m_showUI = false;
   // UI utility for choice menus
   ImGuiH::Registry m_ui;
   // cpu sorter feedback for ui
-  double m_distTime = 0.0;  // distance compute time in ms
-  double m_sortTime = 0.0;  // sorting compute time in ms
+  double m_distTime        = 0.0;    // distance compute time in ms
+  double m_sortTime        = 0.0;    // sorting compute time in ms
+  bool   m_cpuSortConsumed = false;  // the last frame consumed a new CPU sort, of the times above
+  // chunk culling feedback for ui
+  double m_chunkCullTime = 0.0;  // CPU chunk culling time in ms
+  uint32_t m_cpuVisibleChunkCount = 0;  // visible chunks of the last CPU chunk culling
+  // streaming feedback for ui
+  double m_streamingTime = 0.0;  // residency update and staging time in ms
 
   //
   nvvkhl::Application*                     m_app{nullptr};
@@ -329,11 +475,38 @@ private:  // Attributes
   nvvk::Texture m_covariancesMap;
   nvvk::Texture m_sphericalHarmonicsMap;
 
+  // uploads of the data buffers and textures, on the transfer queue if any
+  SplatUploader m_uploader;
+
+  // used by every pipeline creation, loaded in onAttach and saved in onDetach
+  vkprof::PersistentPipelineCache m_pipelineCache;
+
   // Data buffers
   nvvk::Buffer m_centersDevice;
   nvvk::Buffer m_colorsDevice;
   nvvk::Buffer m_covariancesDevice;
   nvvk::Buffer m_sphericalHarmonicsDevice;
+  nvvk::Buffer m_shCodebookDevice;     // entries of the SH codebook, with FORMAT_VQ only
+  nvvk::Buffer m_centersBoundsDevice;  // bounds of the chunks of centers, with FORMAT_UNORM16 centers only
+
+  // chunks of splats for the two level frustum culling, see splat_chunks.h
+  std::vector<float> m_chunkBounds;           // CHUNK_BOUNDS_FLOATS per chunk, computed at load time
+  nvvk::Buffer       m_chunkBoundsDevice;     // copy of m_chunkBounds on device
+  nvvk::Buffer       m_visibleChunksDevice;   // indices of the visible chunks read by the distance shader
+  nvvk::Buffer       m_visibleChunksHost;     // one slice per frame in flight, written by CHUNK_CULLING_CPU
+  uint32_t*          m_visibleChunksHostMapped = nullptr;
+
+  // level of detail hierarchy, see splat_lod.h. radius (as float bits) and parent per splat
+  nvvk::Buffer m_lodNodesDevice;
+
+  // out of core streaming, see splat_residency.h. The covariances, colors and SH buffers
+  // are then pools of slots of SPLAT_CHUNK_SIZE splats
+  SplatResidency            m_residency;
+  nvvk::Buffer              m_chunkSlotsDevice;      // slot per chunk, read by the shaders
+  nvvk::Buffer              m_streamingStagingHost;  // one slice per frame in flight, payloads then slots
+  uint8_t*                  m_streamingStagingHostMapped = nullptr;
+  uint64_t                  m_streamingSliceSize         = 0;
+  static constexpr uint32_t s_streamingMaxUploads        = 256;  // chunks per slice
 
   // rasterization pipeline selector
   uint32_t m_selectedPipeline = PIPELINE_MESH;
@@ -341,27 +514,109 @@ private:  // Attributes
   // CPU async sorting
   SplatSorterAsync      m_cpuSorter;
   bool                  m_cpuLazySort = true;  // if true, sorting starts only if viewpoint changed
-  std::vector<uint32_t> m_splatIndices;        // the array of cpu sorted indices to use for rendering
+  SplatSorterAsync::CoherenceSettings m_cpuSortCoherence;  // reuse of the previous order for small viewpoint changes
+  glm::mat4   m_cpuSortRequestedView = glm::mat4(1.0f);  // view matrix of the running CPU sort
+  glm::mat4   m_cpuSortedView        = glm::mat4(1.0f);  // view matrix of the current sorted indices
+  std::string m_cpuSortCheckResult;                      // result of last checkCpuSortOrder
+  // CPU sort order check, see checkCpuSortOrder
+  enum SortCheckStep
+  {
+    SORT_CHECK_IDLE,       // no check running
+    SORT_CHECK_REQUESTED,  // next frame is sorted on the GPU and its indices read back
+    SORT_CHECK_WAIT        // waits for the copy before comparing the orders
+  };
+  SortCheckStep m_sortCheckStep       = SORT_CHECK_IDLE;
+  uint64_t      m_sortCheckReadyAt    = 0;                   // frame index from which the copy is completed
+  glm::mat4     m_sortCheckView       = glm::mat4(1.0f);     // view matrix of the GPU sorted frame
+  glm::mat4     m_sortCheckProjection = glm::mat4(1.0f);     // projection matrix of the GPU sorted frame
+  int           m_sortCheckKeyMode    = SORT_KEY_NDC_DEPTH;  // sort key of the GPU sorted frame
+  nvvk::Buffer  m_sortCheckReadbackHost;                     // visible count then indices of the GPU sorted frame
+  bool          m_cpuIndicesStale = false;  // device indices overwritten by the check, uploaded again by the CPU path
+  std::string m_shPackingBenchmarkResult;                // report of the last SH packing benchmark
+  std::string m_shCodebookReport;                        // quality and footprint of the last SH codebook
+  // SH codebook built by acquireShCodebook, with its key and report, released by deinitScene
+  ShCodebookKey m_shCodebookKey;
+  ShCodebook    m_shCodebook;
+  std::string   m_shCodebookBuildReport;
+  std::string m_localityBenchmarkResult;                 // report of the last spatial order benchmark
+  // PSNR measures, see processPsnrMeasure
+  enum PsnrStep
+  {
+    PSNR_IDLE,       // no measure running
+    PSNR_REFERENCE,  // next frame renders the reference, copied to m_psnrImages[0]
+    PSNR_TEST,       // next frame renders the image to measure, copied to m_psnrImages[1]
+    PSNR_WAIT        // waits for the copies before comparing the images
+  };
+  // minimum PSNR of the compute pipeline against the raster ones, the blending differs by the
+  // 8 bits rounding of each layer with the raster pipelines and by the saturation of the compute one
+  static constexpr double     s_pipelinePsnrThreshold = 35.0;
+  PsnrStep                    m_psnrStep    = PSNR_IDLE;
+  PsnrMeasure                 m_psnrMeasure = PSNR_MEASURE_LOD;
+  uint64_t                    m_psnrReadyAt = 0;  // frame index from which the copies are completed
+  std::array<nvvk::Buffer, 2> m_psnrImages;       // RGBA8 copies of the color image, reference then test
+  uint32_t                    m_psnrUserPipeline      = PIPELINE_MESH;  // restored at the end of a pipeline measure
+  uint32_t                    m_psnrReferencePipeline = PIPELINE_VERT;  // raster pipeline of a pipeline measure
+  std::string                 m_lodPsnrResult;                          // report of the last lod measure
+  std::string                 m_pipelinePsnrResult;                     // report of the last pipeline measure
+  bool                        m_pipelinePsnrPassed = true;              // last pipeline measure above the threshold
+  // --checkcompute, runs a pipeline measure once the scene is rendered, another one
+  // with the camera inside the splat cloud, then exits
+  bool m_checkCompute       = false;
+  int  m_checkComputeFrames = 0;
+  bool m_checkComputeInside = false;  // second measure, camera moved inside the cloud
+  bool m_checkComputePassed = true;   // all the measures done so far passed
   // GPU radix sort
   VrdxSorter m_gpuSorter = VK_NULL_HANDLE;
 
   // buffers used by GPU and/or CPU sort
-  nvvk::Buffer m_splatIndicesHost;      // Buffer of splat indices on host for transfers (used by CPU sort)
+  // Buffers of splat indices on host for transfers (used by CPU sort). Double buffered and persistently
+  // mapped, the CPU sorter writes directly in one while the other holds the indices in use. A buffer
+  // is written again only once the frames in flight that copy from it are completed.
+  std::array<nvvk::Buffer, 2> m_splatIndicesHost;
+  std::array<uint32_t*, 2>    m_splatIndicesHostMapped  = {nullptr, nullptr};
+  std::array<uint64_t, 2>     m_splatIndicesHostFreeAt  = {0, 0};  // frame index from which the buffer is not read by the GPU
+  int                         m_splatIndicesCurrent     = -1;      // host buffer of the indices in use, -1 if none
+  int                         m_splatIndicesSorting     = -1;      // host buffer written by the CPU sorter, -1 if none
+  uint64_t                    m_frameIndex              = 0;       // incremented at each rendered frame
+  uint64_t                    m_framesInFlight          = 3;       // frame cycle of the application, set by onAttach
   nvvk::Buffer m_splatIndicesDevice;    // Buffer of splat indices on device (used by CPU and GPU sort)
   nvvk::Buffer m_splatDistancesDevice;  // Buffer of splat indices on device (used by CPU and GPU sort)
   nvvk::Buffer m_vrdxStorageDevice;     // Used internally by VrdxSorter, GPU sort
 
+  // compute pipeline buffers, allocated by updateTileBuffers once the pipeline is used
+  nvvk::Buffer m_tileSplatsDevice;       // projected splats, one per sorted splat
+  nvvk::Buffer m_tileCountsDevice;       // tiles overlapped by each sorted splat
+  nvvk::Buffer m_tileOffsetsDevice;      // first tile entry of each sorted splat in its scan block
+  nvvk::Buffer m_tileBlockSumsDevice;    // first tile entry of each scan block
+  nvvk::Buffer m_tileKeysDevice;         // tile of each tile entry
+  nvvk::Buffer m_tileValuesDevice;       // sorted splat of each tile entry
+  nvvk::Buffer m_tileRangesDevice;       // first and end entries of each tile
+  nvvk::Buffer m_vrdxTileStorageDevice;  // Used internally by VrdxSorter, sort of the tile entries
+  uint32_t     m_tileSplatsCapacity   = 0;
+  uint32_t     m_tileEntryCapacity    = 0;
+  uint32_t     m_tileRangesCapacity   = 0;
+  bool         m_tileDescriptorsDirty = true;  // set when the descriptor set or the color image are recreated
+
   // used to load and compile shaders
   nvvk::ShaderModuleManager m_shaderManager;
+  // SPIR-V of the 3DGS shader permutations already compiled, offline or by a previous run
+  ShaderVariantCache m_shaderVariantCache;
 
   // The different shaders that are used in the pipelines
   struct Shaders
   {
     //3dgs shaders
     nvvk::ShaderModuleID distShader;
+    nvvk::ShaderModuleID chunkShader;
     nvvk::ShaderModuleID meshShader;
     nvvk::ShaderModuleID vertexShader;
     nvvk::ShaderModuleID fragmentShader;
+    nvvk::ShaderModuleID tileKeysShader;
+    nvvk::ShaderModuleID tileEmitShader;
+    nvvk::ShaderModuleID tileScanBlocksShader;
+    nvvk::ShaderModuleID tileScanSumsShader;
+    nvvk::ShaderModuleID tileRangesShader;
+    nvvk::ShaderModuleID tileBlendShader;
 
     //PBR shaders
     nvvk::ShaderModuleID pbrVertexShader;
@@ -378,14 +633,27 @@ private:  // Attributes
     int  maxShDegree             = 3;  // in [0,3]
     bool pointCloudModeEnabled   = false;
     int  shFormat                = FORMAT_FLOAT32;
+    int  centersFormat           = FORMAT_FLOAT32;  // or FORMAT_UNORM16
+    int  covariancesFormat       = FORMAT_FLOAT32;  // or FORMAT_FLOAT16
+    int  colorsFormat            = FORMAT_STORAGE_DEFAULT;  // or FORMAT_FLOAT32, FORMAT_UINT8
     int  dataStorage             = STORAGE_BUFFERS;
     bool fragmentBarycentric     = true;
+    int  chunkCulling            = CHUNK_CULLING_GPU;
   } m_defines;
+  // values restored by resetRenderSettings, the defaults modified by the command line
+  ShaderDefines m_defaultDefines;
 
   // Pipelines
   VkPipeline          m_graphicsPipeline     = VK_NULL_HANDLE;  // The graphic pipeline to render using vertex shaders
   VkPipeline          m_graphicsPipelineMesh = VK_NULL_HANDLE;  // The graphic pipeline to render using mesh shaders
   VkPipeline          m_computePipeline{};                      // The compute pipeline to compute distances and cull
+  VkPipeline          m_chunkCullPipeline{};                    // The compute pipeline to cull the chunks of splats
+  VkPipeline          m_tileKeysPipeline{};                     // The compute pipelines of PIPELINE_COMPUTE
+  VkPipeline          m_tileEmitPipeline{};                     //
+  VkPipeline          m_tileScanBlocksPipeline{};               //
+  VkPipeline          m_tileScanSumsPipeline{};                 //
+  VkPipeline          m_tileRangesPipeline{};                   //
+  VkPipeline          m_tileBlendPipeline{};                    //
   shaderio::FrameInfo m_frameInfo{};      // Frame parameters, sent to device using a uniform buffer
   nvvk::Buffer        m_frameInfoBuffer;  // uniform buffer to store frame info
 
@@ -394,58 +662,66 @@ private:  // Attributes
   {
     // Memory footprint on host memory
 
-    uint32_t srcAll     = 0;  // RAM bytes used for all the data of source model
-    uint32_t srcCenters = 0;  // RAM bytes used for splat centers of source model
+    uint64_t srcAll     = 0;  // RAM bytes used for all the data of source model
+    uint64_t srcCenters = 0;  // RAM bytes used for splat centers of source model
     // covariance
-    uint32_t srcCov = 0;
+    uint64_t srcCov = 0;
     // spherical harmonics coeficients
-    uint32_t srcShAll   = 0;  // RAM bytes used for all the SH coefs of source model
-    uint32_t srcSh0     = 0;  // RAM bytes used for SH degree 0 of source model
-    uint32_t srcShOther = 0;  // RAM bytes used for SH degree 1 of source model
+    uint64_t srcShAll   = 0;  // RAM bytes used for all the SH coefs of source model
+    uint64_t srcSh0     = 0;  // RAM bytes used for SH degree 0 of source model
+    uint64_t srcShOther = 0;  // RAM bytes used for SH degree 1 of source model
 
     // Memory footprint on device memory (allocated)
 
-    uint32_t devAll     = 0;  // GRAM bytes used for all the data of source model
-    uint32_t devCenters = 0;  // GRAM bytes used for splat centers of source model
+    uint64_t devAll     = 0;  // GRAM bytes used for all the data of source model
+    uint64_t devCenters = 0;  // GRAM bytes used for splat centers of source model
     // covariance
-    uint32_t devCov = 0;
+    uint64_t devCov = 0;
     // spherical harmonics coeficients
-    uint32_t devShAll   = 0;  // GRAM bytes used for all the SH coefs of source model
-    uint32_t devSh0     = 0;  // GRAM bytes used for SH degree 0 of source model
-    uint32_t devShOther = 0;  // GRAM bytes used for SH degree 1 of source model
+    uint64_t devShAll   = 0;  // GRAM bytes used for all the SH coefs of source model
+    uint64_t devSh0     = 0;  // GRAM bytes used for SH degree 0 of source model
+    uint64_t devShOther = 0;  // GRAM bytes used for SH degree 1 of source model
 
 
     // Actual data size within textures (a.k.a. mem footprint minus padding and
     // eventual unused components)
 
-    uint32_t odevAll     = 0;  // GRAM bytes used for all the data of source model
-    uint32_t odevCenters = 0;  // GRAM bytes used for splat centers of source model
+    uint64_t odevAll     = 0;  // GRAM bytes used for all the data of source model
+    uint64_t odevCenters = 0;  // GRAM bytes used for splat centers of source model
     // covariance
-    uint32_t odevCov = 0;
+    uint64_t odevCov = 0;
     // spherical harmonics coeficients
-    uint32_t odevShAll   = 0;  // GRAM bytes used for all the SH coefs of source model
-    uint32_t odevSh0     = 0;  // GRAM bytes used for SH degree 0 of source model
-    uint32_t odevShOther = 0;  // GRAM bytes used for SH degree 1 of source model
+    uint64_t odevShAll   = 0;  // GRAM bytes used for all the SH coefs of source model
+    uint64_t odevSh0     = 0;  // GRAM bytes used for SH degree 0 of source model
+    uint64_t odevShOther = 0;  // GRAM bytes used for SH degree 1 of source model
   } m_modelMemoryStats;
 
   // Rendering (sorting and splatting) related memory usage statistics
   struct RenderMemoryStats
   {
-    uint32_t usedUboFrameInfo = 0;  // used = alloc all the time
-    uint32_t usedIndirect     = 0;  // used = alloc all the time, for the active pipeline
-
-    uint32_t hostAllocDistances = 0;  // used = alloc
-    uint32_t hostAllocIndices   = 0;  // used = alloc
-
-    uint32_t allocIndices      = 0;
-    uint32_t usedIndices       = 0;
-    uint32_t allocDistances    = 0;
-    uint32_t usedDistances     = 0;
-    uint32_t allocVdrxInternal = 0;  // used is unknown
-
-    uint32_t hostTotal        = 0;
-    uint32_t deviceUsedTotal  = 0;
-    uint32_t deviceAllocTotal = 0;
+    uint64_t usedUboFrameInfo = 0;  // used = alloc all the time
+    uint64_t usedIndirect     = 0;  // used = alloc all the time, for the active pipeline
+
+    uint64_t hostAllocDistances = 0;  // used = alloc
+    uint64_t hostAllocIndices   = 0;  // used = alloc
+
+    uint64_t allocIndices      = 0;
+    uint64_t usedIndices       = 0;
+    uint64_t allocDistances    = 0;
+    uint64_t usedDistances     = 0;
+    uint64_t allocVdrxInternal = 0;  // used is unknown
+    uint64_t hostAllocChunks   = 0;  // used = alloc, CHUNK_CULLING_CPU only
+    uint64_t allocChunks       = 0;  // bounds and visible list
+    uint64_t usedChunks        = 0;
+    uint64_t allocLod          = 0;  // used = alloc, level of detail nodes
+    uint64_t hostAllocStaging  = 0;  // used = alloc, staging slices of the streaming
+    uint64_t allocChunkSlots   = 0;  // used = alloc, slots of the chunks for the streaming
+    uint64_t hostAllocUpload   = 0;  // used = alloc, staging ring of the uploads of the splat data
+    uint64_t allocTiles        = 0;  // used is unknown, buffers of the compute pipeline once used
+
+    uint64_t hostTotal        = 0;
+    uint64_t deviceUsedTotal  = 0;
+    uint64_t deviceAllocTotal = 0;
 
   } m_renderMemoryStats;
 };
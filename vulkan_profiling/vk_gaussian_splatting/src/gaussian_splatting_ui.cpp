@@ -24,6 +24,7 @@
 // clang-format on
 
 #include <gaussian_splatting.h>
+#include "sh_packing.h"
 
 std::string formatMemorySize(size_t sizeInBytes)
 {
@@ -73,14 +74,40 @@ void GaussianSplatting::initGui()
   // Pipeline selector
   m_ui.enumAdd(GUI_PIPELINE, PIPELINE_VERT, "Vertex shader");
   m_ui.enumAdd(GUI_PIPELINE, PIPELINE_MESH, "Mesh shader");
+  m_ui.enumAdd(GUI_PIPELINE, PIPELINE_COMPUTE, "Compute tiles");
   // m_ui.enumAdd(GUI_PIPELINE, PIPELINE_RTX,  "Ray tracing", true);  // disabled for the time being, not implemented
   // Sorting method selector
   m_ui.enumAdd(GUI_SORTING, SORTING_GPU_SYNC_RADIX, "GPU radix sort");
-  m_ui.enumAdd(GUI_SORTING, SORTING_CPU_ASYNC_MULTI, "CPU async std multi");
+  m_ui.enumAdd(GUI_SORTING, SORTING_CPU_ASYNC_MULTI, "CPU async radix multi");
+  m_ui.enumAdd(GUI_SORTING, SORTING_CPU_ASYNC_MONO, "CPU async std mono");
+
+  m_ui.enumAdd(GUI_SORT_KEY, SORT_KEY_PLANE_DISTANCE, "Plane distance");
+  m_ui.enumAdd(GUI_SORT_KEY, SORT_KEY_VIEW_DEPTH, "View depth");
+  m_ui.enumAdd(GUI_SORT_KEY, SORT_KEY_RADIAL_DISTANCE, "Radial distance");
+  m_ui.enumAdd(GUI_SORT_KEY, SORT_KEY_NDC_DEPTH, "NDC depth");
   //
   m_ui.enumAdd(GUI_SH_FORMAT, FORMAT_FLOAT32, "Float 32");
   m_ui.enumAdd(GUI_SH_FORMAT, FORMAT_FLOAT16, "Float 16");
   m_ui.enumAdd(GUI_SH_FORMAT, FORMAT_UINT8, "Uint8");
+  m_ui.enumAdd(GUI_SH_FORMAT, FORMAT_VQ, "VQ codebook");
+
+  m_ui.enumAdd(GUI_CENTERS_FORMAT, FORMAT_FLOAT32, "Float 32");
+  m_ui.enumAdd(GUI_CENTERS_FORMAT, FORMAT_UNORM16, "Unorm16 per chunk");
+
+  m_ui.enumAdd(GUI_COVARIANCES_FORMAT, FORMAT_FLOAT32, "Float 32");
+  m_ui.enumAdd(GUI_COVARIANCES_FORMAT, FORMAT_FLOAT16, "Float 16");
+
+  m_ui.enumAdd(GUI_COLORS_FORMAT, FORMAT_STORAGE_DEFAULT, "Storage default");
+  m_ui.enumAdd(GUI_COLORS_FORMAT, FORMAT_FLOAT32, "Float 32");
+  m_ui.enumAdd(GUI_COLORS_FORMAT, FORMAT_UINT8, "RGBA8");
+
+  m_ui.enumAdd(GUI_SPATIAL_ORDER, E_ORDER_FILE, "File");
+  m_ui.enumAdd(GUI_SPATIAL_ORDER, E_ORDER_MORTON, "Morton curve");
+  m_ui.enumAdd(GUI_SPATIAL_ORDER, E_ORDER_HILBERT, "Hilbert curve");
+
+  m_ui.enumAdd(GUI_CHUNK_CULLING, CHUNK_CULLING_NONE, "Disabled");
+  m_ui.enumAdd(GUI_CHUNK_CULLING, CHUNK_CULLING_CPU, "On CPU");
+  m_ui.enumAdd(GUI_CHUNK_CULLING, CHUNK_CULLING_GPU, "In compute shader");
 }
 
 void GaussianSplatting::onUIRender()
@@ -136,6 +163,8 @@ void GaussianSplatting::onUIRender()
     vkDeviceWaitIdle(m_device);
 
     std::cout << "Start loading file " << m_sceneToLoadFilename << std::endl;
+    m_plyLoader.setSpatialOrder((SpatialOrder)m_spatialOrder);
+    m_plyLoader.setLodEnabled(m_lodEnabled);
     if(!m_plyLoader.loadScene(m_sceneToLoadFilename, m_splatSet))
     {
       // this should never occur since status is READY.
@@ -193,14 +222,12 @@ void GaussianSplatting::onUIRender()
       case PlyAsyncLoader::State::E_LOADING: {
         ImGui::Text("%s", m_plyLoader.getFilename().c_str());
         ImGui::ProgressBar(m_plyLoader.getProgress(), ImVec2(ImGui::GetContentRegionAvail().x, 0.0f));
-        /*
         if(ImGui::Button("Cancel", ImVec2(120, 0)))
         {
           // send cancelation order to loader
-          // should then disable the button, until cancel occurs or finished
+          // the load then ends in FAILURE status
           m_plyLoader.cancel();
         }
-        */
       }
       break;
       case PlyAsyncLoader::State::E_FAILURE: {
@@ -261,8 +288,12 @@ void GaussianSplatting::onUIRender()
       if(PE::entry(
              "Default settings", [&] { return ImGui::Button("Reset"); }, "resets to default settings"))
       {
-        m_defines.dataStorage = STORAGE_BUFFERS;
-        m_defines.shFormat    = FORMAT_FLOAT32;
+        m_defines.dataStorage       = STORAGE_BUFFERS;
+        m_defines.shFormat          = FORMAT_FLOAT32;
+        m_defines.centersFormat     = FORMAT_FLOAT32;
+        m_defines.covariancesFormat = FORMAT_FLOAT32;
+        m_defines.colorsFormat      = FORMAT_STORAGE_DEFAULT;
+        m_updateData                = true;
       }
       if(PE::entry(
              "Storage", [&]() { return m_ui.enumCombobox(GUI_STORAGE, "##ID", &m_defines.dataStorage); },
@@ -274,10 +305,87 @@ void GaussianSplatting::onUIRender()
       }
       if(PE::entry(
              "SH format", [&]() { return m_ui.enumCombobox(GUI_SH_FORMAT, "##ID", &m_defines.shFormat); },
-             "Selects storage format for SH coefficient, balancing precision and memory usage"))
+             "Selects storage format for SH coefficient, balancing precision and memory usage.\n"
+             "VQ codebook stores a 16 bit index per splat into a k-means codebook of the SH vectors."))
       {
         m_updateData = true;
       }
+      if(m_defines.shFormat == FORMAT_VQ && !m_shCodebookReport.empty())
+        PE::Text("SH codebook", m_shCodebookReport.c_str());
+      if(PE::entry(
+             "Centers format", [&]() { return m_ui.enumCombobox(GUI_CENTERS_FORMAT, "##ID", &m_defines.centersFormat); },
+             "Selects storage format for splat centers.\n"
+             "Unorm16 stores 16 bit coordinates relative to the bounding box of each chunk of consecutive splats."))
+      {
+        m_updateData = true;
+      }
+      if(PE::entry(
+             "Covariances format", [&]() { return m_ui.enumCombobox(GUI_COVARIANCES_FORMAT, "##ID", &m_defines.covariancesFormat); },
+             "Selects storage format for the 3D covariance matrices."))
+      {
+        m_updateData = true;
+      }
+      if(PE::entry(
+             "Colors format", [&]() { return m_ui.enumCombobox(GUI_COLORS_FORMAT, "##ID", &m_defines.colorsFormat); },
+             "Selects storage format for the base color and opacity.\n"
+             "Storage default keeps Float 32 with data buffers and RGBA8 with textures."))
+      {
+        m_updateData = true;
+      }
+      ImGui::BeginDisabled(m_defines.dataStorage != STORAGE_BUFFERS);
+      PE::SliderInt("Streaming pool (MB)", &m_streamingPoolSize, 0, 16384, "%d", ImGuiSliderFlags_Logarithmic,
+                    "Out of core streaming with data buffers. Only the chunks of splats that fit in a device pool \n"
+                    "of this size are resident, the visible ones are uploaded closest first and replace the least \n"
+                    "recently visible ones. Centers stay resident. Zero keeps the whole model on device.");
+      // the pools are recreated once the slider is released
+      if(ImGui::IsItemDeactivatedAfterEdit())
+        m_updateData = true;
+      ImGui::BeginDisabled(!streamingEnabled());
+      PE::SliderInt("Chunk uploads per frame", &m_streamingUploadsPerFrame, 1, int(s_streamingMaxUploads), "%d", 0,
+                    "Maximum number of chunks of splats uploaded to the pools at each frame.");
+      ImGui::EndDisabled();
+      ImGui::EndDisabled();
+      // the splat set is only complete when the loader is idle
+      ImGui::BeginDisabled(m_plyLoader.getStatus() != PlyAsyncLoader::State::E_READY);
+      if(PE::entry(
+             "SH packing benchmark", [&] { return ImGui::Button("Run"); },
+             "Times the conversion of the SH coefficients of the loaded model to each format, \n"
+             "per element reference path versus the kernels specialized for the format and degree."))
+      {
+        m_shPackingBenchmarkResult = benchmarkSphericalHarmonicsPacking(m_splatSet.f_restView(), (uint32_t)m_splatSet.size());
+        std::cout << m_shPackingBenchmarkResult;
+      }
+      ImGui::EndDisabled();
+      if(!m_shPackingBenchmarkResult.empty())
+        PE::Text("SH packing result", m_shPackingBenchmarkResult.c_str());
+      if(PE::entry(
+             "Splat order", [&]() { return m_ui.enumCombobox(GUI_SPATIAL_ORDER, "##ID", &m_spatialOrder); },
+             "Reorders the splats in memory along a space filling curve over their centers at load time,\n"
+             "so that splats close in space share cache lines. Reloads the scene."))
+      {
+        m_sceneToLoadFilename = m_loadedSceneFilename;
+      }
+      if(PE::Checkbox("Level of detail", &m_lodEnabled,
+                      "Builds a level of detail hierarchy at load time by merging groups of neighbouring splats \n"
+                      "into parent splats, and renders a cut through the hierarchy selected by projected size. \n"
+                      "Reloads the scene."))
+      {
+        m_sceneToLoadFilename = m_loadedSceneFilename;
+      }
+      ImGui::BeginDisabled(m_plyLoader.getStatus() != PlyAsyncLoader::State::E_READY || m_splatSet.size() == 0);
+      if(PE::entry(
+             "Locality benchmark", [&] { return ImGui::Button("Run"); },
+             "Measures the locality of the center and SH fetches for the back to front order of the current view,\n"
+             "with the current order of the splats and with the Morton and Hilbert orders.\n"
+             "Compare the frame times in the profiler after changing the splat order."))
+      {
+        m_localityBenchmarkResult = benchmarkSpatialOrders(m_splatSet.positions, m_frameInfo.viewMatrix,
+                                                           m_frameInfo.projectionMatrix, m_frameInfo.sortKeyMode);
+        std::cout << m_localityBenchmarkResult;
+      }
+      ImGui::EndDisabled();
+      if(!m_localityBenchmarkResult.empty())
+        PE::Text("Locality result", m_localityBenchmarkResult.c_str());
       PE::end();
     }
 
@@ -311,15 +419,59 @@ void GaussianSplatting::onUIRender()
         }
       }
 
+      PE::entry(
+          "Sorting key", [&]() { return m_ui.enumCombobox(GUI_SORT_KEY, "##ID", &m_frameInfo.sortKeyMode); },
+          "Selects the distance used to sort the splats back to front, same for CPU and GPU sorting: \n"
+          "absolute distance to the camera plane, view space depth, distance to the camera position \n"
+          "or post projection depth (default). The CPU sorts the post projection depth with the view \n"
+          "space depth, which gives the same order for the splats in front of the camera.");
+
       ImGui::BeginDisabled(m_frameInfo.sortingMethod == SORTING_GPU_SYNC_RADIX);
       PE::Checkbox("Lazy CPU sorting", &m_cpuLazySort, "Perform sorting only if viewpoint changes");
+      PE::Checkbox("Coherent CPU sorting", &m_cpuSortCoherence.enabled,
+                   "Reuses the previous order when the viewpoint changes slightly. The new sort starts \n"
+                   "from the previous order and is faster if this order is nearly sorted. With lazy sorting \n"
+                   "on, very small viewpoint changes do not trigger a new sort.");
+      ImGui::BeginDisabled(!m_cpuSortCoherence.enabled);
+      PE::SliderFloat("Skip angle", &m_cpuSortCoherence.skipAngle, 0.0f, 1.0f, "%.3f", 0,
+                      "Below this view direction change (in degrees) and skip distance, no new sort is done.");
+      PE::SliderFloat("Skip distance", &m_cpuSortCoherence.skipDistance, 0.0f, 0.1f, "%.4f", 0,
+                      "Below this camera displacement (in world units) and skip angle, no new sort is done.");
+      PE::SliderFloat("Incremental max angle", &m_cpuSortCoherence.maxAngle, 0.0f, 45.0f, "%.1f", 0,
+                      "Above this view direction change (in degrees), a full sort is done.");
+      PE::SliderFloat("Incremental max distance", &m_cpuSortCoherence.maxDistance, 0.0f, 10.0f, "%.2f", 0,
+                      "Above this camera displacement (in world units), a full sort is done.");
+      PE::Text("Last CPU sort", m_cpuSorter.lastSortWasIncremental() ? "Incremental" : "Full");
+      ImGui::EndDisabled();
+      if(PE::entry(
+             "CPU order check", [&] { return ImGui::Button("Check"); },
+             "Sorts the next frame on the GPU, reads back the GPU sorted indices and compares them \n"
+             "with the last CPU sorted order. Splats with equal keys may come in any order. \n"
+             "The camera must not move until the result is displayed."))
+        checkCpuSortOrder();
+      if(!m_cpuSortCheckResult.empty())
+        PE::Text("CPU order check result", m_cpuSortCheckResult.c_str());
 
       PE::Text("CPU sorting state", m_cpuSorter.getStatus() == SplatSorterAsync::E_SORTING ? "Sorting" : "Idled");
       ImGui::EndDisabled();
 
       PE::entry(
           "Rasterization", [&]() { return m_ui.enumCombobox(GUI_PIPELINE, "##ID", &m_selectedPipeline); },
-          "Selects the rendering pipeline, either Mesh Shader or Vertex Shader.");
+          "Selects the rendering pipeline, either Mesh Shader, Vertex Shader or Compute tiles, which\n"
+          "blends the splats front to back per tile of 16x16 pixels in compute shaders.");
+
+      ImGui::BeginDisabled(m_psnrStep != PSNR_IDLE);
+      if(PE::entry(
+             "Compute check", [&] { return ImGui::Button("Compare"); },
+             "Renders the current view with the raster pipeline in use (vertex shader if the compute \n"
+             "pipeline is in use) then with the compute pipeline, and reports the PSNR of the second \n"
+             "image against the first one, background excluded. Fails below 35 dB."))
+      {
+        startPsnrMeasure(PSNR_MEASURE_PIPELINE);
+      }
+      ImGui::EndDisabled();
+      if(!m_pipelinePsnrResult.empty())
+        PE::Text("Compute check result", m_pipelinePsnrResult.c_str());
 
       // Radio buttons for exclusive selection
       PE::entry(
@@ -349,12 +501,39 @@ void GaussianSplatting::onUIRender()
           "Defines where frustum culling is performed: in the distance compute shader or \n"
           "at rasterization (in vertex or mesh shader). Culling can also be disabled for performance comparisons.");
 
+      ImGui::BeginDisabled(m_frameInfo.sortingMethod != SORTING_GPU_SYNC_RADIX || m_defines.frustumCulling == FRUSTUM_CULLING_NONE);
+      if(PE::entry(
+             "Chunk culling", [&]() { return m_ui.enumCombobox(GUI_CHUNK_CULLING, "##ID", &m_defines.chunkCulling); },
+             "First frustum culling level, with GPU sorting and frustum culling enabled. The chunks of \n"
+             "consecutive splats whose bounding box is outside of the dilated frustum are culled as a whole, \n"
+             "on the CPU or in a compute shader, and the distance shader only visits the visible chunks. \n"
+             "More efficient with a Morton or Hilbert splat order."))
+        m_updateShaders = true;
+      ImGui::EndDisabled();
+
       PE::SliderFloat("Frustum dilation", &m_frameInfo.frustumDilation, 0.0f, 1.0f, "%.1f", 0,
                       "Adjusts the frustum culling bounds to account for the fact that visibility is tested \n"
                       "only at the center of each splat, rather than its full elliptical shape. A positive \n"
                       "value expands the frustum by the given percentage, reducing the risk of prematurely \n"
                       "discarding splats near the frustum boundaries.");
 
+      ImGui::BeginDisabled(m_splatSet.lodLeafCount == 0);
+      PE::SliderFloat("LOD threshold (pixels)", &m_frameInfo.lodThreshold, 0.0f, 64.0f, "%.1f", ImGuiSliderFlags_Logarithmic,
+                      "A node of the level of detail hierarchy replaces its children when the projected radius \n"
+                      "of its bounding sphere is below this value. Zero renders all the leaves (full detail).");
+      ImGui::BeginDisabled(m_psnrStep != PSNR_IDLE);
+      if(PE::entry(
+             "LOD PSNR", [&] { return ImGui::Button("Measure"); },
+             "Renders the current view at full detail then with the threshold and reports the PSNR \n"
+             "of the second image against the first one, background excluded, and the size of the cut."))
+      {
+        startPsnrMeasure(PSNR_MEASURE_LOD);
+      }
+      ImGui::EndDisabled();
+      if(!m_lodPsnrResult.empty())
+        PE::Text("LOD PSNR result", m_lodPsnrResult.c_str());
+      ImGui::EndDisabled();
+
       int alphaThres = 255 * m_frameInfo.alphaCullThreshold;
       if(PE::SliderInt("Alpha culling threshold", &alphaThres, 0, 255, "%d", 0, "Discard splats with low opacity (with low contribution)."))
       {
@@ -401,6 +580,10 @@ void GaussianSplatting::onUIRender()
                                         m_indirectReadback.groupCountX :
                                         (m_frameInfo.splatCount + RASTER_MESH_WORKGROUP_SIZE - 1) / RASTER_MESH_WORKGROUP_SIZE) :
                                    0;
+      const uint32_t visibleChunkCount =
+          (m_frameInfo.sortingMethod == SORTING_GPU_SYNC_RADIX && chunkCullingMode() != CHUNK_CULLING_NONE) ?
+              m_indirectReadback.visibleChunkCount :
+              splatChunkCount(totalSplatCount);
 
       if(ImGui::BeginTable("Stats", 3, ImGuiTableFlags_BordersOuter))
       {
@@ -424,6 +607,30 @@ void GaussianSplatting::onUIRender()
         ImGui::Text("%d", rasterSplatCount);
         ImGui::TableNextRow();
         ImGui::TableNextColumn();
+        ImGui::Text("LOD leaves");
+        ImGui::TableNextColumn();
+        ImGui::Text("%s", formatSize(m_splatSet.lodLeafCount).c_str());
+        ImGui::TableNextColumn();
+        ImGui::Text("%u", m_splatSet.lodLeafCount);
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::Text("Visible chunks");
+        ImGui::TableNextColumn();
+        ImGui::Text("%s", formatSize(visibleChunkCount).c_str());
+        ImGui::TableNextColumn();
+        ImGui::Text("%u / %u", visibleChunkCount, splatChunkCount(totalSplatCount));
+        if(m_selectedPipeline == PIPELINE_COMPUTE)
+        {
+          ImGui::TableNextRow();
+          ImGui::TableNextColumn();
+          ImGui::Text("Tile entries");
+          ImGui::TableNextColumn();
+          ImGui::Text("%s", formatSize(m_indirectReadback.tileEntryCount).c_str());
+          ImGui::TableNextColumn();
+          ImGui::Text("%u / %u", m_indirectReadback.tileEntryCount, m_tileEntryCapacity);
+        }
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
         ImGui::Text("Mesh shader work groups");
         ImGui::TableNextColumn();
         ImGui::Text("%s", formatSize(wgCount).c_str());
@@ -435,7 +642,18 @@ void GaussianSplatting::onUIRender()
         PE::begin("##Sorting statistics");
         PE::Text("CPU Distances  (ms)", "%.3f", m_distTime);
         PE::Text("CPU Sorting  (ms)", "%.3f", m_sortTime);
+        PE::Text("CPU Chunk culling  (ms)", "%.3f", m_chunkCullTime);
+        PE::Text("CPU Streaming  (ms)", "%.3f", m_streamingTime);
         PE::end();
+
+        // averages of the last frames read back by the stage profiler
+        if(!m_stageProfiler.recentAverages().empty())
+        {
+          PE::begin("##GPU stage times");
+          for(const auto& [name, ms] : m_stageProfiler.recentAverages())
+            PE::Text(("GPU " + name + "  (ms)").c_str(), "%.3f", ms);
+          PE::end();
+        }
       }
     }
   }
@@ -561,6 +779,42 @@ void GaussianSplatting::onUIRender()
       ImGui::Text("%s", formatMemorySize(m_renderMemoryStats.allocIndices).c_str());
       ImGui::TableNextRow();
       ImGui::TableNextColumn();
+      ImGui::Text("Culling chunks");
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", formatMemorySize(m_renderMemoryStats.hostAllocChunks).c_str());
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", formatMemorySize(m_renderMemoryStats.usedChunks).c_str());
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", formatMemorySize(m_renderMemoryStats.allocChunks).c_str());
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::Text("LOD nodes");
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", formatMemorySize(0).c_str());
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", formatMemorySize(m_renderMemoryStats.allocLod).c_str());
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", formatMemorySize(m_renderMemoryStats.allocLod).c_str());
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::Text("Streaming");
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", formatMemorySize(m_renderMemoryStats.hostAllocStaging).c_str());
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", formatMemorySize(m_renderMemoryStats.allocChunkSlots).c_str());
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", formatMemorySize(m_renderMemoryStats.allocChunkSlots).c_str());
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::Text("Uploads");
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", formatMemorySize(m_renderMemoryStats.hostAllocUpload).c_str());
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", formatMemorySize(0).c_str());
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", formatMemorySize(0).c_str());
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
       ImGui::Text("GPU sort");
       ImGui::TableNextColumn();
       ImGui::Text("%s", formatMemorySize(0).c_str());
@@ -572,6 +826,15 @@ void GaussianSplatting::onUIRender()
                             .c_str());
       ImGui::TableNextRow();
       ImGui::TableNextColumn();
+      ImGui::Text("Compute tiles");
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", formatMemorySize(0).c_str());
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", formatMemorySize(m_renderMemoryStats.allocTiles).c_str());
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", formatMemorySize(m_renderMemoryStats.allocTiles).c_str());
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
       ImGui::Text("Sub-total");
       ImGui::TableNextColumn();
       ImGui::Text("%s", formatMemorySize(m_renderMemoryStats.hostTotal).c_str());
@@ -598,6 +861,22 @@ void GaussianSplatting::onUIRender()
       ImGui::Text("%s", formatMemorySize(m_modelMemoryStats.devAll + m_renderMemoryStats.deviceAllocTotal).c_str());
       ImGui::EndTable();
     }
+    // residency of the chunks, the model sizes above are the ones of the pools
+    if(streamingEnabled())
+    {
+      const SplatResidency::Stats& stats = m_residency.stats();
+      ImGui::Separator();
+      PE::begin("##Streaming statistics");
+      PE::Text("Resident chunks", "%u / %u slots, %u chunks", m_residency.residentCount(), m_residency.slotCount(),
+               m_residency.chunkCount());
+      PE::Text("Visible chunks", "%u, %u missing", stats.visibleChunks, stats.missingChunks);
+      PE::Text("Frame uploads", "%u, %u evictions", stats.frameUploads, stats.frameEvictions);
+      PE::Text("Total uploads", "%llu, %llu evictions", (unsigned long long)stats.totalUploads,
+               (unsigned long long)stats.totalEvictions);
+      PE::Text("Total uploaded", "%s", formatMemorySize(stats.totalUploadedBytes).c_str());
+      PE::Text("Host store", m_residency.isMapped() ? "Mapped splat cache" : "Host memory");
+      PE::end();
+    }
   }
   ImGui::End();
 }
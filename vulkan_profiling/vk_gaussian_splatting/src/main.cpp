@@ -18,6 +18,114 @@
  */
 
 #include <gaussian_splatting.h>
+#include "splat_cpu_rasterizer.h"
+
+#include <fstream>
+
+// loads the input ply on the calling thread, returns false on failure
+static bool loadPly(const std::string& filename, SplatSet& splatSet)
+{
+  PlyAsyncLoader loader;
+  if(!loader.initialize())
+    return false;
+  // the loader thread sets the status to E_READY once started, and keeps it until it picks the request
+  while(loader.getStatus() == PlyAsyncLoader::State::E_SHUTDOWN)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  PlyAsyncLoader::State state = PlyAsyncLoader::State::E_FAILURE;
+  if(loader.loadScene(filename, splatSet))
+  {
+    while((state = loader.getStatus()) == PlyAsyncLoader::State::E_READY || state == PlyAsyncLoader::State::E_LOADING)
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  loader.shutdown();
+  return state == PlyAsyncLoader::State::E_LOADED;
+}
+
+// renders the input model with SplatCpuRasterizer, either the -v/-p view to the -o image
+// or each view of --views to the -o folder with the per stage timings in cpu_timings.csv.
+// Used to produce reference images for the PSNR scripts and CPU timings without a GPU.
+static int renderCpuReference(argparse::ArgumentParser& parser, glm::uvec2 size)
+{
+  const std::string input = parser.get<std::string>("input1");
+  SplatSet          splatSet;
+  auto              startTime = std::chrono::high_resolution_clock::now();
+  if(!loadPly(input, splatSet))
+  {
+    std::cerr << "Error: cannot load " << input << std::endl;
+    return 1;
+  }
+  auto endTime = std::chrono::high_resolution_clock::now();
+  std::cout << "Loaded " << splatSet.size() << " splats from " << input << " in "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count() << " ms" << std::endl;
+
+  SplatCpuRasterizer::Settings settings;
+  settings.width       = size.x;
+  settings.height      = size.y;
+  settings.maxShDegree = std::clamp(parser.get<int>("maxshdegree"), 0, 3);
+  settings.simd        = !parser.get<bool>("cpuscalar");
+  SplatCpuRasterizer rasterizer;
+  rasterizer.setSettings(settings);
+
+  const glm::mat4 view = glm::make_mat4(parser.get<std::vector<float>>("view").data());
+  const glm::mat4 proj = glm::make_mat4(parser.get<std::vector<float>>("proj").data());
+
+  if(!parser.is_used("views"))
+  {
+    const std::string output = parser.is_used("output") ? parser.get<std::string>("output") : std::string("cpu_reference.png");
+    rasterizer.render(splatSet, view, proj);
+    std::cout << "CPU reference: " << SplatCpuRasterizer::formatStats(rasterizer.stats()) << std::endl;
+    if(!rasterizer.writePng(output))
+    {
+      std::cerr << "Error: cannot write " << output << std::endl;
+      return 1;
+    }
+    std::cout << "Image written to " << output << std::endl;
+    return 0;
+  }
+
+  const std::string viewsFilename = parser.get<std::string>("views");
+  ViewBatch         batch;
+  if(!batch.load(viewsFilename))
+    return 1;
+  const std::filesystem::path outputDir =
+      parser.is_used("output") ? std::filesystem::path(parser.get<std::string>("output")) : std::filesystem::path(viewsFilename).parent_path();
+  std::error_code ec;
+  std::filesystem::create_directories(outputDir, ec);
+
+  // each view is rendered --timed times, the image of the last render is written
+  const int     renders = std::max(parser.get<int>("timed"), 1);
+  std::ofstream timings(outputDir / "cpu_timings.csv");
+  timings << "view,renders,visible_splats,tile_entries,project_avg_ms,bin_avg_ms,sort_avg_ms,blend_avg_ms,total_avg_ms,total_min_ms"
+          << std::endl;
+  for(const ViewBatch::Pose& pose : batch.poses())
+  {
+    SplatCpuRasterizer::Stats sum;
+    double                    totalMin = 0.0;
+    for(int i = 0; i < renders; ++i)
+    {
+      rasterizer.render(splatSet, pose.view, pose.hasProj ? pose.proj : proj);
+      const SplatCpuRasterizer::Stats& stats = rasterizer.stats();
+      sum.projectTime += stats.projectTime;
+      sum.binTime += stats.binTime;
+      sum.sortTime += stats.sortTime;
+      sum.blendTime += stats.blendTime;
+      sum.totalTime += stats.totalTime;
+      totalMin = i ? std::min(totalMin, stats.totalTime) : stats.totalTime;
+    }
+    const SplatCpuRasterizer::Stats& stats = rasterizer.stats();
+    timings << pose.name << "," << renders << "," << stats.visibleCount << "," << stats.tileEntries << ","
+            << sum.projectTime / renders << "," << sum.binTime / renders << "," << sum.sortTime / renders << ","
+            << sum.blendTime / renders << "," << sum.totalTime / renders << "," << totalMin << std::endl;
+    std::cout << pose.name << ": " << SplatCpuRasterizer::formatStats(stats) << std::endl;
+
+    const std::string image = (outputDir / (pose.name + ".png")).string();
+    if(!rasterizer.writePng(image))
+      std::cerr << "Error: cannot write " << image << std::endl;
+  }
+  std::cout << "Timings of " << batch.poses().size() << " views written to " << (outputDir / "cpu_timings.csv").string()
+            << std::endl;
+  return 0;
+}
 
 // create, setup and run an nvvkhl::Application
 // with a GaussianSplatting element.
@@ -48,15 +156,31 @@ int main(int argc, char** argv)
     }
   };
 
-  // Create Vulkan context
-  nvvk::Context vkContext;
-  vkContext.init(vkSetup);
-
   auto parser = std::make_shared<argparse::ArgumentParser>();
   parser->add_description("Gaussian Splatting");
   parser->add_argument("-i1", "--input1").help("Input ply file to load").default_value("/home/nisarg/data/amber/point_cloud/iteration_30000/point_cloud.ply");
   parser->add_argument("-i2", "--input2").help("Input gltf file to load").default_value("/home/nisarg/data/amber/scene.gltf");
   parser->add_argument("-o", "--output").help("output image path.");
+  parser->add_argument("--nocache").help("do not read or write the .splatcache file next to the ply").default_value(false).implicit_value(true);
+  parser->add_argument("--lod").help("build a level of detail hierarchy at load time and render a cut selected by projected size").default_value(false).implicit_value(true);
+  parser->add_argument("--streaming").help("size in MB of the device pools streaming the chunks of splats, 0 keeps the whole model resident").default_value(0).scan<'i', int>();
+  parser->add_argument("--views").help("file of viewpoints to render in one run, one 'name view[16] [proj[16]]' per line, -o gives the output folder");
+  parser->add_argument("--warmup").help("frames rendered per viewpoint before timing, with --views").default_value(10).scan<'i', int>();
+  parser->add_argument("--timed").help("frames timed per viewpoint, with --views").default_value(10).scan<'i', int>();
+  parser->add_argument("--order").help("order of the splats in memory, file, morton or hilbert curve").default_value(std::string("file"));
+  parser->add_argument("--centersformat").help("storage of the splat centers, fp32 or unorm16 relative to chunk bounds").default_value(std::string("fp32"));
+  parser->add_argument("--covformat").help("storage of the splat covariances, fp32 or fp16").default_value(std::string("fp32"));
+  parser->add_argument("--colorsformat").help("storage of the splat colors and opacities, fp32 or rgba8, fp32 with buffers and rgba8 with textures if not set").default_value(std::string("fp32"));
+  parser->add_argument("--chunkculling").help("culling of the chunks of splats before the distance shader, none, cpu or gpu").default_value(std::string("gpu"));
+  parser->add_argument("--pipeline").help("rendering pipeline of the splats, vert, mesh or compute (tile based, blended front to back)").default_value(std::string("vert"));
+  parser->add_argument("--shadercache").help("folder of the SPIR-V cache of the shader permutations, spirv_cache next to the executable by default, empty to disable");
+  parser->add_argument("--pipelinecache").help("pipeline cache file loaded at startup and saved at exit, shared with rast and pbr, empty to disable").default_value(std::string("pipeline_cache.bin"));
+  parser->add_argument("--stagetimes").help("file receiving the GPU stage times at exit and after each viewpoint of --views, json if it ends with .json, csv otherwise");
+  parser->add_argument("--maxshdegree").help("maximum degree of the spherical harmonics used for rendering, in [0,3]").default_value(3).scan<'i', int>();
+  parser->add_argument("--cpureference").help("render -v/-p (or each view of --views) with the multithreaded CPU rasterizer to -o and exit, no Vulkan device needed").default_value(false).implicit_value(true);
+  parser->add_argument("--cpuscalar").help("disable the SIMD blending of --cpureference").default_value(false).implicit_value(true);
+  parser->add_argument("--checkcompute").help("render -v/-p then from inside the splat cloud with the raster pipeline then the compute pipeline, report the PSNRs and exit, non zero exit code below 35 dB").default_value(false).implicit_value(true);
+  parser->add_argument("--statsformat").help("benchmark memory stats also reported as json or csv lines, text only by default").default_value(std::string("text"));
   std::vector<float> view_def = {
     0.707107, -0.5, 0.5, 0, 
     0, 0.707107, 0.707107, 0, 
@@ -79,6 +203,18 @@ int main(int argc, char** argv)
     std::cerr << parser;
     return 1;
   }
+  // size of the window, hence of the rendered images
+  const glm::uvec2 windowSize = {1600, 900};
+
+  // GPU-free path, renders the model on the CPU and exits before any Vulkan object is created
+  if(parser->get<bool>("cpureference")) {
+    return renderCpuReference(*parser, windowSize);
+  }
+
+  // Create Vulkan context
+  nvvk::Context vkContext;
+  vkContext.init(vkSetup);
+
   bool headless = false;
   // std::string output;
 
@@ -92,12 +228,15 @@ int main(int argc, char** argv)
   appSetup.name                  = fmt::format("{}", PROJECT_NAME);
   appSetup.vSync                 = false;
   appSetup.useMenu               = false;
-  appSetup.windowSize            = {1600, 900};
+  appSetup.windowSize            = windowSize;
   appSetup.hasUndockableViewport = false;
   appSetup.instance              = vkContext.m_instance;
   appSetup.device                = vkContext.m_device;
   appSetup.physicalDevice        = vkContext.m_physicalDevice;
   appSetup.queues.push_back({vkContext.m_queueGCT.familyIndex, vkContext.m_queueGCT.queueIndex, vkContext.m_queueGCT.queue});
+  // transfer queue for the uploads of the splat data, the graphics queue if the device has no other
+  const nvvk::Context::Queue& transferQueue = vkContext.m_queueT.queue != VK_NULL_HANDLE ? vkContext.m_queueT : vkContext.m_queueGCT;
+  appSetup.queues.push_back({transferQueue.familyIndex, transferQueue.queueIndex, transferQueue.queue});
   appSetup.headless = headless;
   // appSetup.headlessFrameCount = 10;
 
@@ -148,5 +287,5 @@ int main(int argc, char** argv)
   app.reset();
 
   // return benchmark->errorCode();
-  return 0;
+  return gaussianSplatting->exitCode();
 }
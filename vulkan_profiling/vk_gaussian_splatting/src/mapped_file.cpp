@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2023-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <iostream>
+
+#include "mapped_file.h"
+
+bool MappedFile::open(const std::string& filename)
+{
+  close();
+
+#ifdef _WIN32
+  HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if(file == INVALID_HANDLE_VALUE)
+  {
+    std::cout << "Error: cannot open file for mapping: " << filename << std::endl;
+    return false;
+  }
+  LARGE_INTEGER fileSize;
+  if(!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+  {
+    CloseHandle(file);
+    std::cout << "Error: cannot map empty file: " << filename << std::endl;
+    return false;
+  }
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  void*  view    = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+  // the view keeps its own reference on the file, handles can be released
+  if(mapping)
+    CloseHandle(mapping);
+  CloseHandle(file);
+  if(view == nullptr)
+  {
+    std::cout << "Error: cannot map file: " << filename << std::endl;
+    return false;
+  }
+  m_data = static_cast<const char*>(view);
+  m_size = (size_t)fileSize.QuadPart;
+#else
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if(fd < 0)
+  {
+    std::cout << "Error: cannot open file for mapping: " << filename << std::endl;
+    return false;
+  }
+  struct stat st;
+  if(fstat(fd, &st) != 0 || st.st_size == 0)
+  {
+    ::close(fd);
+    std::cout << "Error: cannot map empty file: " << filename << std::endl;
+    return false;
+  }
+  void* view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // the mapping keeps its own reference on the file, fd can be released
+  ::close(fd);
+  if(view == MAP_FAILED)
+  {
+    std::cout << "Error: cannot map file: " << filename << std::endl;
+    return false;
+  }
+  // splats are mostly visited in file order
+  madvise(view, (size_t)st.st_size, MADV_SEQUENTIAL);
+  m_data = static_cast<const char*>(view);
+  m_size = (size_t)st.st_size;
+#endif
+
+  return true;
+}
+
+void MappedFile::close()
+{
+  if(m_data == nullptr)
+    return;
+#ifdef _WIN32
+  UnmapViewOfFile(m_data);
+#else
+  munmap(const_cast<char*>(m_data), m_size);
+#endif
+  m_data = nullptr;
+  m_size = 0;
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2023-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _MAPPED_FILE_H_
+#define _MAPPED_FILE_H_
+
+#include <string>
+#include <cstddef>
+
+// Read only memory mapping of a whole file.
+// Pages are brought in by the OS on access so the content
+// is read directly from the page cache without extra copies.
+class MappedFile
+{
+public:
+  MappedFile() = default;
+  ~MappedFile() { close(); }
+
+  MappedFile(const MappedFile&)            = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  // maps the file, returns false on failure
+  bool open(const std::string& filename);
+  // unmaps the file, no effect if not mapped
+  void close();
+
+  [[nodiscard]] inline bool        valid() const { return m_data != nullptr; }
+  [[nodiscard]] inline const char* data() const { return m_data; }
+  [[nodiscard]] inline size_t      size() const { return m_size; }
+
+private:
+  const char* m_data = nullptr;
+  size_t      m_size = 0;
+};
+
+#endif
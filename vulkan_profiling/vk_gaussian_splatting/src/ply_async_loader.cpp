@@ -20,6 +20,8 @@
 //
 #include <fstream>
 #include <array>
+#include <atomic>
+#include <cstring>
 #include <chrono>
 #include <filesystem>
 #include <iostream>
@@ -29,6 +31,86 @@
 
 //
 #include "ply_async_loader.h"
+#include "splat_lod.h"
+#include "utilities.h"
+
+// a 3DGS attribute to be extracted from the vertex element
+struct VertexAttribute
+{
+  std::vector<float>*   dst = nullptr;  // destination array in the splat set
+  std::vector<uint32_t> srcOffsets;     // byte offset in a row of each component, empty if not in file
+};
+
+// Fills attribs with the layout of the 3DGS attributes in the vertex element, in SplatSet order.
+// Returns false if the element cannot be decoded by the chunked loader,
+// that is if it has list properties, is missing the positions or uses non float attributes.
+static bool findVertexAttributes(const miniply::PLYElement& elem, SplatSet& output, std::array<VertexAttribute, 6>& attribs)
+{
+  if(!elem.fixedSize)
+    return false;
+
+  auto findAttribute = [&](VertexAttribute& attrib, std::vector<float>* dst, const std::vector<std::string>& names) {
+    attrib.dst = dst;
+    attrib.srcOffsets.clear();
+    for(const auto& name : names)
+    {
+      const uint32_t propIdx = elem.find_property(name.c_str());
+      if(propIdx == miniply::kInvalidIndex)
+      {
+        // the sequential path leaves missing attributes to zero, we do the same
+        attrib.srcOffsets.clear();
+        return true;
+      }
+      if(elem.properties[propIdx].type != miniply::PLYPropertyType::Float)
+        return false;
+      attrib.srcOffsets.push_back(elem.properties[propIdx].offset);
+    }
+    return true;
+  };
+
+  std::vector<std::string> shNames;
+  for(int i = 0; i < 45; ++i)
+    shNames.push_back("f_rest_" + std::to_string(i));
+
+  return findAttribute(attribs[0], &output.positions, {"x", "y", "z"})
+         && findAttribute(attribs[1], &output.f_dc, {"f_dc_0", "f_dc_1", "f_dc_2"})
+         && findAttribute(attribs[2], &output.f_rest, shNames) && findAttribute(attribs[3], &output.opacity, {"opacity"})
+         && findAttribute(attribs[4], &output.scale, {"scale_0", "scale_1", "scale_2"})
+         && findAttribute(attribs[5], &output.rotation, {"rot_0", "rot_1", "rot_2", "rot_3"})
+         && !attribs[0].srcOffsets.empty();
+}
+
+// Returns true if all the 3DGS attributes are present with consecutive float components,
+// so that they can be exposed as strided views over the vertex rows by the mapped loader
+static bool isMappable(const std::array<VertexAttribute, 6>& attribs)
+{
+  const size_t expectedComponents[6] = {3, 3, 45, 1, 3, 4};
+  for(size_t i = 0; i < attribs.size(); ++i)
+  {
+    const auto& offsets = attribs[i].srcOffsets;
+    if(offsets.size() != expectedComponents[i])
+      return false;
+    for(size_t cmp = 1; cmp < offsets.size(); ++cmp)
+    {
+      if(offsets[cmp] != offsets[0] + cmp * sizeof(float))
+        return false;
+    }
+  }
+  return true;
+}
+
+// Returns the offset of the first byte following the header, 0 on failure
+static size_t findDataOffset(const std::string& filename)
+{
+  std::ifstream file(filename, std::ios::binary);
+  std::string   line;
+  while(std::getline(file, line))
+  {
+    if(line.rfind("end_header", 0) == 0)
+      return (size_t)file.tellg();
+  }
+  return 0;
+}
 
 bool PlyAsyncLoader::loadScene(std::string filename, SplatSet& output)
 {
@@ -39,8 +121,9 @@ bool PlyAsyncLoader::loadScene(std::string filename, SplatSet& output)
   }
 
   // setup load info and wakeup the thread
-  m_filename = filename;
-  m_output   = &output;
+  m_filename        = filename;
+  m_output          = &output;
+  m_cancelRequested = false;
   m_loadCV.notify_all();
 
   return true;
@@ -79,16 +162,18 @@ bool PlyAsyncLoader::initialize()
         if(m_output != nullptr && innerLoad(m_filename, *m_output))
         {
           std::lock_guard<std::mutex> lock(m_mutex);
-          m_status   = E_LOADED;
-          m_output   = nullptr;
-          m_filename = "";
+          m_status          = E_LOADED;
+          m_output          = nullptr;
+          m_filename        = "";
+          m_cancelRequested = false;
         }
         else
         {
           std::lock_guard<std::mutex> lock(m_mutex);
-          m_status   = E_FAILURE;
-          m_output   = nullptr;
-          m_filename = "";
+          m_status          = E_FAILURE;
+          m_output          = nullptr;
+          m_filename        = "";
+          m_cancelRequested = false;
         }
       }
       else
@@ -108,7 +193,12 @@ bool PlyAsyncLoader::initialize()
 
 void PlyAsyncLoader::cancel()
 {
-  // does nothing for the time beeing
+  // the flag is polled by the loader between two chunks or properties
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if(m_status == E_LOADING)
+  {
+    m_cancelRequested = true;
+  }
 }
 
 PlyAsyncLoader::State PlyAsyncLoader::getStatus()
@@ -144,11 +234,40 @@ bool PlyAsyncLoader::innerLoad(std::string filename, SplatSet& output)
     return false;
   }
 
+  // the chunked loader reads the vertex block by itself
+  // so we need its location in the file
+  bool parallel, mapped;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const bool binary = reader.file_type() == miniply::PLYFileType::Binary;
+    parallel          = m_parallelLoading && binary;
+    mapped            = m_mappedLoading && binary;
+  }
+  size_t dataOffset = (parallel || mapped) ? findDataOffset(filename) : 0;
+
   uint32_t indices[45];
   bool     gsFound = false;
 
   while(reader.has_element() && !gsFound)
   {
+    std::array<VertexAttribute, 6> attribs;
+    const bool fastPath   = reader.element_is(miniply::kPLYVertexElement) && reader.num_rows() != 0 && dataOffset != 0
+                          && findVertexAttributes(*reader.element(), output, attribs);
+    const bool useMapping = fastPath && mapped && isMappable(attribs);
+    if(useMapping || (fastPath && parallel))
+    {
+      if(useMapping)
+        gsFound = innerLoadMapped(filename, dataOffset, *reader.element(), output);
+      else
+        gsFound = innerLoadParallel(filename, dataOffset, *reader.element(), output);
+      if(!gsFound)
+      {
+        output = {};
+        return false;
+      }
+      break;
+    }
+
     if(reader.element_is(miniply::kPLYVertexElement) && reader.load_element())
     {
       const uint32_t numVerts = reader.num_rows();
@@ -168,52 +287,65 @@ bool PlyAsyncLoader::innerLoad(std::string filename, SplatSet& output)
       uint32_t       loaded = 0;
 
       // put that first so the loading progress looks better
-      if(reader.find_properties(indices, 45, "f_rest_0", "f_rest_1", "f_rest_2", "f_rest_3", "f_rest_4", "f_rest_5",
-                                "f_rest_6", "f_rest_7", "f_rest_8", "f_rest_9", "f_rest_10", "f_rest_11", "f_rest_12",
-                                "f_rest_13", "f_rest_14", "f_rest_15", "f_rest_16", "f_rest_17", "f_rest_18",
-                                "f_rest_19", "f_rest_20", "f_rest_21", "f_rest_22", "f_rest_23", "f_rest_24",
-                                "f_rest_25", "f_rest_26", "f_rest_27", "f_rest_28", "f_rest_29", "f_rest_30", "f_rest_31",
-                                "f_rest_32", "f_rest_33", "f_rest_34", "f_rest_35", "f_rest_36", "f_rest_37", "f_rest_38",
-                                "f_rest_39", "f_rest_40", "f_rest_41", "f_rest_42", "f_rest_43", "f_rest_44"))
+      if(!isCancelRequested()
+         && reader.find_properties(indices, 45, "f_rest_0", "f_rest_1", "f_rest_2", "f_rest_3", "f_rest_4", "f_rest_5",
+                                   "f_rest_6", "f_rest_7", "f_rest_8", "f_rest_9", "f_rest_10", "f_rest_11", "f_rest_12",
+                                   "f_rest_13", "f_rest_14", "f_rest_15", "f_rest_16", "f_rest_17", "f_rest_18",
+                                   "f_rest_19", "f_rest_20", "f_rest_21", "f_rest_22", "f_rest_23", "f_rest_24",
+                                   "f_rest_25", "f_rest_26", "f_rest_27", "f_rest_28", "f_rest_29", "f_rest_30", "f_rest_31",
+                                   "f_rest_32", "f_rest_33", "f_rest_34", "f_rest_35", "f_rest_36", "f_rest_37", "f_rest_38",
+                                   "f_rest_39", "f_rest_40", "f_rest_41", "f_rest_42", "f_rest_43", "f_rest_44"))
       {
         reader.extract_properties(indices, 45, miniply::PLYPropertyType::Float, output.f_rest.data());
         loaded += numVerts * 45;
         setProgress(float(loaded) / float(total));
       }
-      if(reader.find_properties(indices, 3, "x", "y", "z"))
+      if(!isCancelRequested() && reader.find_properties(indices, 3, "x", "y", "z"))
       {
         reader.extract_properties(indices, 3, miniply::PLYPropertyType::Float, output.positions.data());
         loaded += numVerts * 3;
         setProgress(float(loaded) / float(total));
       }
-      if(reader.find_properties(indices, 1, "opacity"))
+      if(!isCancelRequested() && reader.find_properties(indices, 1, "opacity"))
       {
         reader.extract_properties(indices, 1, miniply::PLYPropertyType::Float, output.opacity.data());
         loaded += numVerts;
         setProgress(float(loaded) / float(total));
       }
-      if(reader.find_properties(indices, 3, "scale_0", "scale_1", "scale_2"))
+      if(!isCancelRequested() && reader.find_properties(indices, 3, "scale_0", "scale_1", "scale_2"))
       {
         reader.extract_properties(indices, 3, miniply::PLYPropertyType::Float, output.scale.data());
         loaded += numVerts * 3;
         setProgress(float(loaded) / float(total));
       }
-      if(reader.find_properties(indices, 4, "rot_0", "rot_1", "rot_2", "rot_3"))
+      if(!isCancelRequested() && reader.find_properties(indices, 4, "rot_0", "rot_1", "rot_2", "rot_3"))
       {
         reader.extract_properties(indices, 4, miniply::PLYPropertyType::Float, output.rotation.data());
         loaded += numVerts * 4;
         setProgress(float(loaded) / float(total));
       }
-      if(reader.find_properties(indices, 3, "f_dc_0", "f_dc_1", "f_dc_2"))
+      if(!isCancelRequested() && reader.find_properties(indices, 3, "f_dc_0", "f_dc_1", "f_dc_2"))
       {
         reader.extract_properties(indices, 3, miniply::PLYPropertyType::Float, output.f_dc.data());
         loaded += numVerts * 3;
         setProgress(float(loaded) / float(total));
       }
 
+      if(isCancelRequested())
+      {
+        std::cout << "Warning: ply loading canceled" << std::endl;
+        output = {};
+        return false;
+      }
 
       gsFound = true;
     }
+    else if(dataOffset != 0)
+    {
+      // skip the element in the data offset, only possible for fixed size elements
+      const miniply::PLYElement* elem = reader.element();
+      dataOffset = elem->fixedSize ? dataOffset + size_t(elem->count) * elem->rowStride : 0;
+    }
 
     reader.next_element();
   }
@@ -223,6 +355,32 @@ bool PlyAsyncLoader::innerLoad(std::string filename, SplatSet& output)
     auto      endTime  = std::chrono::high_resolution_clock::now();
     long long loadTime = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
     std::cout << "File loaded in " << loadTime << "ms" << std::endl;
+
+    SpatialOrder spatialOrder;
+    bool         lodEnabled;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      spatialOrder = m_spatialOrder;
+      lodEnabled   = m_lodEnabled;
+    }
+    if(spatialOrder != E_ORDER_FILE)
+    {
+      auto startOrderTime = std::chrono::high_resolution_clock::now();
+      reorderSplatSet(output, computeSpatialOrder(output.positions, spatialOrder));
+      auto      endOrderTime = std::chrono::high_resolution_clock::now();
+      long long orderTime = std::chrono::duration_cast<std::chrono::milliseconds>(endOrderTime - startOrderTime).count();
+      std::cout << "Splats reordered along the " << (spatialOrder == E_ORDER_HILBERT ? "Hilbert" : "Morton")
+                << " curve in " << orderTime << "ms" << std::endl;
+    }
+    if(lodEnabled)
+    {
+      auto startLodTime = std::chrono::high_resolution_clock::now();
+      buildSplatLod(output);
+      auto      endLodTime = std::chrono::high_resolution_clock::now();
+      long long lodTime    = std::chrono::duration_cast<std::chrono::milliseconds>(endLodTime - startLodTime).count();
+      std::cout << "Level of detail hierarchy of " << output.size() - output.lodLeafCount << " nodes built in " << lodTime
+                << "ms" << std::endl;
+    }
   }
   else
   {
@@ -231,3 +389,133 @@ bool PlyAsyncLoader::innerLoad(std::string filename, SplatSet& output)
 
   return gsFound;
 }
+
+bool PlyAsyncLoader::innerLoadParallel(const std::string& filename, size_t dataOffset, const miniply::PLYElement& vertexElement, SplatSet& output)
+{
+  std::array<VertexAttribute, 6> attribs;
+  findVertexAttributes(vertexElement, output, attribs);
+
+  const uint32_t numVerts  = vertexElement.count;
+  const size_t   rowStride = vertexElement.rowStride;
+
+  output.positions.resize(numVerts * 3);
+  output.scale.resize(numVerts * 3);
+  output.rotation.resize(numVerts * 4);
+  output.opacity.resize(numVerts);
+  output.f_dc.resize(numVerts * 3);
+  output.f_rest.resize(numVerts * 45);
+
+  // a few chunks per worker so that the load balances
+  // and the progress is updated regularly
+  const uint32_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+  const uint32_t chunkRows   = std::max(4096u, (numVerts + threadCount * 8 - 1) / (threadCount * 8));
+  const uint32_t chunkCount  = (numVerts + chunkRows - 1) / chunkRows;
+
+  std::vector<std::vector<char>> readBuffers(threadCount);  // one per worker, reused across chunks
+  std::atomic<uint32_t>          loadedRows = 0;
+  std::atomic<bool>              failed     = false;
+  std::atomic<bool>              canceled   = false;
+
+  nvh::parallel_batches_indexed<1>(
+      chunkCount,
+      [&](uint64_t chunkIdx, uint32_t tidx) {
+        if(failed || canceled)
+          return;
+        if(isCancelRequested())
+        {
+          canceled = true;
+          return;
+        }
+
+        const uint32_t firstRow = uint32_t(chunkIdx) * chunkRows;
+        const uint32_t rowCount = std::min(chunkRows, numVerts - firstRow);
+
+        // each chunk uses its own stream so reads do not serialize on a shared file position
+        auto& buffer = readBuffers[tidx];
+        buffer.resize(rowCount * rowStride);
+        std::ifstream file(filename, std::ios::binary);
+        file.seekg(dataOffset + firstRow * rowStride);
+        if(!file.read(buffer.data(), buffer.size()))
+        {
+          failed = true;
+          return;
+        }
+
+        // decode the rows straight into the splat set
+        for(const auto& attrib : attribs)
+        {
+          const size_t components = attrib.srcOffsets.size();
+          float*       dst        = attrib.dst->data() + size_t(firstRow) * components;
+          for(uint32_t row = 0; row < rowCount; ++row)
+          {
+            const char* src = buffer.data() + row * rowStride;
+            for(size_t cmp = 0; cmp < components; ++cmp)
+            {
+              std::memcpy(dst++, src + attrib.srcOffsets[cmp], sizeof(float));
+            }
+          }
+        }
+
+        const uint32_t loaded = loadedRows.fetch_add(rowCount) + rowCount;
+        setProgress(float(loaded) / float(numVerts));
+      },
+      threadCount);
+
+  if(canceled)
+  {
+    std::cout << "Warning: ply loading canceled" << std::endl;
+    return false;
+  }
+  if(failed)
+  {
+    std::cout << "Error: ply loader failed to read vertex data: " << filename << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool PlyAsyncLoader::innerLoadMapped(const std::string& filename, size_t dataOffset, const miniply::PLYElement& vertexElement, SplatSet& output)
+{
+  auto mapping = std::make_shared<MappedFile>();
+  if(!mapping->open(filename))
+    return false;
+
+  const uint32_t numVerts  = vertexElement.count;
+  const size_t   rowStride = vertexElement.rowStride;
+  if(dataOffset + numVerts * rowStride > mapping->size())
+  {
+    std::cout << "Error: ply loader truncated vertex data: " << filename << std::endl;
+    return false;
+  }
+
+  std::array<VertexAttribute, 6> attribs;
+  findVertexAttributes(vertexElement, output, attribs);
+
+  const char* vertexBlock = mapping->data() + dataOffset;
+  auto        makeView    = [&](const VertexAttribute& attrib) {
+    return SplatAttributeView{vertexBlock + attrib.srcOffsets[0], rowStride, (uint32_t)attrib.srcOffsets.size()};
+  };
+
+  // release any previous content, attributes other than positions stay empty
+  output                = {};
+  output.mapping        = mapping;
+  output.mappedF_dc     = makeView(attribs[1]);
+  output.mappedF_rest   = makeView(attribs[2]);
+  output.mappedOpacity  = makeView(attribs[3]);
+  output.mappedScale    = makeView(attribs[4]);
+  output.mappedRotation = makeView(attribs[5]);
+
+  // positions are copied, the sorters need them as a packed array
+  const SplatAttributeView positions = makeView(attribs[0]);
+  output.positions.resize(numVerts * 3);
+  START_PAR_LOOP(numVerts, splatIdx)
+  {
+    for(uint32_t cmp = 0; cmp < 3; ++cmp)
+      output.positions[splatIdx * 3 + cmp] = positions.get(splatIdx, cmp);
+  }
+  END_PAR_LOOP()
+
+  setProgress(1.0f);
+
+  return true;
+}
@@ -27,6 +27,11 @@
 #include <mutex>
 //
 #include "splat_set.h"
+#include "splat_reorder.h"
+
+namespace miniply {
+struct PLYElement;
+}
 
 //
 class PlyAsyncLoader
@@ -60,6 +65,7 @@ public:
   bool loadScene(std::string filename, SplatSet& output);
   // cancel scene loading if possible
   // non blocking, may have no effect
+  // a canceled load ends in FAILURE status
   void cancel();
   // return loader status
   State getStatus();
@@ -83,11 +89,60 @@ public:
     std::lock_guard<std::mutex> lock(m_mutex);
     return m_progress;
   }
+  // enables the multi-threaded chunked decoder for
+  // binary little endian files (default), other files
+  // always use the sequential path.
+  inline void setParallelLoading(bool enable)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_parallelLoading = enable;
+  }
+  // enables the memory mapped path for binary little endian
+  // files with the INRIA layout (default). attributes other than
+  // positions are then read in place from the mapped file.
+  inline void setMappedLoading(bool enable)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_mappedLoading = enable;
+  }
+  // reorders the splats along a space filling curve once
+  // loaded, E_ORDER_FILE keeps the order of the file (default).
+  // the attributes are then never read in place from a mapped file.
+  inline void setSpatialOrder(SpatialOrder order)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_spatialOrder = order;
+  }
+  // builds the level of detail hierarchy of splat_lod.h once loaded
+  // and reordered, the parents nodes are appended to the splat set.
+  // the attributes are then never read in place from a mapped file.
+  inline void setLodEnabled(bool enable)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_lodEnabled = enable;
+  }
 
 private:
   // actually loads the scene
   bool innerLoad(std::string filename, SplatSet& output);
 
+  // loads the vertex element by splitting its rows in ranges
+  // decoded by worker threads directly into output arrays.
+  // dataOffset is the offset of the vertex block in the file.
+  bool innerLoadParallel(const std::string& filename, size_t dataOffset, const miniply::PLYElement& vertexElement, SplatSet& output);
+
+  // maps the file and exposes the vertex attributes of output as
+  // strided views over the mapped vertex block, only positions are copied.
+  // the vertex element layout must have been validated by the caller.
+  bool innerLoadMapped(const std::string& filename, size_t dataOffset, const miniply::PLYElement& vertexElement, SplatSet& output);
+
+  // true if cancel was invoked since the load started
+  bool isCancelRequested()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_cancelRequested;
+  }
+
   // in {0.0,1.0}
   void setProgress(float progress)
   {
@@ -115,6 +170,14 @@ private:
   SplatSet* m_output = nullptr;
   // the loading percentage
   float m_progress = 0.0f;
+  // use the chunked multi-threaded decoder when possible
+  bool m_parallelLoading = true;
+  // read attributes in place from a memory mapped file when possible
+  bool m_mappedLoading = true;
+  // order of the splats after load
+  SpatialOrder m_spatialOrder = E_ORDER_FILE;
+  // build the level of detail hierarchy after load
+  bool m_lodEnabled = false;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,416 @@
+/*
+ * Copyright (c) 2023-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "sh_codebook.h"
+#include "sh_packing.h"
+#include "utilities.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <sstream>
+
+// vectors are processed with 48 floats (45 coefficients and zero padding)
+// so that the distance loops split evenly in 8 wide lanes
+static constexpr uint32_t s_stride = 48;
+// splats processed by a parallel task
+static constexpr uint32_t s_chunkSize = 16384;
+// Lloyd iterations of each k-means
+static constexpr uint32_t s_iterations = 10;
+// training vectors per cluster, the k-means run on subsets of the splat set
+static constexpr uint32_t s_samplesPerCluster = 64;
+static constexpr uint32_t s_maxCoarseSamples  = 65536;
+
+static uint32_t threadCount()
+{
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// highest complete SH degree of src
+static int shDegree(const SplatAttributeView& src)
+{
+  const uint32_t coefficients = src.components / 3;
+  return coefficients >= 15 ? 3 : (coefficients >= 8 ? 2 : (coefficients >= 3 ? 1 : 0));
+}
+
+// packs splats [begin, end) of src as float32 vectors of s_stride floats in dst
+static void packVectors(const SplatAttributeView& src, int degree, uint32_t begin, uint32_t end, float* dst)
+{
+  std::memset(dst, 0, size_t(end - begin) * s_stride * sizeof(float));
+  const SplatAttributeView range{src.data + begin * src.stride, src.stride, src.components};
+  packSphericalHarmonicsRange(FORMAT_FLOAT32, degree, range, 0, end - begin, dst, s_stride);
+}
+
+static inline float distance2(const float* a, const float* b)
+{
+  // 8 partial sums so that the loop is vectorized without reassociation
+  float sums[8] = {};
+  for(uint32_t i = 0; i < s_stride; i += 8)
+  {
+    for(uint32_t j = 0; j < 8; ++j)
+    {
+      const float d = a[i + j] - b[i + j];
+      sums[j] += d * d;
+    }
+  }
+  return ((sums[0] + sums[1]) + (sums[2] + sums[3])) + ((sums[4] + sums[5]) + (sums[6] + sums[7]));
+}
+
+static inline uint32_t nearest(const float* vector, const float* centroids, uint32_t count)
+{
+  uint32_t best     = 0;
+  float    bestDist = distance2(vector, centroids);
+  for(uint32_t c = 1; c < count; ++c)
+  {
+    const float dist = distance2(vector, centroids + size_t(c) * s_stride);
+    if(dist < bestDist)
+    {
+      bestDist = dist;
+      best     = c;
+    }
+  }
+  return best;
+}
+
+// Lloyd's k-means of count vectors into k centroids, initialized with distinct random vectors.
+// the assignment step is multi threaded if parallel is set.
+static void kmeans(const float* vectors, uint32_t count, uint32_t k, bool parallel, std::mt19937& rng, std::vector<float>& centroids)
+{
+  centroids.assign(size_t(k) * s_stride, 0.0f);
+  if(count == 0)
+    return;
+
+  // distinct random vectors, repeated if there are fewer vectors than centroids
+  std::vector<uint32_t> order(count);
+  std::iota(order.begin(), order.end(), 0);
+  for(uint32_t c = 0; c < std::min(k, count); ++c)
+    std::swap(order[c], order[c + rng() % (count - c)]);
+  for(uint32_t c = 0; c < k; ++c)
+    std::memcpy(&centroids[size_t(c) * s_stride], vectors + size_t(order[c % count]) * s_stride, s_stride * sizeof(float));
+  if(count <= k)
+    return;
+
+  std::vector<uint32_t> assignment(count);
+  std::vector<double>   sums(size_t(k) * s_stride);
+  std::vector<uint32_t> sizes(k);
+  for(uint32_t iter = 0; iter < s_iterations; ++iter)
+  {
+    auto assign = [&](uint32_t begin, uint32_t end) {
+      for(uint32_t v = begin; v < end; ++v)
+        assignment[v] = nearest(vectors + size_t(v) * s_stride, centroids.data(), k);
+    };
+    if(parallel)
+    {
+      nvh::parallel_batches_indexed<1>(
+          (count + s_chunkSize - 1) / s_chunkSize,
+          [&](uint64_t chunkIdx, uint32_t) {
+            const uint32_t begin = (uint32_t)chunkIdx * s_chunkSize;
+            assign(begin, std::min(count, begin + s_chunkSize));
+          },
+          threadCount());
+    }
+    else
+    {
+      assign(0, count);
+    }
+
+    // new centroids are the means of their vectors, empty ones are reseeded
+    std::fill(sums.begin(), sums.end(), 0.0);
+    std::fill(sizes.begin(), sizes.end(), 0);
+    for(uint32_t v = 0; v < count; ++v)
+    {
+      const float* vector = vectors + size_t(v) * s_stride;
+      double*      sum    = &sums[size_t(assignment[v]) * s_stride];
+      for(uint32_t i = 0; i < s_stride; ++i)
+        sum[i] += vector[i];
+      sizes[assignment[v]]++;
+    }
+    for(uint32_t c = 0; c < k; ++c)
+    {
+      float* centroid = &centroids[size_t(c) * s_stride];
+      if(sizes[c] == 0)
+      {
+        std::memcpy(centroid, vectors + size_t(rng() % count) * s_stride, s_stride * sizeof(float));
+        continue;
+      }
+      for(uint32_t i = 0; i < s_stride; ++i)
+        centroid[i] = float(sums[size_t(c) * s_stride + i] / sizes[c]);
+    }
+  }
+}
+
+// two levels, each splat is first assigned to one of coarseCount clusters, then
+// to one of the fineCount entries of this cluster, so that encoding a splat costs
+// coarseCount + fineCount distances instead of codebookSize
+static void codebookLevels(uint32_t codebookSize, uint32_t& coarseCount, uint32_t& fineCount)
+{
+  const uint32_t size = std::clamp(codebookSize, 1u, 65536u);
+  coarseCount         = std::max(1u, (uint32_t)std::lround(std::sqrt(double(size))));
+  fineCount           = std::max(1u, size / coarseCount);
+}
+
+uint32_t shCodebookEntryCount(uint32_t codebookSize)
+{
+  uint32_t coarseCount, fineCount;
+  codebookLevels(codebookSize, coarseCount, fineCount);
+  return coarseCount * fineCount;
+}
+
+bool buildShCodebook(const SplatAttributeView& src, uint32_t splatCount, uint32_t codebookSize, ShCodebook& codebook)
+{
+  codebook.entries.clear();
+  codebook.codes.clear();
+  const int degree = shDegree(src);
+  if(degree == 0 || splatCount == 0)
+    return false;
+
+  uint32_t coarseCount, fineCount;
+  codebookLevels(codebookSize, coarseCount, fineCount);
+  const uint32_t chunkCount = (splatCount + s_chunkSize - 1) / s_chunkSize;
+  std::mt19937   rng(1);
+
+  // coarse clusters, trained on evenly spaced splats
+  std::vector<float> coarse;
+  {
+    const uint32_t     sampleCount = std::min(splatCount, std::max(s_maxCoarseSamples, coarseCount * s_samplesPerCluster));
+    std::vector<float> samples(size_t(sampleCount) * s_stride);
+    START_PAR_LOOP(sampleCount, sampleIdx)
+    {
+      const uint32_t splatIdx = uint32_t(sampleIdx * splatCount / sampleCount);
+      packVectors(src, degree, splatIdx, splatIdx + 1, &samples[sampleIdx * s_stride]);
+    }
+    END_PAR_LOOP()
+    kmeans(samples.data(), sampleCount, coarseCount, true, rng, coarse);
+  }
+
+  // coarse cluster of each splat
+  std::vector<uint16_t> coarseOf(splatCount);
+  nvh::parallel_batches_indexed<1>(
+      chunkCount,
+      [&](uint64_t chunkIdx, uint32_t) {
+        const uint32_t     begin = (uint32_t)chunkIdx * s_chunkSize;
+        const uint32_t     end   = std::min(splatCount, begin + s_chunkSize);
+        std::vector<float> vectors(size_t(end - begin) * s_stride);
+        packVectors(src, degree, begin, end, vectors.data());
+        for(uint32_t splatIdx = begin; splatIdx < end; ++splatIdx)
+          coarseOf[splatIdx] = (uint16_t)nearest(&vectors[size_t(splatIdx - begin) * s_stride], coarse.data(), coarseCount);
+      },
+      threadCount());
+
+  std::vector<std::vector<uint32_t>> members(coarseCount);
+  for(uint32_t splatIdx = 0; splatIdx < splatCount; ++splatIdx)
+    members[coarseOf[splatIdx]].push_back(splatIdx);
+
+  // fine entries of each coarse cluster, trained on evenly spaced members
+  std::vector<std::vector<float>> fine(coarseCount);
+  nvh::parallel_batches_indexed<1>(
+      coarseCount,
+      [&](uint64_t clusterIdx, uint32_t) {
+        const std::vector<uint32_t>& clusterMembers = members[clusterIdx];
+        const uint32_t memberCount = (uint32_t)clusterMembers.size();
+        const uint32_t sampleCount = std::min(memberCount, fineCount * s_samplesPerCluster);
+        std::vector<float> samples(size_t(sampleCount) * s_stride);
+        for(uint32_t sampleIdx = 0; sampleIdx < sampleCount; ++sampleIdx)
+        {
+          const uint32_t splatIdx = clusterMembers[uint64_t(sampleIdx) * memberCount / sampleCount];
+          packVectors(src, degree, splatIdx, splatIdx + 1, &samples[size_t(sampleIdx) * s_stride]);
+        }
+        std::mt19937 clusterRng(uint32_t(clusterIdx) + 2);
+        kmeans(samples.data(), sampleCount, fineCount, false, clusterRng, fine[clusterIdx]);
+        // empty clusters keep their coarse centroid
+        if(sampleCount == 0)
+          for(uint32_t f = 0; f < fineCount; ++f)
+            std::memcpy(&fine[clusterIdx][size_t(f) * s_stride], &coarse[clusterIdx * s_stride], s_stride * sizeof(float));
+      },
+      threadCount());
+
+  // encoding
+  codebook.codes.resize(splatCount);
+  nvh::parallel_batches_indexed<1>(
+      chunkCount,
+      [&](uint64_t chunkIdx, uint32_t) {
+        const uint32_t     begin = (uint32_t)chunkIdx * s_chunkSize;
+        const uint32_t     end   = std::min(splatCount, begin + s_chunkSize);
+        std::vector<float> vectors(size_t(end - begin) * s_stride);
+        packVectors(src, degree, begin, end, vectors.data());
+        for(uint32_t splatIdx = begin; splatIdx < end; ++splatIdx)
+        {
+          const uint32_t cluster = coarseOf[splatIdx];
+          const uint32_t entry = nearest(&vectors[size_t(splatIdx - begin) * s_stride], fine[cluster].data(), fineCount);
+          codebook.codes[splatIdx] = (uint16_t)(cluster * fineCount + entry);
+        }
+      },
+      threadCount());
+
+  // the entries are the means of their splats, which can only lower the error
+  // of the encoding, entries without splats keep their trained value
+  const uint32_t      entryCount = coarseCount * fineCount;
+  std::vector<double> sums(size_t(entryCount) * s_stride, 0.0);
+  std::vector<uint32_t> sizes(entryCount, 0);
+  {
+    std::vector<float> vectors(size_t(s_chunkSize) * s_stride);
+    for(uint32_t begin = 0; begin < splatCount; begin += s_chunkSize)
+    {
+      const uint32_t end = std::min(splatCount, begin + s_chunkSize);
+      packVectors(src, degree, begin, end, vectors.data());
+      for(uint32_t splatIdx = begin; splatIdx < end; ++splatIdx)
+      {
+        const uint32_t code   = codebook.codes[splatIdx];
+        const float*   vector = &vectors[size_t(splatIdx - begin) * s_stride];
+        double*        sum    = &sums[size_t(code) * s_stride];
+        for(uint32_t i = 0; i < s_stride; ++i)
+          sum[i] += vector[i];
+        sizes[code]++;
+      }
+    }
+  }
+
+  codebook.entries.resize(size_t(entryCount) * ShCodebook::s_entryFloats);
+  for(uint32_t code = 0; code < entryCount; ++code)
+  {
+    float*       entry   = &codebook.entries[size_t(code) * ShCodebook::s_entryFloats];
+    const float* trained = &fine[code / fineCount][size_t(code % fineCount) * s_stride];
+    for(uint32_t i = 0; i < ShCodebook::s_entryFloats; ++i)
+      entry[i] = sizes[code] ? float(sums[size_t(code) * s_stride + i] / sizes[code]) : trained[i];
+  }
+  return true;
+}
+
+void decodeShCodebook(const ShCodebook& codebook, uint32_t splatIdx, float* coefficients)
+{
+  const float* entry = &codebook.entries[size_t(codebook.codes[splatIdx]) * ShCodebook::s_entryFloats];
+  std::memcpy(coefficients, entry, ShCodebook::s_entryFloats * sizeof(float));
+}
+
+// SH basis of degree 1 to 3 for direction dir, same constants and order as the shaders
+static void shBasis(const float dir[3], float basis[15])
+{
+  const float SH_C1   = 0.4886025119029199f;
+  const float SH_C2[] = {1.0925484f, -1.0925484f, 0.3153916f, -1.0925484f, 0.5462742f};
+  const float SH_C3[] = {-0.5900435899266435f, 2.890611442640554f, -0.4570457994644658f, 0.3731763325901154f,
+                         -0.4570457994644658f, 1.445305721320277f, -0.5900435899266435f};
+
+  const float x = dir[0], y = dir[1], z = dir[2];
+  const float xx = x * x, yy = y * y, zz = z * z;
+  basis[0]  = -SH_C1 * y;
+  basis[1]  = SH_C1 * z;
+  basis[2]  = -SH_C1 * x;
+  basis[3]  = SH_C2[0] * x * y;
+  basis[4]  = SH_C2[1] * y * z;
+  basis[5]  = SH_C2[2] * (2.0f * zz - xx - yy);
+  basis[6]  = SH_C2[3] * x * z;
+  basis[7]  = SH_C2[4] * (xx - yy);
+  basis[8]  = SH_C3[0] * y * (3.0f * xx - yy);
+  basis[9]  = SH_C3[1] * x * y * z;
+  basis[10] = SH_C3[2] * y * (4.0f * zz - xx - yy);
+  basis[11] = SH_C3[3] * z * (2.0f * zz - 3.0f * xx - 3.0f * yy);
+  basis[12] = SH_C3[4] * x * (4.0f * zz - xx - yy);
+  basis[13] = SH_C3[5] * z * (xx - yy);
+  basis[14] = SH_C3[6] * x * (xx - 3.0f * yy);
+}
+
+ShCodebookReport evaluateShCodebook(const SplatAttributeView& src, uint32_t splatCount, const ShCodebook& codebook)
+{
+  ShCodebookReport report;
+  const int        degree = shDegree(src);
+  if(degree == 0 || splatCount == 0 || codebook.codes.size() != splatCount)
+    return report;
+
+  // the 6 axis and the 8 diagonals
+  std::array<std::array<float, 15>, 14> bases;
+  for(uint32_t d = 0; d < 14; ++d)
+  {
+    float dir[3] = {0.0f, 0.0f, 0.0f};
+    if(d < 6)
+      dir[d / 2] = (d & 1) ? -1.0f : 1.0f;
+    else
+      for(uint32_t i = 0; i < 3; ++i)
+        dir[i] = (((d - 6) >> i) & 1) ? -0.57735027f : 0.57735027f;
+    shBasis(dir, bases[d].data());
+  }
+
+  // per chunk partial results, summed afterward
+  struct Partial
+  {
+    double coefficientSum = 0.0;
+    double coefficientMax = 0.0;
+    double radianceSum    = 0.0;
+  };
+  const uint32_t       chunkCount = (splatCount + s_chunkSize - 1) / s_chunkSize;
+  std::vector<Partial> partials(chunkCount);
+  const uint32_t       coefficientCount = uint32_t((degree + 1) * (degree + 1) - 1);
+
+  nvh::parallel_batches_indexed<1>(
+      chunkCount,
+      [&](uint64_t chunkIdx, uint32_t) {
+        const uint32_t     begin = (uint32_t)chunkIdx * s_chunkSize;
+        const uint32_t     end   = std::min(splatCount, begin + s_chunkSize);
+        std::vector<float> vectors(size_t(end - begin) * s_stride);
+        packVectors(src, degree, begin, end, vectors.data());
+        Partial& partial = partials[chunkIdx];
+        float    decoded[ShCodebook::s_entryFloats];
+        for(uint32_t splatIdx = begin; splatIdx < end; ++splatIdx)
+        {
+          decodeShCodebook(codebook, splatIdx, decoded);
+          const float* source = &vectors[size_t(splatIdx - begin) * s_stride];
+          for(uint32_t i = 0; i < coefficientCount * 3; ++i)
+          {
+            const double error = double(decoded[i]) - source[i];
+            partial.coefficientSum += error * error;
+            partial.coefficientMax = std::max(partial.coefficientMax, std::abs(error));
+          }
+          for(const auto& basis : bases)
+          {
+            for(uint32_t rgb = 0; rgb < 3; ++rgb)
+            {
+              double error = 0.0;
+              for(uint32_t i = 0; i < coefficientCount; ++i)
+                error += double(basis[i]) * (decoded[i * 3 + rgb] - source[i * 3 + rgb]);
+              partial.radianceSum += error * error;
+            }
+          }
+        }
+      },
+      threadCount());
+
+  for(const Partial& partial : partials)
+  {
+    report.coefficientRmse += partial.coefficientSum;
+    report.radianceRmse += partial.radianceSum;
+    report.coefficientMax = std::max(report.coefficientMax, partial.coefficientMax);
+  }
+  report.coefficientRmse = std::sqrt(report.coefficientRmse / (double(splatCount) * coefficientCount * 3));
+  report.radianceRmse    = std::sqrt(report.radianceRmse / (double(splatCount) * bases.size() * 3));
+  report.float32Bytes    = uint64_t(splatCount) * coefficientCount * 3 * sizeof(float);
+  report.codebookBytes   = codebook.codesBytes() + codebook.entriesBytes();
+  return report;
+}
+
+std::string ShCodebookReport::toString() const
+{
+  std::ostringstream stream;
+  stream << "SH codebook " << codebookBytes << " bytes, x"
+         << (codebookBytes ? double(float32Bytes) / double(codebookBytes) : 0.0) << " smaller than float32, coefficient RMSE "
+         << coefficientRmse << " (max " << coefficientMax << "), radiance RMSE " << radianceRmse;
+  return stream.str();
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2023-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#ifndef _SH_CODEBOOK_H_
+#define _SH_CODEBOOK_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "splat_set.h"
+#include "shaders/shaderio.h"
+
+// Vector quantized storage of the spherical harmonics of degree 1 to 3 (FORMAT_VQ).
+// The 45 coefficients of each splat are replaced by a 16 bit code, the index of the
+// nearest entry of a codebook built with a two level k-means over the splat set.
+// Entries use the GPU layout of packSphericalHarmonics (coefficient major, interleaved
+// rgb), zero padded to 45 floats when the file holds lower degrees.
+struct ShCodebook
+{
+  static constexpr uint32_t s_entryFloats = SH_VQ_ENTRY_FLOATS;  // floats per codebook entry
+  static constexpr uint32_t s_defaultSize = 4096;                // entries, at most 65536
+
+  std::vector<float>    entries;  // size() * s_entryFloats floats
+  std::vector<uint16_t> codes;    // one code per splat
+
+  inline uint32_t size() const { return uint32_t(entries.size() / s_entryFloats); }
+  // bytes used on the device, codes are padded to 32 bits
+  inline uint64_t codesBytes() const { return (codes.size() * sizeof(uint16_t) + 3) & ~uint64_t(3); }
+  inline uint64_t entriesBytes() const { return entries.size() * sizeof(float); }
+};
+
+// the splat set and the parameters a codebook is built for, a codebook is reused as
+// long as its key matches, e.g. when the storage or the other formats change
+struct ShCodebookKey
+{
+  std::string scene;             // file of the splat set
+  uint32_t    splatCount   = 0;  //
+  uint32_t    shComponents = 0;  // SH components of degree 1 to 3 per splat
+  uint32_t    spatialOrder = 0;  // SpatialOrder of splat_reorder.h
+  uint32_t    codebookSize = 0;  // requested entries
+
+  bool operator==(const ShCodebookKey&) const = default;
+};
+
+// quality and footprint of a codebook compared to the source coefficients
+struct ShCodebookReport
+{
+  double   coefficientRmse = 0.0;  // over all the coefficients
+  double   coefficientMax  = 0.0;  // largest absolute coefficient error
+  double   radianceRmse    = 0.0;  // of the view dependent color, over a set of directions
+  uint64_t float32Bytes    = 0;    // source coefficients stored as float32
+  uint64_t codebookBytes   = 0;    // codes and entries
+
+  std::string toString() const;
+};
+
+// number of entries of a codebook built for codebookSize, the two levels
+// of the k-means may give a few entries less than requested
+uint32_t shCodebookEntryCount(uint32_t codebookSize);
+
+// builds a codebook of at most codebookSize entries for splatCount splats of src, multi threaded.
+// returns false if src holds no coefficients.
+bool buildShCodebook(const SplatAttributeView& src, uint32_t splatCount, uint32_t codebookSize, ShCodebook& codebook);
+
+// CPU reference decoder, writes the s_entryFloats coefficients of splat splatIdx
+// as fetchSh does from the codebook on the GPU
+void decodeShCodebook(const ShCodebook& codebook, uint32_t splatIdx, float* coefficients);
+
+// compares the decoded coefficients to the source ones
+ShCodebookReport evaluateShCodebook(const SplatAttributeView& src, uint32_t splatCount, const ShCodebook& codebook);
+
+#endif
@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2023-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "sh_packing.h"
+#include "utilities.h"
+
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <sstream>
+#include <vector>
+// vectorization, F16C conversion is selected at runtime on x86
+#if defined(__x86_64__) || defined(_M_X64)
+#define SH_PACKING_X86_SIMD
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SH_PACKING_F16C_FUNCTION
+#else
+#define SH_PACKING_F16C_FUNCTION __attribute__((target("avx,f16c")))
+#endif
+#endif
+
+// splats processed by a parallel task
+static constexpr uint32_t s_chunkSize = 16384;
+
+// number of coefficients per channel of degree 1 to Degree
+template <int Degree>
+static constexpr uint32_t coefficientCount()
+{
+  return (Degree + 1) * (Degree + 1) - 1;
+}
+
+// gathers the coefficients of a splat in GPU order in transposed.
+// srcCoefficients is the number of coefficients per channel in the source,
+// can be greater than coefficientCount<Degree>() if the file holds higher degrees.
+template <int Degree>
+static inline void transposeSplat(const char* row, uint32_t srcCoefficients, float* transposed)
+{
+  constexpr uint32_t count = coefficientCount<Degree>();
+  // one fixed size copy per channel, rows of mapped files are not necessarily aligned
+  float channels[3][count];
+  for(uint32_t rgb = 0; rgb < 3; ++rgb)
+    std::memcpy(channels[rgb], row + rgb * srcCoefficients * sizeof(float), count * sizeof(float));
+  for(uint32_t i = 0; i < count; ++i)
+  {
+    transposed[i * 3 + 0] = channels[0][i];
+    transposed[i * 3 + 1] = channels[1][i];
+    transposed[i * 3 + 2] = channels[2][i];
+  }
+}
+
+template <int Format, int Degree>
+static void packKernel(const SplatAttributeView& src, uint32_t begin, uint32_t end, void* dst, uint32_t dstStride)
+{
+  constexpr uint32_t count           = 3 * coefficientCount<Degree>();
+  const uint32_t     srcCoefficients = src.components / 3;
+  float              transposed[count];
+
+  for(uint32_t splatIdx = begin; splatIdx < end; ++splatIdx)
+  {
+    transposeSplat<Degree>(src.data + splatIdx * src.stride, srcCoefficients, transposed);
+    const uint64_t dstBase = uint64_t(dstStride) * splatIdx;
+    if constexpr(Format == FORMAT_FLOAT32)
+    {
+      std::memcpy(static_cast<float*>(dst) + dstBase, transposed, sizeof(transposed));
+    }
+    else if constexpr(Format == FORMAT_FLOAT16)
+    {
+      uint16_t* out = static_cast<uint16_t*>(dst) + dstBase;
+      for(uint32_t i = 0; i < count; ++i)
+        out[i] = glm::packHalf1x16(transposed[i]);
+    }
+    else
+    {
+      // same rounding as toUint8(v, -1, 1), half away from zero, written to be vectorized
+      uint8_t* out = static_cast<uint8_t*>(dst) + dstBase;
+      for(uint32_t i = 0; i < count; ++i)
+      {
+        const float   scaled    = std::clamp((transposed[i] + 1.0f) * 0.5f * 255.0f, 0.0f, 255.0f);
+        const int32_t truncated = (int32_t)scaled;
+        out[i]                  = uint8_t(truncated + (scaled - float(truncated) >= 0.5f ? 1 : 0));
+      }
+    }
+  }
+}
+
+#if defined(SH_PACKING_X86_SIMD)
+// half conversion with the F16C instructions, 8 values at a time.
+// rounds ties to even where glm::packHalf1x16 rounds them away from zero.
+template <int Degree>
+SH_PACKING_F16C_FUNCTION static void packKernelF16c(const SplatAttributeView& src, uint32_t begin, uint32_t end, void* dst, uint32_t dstStride)
+{
+  constexpr uint32_t count           = 3 * coefficientCount<Degree>();
+  const uint32_t     srcCoefficients = src.components / 3;
+  float              transposed[count];
+
+  for(uint32_t splatIdx = begin; splatIdx < end; ++splatIdx)
+  {
+    transposeSplat<Degree>(src.data + splatIdx * src.stride, srcCoefficients, transposed);
+    uint16_t* out = static_cast<uint16_t*>(dst) + uint64_t(dstStride) * splatIdx;
+    uint32_t  i   = 0;
+    for(; i + 8 <= count; i += 8)
+    {
+      const __m128i half = _mm256_cvtps_ph(_mm256_loadu_ps(transposed + i), _MM_FROUND_TO_NEAREST_INT);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), half);
+    }
+    for(; i < count; ++i)
+      out[i] = (uint16_t)_mm_extract_epi16(_mm_cvtps_ph(_mm_set_ss(transposed[i]), _MM_FROUND_TO_NEAREST_INT), 0);
+  }
+}
+
+// F16C availability is checked at runtime so that the binary still runs on older CPUs
+static bool cpuSupportsF16c()
+{
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 1);
+  const bool osxsave = (info[2] & (1 << 27)) != 0;
+  const bool avx     = (info[2] & (1 << 28)) != 0;
+  const bool f16c    = (info[2] & (1 << 29)) != 0;
+  return osxsave && avx && f16c && (_xgetbv(0) & 6) == 6;
+#else
+  return __builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c");
+#endif
+}
+#endif
+
+using PackKernel = void (*)(const SplatAttributeView&, uint32_t, uint32_t, void*, uint32_t);
+
+// kernel for the format and the degree, nullptr if there is nothing to pack
+static PackKernel selectKernel(int format, int degree)
+{
+  if(degree < 1 || degree > 3 || format < FORMAT_FLOAT32 || format > FORMAT_UINT8)
+    return nullptr;
+
+  // indexed by [format][degree - 1]
+  static const std::array<std::array<PackKernel, 3>, 3> kernels = []() {
+    std::array<std::array<PackKernel, 3>, 3> table = {{
+        {packKernel<FORMAT_FLOAT32, 1>, packKernel<FORMAT_FLOAT32, 2>, packKernel<FORMAT_FLOAT32, 3>},
+        {packKernel<FORMAT_FLOAT16, 1>, packKernel<FORMAT_FLOAT16, 2>, packKernel<FORMAT_FLOAT16, 3>},
+        {packKernel<FORMAT_UINT8, 1>, packKernel<FORMAT_UINT8, 2>, packKernel<FORMAT_UINT8, 3>},
+    }};
+#if defined(SH_PACKING_X86_SIMD)
+    if(cpuSupportsF16c())
+      table[FORMAT_FLOAT16] = {packKernelF16c<1>, packKernelF16c<2>, packKernelF16c<3>};
+#endif
+    return table;
+  }();
+  return kernels[format][degree - 1];
+}
+
+void packSphericalHarmonics(int format, int degree, const SplatAttributeView& src, uint32_t splatCount, void* dst, uint32_t dstStride)
+{
+  const PackKernel kernel = selectKernel(format, degree);
+  if(!kernel)
+    return;
+
+  const uint32_t chunkCount = (splatCount + s_chunkSize - 1) / s_chunkSize;
+  nvh::parallel_batches_indexed<1>(
+      chunkCount,
+      [&](uint64_t chunkIdx, uint32_t) {
+        const uint32_t begin = (uint32_t)chunkIdx * s_chunkSize;
+        const uint32_t end   = std::min(splatCount, begin + s_chunkSize);
+        kernel(src, begin, end, dst, dstStride);
+      },
+      (uint32_t)std::thread::hardware_concurrency());
+}
+
+void packSphericalHarmonicsRange(int format, int degree, const SplatAttributeView& src, uint32_t begin, uint32_t end, void* dst, uint32_t dstStride)
+{
+  const PackKernel kernel = selectKernel(format, degree);
+  if(kernel)
+    kernel(src, begin, end, dst, dstStride);
+}
+
+void packSphericalHarmonicsReference(int format, int degree, const SplatAttributeView& src, uint32_t splatCount, void* dst, uint32_t dstStride)
+{
+  const uint32_t sphericalHarmonicsCoefficientsPerChannel = src.components / 3;
+  // first coefficient and coefficient count of each degree in a channel
+  const int degreeStart[3] = {0, 3, 8};
+  const int degreeCount[3] = {3, 5, 7};
+
+  START_PAR_LOOP(splatCount, splatIdx)
+  {
+    const auto destBase  = uint64_t(dstStride) * splatIdx;
+    int        dstOffset = 0;
+    for(auto d = 0; d < degree; d++)
+    {
+      for(auto i = 0; i < degreeCount[d]; i++)
+      {
+        for(auto rgb = 0; rgb < 3; rgb++)
+        {
+          const auto srcIndex = sphericalHarmonicsCoefficientsPerChannel * rgb + degreeStart[d] + i;
+          const auto dstIndex = destBase + dstOffset++;  // inc after add
+
+          storeSh(format, src.get(splatIdx, srcIndex), dst, dstIndex);
+        }
+      }
+    }
+  }
+  END_PAR_LOOP()
+}
+
+std::string benchmarkSphericalHarmonicsPacking(const SplatAttributeView& src, uint32_t splatCount)
+{
+  const uint32_t coefficients = src.components / 3;
+  const int      degree       = coefficients >= 15 ? 3 : (coefficients >= 8 ? 2 : (coefficients >= 3 ? 1 : 0));
+  if(degree == 0 || splatCount == 0)
+    return "No spherical harmonics to pack";
+
+  const uint32_t     stride      = 3 * ((degree + 1) * (degree + 1) - 1);
+  const char*        names[3]    = {"float32", "float16", "uint8"};
+  const int          sizes[3]    = {4, 2, 1};
+  const int          iterations  = 5;  // best time is kept
+  std::ostringstream report;
+
+  for(int format = FORMAT_FLOAT32; format <= FORMAT_UINT8; ++format)
+  {
+    std::vector<uint8_t> reference(uint64_t(splatCount) * stride * sizes[format]);
+    std::vector<uint8_t> specialized(reference.size());
+
+    auto timeBest = [&](auto&& pack) {
+      double best = 0.0;
+      for(int iter = 0; iter < iterations; ++iter)
+      {
+        auto         startTime = std::chrono::high_resolution_clock::now();
+        pack();
+        auto         endTime   = std::chrono::high_resolution_clock::now();
+        const double time      = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+        best                   = iter == 0 ? time : std::min(best, time);
+      }
+      return best;
+    };
+    const double referenceTime = timeBest(
+        [&] { packSphericalHarmonicsReference(format, degree, src, splatCount, reference.data(), stride); });
+    const double specializedTime =
+        timeBest([&] { packSphericalHarmonics(format, degree, src, splatCount, specialized.data(), stride); });
+
+    // halfs may differ by one unit on ties depending on the rounding mode of the conversion
+    uint64_t mismatches = 0;
+    if(format == FORMAT_FLOAT16)
+    {
+      const uint16_t* a = reinterpret_cast<const uint16_t*>(reference.data());
+      const uint16_t* b = reinterpret_cast<const uint16_t*>(specialized.data());
+      for(uint64_t i = 0; i < reference.size() / 2; ++i)
+        mismatches += std::abs(int(a[i]) - int(b[i])) > 1;
+    }
+    else
+    {
+      for(uint64_t i = 0; i < reference.size(); ++i)
+        mismatches += reference[i] != specialized[i];
+    }
+
+    report << names[format] << " degree " << degree << ": per element " << referenceTime << "ms, specialized "
+           << specializedTime << "ms, x" << (specializedTime > 0.0 ? referenceTime / specializedTime : 0.0) << ", "
+           << mismatches << " mismatches" << std::endl;
+  }
+  return report.str();
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2023-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#ifndef _SH_PACKING_H_
+#define _SH_PACKING_H_
+
+#include <cstdint>
+#include <string>
+#include <algorithm>
+#include <cmath>
+
+#include <glm/gtc/packing.hpp>
+
+#include "splat_set.h"
+#include "shaders/shaderio.h"
+
+// Conversion of the spherical harmonics of degree 1 to 3 from the ply layout to the
+// GPU layout. In the ply file (f_rest), the coefficients of a splat are channel major:
+// all the red coefficients, then the green ones, then the blue ones. On the GPU they are
+// coefficient major with interleaved rgb: c0.r c0.g c0.b c1.r ...
+
+// quantizes v from [rangeMin, rangeMax] to [0, 255]
+inline uint8_t toUint8(float v, float rangeMin, float rangeMax)
+{
+  float normalized = (v - rangeMin) / (rangeMax - rangeMin);
+  return static_cast<uint8_t>(std::clamp(std::round(normalized * 255.0f), 0.0f, 255.0f));
+}
+
+// stores value at dstIndex of dstBuffer in the given format (FORMAT_* of shaderio.h)
+inline void storeSh(int format, float value, void* dstBuffer, uint64_t dstIndex)
+{
+  if(format == FORMAT_FLOAT32)
+    static_cast<float*>(dstBuffer)[dstIndex] = value;
+  else if(format == FORMAT_FLOAT16)
+    static_cast<uint16_t*>(dstBuffer)[dstIndex] = glm::packHalf1x16(value);
+  else if(format == FORMAT_UINT8)
+    static_cast<uint8_t*>(dstBuffer)[dstIndex] = toUint8(value, -1., 1.);
+}
+
+// packs the coefficients of degree 1 to degree of splatCount splats of src into dst,
+// in format (FORMAT_* of shaderio.h), dstStride elements apart (padding is not written).
+// Uses kernels specialized at compile time for the format and the degree, multi threaded.
+void packSphericalHarmonics(int format, int degree, const SplatAttributeView& src, uint32_t splatCount, void* dst, uint32_t dstStride);
+
+// same as packSphericalHarmonics for splats [begin, end) only, on the calling thread
+void packSphericalHarmonicsRange(int format, int degree, const SplatAttributeView& src, uint32_t begin, uint32_t end, void* dst, uint32_t dstStride);
+
+// same result as packSphericalHarmonics, one storeSh per coefficient, used as a reference
+void packSphericalHarmonicsReference(int format, int degree, const SplatAttributeView& src, uint32_t splatCount, void* dst, uint32_t dstStride);
+
+// times both paths on src for each format and degree 3 (or the degree of src if lower),
+// checks that they give the same result, returns a one line report per format
+std::string benchmarkSphericalHarmonicsPacking(const SplatAttributeView& src, uint32_t splatCount);
+
+#endif
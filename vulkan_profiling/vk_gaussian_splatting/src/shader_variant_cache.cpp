@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2023-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <sstream>
+#include <cstdio>
+
+#include "shader_variant_cache.h"
+
+namespace {
+
+constexpr uint64_t s_fnvOffset = 14695981039346656037ull;
+constexpr uint64_t s_fnvPrime  = 1099511628211ull;
+
+// FNV-1a 64, the terminating zero is hashed too so that consecutive strings cannot alias
+uint64_t fnv1a(uint64_t hash, const char* data, size_t size)
+{
+  for(size_t i = 0; i < size; ++i)
+  {
+    hash ^= (uint8_t)data[i];
+    hash *= s_fnvPrime;
+  }
+  hash *= s_fnvPrime;  // terminating zero
+  return hash;
+}
+
+inline uint64_t fnv1a(uint64_t hash, const std::string& str)
+{
+  return fnv1a(hash, str.data(), str.size());
+}
+
+std::string toHex(uint64_t value)
+{
+  char str[17];
+  snprintf(str, sizeof(str), "%016llx", (unsigned long long)value);
+  return str;
+}
+
+}  // namespace
+
+void ShaderVariantCache::init(const std::string& folder, const std::vector<std::string>& sourceDirectories, nvvk::ShaderModuleManager& manager)
+{
+  m_folder.clear();
+  m_sourceFolder.clear();
+  resetStats();
+
+  if(folder.empty())
+    return;
+
+  // the shaders are looked up in the same order as the shader manager does
+  std::error_code ec;
+  for(const auto& directory : sourceDirectories)
+  {
+    if(std::filesystem::exists(std::filesystem::path(directory) / "shaderio.h", ec))
+    {
+      m_sourceFolder = directory;
+      break;
+    }
+  }
+  if(m_sourceFolder.empty())
+  {
+    std::cout << "Warning: shader sources not found, SPIR-V cache disabled" << std::endl;
+    return;
+  }
+
+  std::filesystem::create_directories(folder, ec);
+  if(!std::filesystem::is_directory(folder, ec))
+  {
+    std::cout << "Warning: cannot create the SPIR-V cache folder " << folder << std::endl;
+    return;
+  }
+
+  m_folder = folder;
+  manager.addDirectory(m_folder);
+  refreshSources();
+}
+
+void ShaderVariantCache::refreshSources()
+{
+  if(isEnabled())
+    m_sourceHash = hashSources(m_sourceFolder);
+}
+
+uint64_t ShaderVariantCache::hashSources(const std::string& folder)
+{
+  std::vector<std::filesystem::path> files;
+  std::error_code                    ec;
+  for(const auto& entry : std::filesystem::directory_iterator(folder, ec))
+  {
+    const auto extension = entry.path().extension();
+    if(entry.is_regular_file(ec) && (extension == ".glsl" || extension == ".h"))
+      files.push_back(entry.path());
+  }
+  std::sort(files.begin(), files.end(),
+            [](const auto& a, const auto& b) { return a.filename().string() < b.filename().string(); });
+
+  uint64_t hash = s_fnvOffset;
+  for(const auto& file : files)
+  {
+    std::ifstream      stream(file, std::ios::binary);
+    std::ostringstream content;
+    content << stream.rdbuf();
+    hash = fnv1a(hash, file.filename().string());
+    hash = fnv1a(hash, content.str());
+  }
+  return hash;
+}
+
+std::string ShaderVariantCache::variantFilename(const std::string& filename, const std::string& prepend) const
+{
+  // one define per line, sorted so that only the set of defines matters
+  std::vector<std::string> lines;
+  std::istringstream       stream(prepend);
+  for(std::string line; std::getline(stream, line);)
+  {
+    if(!line.empty())
+      lines.push_back(line);
+  }
+  std::sort(lines.begin(), lines.end());
+  std::string defines;
+  for(const auto& line : lines)
+    defines += line + "\n";
+
+  uint64_t hash = fnv1a(s_fnvOffset, std::string(s_version));
+  hash          = fnv1a(hash, filename);
+  hash          = fnv1a(hash, defines);
+  hash          = fnv1a(hash, toHex(m_sourceHash));
+  return toHex(hash) + ".spv";
+}
+
+nvvk::ShaderModuleID ShaderVariantCache::createShaderModule(nvvk::ShaderModuleManager& manager,
+                                                            uint32_t                   stage,
+                                                            const std::string&         filename,
+                                                            const std::string&         prepend)
+{
+  if(!isEnabled())
+    return manager.createShaderModule(stage, filename, prepend);
+
+  const std::string variant = variantFilename(filename, prepend);
+  const auto        path    = std::filesystem::path(m_folder) / variant;
+  std::error_code   ec;
+  if(std::filesystem::exists(path, ec))
+  {
+    nvvk::ShaderModuleID id = manager.createShaderModule(stage, variant, "", nvh::ShaderFileManager::FILETYPE_SPIRV);
+    if(manager.isValid(id))
+    {
+      ++m_hits;
+      return id;
+    }
+    // unreadable entry, replaced below
+    manager.destroyShaderModule(id);
+    std::filesystem::remove(path, ec);
+  }
+
+  nvvk::ShaderModuleID id = manager.createShaderModule(stage, filename, prepend);
+  if(!manager.isValid(id))
+    return id;
+
+  // requires the shader manager to keep the SPIR-V of the modules (m_keepModuleSPIRV)
+  size_t      size = 0;
+  const char* code = manager.getCode(id, &size);
+  if(code && size)
+  {
+    // written aside then renamed, a concurrent run never reads a partial file
+    const auto tmpPath = std::filesystem::path(m_folder) / (variant + ".tmp");
+    {
+      std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+      file.write(code, (std::streamsize)size);
+    }
+    std::filesystem::rename(tmpPath, path, ec);
+    if(ec)
+      std::filesystem::remove(tmpPath, ec);
+    else
+      ++m_fills;
+  }
+  return id;
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2023-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#ifndef _SHADER_VARIANT_CACHE_H_
+#define _SHADER_VARIANT_CACHE_H_
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <nvvk/shadermodulemanager_vk.hpp>
+
+// On disk cache of the SPIR-V of the 3DGS shader permutations.
+// A permutation is identified by the shader file name, its set of defines (the prepend
+// given to the shader manager, line order does not matter) and a hash of all the shader
+// sources. Each one is stored as <hash>.spv in the cache folder, filled ahead of time
+// by build_shader_variants.py (shader_variants build target) and at runtime with
+// the permutations compiled on a miss. Both sides must compute the same names, see variantFilename.
+class ShaderVariantCache
+{
+public:
+  // folder is the cache folder, created if needed, empty disables the cache.
+  // sourceDirectories are the shader search paths, the first one holding the shaders is hashed.
+  // Adds folder to the search paths of manager so that cached SPIR-V files can be loaded by name.
+  void init(const std::string& folder, const std::vector<std::string>& sourceDirectories, nvvk::ShaderModuleManager& manager);
+
+  // hashes the shader sources again, to call before a batch of createShaderModule
+  // so that edited shaders are never served from the cache
+  void refreshSources();
+
+  // returns the module of the permutation, loaded from the cache if present, compiled
+  // from the GLSL source and added to the cache otherwise
+  nvvk::ShaderModuleID createShaderModule(nvvk::ShaderModuleManager& manager,
+                                          uint32_t                   stage,
+                                          const std::string&         filename,
+                                          const std::string&         prepend);
+
+  // name of the cached SPIR-V file of a permutation, for the current sources
+  std::string variantFilename(const std::string& filename, const std::string& prepend) const;
+
+  // FNV-1a 64 of the *.glsl and *.h files of folder, by increasing file name
+  static uint64_t hashSources(const std::string& folder);
+
+  [[nodiscard]] inline bool isEnabled() const { return !m_folder.empty(); }
+
+  // modules loaded from and added to the cache since the last resetStats
+  [[nodiscard]] inline uint32_t hits() const { return m_hits; }
+  [[nodiscard]] inline uint32_t fills() const { return m_fills; }
+  inline void                   resetStats() { m_hits = m_fills = 0; }
+
+private:
+  // increase when the naming scheme or the compilation options change
+  static constexpr const char* s_version = "vkgs-spirv-1";
+
+  std::string m_folder;
+  std::string m_sourceFolder;
+  uint64_t    m_sourceHash = 0;
+  uint32_t    m_hits       = 0;
+  uint32_t    m_fills      = 0;
+};
+
+#endif
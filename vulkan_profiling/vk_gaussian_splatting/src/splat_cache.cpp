@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2023-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <filesystem>
+#include <iostream>
+#include <cstring>
+
+#include "splat_cache.h"
+
+std::string SplatCache::cacheFilename(const std::string& plyFilename)
+{
+  return std::filesystem::path(plyFilename).replace_extension(".splatcache").string();
+}
+
+bool SplatCache::identifySource(const std::string& plyFilename, Header& header)
+{
+  std::error_code ec;
+  const auto      size = std::filesystem::file_size(plyFilename, ec);
+  if(ec)
+    return false;
+  const auto time = std::filesystem::last_write_time(plyFilename, ec);
+  if(ec)
+    return false;
+  header.sourceSize = (uint64_t)size;
+  header.sourceTime = (int64_t)time.time_since_epoch().count();
+  return true;
+}
+
+bool SplatCache::openForRead(const std::string& plyFilename, const Description& desc)
+{
+  close();
+
+  Header expected;
+  if(!identifySource(plyFilename, expected))
+    return false;
+
+  m_filename = cacheFilename(plyFilename);
+  m_file.open(m_filename, std::ios::in | std::ios::binary);
+  if(!m_file.is_open())
+    return false;
+
+  Header header;
+  if(!m_file.read(reinterpret_cast<char*>(&header), sizeof(Header)) || memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0
+     || header.version != s_version || !header.complete || header.sourceSize != expected.sourceSize
+     || header.sourceTime != expected.sourceTime || header.desc.splatCount != desc.splatCount
+     || header.desc.shFormat != desc.shFormat || header.desc.shComponentCount != desc.shComponentCount
+     || header.desc.centersFormat != desc.centersFormat || header.desc.covariancesFormat != desc.covariancesFormat
+     || header.desc.colorsFormat != desc.colorsFormat || header.desc.spatialOrder != desc.spatialOrder
+     || header.desc.lodLeafCount != desc.lodLeafCount)
+  {
+    m_file.close();
+    std::cout << "Splat cache " << m_filename << " is missing or out of date" << std::endl;
+    return false;
+  }
+
+  m_header      = header;
+  m_mode        = E_READ;
+  m_nextSection = 0;
+  return true;
+}
+
+bool SplatCache::openForWrite(const std::string& plyFilename, const Description& desc)
+{
+  close();
+
+  Header header;
+  if(!identifySource(plyFilename, header))
+    return false;
+  header.version = s_version;
+  header.desc    = desc;
+
+  m_filename    = cacheFilename(plyFilename);
+  m_tmpFilename = m_filename + ".tmp";
+  m_file.open(m_tmpFilename, std::ios::out | std::ios::binary | std::ios::trunc);
+  // the header is rewritten by close once complete
+  if(!m_file.is_open() || !m_file.write(reinterpret_cast<const char*>(&header), sizeof(Header)))
+  {
+    std::cout << "Warning: cannot create splat cache " << m_tmpFilename << std::endl;
+    m_file.close();
+    return false;
+  }
+
+  m_header      = header;
+  m_mode        = E_WRITE;
+  m_nextSection = 0;
+  return true;
+}
+
+bool SplatCache::readSection(Section section, void* dst, uint64_t size)
+{
+  if(m_mode != E_READ || section != m_nextSection || m_header.sectionSizes[section] != size)
+    return false;
+  if(!m_file.read(static_cast<char*>(dst), (std::streamsize)size))
+  {
+    std::cout << "Error: splat cache " << m_filename << " is truncated" << std::endl;
+    return false;
+  }
+  ++m_nextSection;
+  return true;
+}
+
+bool SplatCache::skipSection(Section section, uint64_t size)
+{
+  if(m_mode != E_READ || section != m_nextSection || m_header.sectionSizes[section] != size)
+    return false;
+  if(!m_file.seekg((std::streamoff)size, std::ios::cur))
+  {
+    std::cout << "Error: splat cache " << m_filename << " is truncated" << std::endl;
+    return false;
+  }
+  ++m_nextSection;
+  return true;
+}
+
+uint64_t SplatCache::sectionOffset(Section section) const
+{
+  uint64_t offset = sizeof(Header);
+  for(uint32_t i = 0; i < section; ++i)
+    offset += m_header.sectionSizes[i];
+  return offset;
+}
+
+bool SplatCache::writeSection(Section section, const void* src, uint64_t size)
+{
+  if(m_mode != E_WRITE || section != m_nextSection)
+    return false;
+  if(!m_file.write(static_cast<const char*>(src), (std::streamsize)size))
+  {
+    std::cout << "Warning: cannot write splat cache " << m_tmpFilename << std::endl;
+    return false;
+  }
+  m_header.sectionSizes[section] = size;
+  ++m_nextSection;
+  return true;
+}
+
+bool SplatCache::beginSection(Section section, uint64_t size)
+{
+  m_blockSection = -1;
+  m_sectionBytes = 0;
+  if(section != m_nextSection || (m_mode == E_READ && m_header.sectionSizes[section] != size) || m_mode == E_CLOSED)
+    return false;
+  m_blockSection = section;
+  return m_mode == E_READ;
+}
+
+bool SplatCache::readBlock(void* dst, uint64_t size)
+{
+  if(m_mode != E_READ || m_blockSection < 0 || m_sectionBytes + size > m_header.sectionSizes[m_blockSection])
+    return false;
+  if(!m_file.read(static_cast<char*>(dst), (std::streamsize)size))
+  {
+    std::cout << "Error: splat cache " << m_filename << " is truncated" << std::endl;
+    m_blockSection = -1;
+    return false;
+  }
+  m_sectionBytes += size;
+  return true;
+}
+
+bool SplatCache::writeBlock(const void* src, uint64_t size)
+{
+  if(m_mode != E_WRITE || m_blockSection < 0)
+    return false;
+  if(!m_file.write(static_cast<const char*>(src), (std::streamsize)size))
+  {
+    // the section is not ended, close() then drops the incomplete cache
+    std::cout << "Warning: cannot write splat cache " << m_tmpFilename << std::endl;
+    m_blockSection = -1;
+    return false;
+  }
+  m_sectionBytes += size;
+  return true;
+}
+
+void SplatCache::endSection()
+{
+  if(m_blockSection < 0)
+    return;
+  if(m_mode == E_WRITE)
+    m_header.sectionSizes[m_blockSection] = m_sectionBytes;
+  ++m_nextSection;
+  m_blockSection = -1;
+}
+
+bool SplatCache::close()
+{
+  bool success = true;
+
+  if(m_mode == E_WRITE)
+  {
+    // finalize the header then make the file visible
+    m_header.complete = m_nextSection == E_SECTION_COUNT;
+    success           = m_header.complete && m_file.seekp(0)
+              && m_file.write(reinterpret_cast<const char*>(&m_header), sizeof(Header));
+    m_file.close();
+
+    std::error_code ec;
+    if(success)
+    {
+      std::filesystem::rename(m_tmpFilename, m_filename, ec);
+      success = !ec;
+    }
+    if(success)
+    {
+      std::cout << "Splat cache written to " << m_filename << std::endl;
+    }
+    else
+    {
+      std::filesystem::remove(m_tmpFilename, ec);
+    }
+  }
+  else if(m_mode == E_READ)
+  {
+    m_file.close();
+  }
+
+  m_mode        = E_CLOSED;
+  m_nextSection = 0;
+  return success;
+}
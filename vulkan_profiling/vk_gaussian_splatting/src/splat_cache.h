@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2023-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _SPLAT_CACHE_H_
+#define _SPLAT_CACHE_H_
+
+#include <string>
+#include <fstream>
+#include <cstdint>
+
+// Preprocessed splat data stored next to the source ply file (.splatcache).
+// Holds the GPU ready payloads produced by initDataBuffers (centers, covariances,
+// colors and SH in the given formats) so that later launches stream them directly
+// into the staging buffers instead of recomputing them from the ply attributes.
+// A cache is only used if its version, content description and source
+// file size and date match, it is rewritten otherwise.
+class SplatCache
+{
+public:
+  // sections, always stored in this order
+  enum Section
+  {
+    E_CENTERS,      // 3 floats per splat, codes then chunk bounds for FORMAT_UNORM16
+    E_COVARIANCES,  // 6 floats or halfs per splat
+    E_COLORS,       // 4 floats or unorm8 per splat, RGB from SH degree 0 and opacity
+    E_SH,           // SH degree 1 to 3 in the format given by the description, codes then codebook for FORMAT_VQ
+    E_SECTION_COUNT
+  };
+
+  // what the payloads must be made of to be reused
+  struct Description
+  {
+    uint64_t splatCount        = 0;
+    uint32_t shFormat          = 0;  // FORMAT_FLOAT32, FORMAT_FLOAT16, FORMAT_UINT8 or FORMAT_VQ
+    uint32_t shComponentCount  = 0;  // SH components of degree 1 to 3 per splat
+    uint32_t centersFormat     = 0;  // FORMAT_FLOAT32 or FORMAT_UNORM16
+    uint32_t covariancesFormat = 0;  // FORMAT_FLOAT32 or FORMAT_FLOAT16
+    uint32_t colorsFormat      = 0;  // FORMAT_FLOAT32 or FORMAT_UINT8
+    uint32_t spatialOrder      = 0;  // SpatialOrder of splat_reorder.h
+    uint32_t lodLeafCount      = 0;  // leaves of the level of detail hierarchy, 0 if none
+  };
+
+public:
+  ~SplatCache() { close(); }
+
+  // returns the cache file name associated to a ply file
+  static std::string cacheFilename(const std::string& plyFilename);
+
+  // opens an existing cache for reading
+  // returns false if there is no cache or if it does not match desc or the source file
+  bool openForRead(const std::string& plyFilename, const Description& desc);
+
+  // creates a new cache for writing, the file is only
+  // made visible by close() if all the sections were written
+  bool openForWrite(const std::string& plyFilename, const Description& desc);
+
+  // reads the next section, size must match the stored one
+  // returns false on failure, the cache shall then not be used anymore
+  bool readSection(Section section, void* dst, uint64_t size);
+
+  // skips the next section, size must match the stored one. For the sections
+  // accessed in place in the cache file afterward, see sectionOffset
+  bool skipSection(Section section, uint64_t size);
+
+  // appends the next section, no effect if not opened for writing
+  bool writeSection(Section section, const void* src, uint64_t size);
+
+  // streams the next section block by block, for payloads uploaded through a staging ring:
+  // beginSection, then readBlock or writeBlock for consecutive blocks summing to size, then endSection.
+  // returns true if the blocks can be read, size must match the stored one
+  bool beginSection(Section section, uint64_t size);
+
+  // reads the next block of the section begun, returns false on failure, the following blocks
+  // shall then be computed and the next sections are not read anymore
+  bool readBlock(void* dst, uint64_t size);
+
+  // appends a block to the section begun, no effect if not opened for writing
+  bool writeBlock(const void* src, uint64_t size);
+
+  // ends the section begun, the next section can then be accessed
+  void endSection();
+
+  // ends read or write, returns false if a written cache is incomplete
+  bool close();
+
+  // offset of section in the cache file, valid once the previous sections were read, skipped or written
+  [[nodiscard]] uint64_t sectionOffset(Section section) const;
+
+  [[nodiscard]] inline bool isReading() const { return m_mode == E_READ; }
+  [[nodiscard]] inline bool isWriting() const { return m_mode == E_WRITE; }
+
+private:
+  // stored at the beginning of the file
+  struct Header
+  {
+    char     magic[8]   = {'S', 'P', 'L', 'C', 'A', 'C', 'H', 'E'};
+    uint32_t version    = 0;
+    uint32_t complete   = 0;  // set when all sections are written
+    uint64_t sourceSize = 0;  // size of the ply file
+    int64_t  sourceTime = 0;  // last write time of the ply file
+    Description desc;
+    uint64_t    sectionSizes[E_SECTION_COUNT] = {};
+  };
+
+  // increase when the layout of the payloads or of the header changes
+  static constexpr uint32_t s_version = 4;
+
+  // fills the source identification fields of header, false if source file not found
+  static bool identifySource(const std::string& plyFilename, Header& header);
+
+  enum Mode
+  {
+    E_CLOSED,
+    E_READ,
+    E_WRITE
+  };
+
+  Mode         m_mode = E_CLOSED;
+  std::fstream m_file;
+  std::string  m_filename;     // final cache file name
+  std::string  m_tmpFilename;  // file being written
+  Header       m_header;
+  uint32_t     m_nextSection = 0;
+  int          m_blockSection = -1;  // section begun, -1 if none or if a block failed
+  uint64_t     m_sectionBytes = 0;   // read or written in the section begun
+};
+
+#endif
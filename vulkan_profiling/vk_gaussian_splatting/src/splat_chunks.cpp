@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2023-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "splat_chunks.h"
+#include "utilities.h"
+
+#include <algorithm>
+#include <array>
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/geometric.hpp>
+
+std::vector<float> computeChunkBounds(const std::vector<float>& positions)
+{
+  const uint32_t     splatCount = uint32_t(positions.size() / 3);
+  const uint32_t     chunkCount = splatChunkCount(splatCount);
+  std::vector<float> bounds(size_t(chunkCount) * CHUNK_BOUNDS_FLOATS);
+
+  nvh::parallel_batches_indexed<1>(
+      chunkCount,
+      [&](uint64_t chunkIdx, uint32_t) {
+        const uint32_t begin = (uint32_t)chunkIdx * SPLAT_CHUNK_SIZE;
+        const uint32_t end   = std::min(splatCount, begin + SPLAT_CHUNK_SIZE);
+
+        glm::vec3 minimum(positions[begin * 3 + 0], positions[begin * 3 + 1], positions[begin * 3 + 2]);
+        glm::vec3 maximum = minimum;
+        for(uint32_t splatIdx = begin + 1; splatIdx < end; ++splatIdx)
+        {
+          const glm::vec3 center(positions[splatIdx * 3 + 0], positions[splatIdx * 3 + 1], positions[splatIdx * 3 + 2]);
+          minimum = glm::min(minimum, center);
+          maximum = glm::max(maximum, center);
+        }
+
+        float* chunkBounds = bounds.data() + chunkIdx * CHUNK_BOUNDS_FLOATS;
+        for(uint32_t cmp = 0; cmp < 3; ++cmp)
+        {
+          chunkBounds[cmp]     = minimum[cmp];
+          chunkBounds[3 + cmp] = maximum[cmp];
+        }
+      },
+      (uint32_t)std::thread::hardware_concurrency());
+
+  return bounds;
+}
+
+uint32_t cullChunks(const std::vector<float>& bounds, const glm::mat4& viewProj, float dilation, uint32_t* visible)
+{
+  // planes of the dilated frustum in world space, a point p is inside if dot(plane, (p,1)) >= 0.
+  // same bounds as the homogeneous tests of chunks.comp.glsl: |x|,|y| <= clip*w, -dilation*w <= z <= w
+  const glm::vec4                 row0 = glm::vec4(viewProj[0][0], viewProj[1][0], viewProj[2][0], viewProj[3][0]);
+  const glm::vec4                 row1 = glm::vec4(viewProj[0][1], viewProj[1][1], viewProj[2][1], viewProj[3][1]);
+  const glm::vec4                 row2 = glm::vec4(viewProj[0][2], viewProj[1][2], viewProj[2][2], viewProj[3][2]);
+  const glm::vec4                 row3 = glm::vec4(viewProj[0][3], viewProj[1][3], viewProj[2][3], viewProj[3][3]);
+  const float                     clip = 1.0f + dilation;
+  const std::array<glm::vec4, 6> planes = {clip * row3 - row0, clip * row3 + row0, clip * row3 - row1,
+                                           clip * row3 + row1, row2 + dilation * row3, row3 - row2};
+
+  const uint32_t chunkCount = uint32_t(bounds.size() / CHUNK_BOUNDS_FLOATS);
+
+  // one flag per chunk then a compaction, keeps the chunks in storage order
+  std::vector<uint8_t> inside(chunkCount);
+  START_PAR_LOOP(chunkCount, chunkIdx)
+  {
+    const float*    chunkBounds = bounds.data() + chunkIdx * CHUNK_BOUNDS_FLOATS;
+    const glm::vec3 minimum(chunkBounds[0], chunkBounds[1], chunkBounds[2]);
+    const glm::vec3 maximum(chunkBounds[3], chunkBounds[4], chunkBounds[5]);
+    bool            isInside = true;
+    for(const glm::vec4& plane : planes)
+    {
+      // corner of the box the most inside the plane
+      const glm::vec3 corner(plane.x >= 0.0f ? maximum.x : minimum.x, plane.y >= 0.0f ? maximum.y : minimum.y,
+                             plane.z >= 0.0f ? maximum.z : minimum.z);
+      if(glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+      {
+        isInside = false;
+        break;
+      }
+    }
+    inside[chunkIdx] = isInside;
+  }
+  END_PAR_LOOP()
+
+  uint32_t visibleCount = 0;
+  for(uint32_t chunkIdx = 0; chunkIdx < chunkCount; ++chunkIdx)
+  {
+    if(inside[chunkIdx])
+      visible[visibleCount++] = chunkIdx;
+  }
+  return visibleCount;
+}
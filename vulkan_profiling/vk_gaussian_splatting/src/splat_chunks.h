@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2023-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#ifndef _SPLAT_CHUNKS_H_
+#define _SPLAT_CHUNKS_H_
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+
+#include "shaders/shaderio.h"
+
+// Two level frustum culling. The splats are partitioned into chunks of SPLAT_CHUNK_SIZE
+// consecutive splats with the bounding box of their centers computed at load time. The
+// chunks outside of the frustum are culled as a whole, on the CPU or by chunks.comp.glsl,
+// then the distance shader only visits the splats of the visible chunks. The chunks are
+// compact only if the splat order is spatially coherent (see splat_reorder.h).
+
+// number of chunks of SPLAT_CHUNK_SIZE splats
+inline uint32_t splatChunkCount(uint32_t splatCount)
+{
+  return (splatCount + SPLAT_CHUNK_SIZE - 1) / SPLAT_CHUNK_SIZE;
+}
+
+// returns CHUNK_BOUNDS_FLOATS floats per chunk (minimum then maximum of the centers)
+// for positions (3 floats per splat). Multi threaded.
+std::vector<float> computeChunkBounds(const std::vector<float>& positions);
+
+// writes in visible the indices of the chunks whose bounds intersect the frustum of viewProj
+// dilated by dilation, as in chunks.comp.glsl, and returns their count. visible must hold
+// one entry per chunk. Conservative for the splat centers culled at distance or raster stage.
+uint32_t cullChunks(const std::vector<float>& bounds, const glm::mat4& viewProj, float dilation, uint32_t* visible);
+
+#endif
@@ -0,0 +1,568 @@
+/*
+ * Copyright (c) 2023-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "splat_cpu_rasterizer.h"
+#include "utilities.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <stb_image_write.h>
+
+// vectorization of the blending, SSE2 is always available on x86-64
+#if defined(__x86_64__) || defined(_M_X64)
+#define SPLAT_CPU_RASTERIZER_SSE
+#include <immintrin.h>
+#endif
+
+// splats projected by a parallel task
+static constexpr uint32_t s_projectBatch = 4096;
+// a pixel whose transmittance is below this threshold does not change anymore once quantized to 8 bits
+static constexpr float s_minTransmittance = 1.0f / 512.0f;
+// entries blended between two checks of the early termination of a tile
+static constexpr uint32_t s_terminationCheckPeriod = 32;
+
+// same constants as common.glsl
+static const float     s_sqrt8 = std::sqrt(8.0f);
+static constexpr float SH_C0   = 0.28209479177387814f;
+static constexpr float SH_C1   = 0.4886025119029199f;
+static constexpr float SH_C2[] = {1.0925484f, -1.0925484f, 0.3153916f, -1.0925484f, 0.5462742f};
+static constexpr float SH_C3[] = {-0.5900435899266435f, 2.890611442640554f, -0.4570457994644658f, 0.3731763325901154f,
+                                  -0.4570457994644658f, 1.445305721320277f, -0.5900435899266435f};
+
+static double elapsedMs(std::chrono::high_resolution_clock::time_point& start)
+{
+  const auto   now     = std::chrono::high_resolution_clock::now();
+  const double elapsed = std::chrono::duration<double, std::milli>(now - start).count();
+  start                = now;
+  return elapsed;
+}
+
+// highest SH degree stored in a set with coefficientsPerChannel coefficients of degree 1 to 3 per channel
+static int shDegreeOf(uint32_t coefficientsPerChannel)
+{
+  if(coefficientsPerChannel >= 15)
+    return 3;
+  if(coefficientsPerChannel >= 8)
+    return 2;
+  if(coefficientsPerChannel >= 3)
+    return 1;
+  return 0;
+}
+
+// view dependent color of a splat, as the vertex and mesh shaders do it. The ply layout is channel major
+// (see sh_packing.h), shd[i] gathers coefficient i of the three channels.
+static glm::vec3 evaluateSh(const SplatAttributeView& rest, size_t splatIdx, int degree, const glm::vec3& dir)
+{
+  const uint32_t coefficientsPerChannel = rest.components / 3;
+  auto           shd                    = [&](uint32_t i) {
+    return glm::vec3(rest.get(splatIdx, i), rest.get(splatIdx, coefficientsPerChannel + i),
+                     rest.get(splatIdx, 2 * coefficientsPerChannel + i));
+  };
+
+  const float x = dir.x;
+  const float y = dir.y;
+  const float z = dir.z;
+
+  glm::vec3 color = SH_C1 * (-shd(0) * y + shd(1) * z - shd(2) * x);
+  if(degree >= 2)
+  {
+    const float xx = x * x;
+    const float yy = y * y;
+    const float zz = z * z;
+    const float xy = x * y;
+    const float yz = y * z;
+    const float xz = x * z;
+
+    color += (SH_C2[0] * xy) * shd(3) + (SH_C2[1] * yz) * shd(4) + (SH_C2[2] * (2.0f * zz - xx - yy)) * shd(5)
+             + (SH_C2[3] * xz) * shd(6) + (SH_C2[4] * (xx - yy)) * shd(7);
+  }
+  if(degree >= 3)
+  {
+    color += SH_C3[0] * shd(8) * (3.0f * x * x - y * y) * y + SH_C3[1] * shd(9) * x * y * z
+             + SH_C3[2] * shd(10) * (4.0f * z * z - x * x - y * y) * y
+             + SH_C3[3] * shd(11) * z * (2.0f * z * z - 3.0f * x * x - 3.0f * y * y)
+             + SH_C3[4] * shd(12) * x * (4.0f * z * z - x * x - y * y) + SH_C3[5] * shd(13) * (x * x - y * y) * z
+             + SH_C3[6] * shd(14) * x * (x * x - 3.0f * y * y);
+  }
+  return color;
+}
+
+// 3D covariance of a splat, as splatCovariance of gaussian_splatting.cpp
+static glm::mat3 covariance3D(const SplatAttributeView& srcScale, const SplatAttributeView& srcRotation, size_t splatIdx)
+{
+  const glm::vec3 scale{std::exp(srcScale.get(splatIdx, 0)), std::exp(srcScale.get(splatIdx, 1)),
+                        std::exp(srcScale.get(splatIdx, 2))};
+  const glm::quat rotation = glm::normalize(glm::quat{srcRotation.get(splatIdx, 0), srcRotation.get(splatIdx, 1),
+                                                      srcRotation.get(splatIdx, 2), srcRotation.get(splatIdx, 3)});
+  const glm::mat3 m = glm::mat3_cast(rotation) * glm::mat3(scale.x, 0, 0, 0, scale.y, 0, 0, 0, scale.z);
+  return m * glm::transpose(m);
+}
+
+void SplatCpuRasterizer::render(const SplatSet& splatSet, const glm::mat4& view, const glm::mat4& proj)
+{
+  m_stats = Stats();
+
+  const uint32_t width  = std::max(m_settings.width, 1u);
+  const uint32_t height = std::max(m_settings.height, 1u);
+  m_tilesX              = (width + s_tileSize - 1) / s_tileSize;
+  m_tilesY              = (height + s_tileSize - 1) / s_tileSize;
+  m_image.assign(size_t(width) * height * 4, 0);
+
+  // the parents of a level of detail hierarchy follow the leaves
+  const uint32_t splatCount = splatSet.lodLeafCount ? splatSet.lodLeafCount : uint32_t(splatSet.size());
+
+  auto       start      = std::chrono::high_resolution_clock::now();
+  const auto renderTime = start;
+
+  project(splatSet, splatCount, view, proj);
+  m_stats.projectTime = elapsedMs(start);
+
+  bin(splatCount);
+  m_stats.binTime = elapsedMs(start);
+
+  sort();
+  m_stats.sortTime = elapsedMs(start);
+
+  blend();
+  m_stats.blendTime = elapsedMs(start);
+
+  m_stats.totalTime = std::chrono::duration<double, std::milli>(start - renderTime).count();
+}
+
+void SplatCpuRasterizer::project(const SplatSet& splatSet, uint32_t splatCount, const glm::mat4& view, const glm::mat4& proj)
+{
+  const float width  = float(m_settings.width);
+  const float height = float(m_settings.height);
+
+  // same frame parameters as GaussianSplatting::updateAndUploadFrameInfoUBO
+  const glm::mat4 viewMatrix       = glm::transpose(view);
+  glm::mat4       projectionMatrix = proj;
+  projectionMatrix[1][1] *= -1;
+  const glm::mat4 inverseView = glm::inverse(view);
+  const glm::vec3 cameraPosition(inverseView[0][3], inverseView[1][3], inverseView[2][3]);
+  const glm::vec2 focal(projectionMatrix[0][0] * 0.5f * width, projectionMatrix[1][1] * 0.5f * height);
+  const glm::mat3 W = glm::transpose(glm::mat3(viewMatrix));
+
+  const SplatAttributeView dc       = splatSet.f_dcView();
+  const SplatAttributeView rest     = splatSet.f_restView();
+  const SplatAttributeView opacity  = splatSet.opacityView();
+  const SplatAttributeView scale    = splatSet.scaleView();
+  const SplatAttributeView rotation = splatSet.rotationView();
+  const int shDegree = std::clamp(m_settings.maxShDegree, 0, shDegreeOf(rest.components / 3));
+
+  m_splats.resize(splatCount);
+
+  const uint32_t batchCount = (splatCount + s_projectBatch - 1) / s_projectBatch;
+  nvh::parallel_batches_indexed<1>(
+      batchCount,
+      [&](uint64_t batchIdx, uint32_t) {
+        const uint32_t begin = (uint32_t)batchIdx * s_projectBatch;
+        const uint32_t end   = std::min(splatCount, begin + s_projectBatch);
+        for(uint32_t splatIdx = begin; splatIdx < end; ++splatIdx)
+        {
+          ProjectedSplat& splat = m_splats[splatIdx];
+          splat.tileMin[0] = splat.tileMin[1] = splat.tileMax[0] = splat.tileMax[1] = 0;
+
+          const glm::vec3 splatCenter(splatSet.positions[splatIdx * 3 + 0], splatSet.positions[splatIdx * 3 + 1],
+                                      splatSet.positions[splatIdx * 3 + 2]);
+          const glm::vec4 viewCenter = viewMatrix * glm::vec4(splatCenter, 1.0f);
+          const glm::vec4 clipCenter = projectionMatrix * viewCenter;
+
+          // frustum culling
+          const float clip = (1.0f + m_settings.frustumDilation) * clipCenter.w;
+          if(std::abs(clipCenter.x) > clip || std::abs(clipCenter.y) > clip
+             || clipCenter.z < (0.0f - m_settings.frustumDilation) * clipCenter.w || clipCenter.z > clipCenter.w)
+            continue;
+
+          // color and alpha culling
+          glm::vec4 color(glm::clamp(0.5f + SH_C0 * dc.get(splatIdx, 0), 0.0f, 1.0f),
+                          glm::clamp(0.5f + SH_C0 * dc.get(splatIdx, 1), 0.0f, 1.0f),
+                          glm::clamp(0.5f + SH_C0 * dc.get(splatIdx, 2), 0.0f, 1.0f),
+                          glm::clamp(1.0f / (1.0f + std::exp(-opacity.get(splatIdx, 0))), 0.0f, 1.0f));
+          if(shDegree >= 1)
+          {
+            const glm::vec3 worldViewDir = glm::normalize(splatCenter - cameraPosition);
+            color += glm::vec4(evaluateSh(rest, splatIdx, shDegree, worldViewDir), 0.0f);
+          }
+          if(color.a < m_settings.alphaCullThreshold)
+            continue;
+
+          // 2D covariance, see raster.vert.glsl
+          const glm::mat3 Vrk = covariance3D(scale, rotation, splatIdx);
+          const float     s   = 1.0f / (viewCenter.z * viewCenter.z);
+          const glm::mat3 J   = glm::mat3(focal.x / viewCenter.z, 0., -(focal.x * viewCenter.x) * s, 0.,
+                                          focal.y / viewCenter.z, -(focal.y * viewCenter.y) * s, 0., 0., 0.);
+          const glm::mat3 T   = W * J;
+          glm::mat3       cov2Dm = glm::transpose(T) * Vrk * T;
+          cov2Dm[0][0] += 0.3f;
+          cov2Dm[1][1] += 0.3f;
+
+          const float a           = cov2Dm[0][0];
+          const float d           = cov2Dm[1][1];
+          const float b           = cov2Dm[0][1];
+          const float D           = a * d - b * b;
+          const float traceOver2  = 0.5f * (a + d);
+          const float term2       = std::sqrt(std::max(0.1f, traceOver2 * traceOver2 - D));
+          const float eigenValue1 = traceOver2 + term2;
+          const float eigenValue2 = traceOver2 - term2;
+          if(eigenValue2 <= 0.0f)
+            continue;
+
+          const glm::vec2 eigenVector1 = glm::normalize(glm::vec2(b, eigenValue1 - a));
+          const glm::vec2 eigenVector2 = glm::vec2(eigenVector1.y, -eigenVector1.x);
+          // basis of the quad in pixels, the fragment shader covers the unit disk of this basis scaled by sqrt(8)
+          const glm::vec2 basisVector1 =
+              eigenVector1 * m_settings.splatScale * std::min(s_sqrt8 * std::sqrt(eigenValue1), 2048.0f);
+          const glm::vec2 basisVector2 =
+              eigenVector2 * m_settings.splatScale * std::min(s_sqrt8 * std::sqrt(eigenValue2), 2048.0f);
+          const float inverseLength1 = 8.0f / glm::dot(basisVector1, basisVector1);
+          const float inverseLength2 = 8.0f / glm::dot(basisVector2, basisVector2);
+          if(!std::isfinite(inverseLength1) || !std::isfinite(inverseLength2))
+            continue;
+
+          const glm::vec3 ndcCenter = glm::vec3(clipCenter) / clipCenter.w;
+          if(!std::isfinite(ndcCenter.x) || !std::isfinite(ndcCenter.y))
+            continue;
+          splat.center  = glm::vec2((ndcCenter.x + 1.0f) * 0.5f * width, (ndcCenter.y + 1.0f) * 0.5f * height);
+          splat.extent  = glm::vec2(std::sqrt(basisVector1.x * basisVector1.x + basisVector2.x * basisVector2.x),
+                                    std::sqrt(basisVector1.y * basisVector1.y + basisVector2.y * basisVector2.y));
+          splat.conic   = glm::vec3(inverseLength1 * eigenVector1.x * eigenVector1.x + inverseLength2 * eigenVector2.x * eigenVector2.x,
+                                    2.0f * (inverseLength1 * eigenVector1.x * eigenVector1.y + inverseLength2 * eigenVector2.x * eigenVector2.y),
+                                    inverseLength1 * eigenVector1.y * eigenVector1.y + inverseLength2 * eigenVector2.y * eigenVector2.y);
+          splat.opacity = color.a;
+          // fixed point attachments clamp the fragment color before blending
+          splat.color = glm::clamp(glm::vec3(color), 0.0f, 1.0f);
+          splat.depth = -viewCenter.z;
+
+          // tiles overlapped by the screen bounds
+          const float tileSize = float(s_tileSize);
+          const int   minX     = (int)std::floor((splat.center.x - splat.extent.x) / tileSize);
+          const int   minY     = (int)std::floor((splat.center.y - splat.extent.y) / tileSize);
+          const int   maxX     = (int)std::floor((splat.center.x + splat.extent.x) / tileSize) + 1;
+          const int   maxY     = (int)std::floor((splat.center.y + splat.extent.y) / tileSize) + 1;
+          splat.tileMin[0]     = uint16_t(std::clamp(minX, 0, (int)m_tilesX));
+          splat.tileMin[1]     = uint16_t(std::clamp(minY, 0, (int)m_tilesY));
+          splat.tileMax[0]     = uint16_t(std::clamp(maxX, 0, (int)m_tilesX));
+          splat.tileMax[1]     = uint16_t(std::clamp(maxY, 0, (int)m_tilesY));
+          if(splat.tileMin[0] >= splat.tileMax[0] || splat.tileMin[1] >= splat.tileMax[1])
+            splat.tileMax[0] = splat.tileMin[0];
+        }
+      },
+      (uint32_t)std::thread::hardware_concurrency());
+}
+
+void SplatCpuRasterizer::bin(uint32_t splatCount)
+{
+  const uint32_t tileCount  = m_tilesX * m_tilesY;
+  const uint32_t batchCount = (splatCount + s_projectBatch - 1) / s_projectBatch;
+  m_tileOffsets.assign(tileCount + 1, 0);
+
+  // entries per tile, then their offsets
+  std::atomic<uint32_t> visibleCount{0};
+  nvh::parallel_batches_indexed<1>(
+      batchCount,
+      [&](uint64_t batchIdx, uint32_t) {
+        const uint32_t begin   = (uint32_t)batchIdx * s_projectBatch;
+        const uint32_t end     = std::min(splatCount, begin + s_projectBatch);
+        uint32_t       visible = 0;
+        for(uint32_t splatIdx = begin; splatIdx < end; ++splatIdx)
+        {
+          const ProjectedSplat& splat = m_splats[splatIdx];
+          if(splat.tileMin[0] == splat.tileMax[0])
+            continue;
+          visible++;
+          for(uint32_t tileY = splat.tileMin[1]; tileY < splat.tileMax[1]; ++tileY)
+            for(uint32_t tileX = splat.tileMin[0]; tileX < splat.tileMax[0]; ++tileX)
+              std::atomic_ref<uint32_t>(m_tileOffsets[tileY * m_tilesX + tileX]).fetch_add(1, std::memory_order_relaxed);
+        }
+        visibleCount.fetch_add(visible, std::memory_order_relaxed);
+      },
+      (uint32_t)std::thread::hardware_concurrency());
+
+  uint32_t offset = 0;
+  for(uint32_t tileIdx = 0; tileIdx <= tileCount; ++tileIdx)
+  {
+    const uint32_t count    = m_tileOffsets[tileIdx];
+    m_tileOffsets[tileIdx] = offset;
+    offset += count;
+  }
+  m_stats.visibleCount = visibleCount;
+  m_stats.tileEntries  = offset;
+
+  // the order of the entries within a tile depends on the threads, the sort makes it deterministic
+  m_entries.resize(offset);
+  std::vector<uint32_t> cursors(m_tileOffsets.begin(), m_tileOffsets.end() - 1);
+  nvh::parallel_batches_indexed<1>(
+      batchCount,
+      [&](uint64_t batchIdx, uint32_t) {
+        const uint32_t begin = (uint32_t)batchIdx * s_projectBatch;
+        const uint32_t end   = std::min(splatCount, begin + s_projectBatch);
+        for(uint32_t splatIdx = begin; splatIdx < end; ++splatIdx)
+        {
+          const ProjectedSplat& splat = m_splats[splatIdx];
+          for(uint32_t tileY = splat.tileMin[1]; tileY < splat.tileMax[1]; ++tileY)
+            for(uint32_t tileX = splat.tileMin[0]; tileX < splat.tileMax[0]; ++tileX)
+            {
+              const uint32_t entry =
+                  std::atomic_ref<uint32_t>(cursors[tileY * m_tilesX + tileX]).fetch_add(1, std::memory_order_relaxed);
+              m_entries[entry] = {splat.depth, splatIdx};
+            }
+        }
+      },
+      (uint32_t)std::thread::hardware_concurrency());
+}
+
+void SplatCpuRasterizer::sort()
+{
+  nvh::parallel_batches_indexed<1>(
+      m_tilesX * m_tilesY,
+      [&](uint64_t tileIdx, uint32_t) {
+        std::sort(m_entries.begin() + m_tileOffsets[tileIdx], m_entries.begin() + m_tileOffsets[tileIdx + 1],
+                  [](const TileEntry& a, const TileEntry& b) {
+                    return a.depth < b.depth || (a.depth == b.depth && a.splatIdx < b.splatIdx);
+                  });
+      },
+      (uint32_t)std::thread::hardware_concurrency());
+}
+
+void SplatCpuRasterizer::blend()
+{
+  nvh::parallel_batches_indexed<1>(
+      m_tilesX * m_tilesY,
+      [&](uint64_t tileIdx, uint32_t) {
+#if defined(SPLAT_CPU_RASTERIZER_SSE)
+        if(m_settings.simd)
+        {
+          blendTileSimd((uint32_t)tileIdx);
+          return;
+        }
+#endif
+        blendTile((uint32_t)tileIdx);
+      },
+      (uint32_t)std::thread::hardware_concurrency());
+}
+
+// accumulated color and transmittance of the pixels of a tile, structure of arrays for the SIMD path
+struct alignas(16) TileAccumulator
+{
+  static constexpr uint32_t s_pixels = SplatCpuRasterizer::s_tileSize * SplatCpuRasterizer::s_tileSize;
+
+  alignas(16) float r[s_pixels];
+  alignas(16) float g[s_pixels];
+  alignas(16) float b[s_pixels];
+  alignas(16) float t[s_pixels];
+
+  TileAccumulator()
+  {
+    std::fill(std::begin(r), std::end(r), 0.0f);
+    std::fill(std::begin(g), std::end(g), 0.0f);
+    std::fill(std::begin(b), std::end(b), 0.0f);
+    std::fill(std::begin(t), std::end(t), 1.0f);
+  }
+
+  bool opaque() const
+  {
+    for(float transmittance : t)
+      if(transmittance >= s_minTransmittance)
+        return false;
+    return true;
+  }
+};
+
+static inline uint8_t toUnorm8(float value)
+{
+  return uint8_t(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+// composites the tile over the background and writes it to image
+static void resolveTile(const TileAccumulator& tile, const glm::vec4& background, uint32_t originX, uint32_t originY,
+                        uint32_t width, uint32_t height, uint8_t* image)
+{
+  const uint32_t endX = std::min(originX + SplatCpuRasterizer::s_tileSize, width);
+  const uint32_t endY = std::min(originY + SplatCpuRasterizer::s_tileSize, height);
+  for(uint32_t y = originY; y < endY; ++y)
+  {
+    for(uint32_t x = originX; x < endX; ++x)
+    {
+      const uint32_t i     = (y - originY) * SplatCpuRasterizer::s_tileSize + (x - originX);
+      const float    t     = tile.t[i];
+      uint8_t*       pixel = image + (size_t(y) * width + x) * 4;
+      pixel[0]             = toUnorm8(tile.r[i] + t * background.r);
+      pixel[1]             = toUnorm8(tile.g[i] + t * background.g);
+      pixel[2]             = toUnorm8(tile.b[i] + t * background.b);
+      pixel[3]             = toUnorm8(1.0f - t + t * background.a);
+    }
+  }
+}
+
+void SplatCpuRasterizer::blendTile(uint32_t tileIdx)
+{
+  const uint32_t originX = (tileIdx % m_tilesX) * s_tileSize;
+  const uint32_t originY = (tileIdx / m_tilesX) * s_tileSize;
+
+  TileAccumulator tile;
+  for(uint32_t entry = m_tileOffsets[tileIdx]; entry < m_tileOffsets[tileIdx + 1]; ++entry)
+  {
+    if((entry - m_tileOffsets[tileIdx]) % s_terminationCheckPeriod == s_terminationCheckPeriod - 1 && tile.opaque())
+      break;
+
+    const ProjectedSplat& splat = m_splats[m_entries[entry].splatIdx];
+    // pixels whose center is within the screen bounds of the splat
+    const int beginX = std::max(0, (int)std::ceil(splat.center.x - splat.extent.x - 0.5f) - (int)originX);
+    const int beginY = std::max(0, (int)std::ceil(splat.center.y - splat.extent.y - 0.5f) - (int)originY);
+    const int endX   = std::min((int)s_tileSize, (int)std::floor(splat.center.x + splat.extent.x - 0.5f) - (int)originX + 1);
+    const int endY   = std::min((int)s_tileSize, (int)std::floor(splat.center.y + splat.extent.y - 0.5f) - (int)originY + 1);
+
+    for(int y = beginY; y < endY; ++y)
+    {
+      const float dy = float(originY + y) + 0.5f - splat.center.y;
+      for(int x = beginX; x < endX; ++x)
+      {
+        const float dx = float(originX + x) + 0.5f - splat.center.x;
+        const float A  = splat.conic.x * dx * dx + splat.conic.y * dx * dy + splat.conic.z * dy * dy;
+        if(A > 8.0f)
+          continue;
+        const uint32_t i      = y * s_tileSize + x;
+        const float    weight = tile.t[i] * std::exp(-0.5f * A) * splat.opacity;
+        tile.r[i] += weight * splat.color.r;
+        tile.g[i] += weight * splat.color.g;
+        tile.b[i] += weight * splat.color.b;
+        tile.t[i] -= weight;
+      }
+    }
+  }
+
+  resolveTile(tile, m_settings.background, originX, originY, m_settings.width, m_settings.height, m_image.data());
+}
+
+#if defined(SPLAT_CPU_RASTERIZER_SSE)
+// exp(x) for x <= 0, relative error below 1e-6. Cody-Waite range reduction to [-ln(2)/2, ln(2)/2]
+// followed by a degree 6 Taylor polynomial.
+static inline __m128 expNegative(__m128 x)
+{
+  x                = _mm_max_ps(x, _mm_set1_ps(-87.0f));
+  const __m128i n  = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)));
+  const __m128  nf = _mm_cvtepi32_ps(n);
+  __m128        r  = _mm_sub_ps(x, _mm_mul_ps(nf, _mm_set1_ps(0.693359375f)));
+  r                = _mm_add_ps(r, _mm_mul_ps(nf, _mm_set1_ps(2.12194440e-4f)));
+
+  __m128 p = _mm_set1_ps(1.0f / 720.0f);
+  p        = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(1.0f / 120.0f));
+  p        = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(1.0f / 24.0f));
+  p        = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(1.0f / 6.0f));
+  p        = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(0.5f));
+  p        = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(1.0f));
+  p        = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(1.0f));
+
+  // 2^n built in the exponent bits
+  const __m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(n, _mm_set1_epi32(127)), 23));
+  return _mm_mul_ps(p, scale);
+}
+
+// same as blendTile, 4 consecutive pixels of a row at a time
+void SplatCpuRasterizer::blendTileSimd(uint32_t tileIdx)
+{
+  const uint32_t originX = (tileIdx % m_tilesX) * s_tileSize;
+  const uint32_t originY = (tileIdx / m_tilesX) * s_tileSize;
+
+  const __m128 eight   = _mm_set1_ps(8.0f);
+  const __m128 minHalf = _mm_set1_ps(-0.5f);
+  // offsets of the 4 pixels of a group from the first one, pixel centers included
+  const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+
+  TileAccumulator tile;
+  for(uint32_t entry = m_tileOffsets[tileIdx]; entry < m_tileOffsets[tileIdx + 1]; ++entry)
+  {
+    if((entry - m_tileOffsets[tileIdx]) % s_terminationCheckPeriod == s_terminationCheckPeriod - 1 && tile.opaque())
+      break;
+
+    const ProjectedSplat& splat = m_splats[m_entries[entry].splatIdx];
+    const int beginX = std::max(0, (int)std::ceil(splat.center.x - splat.extent.x - 0.5f) - (int)originX) & ~3;
+    const int beginY = std::max(0, (int)std::ceil(splat.center.y - splat.extent.y - 0.5f) - (int)originY);
+    const int endX   = std::min((int)s_tileSize, (int)std::floor(splat.center.x + splat.extent.x - 0.5f) - (int)originX + 1);
+    const int endY   = std::min((int)s_tileSize, (int)std::floor(splat.center.y + splat.extent.y - 0.5f) - (int)originY + 1);
+
+    const __m128 conicX  = _mm_set1_ps(splat.conic.x);
+    const __m128 conicY  = _mm_set1_ps(splat.conic.y);
+    const __m128 conicZ  = _mm_set1_ps(splat.conic.z);
+    const __m128 opacity = _mm_set1_ps(splat.opacity);
+    const __m128 red     = _mm_set1_ps(splat.color.r);
+    const __m128 green   = _mm_set1_ps(splat.color.g);
+    const __m128 blue    = _mm_set1_ps(splat.color.b);
+
+    for(int y = beginY; y < endY; ++y)
+    {
+      const __m128 dy      = _mm_set1_ps(float(originY + y) + 0.5f - splat.center.y);
+      const __m128 conicDy = _mm_mul_ps(conicY, dy);
+      const __m128 termDy  = _mm_mul_ps(_mm_mul_ps(conicZ, dy), dy);
+      for(int x = beginX; x < endX; x += 4)
+      {
+        const __m128 dx = _mm_add_ps(_mm_set1_ps(float(originX + x) - splat.center.x), laneOffsets);
+        // A = conic.x * dx^2 + conic.y * dx * dy + conic.z * dy^2
+        const __m128 A    = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(conicX, dx), conicDy), dx), termDy);
+        const __m128 mask = _mm_cmple_ps(A, eight);
+        if(_mm_movemask_ps(mask) == 0)
+          continue;
+
+        const uint32_t i      = y * s_tileSize + x;
+        const __m128   t      = _mm_load_ps(tile.t + i);
+        const __m128   alpha  = _mm_and_ps(mask, _mm_mul_ps(expNegative(_mm_mul_ps(minHalf, A)), opacity));
+        const __m128   weight = _mm_mul_ps(t, alpha);
+        _mm_store_ps(tile.r + i, _mm_add_ps(_mm_load_ps(tile.r + i), _mm_mul_ps(weight, red)));
+        _mm_store_ps(tile.g + i, _mm_add_ps(_mm_load_ps(tile.g + i), _mm_mul_ps(weight, green)));
+        _mm_store_ps(tile.b + i, _mm_add_ps(_mm_load_ps(tile.b + i), _mm_mul_ps(weight, blue)));
+        _mm_store_ps(tile.t + i, _mm_sub_ps(t, weight));
+      }
+    }
+  }
+
+  resolveTile(tile, m_settings.background, originX, originY, m_settings.width, m_settings.height, m_image.data());
+}
+#else
+void SplatCpuRasterizer::blendTileSimd(uint32_t tileIdx)
+{
+  blendTile(tileIdx);
+}
+#endif
+
+bool SplatCpuRasterizer::writePng(const std::string& filename) const
+{
+  if(m_image.empty())
+    return false;
+  const int stride = int(m_settings.width * 4);
+  return stbi_write_png(filename.c_str(), int(m_settings.width), int(m_settings.height), 4, m_image.data(), stride) != 0;
+}
+
+std::string SplatCpuRasterizer::formatStats(const Stats& stats)
+{
+  std::ostringstream stream;
+  stream << std::fixed << std::setprecision(3) << "project " << stats.projectTime << " ms, bin " << stats.binTime
+         << " ms, sort " << stats.sortTime << " ms, blend " << stats.blendTime << " ms, total " << stats.totalTime
+         << " ms, " << stats.visibleCount << " visible splats, " << stats.tileEntries << " tile entries";
+  return stream.str();
+}
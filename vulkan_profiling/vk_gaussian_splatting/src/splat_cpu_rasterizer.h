@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2023-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#ifndef _SPLAT_CPU_RASTERIZER_H_
+#define _SPLAT_CPU_RASTERIZER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include "splat_set.h"
+
+// Tile based CPU renderer of a splat set, used to produce reference images and
+// timings on machines without a Vulkan device. It follows the math of raster.vert.glsl
+// and raster.frag.glsl (same 2D covariance, same sqrt(8) standard deviations extent,
+// same culling) but blends front to back per pixel instead of back to front per quad:
+//  1. projection: center, 2D covariance, view dependent color, screen bounds of each splat
+//  2. binning: one entry per splat and 16x16 pixels tile it overlaps
+//  3. sorting: the entries of each tile by increasing view depth
+//  4. blending: each tile front to back, stops once all its pixels are opaque
+// Every stage is multi threaded, the blending evaluates 4 pixels at a time with SSE on x86.
+class SplatCpuRasterizer
+{
+public:
+  static constexpr uint32_t s_tileSize = 16;
+
+  struct Settings
+  {
+    uint32_t  width              = 1600;
+    uint32_t  height             = 900;
+    int       maxShDegree        = 3;                       // in [0,3], clamped to the degree of the splat set
+    float     splatScale         = 1.0f;                    // as FrameInfo::splatScale
+    float     frustumDilation    = 0.2f;                    // as FrameInfo::frustumDilation
+    float     alphaCullThreshold = 1.0f / 255.0f;           // as FrameInfo::alphaCullThreshold
+    glm::vec4 background         = {0.0f, 0.0f, 0.0f, 0.0f};  // composited under the splats, the GPU clear color is black
+    bool      simd               = true;                    // SSE blending where available
+  };
+
+  // duration of the stages of the last render, in ms
+  struct Stats
+  {
+    double   projectTime  = 0.0;
+    double   binTime      = 0.0;
+    double   sortTime     = 0.0;
+    double   blendTime    = 0.0;
+    double   totalTime    = 0.0;
+    uint32_t visibleCount = 0;  // splats passing the culling
+    uint64_t tileEntries  = 0;  // (splat, tile) pairs blended
+  };
+
+public:
+  void setSettings(const Settings& settings) { m_settings = settings; }
+  [[nodiscard]] inline const Settings& settings() const { return m_settings; }
+
+  // renders splatSet seen from view and proj, laid out as the view_cust and proj_cust matrices
+  // of GaussianSplatting (the --view and --proj arguments). Only the leaves are rendered if the
+  // set holds a level of detail hierarchy, as for the reference image of the LOD PSNR measure.
+  void render(const SplatSet& splatSet, const glm::mat4& view, const glm::mat4& proj);
+
+  // RGBA8 image of the last render, rows from top to bottom. The alpha channel holds the
+  // coverage of the splats so that the PSNR scripts can mask out the background.
+  [[nodiscard]] inline const std::vector<uint8_t>& image() const { return m_image; }
+  [[nodiscard]] inline const Stats&                stats() const { return m_stats; }
+
+  // writes the image of the last render, returns false on failure
+  bool writePng(const std::string& filename) const;
+
+  // one line report of stats
+  static std::string formatStats(const Stats& stats);
+
+private:
+  // splat as seen by the blending stage
+  struct ProjectedSplat
+  {
+    glm::vec2 center;   // in pixels
+    glm::vec2 extent;   // half size of the screen bounds of the splat, in pixels
+    glm::vec3 conic;    // A = conic.x * dx^2 + conic.y * dx * dy + conic.z * dy^2, the splat covers A <= 8
+    float     opacity;
+    glm::vec3 color;
+    float     depth;
+    uint16_t  tileMin[2];  // first tile covered, inclusive
+    uint16_t  tileMax[2];  // last tile covered, exclusive, tileMax == tileMin if the splat is culled
+  };
+
+  // entry of the list of a tile
+  struct TileEntry
+  {
+    float    depth;
+    uint32_t splatIdx;
+  };
+
+  void project(const SplatSet& splatSet, uint32_t splatCount, const glm::mat4& view, const glm::mat4& proj);
+  void bin(uint32_t splatCount);
+  void sort();
+  void blend();
+
+  // blends the entries of tile tileIdx and writes its pixels to m_image
+  void blendTile(uint32_t tileIdx);
+  void blendTileSimd(uint32_t tileIdx);
+
+private:
+  Settings m_settings;
+  Stats    m_stats;
+
+  uint32_t m_tilesX = 0;
+  uint32_t m_tilesY = 0;
+
+  std::vector<ProjectedSplat> m_splats;
+  std::vector<uint32_t>       m_tileOffsets;  // first entry of each tile in m_entries, one more than the tiles
+  std::vector<TileEntry>      m_entries;
+  std::vector<uint8_t>        m_image;
+};
+
+#endif
@@ -0,0 +1,281 @@
+/*
+ * Copyright (c) 2023-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "splat_lod.h"
+#include "splat_reorder.h"
+#include "utilities.h"
+
+#include <algorithm>
+#include <thread>
+#include <cmath>
+#include <numeric>
+
+#include <glm/geometric.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// eigen decomposition of the symmetric matrix m with cyclic Jacobi rotations,
+// the columns of vectors are the eigenvectors of the values
+static void symmetricEigen(glm::mat3 m, glm::vec3& values, glm::mat3& vectors)
+{
+  vectors = glm::mat3(1.0f);
+  for(int sweep = 0; sweep < 16; ++sweep)
+  {
+    const float offDiagonal = m[1][0] * m[1][0] + m[2][0] * m[2][0] + m[2][1] * m[2][1];
+    if(offDiagonal < 1e-30f)
+      break;
+    for(int p = 0; p < 2; ++p)
+    {
+      for(int q = p + 1; q < 3; ++q)
+      {
+        if(std::abs(m[q][p]) < 1e-30f)
+          continue;
+        // rotation in the (p,q) plane zeroing m[q][p]
+        const float theta = (m[q][q] - m[p][p]) / (2.0f * m[q][p]);
+        const float t     = (theta >= 0.0f ? 1.0f : -1.0f) / (std::abs(theta) + std::sqrt(theta * theta + 1.0f));
+        const float c     = 1.0f / std::sqrt(t * t + 1.0f);
+        const float s     = t * c;
+        glm::mat3   rotation(1.0f);
+        rotation[p][p] = c;
+        rotation[q][q] = c;
+        rotation[q][p] = s;
+        rotation[p][q] = -s;
+        m       = glm::transpose(rotation) * m * rotation;
+        vectors = vectors * rotation;
+      }
+    }
+  }
+  values = glm::vec3(m[0][0], m[1][1], m[2][2]);
+}
+
+static inline float sigmoid(float x)
+{
+  return 1.0f / (1.0f + std::exp(-x));
+}
+
+// covariance of splat splatIdx, same computation as initDataBuffers
+static glm::mat3 splatCovariance(const SplatSet& set, uint32_t splatIdx, glm::vec3& scale)
+{
+  scale = glm::vec3(std::exp(set.scale[splatIdx * 3 + 0]), std::exp(set.scale[splatIdx * 3 + 1]),
+                    std::exp(set.scale[splatIdx * 3 + 2]));
+  const glm::quat rotation = glm::normalize(glm::quat(set.rotation[splatIdx * 4 + 0], set.rotation[splatIdx * 4 + 1],
+                                                      set.rotation[splatIdx * 4 + 2], set.rotation[splatIdx * 4 + 3]));
+  const glm::mat3 m = glm::mat3_cast(rotation) * glm::mat3(scale.x, 0, 0, 0, scale.y, 0, 0, 0, scale.z);
+  return m * glm::transpose(m);
+}
+
+// surface of the ellipsoid up to a constant factor, used to weight the children
+static inline float ellipsoidArea(const glm::vec3& scale)
+{
+  return scale.x * scale.y + scale.x * scale.z + scale.y * scale.z;
+}
+
+// writes in node the merge of the childCount splats of children
+static void mergeSplats(SplatSet& set, const uint32_t* children, uint32_t childCount, uint32_t node, uint32_t shComponents)
+{
+  // weights, opacity times area so that the children covering more of the screen dominate
+  float     weights[LOD_BRANCHING];
+  glm::mat3 covariances[LOD_BRANCHING];
+  float     totalWeight = 0.0f;
+  for(uint32_t i = 0; i < childCount; ++i)
+  {
+    glm::vec3 scale;
+    covariances[i] = splatCovariance(set, children[i], scale);
+    weights[i]     = sigmoid(set.opacity[children[i]]) * ellipsoidArea(scale) + 1e-12f;
+    totalWeight += weights[i];
+  }
+
+  // first moment
+  glm::vec3 center(0.0f);
+  for(uint32_t i = 0; i < childCount; ++i)
+    center += weights[i] * glm::vec3(set.positions[children[i] * 3 + 0], set.positions[children[i] * 3 + 1],
+                                     set.positions[children[i] * 3 + 2]);
+  center /= totalWeight;
+
+  // second moment around the new center, colors and SH
+  glm::mat3 covariance(0.0f);
+  glm::vec3 dc(0.0f);
+  for(uint32_t i = 0; i < childCount; ++i)
+  {
+    const glm::vec3 d = glm::vec3(set.positions[children[i] * 3 + 0], set.positions[children[i] * 3 + 1],
+                                  set.positions[children[i] * 3 + 2])
+                        - center;
+    covariance += weights[i] * (covariances[i] + glm::outerProduct(d, d));
+    dc += weights[i] * glm::vec3(set.f_dc[children[i] * 3 + 0], set.f_dc[children[i] * 3 + 1], set.f_dc[children[i] * 3 + 2]);
+  }
+  covariance /= totalWeight;
+  dc /= totalWeight;
+
+  float* rest = set.f_rest.data() + size_t(node) * shComponents;
+  for(uint32_t cmp = 0; cmp < shComponents; ++cmp)
+  {
+    float value = 0.0f;
+    for(uint32_t i = 0; i < childCount; ++i)
+      value += weights[i] * set.f_rest[size_t(children[i]) * shComponents + cmp];
+    rest[cmp] = value / totalWeight;
+  }
+
+  // back to scale and rotation
+  glm::vec3 values;
+  glm::mat3 vectors;
+  symmetricEigen(covariance, values, vectors);
+  if(glm::determinant(vectors) < 0.0f)
+    vectors[2] = -vectors[2];
+  const glm::vec3 scale    = glm::sqrt(glm::max(values, glm::vec3(1e-14f)));
+  const glm::quat rotation = glm::normalize(glm::quat_cast(vectors));
+
+  // the parent covers the same area with the same total coverage as its children
+  const float opacity = std::clamp(totalWeight / ellipsoidArea(scale), 1.0f / 255.0f, 0.999f);
+
+  for(uint32_t cmp = 0; cmp < 3; ++cmp)
+  {
+    set.positions[node * 3 + cmp] = center[cmp];
+    set.f_dc[node * 3 + cmp]      = dc[cmp];
+    set.scale[node * 3 + cmp]     = std::log(scale[cmp]);
+  }
+  set.opacity[node]          = std::log(opacity / (1.0f - opacity));
+  set.rotation[node * 4 + 0] = rotation.w;
+  set.rotation[node * 4 + 1] = rotation.x;
+  set.rotation[node * 4 + 2] = rotation.y;
+  set.rotation[node * 4 + 3] = rotation.z;
+
+  // sphere enclosing the ones of the children and the splat itself (3 sigma), slightly
+  // enlarged so that the nesting survives the quantization of the centers
+  float radius = 3.0f * std::max(scale.x, std::max(scale.y, scale.z));
+  for(uint32_t i = 0; i < childCount; ++i)
+  {
+    const glm::vec3 childCenter(set.positions[children[i] * 3 + 0], set.positions[children[i] * 3 + 1],
+                                set.positions[children[i] * 3 + 2]);
+    radius = std::max(radius, glm::length(childCenter - center) + set.lodRadius[children[i]]);
+    set.lodParent[children[i]] = node;
+  }
+  set.lodRadius[node] = radius * 1.001f;
+}
+
+void buildSplatLod(SplatSet& set)
+{
+  const uint32_t leafCount = uint32_t(set.size());
+  if(leafCount < 2)
+    return;
+
+  // the parents are written in the vectors
+  if(set.mapping)
+  {
+    std::vector<uint32_t> identity(leafCount);
+    std::iota(identity.begin(), identity.end(), 0);
+    reorderSplatSet(set, identity);
+  }
+  const uint32_t shComponents = uint32_t(set.f_rest.size() / leafCount);
+
+  // leaves, sphere of 3 sigma
+  set.lodParent.assign(leafCount, LOD_NO_PARENT);
+  set.lodRadius.resize(leafCount);
+  START_PAR_LOOP(leafCount, splatIdx)
+  {
+    const float maxScale =
+        std::max(set.scale[splatIdx * 3 + 0], std::max(set.scale[splatIdx * 3 + 1], set.scale[splatIdx * 3 + 2]));
+    set.lodRadius[splatIdx] = 3.0f * std::exp(maxScale);
+  }
+  END_PAR_LOOP()
+
+  // nodes of the current level in curve order, the parents of a level are
+  // created in this order so they are also ordered along the curve
+  std::vector<uint32_t> level = computeSpatialOrder(set.positions, E_ORDER_HILBERT);
+  while(level.size() > 1)
+  {
+    const uint32_t groupCount  = uint32_t((level.size() + LOD_BRANCHING - 1) / LOD_BRANCHING);
+    const uint32_t firstParent = uint32_t(set.size());
+    const size_t   nodeCount   = size_t(firstParent) + groupCount;
+
+    set.positions.resize(nodeCount * 3);
+    set.f_dc.resize(nodeCount * 3);
+    set.f_rest.resize(nodeCount * shComponents);
+    set.opacity.resize(nodeCount);
+    set.scale.resize(nodeCount * 3);
+    set.rotation.resize(nodeCount * 4);
+    set.lodParent.resize(nodeCount, LOD_NO_PARENT);
+    set.lodRadius.resize(nodeCount);
+
+    START_PAR_LOOP(groupCount, groupIdx)
+    {
+      const uint32_t begin = uint32_t(groupIdx) * LOD_BRANCHING;
+      const uint32_t count = std::min<uint32_t>(LOD_BRANCHING, uint32_t(level.size()) - begin);
+      mergeSplats(set, level.data() + begin, count, firstParent + uint32_t(groupIdx), shComponents);
+    }
+    END_PAR_LOOP()
+
+    level.resize(groupCount);
+    std::iota(level.begin(), level.end(), firstParent);
+  }
+
+  set.lodLeafCount = leafCount;
+}
+
+bool isLodSelected(const SplatSet& set, uint32_t node, const glm::vec3& cameraPosition, float focal, float threshold)
+{
+  const glm::vec3 center(set.positions[node * 3 + 0], set.positions[node * 3 + 1], set.positions[node * 3 + 2]);
+  if(node >= set.lodLeafCount && lodProjectedSize(center, set.lodRadius[node], cameraPosition, focal) > threshold)
+    return false;
+  const uint32_t parent = set.lodParent[node];
+  if(parent == LOD_NO_PARENT)
+    return true;
+  const glm::vec3 parentCenter(set.positions[parent * 3 + 0], set.positions[parent * 3 + 1], set.positions[parent * 3 + 2]);
+  return lodProjectedSize(parentCenter, set.lodRadius[parent], cameraPosition, focal) > threshold;
+}
+
+uint32_t countLodSelection(const SplatSet& set, const glm::vec3& cameraPosition, float focal, float threshold)
+{
+  // one counter per thread to avoid contention
+  const uint32_t        threadCount = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<uint32_t> counts(threadCount, 0);
+  nvh::parallel_batches_indexed<8192>(
+      set.size(),
+      [&](uint64_t node, uint32_t threadIdx) {
+        if(isLodSelected(set, uint32_t(node), cameraPosition, focal, threshold))
+          counts[threadIdx]++;
+      },
+      threadCount);
+  return std::accumulate(counts.begin(), counts.end(), 0u);
+}
+
+double computeMaskedPsnr(const uint8_t* reference, const uint8_t* image, uint64_t pixelCount)
+{
+  if(pixelCount == 0)
+    return -1.0;
+  const uint8_t* background = reference + (pixelCount - 1) * 4;
+  double         squares    = 0.0;
+  uint64_t       samples    = 0;
+  for(uint64_t pixel = 0; pixel < pixelCount; ++pixel)
+  {
+    const uint8_t* r = reference + pixel * 4;
+    const uint8_t* i = image + pixel * 4;
+    if(r[0] == background[0] && r[1] == background[1] && r[2] == background[2])
+      continue;
+    for(uint32_t cmp = 0; cmp < 3; ++cmp)
+    {
+      const double d = double(r[cmp]) - double(i[cmp]);
+      squares += d * d;
+    }
+    samples += 3;
+  }
+  if(samples == 0 || squares == 0.0)
+    return -1.0;
+  return 10.0 * std::log10(255.0 * 255.0 / (squares / double(samples)));
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2023-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#ifndef _SPLAT_LOD_H_
+#define _SPLAT_LOD_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include <glm/vec3.hpp>
+
+#include "splat_set.h"
+#include "shaders/shaderio.h"
+
+// Level of detail hierarchy built at load time. Groups of LOD_BRANCHING neighbouring
+// splats along a Hilbert curve are merged into parent nodes, level after level up to
+// a single root. A parent is a regular splat appended to the set, whose center and
+// covariance match the first two moments of its children and whose colors and SH are
+// the weighted averages of the children ones. Each node also stores the radius of a
+// sphere around its center that encloses the spheres of its children.
+//
+// At each frame the cut through the hierarchy is made of the nodes whose projected
+// radius is below the threshold while the one of their parent is above (leaves are
+// always fine enough). Since the spheres are nested the projected radius decreases
+// from a parent to its children and every leaf is covered by exactly one selected node.
+
+// projected radius in pixels of the sphere of a node, from the closest point of the sphere
+inline float lodProjectedSize(const glm::vec3& center, float radius, const glm::vec3& cameraPosition, float focal)
+{
+  const glm::vec3 d = center - cameraPosition;
+  return radius * focal / std::max(std::sqrt(d.x * d.x + d.y * d.y + d.z * d.z) - radius, 1e-6f);
+}
+
+// appends the parent nodes to set and fills its lodLeafCount, lodParent and lodRadius.
+// mapped attributes are copied to the vectors of set and the mapping is released. Multi threaded.
+void buildSplatLod(SplatSet& set);
+
+// CPU reference of isLodSelected in common.glsl, true if node is part of the cut for threshold
+bool isLodSelected(const SplatSet& set, uint32_t node, const glm::vec3& cameraPosition, float focal, float threshold);
+
+// number of nodes of the cut for threshold, the frustum is not taken into account. Multi threaded.
+uint32_t countLodSelection(const SplatSet& set, const glm::vec3& cameraPosition, float focal, float threshold);
+
+// PSNR in dB of image against reference, both RGBA8 of pixelCount pixels. As in psnr.py, only
+// the RGB of the pixels of reference that differ from its last pixel (the background) are compared.
+// returns a negative value if the images are identical.
+double computeMaskedPsnr(const uint8_t* reference, const uint8_t* image, uint64_t pixelCount);
+
+#endif
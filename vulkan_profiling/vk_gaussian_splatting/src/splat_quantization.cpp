@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2023-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "splat_quantization.h"
+#include "utilities.h"
+
+#include <vector>
+
+#include <glm/geometric.hpp>
+
+float quantizeCenters(const float* positions, uint32_t splatCount, uint16_t* codes, uint32_t codesStride, float* bounds)
+{
+  const uint32_t     chunkCount = centersChunkCount(splatCount);
+  std::vector<float> chunkErrors(chunkCount, 0.0f);
+
+  nvh::parallel_batches_indexed<1>(
+      chunkCount,
+      [&](uint64_t chunkIdx, uint32_t) {
+        const uint32_t begin = (uint32_t)chunkIdx * CENTERS_CHUNK_SIZE;
+        const uint32_t end   = std::min(splatCount, begin + CENTERS_CHUNK_SIZE);
+
+        // bounds of the chunk
+        glm::vec3 minimum(positions[begin * 3 + 0], positions[begin * 3 + 1], positions[begin * 3 + 2]);
+        glm::vec3 maximum = minimum;
+        for(uint32_t splatIdx = begin + 1; splatIdx < end; ++splatIdx)
+        {
+          const glm::vec3 center(positions[splatIdx * 3 + 0], positions[splatIdx * 3 + 1], positions[splatIdx * 3 + 2]);
+          minimum = glm::min(minimum, center);
+          maximum = glm::max(maximum, center);
+        }
+        const glm::vec3 extent = maximum - minimum;
+
+        float* chunkBounds = bounds + chunkIdx * CENTERS_BOUNDS_FLOATS;
+        for(uint32_t cmp = 0; cmp < 3; ++cmp)
+        {
+          chunkBounds[cmp]     = minimum[cmp];
+          chunkBounds[3 + cmp] = extent[cmp];
+        }
+
+        // codes, a null extent gives null codes
+        float maxError = 0.0f;
+        for(uint32_t splatIdx = begin; splatIdx < end; ++splatIdx)
+        {
+          for(uint32_t cmp = 0; cmp < 3; ++cmp)
+          {
+            const float normalized = extent[cmp] > 0.0f ? (positions[splatIdx * 3 + cmp] - minimum[cmp]) / extent[cmp] : 0.0f;
+            codes[uint64_t(splatIdx) * codesStride + cmp] =
+                static_cast<uint16_t>(std::clamp(normalized, 0.0f, 1.0f) * 65535.0f + 0.5f);
+          }
+          const glm::vec3 center(positions[splatIdx * 3 + 0], positions[splatIdx * 3 + 1], positions[splatIdx * 3 + 2]);
+          maxError = std::max(maxError, glm::distance(center, dequantizeCenter(codes, codesStride, bounds, splatIdx)));
+        }
+        chunkErrors[chunkIdx] = maxError;
+      },
+      (uint32_t)std::thread::hardware_concurrency());
+
+  return chunkErrors.empty() ? 0.0f : *std::max_element(chunkErrors.begin(), chunkErrors.end());
+}
+
+glm::vec3 dequantizeCenter(const uint16_t* codes, uint32_t codesStride, const float* bounds, uint32_t splatIndex)
+{
+  const float*    chunkBounds = bounds + (splatIndex / CENTERS_CHUNK_SIZE) * CENTERS_BOUNDS_FLOATS;
+  const uint16_t* code        = codes + uint64_t(splatIndex) * codesStride;
+  const glm::vec3 minimum(chunkBounds[0], chunkBounds[1], chunkBounds[2]);
+  const glm::vec3 extent(chunkBounds[3], chunkBounds[4], chunkBounds[5]);
+  return minimum + extent * (glm::vec3(code[0], code[1], code[2]) * (1.0f / 65535.0f));
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2023-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#ifndef _SPLAT_QUANTIZATION_H_
+#define _SPLAT_QUANTIZATION_H_
+
+#include <cstdint>
+#include <algorithm>
+#include <cmath>
+
+#include <glm/vec3.hpp>
+
+#include "shaders/shaderio.h"
+
+// Quantization of the centers, covariances and colors of the splats for the compact
+// layouts selected by the CENTERS_FORMAT, COVARIANCES_FORMAT and COLORS_FORMAT defines.
+// Centers in FORMAT_UNORM16 are 16 bit fixed point coordinates relative to the bounding
+// box of their chunk of CENTERS_CHUNK_SIZE consecutive splats, the precision thus
+// depends on the spatial coherence of the splat order.
+
+// number of chunks of CENTERS_CHUNK_SIZE splats
+inline uint32_t centersChunkCount(uint32_t splatCount)
+{
+  return (splatCount + CENTERS_CHUNK_SIZE - 1) / CENTERS_CHUNK_SIZE;
+}
+
+// maps v from [0,1] to [0,255], rounding to nearest
+inline uint8_t toUnorm8(float v)
+{
+  return static_cast<uint8_t>(std::clamp(v, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+// quantizes positions (3 floats per splat) to FORMAT_UNORM16. codes receives codesStride
+// uint16 per splat (padding is not written), bounds receives CENTERS_BOUNDS_FLOATS floats
+// per chunk (minimum then extent). Multi threaded.
+// Returns the largest distance between a center and its decoded value.
+float quantizeCenters(const float* positions, uint32_t splatCount, uint16_t* codes, uint32_t codesStride, float* bounds);
+
+// decodes the center of splat splatIndex, CPU reference of fetchCenter
+glm::vec3 dequantizeCenter(const uint16_t* codes, uint32_t codesStride, const float* bounds, uint32_t splatIndex);
+
+#endif
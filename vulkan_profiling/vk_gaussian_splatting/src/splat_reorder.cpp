@@ -0,0 +1,362 @@
+/*
+ * Copyright (c) 2023-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "splat_reorder.h"
+#include "splat_sorter_async.h"
+#include "utilities.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cstring>
+#include <numeric>
+#include <sstream>
+
+#include <glm/vec3.hpp>
+#include <glm/common.hpp>
+
+// bits per axis of the quantized centers, 3 * 21 bits fit in the 64 bit keys
+static constexpr uint32_t s_curveBits = 21;
+
+// spreads the 21 low bits of v so that there are two zero bits between each
+static inline uint64_t spreadBits(uint64_t v)
+{
+  v &= 0x1fffff;
+  v = (v | v << 32) & 0x1f00000000ffffull;
+  v = (v | v << 16) & 0x1f0000ff0000ffull;
+  v = (v | v << 8) & 0x100f00f00f00f00full;
+  v = (v | v << 4) & 0x10c30c30c30c30c3ull;
+  v = (v | v << 2) & 0x1249249249249249ull;
+  return v;
+}
+
+static inline uint64_t mortonKey(uint32_t x, uint32_t y, uint32_t z)
+{
+  return spreadBits(x) << 2 | spreadBits(y) << 1 | spreadBits(z);
+}
+
+// Skilling's transform of the coordinates to the transposed Hilbert index,
+// the key is then the interleaving of the transposed coordinates.
+static inline uint64_t hilbertKey(uint32_t x, uint32_t y, uint32_t z)
+{
+  uint32_t X[3] = {x, y, z};
+  // inverse undo
+  for(uint32_t bit = s_curveBits - 1; bit > 0; --bit)
+  {
+    const uint32_t P = (1u << bit) - 1;
+    // branchless form of: if bit of X[i] is set invert the low bits of X[0], else exchange them with X[i]
+    for(uint32_t i = 0; i < 3; ++i)
+    {
+      const uint32_t invert = 0u - ((X[i] >> bit) & 1u);
+      const uint32_t t      = (X[0] ^ X[i]) & P & ~invert;
+      X[0] ^= (P & invert) | t;
+      X[i] ^= t;
+    }
+  }
+  // gray encode
+  X[1] ^= X[0];
+  X[2] ^= X[1];
+  uint32_t t = 0;
+  for(uint32_t bit = s_curveBits - 1; bit > 0; --bit)
+    t ^= ((1u << bit) - 1) & (0u - ((X[2] >> bit) & 1u));
+  for(uint32_t i = 0; i < 3; ++i)
+    X[i] ^= t;
+
+  return mortonKey(X[0], X[1], X[2]);
+}
+
+// sorts values by increasing order, blocks are sorted in parallel then merged two by two
+template <typename T>
+static void parallelSort(std::vector<T>& values)
+{
+  const uint64_t count       = values.size();
+  const uint32_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+  const uint64_t blockSize   = std::max<uint64_t>(65536, (count + threadCount - 1) / threadCount);
+  const uint64_t blockCount  = (count + blockSize - 1) / blockSize;
+
+  nvh::parallel_batches_indexed<1>(
+      blockCount,
+      [&](uint64_t blockIdx, uint32_t) {
+        std::sort(values.begin() + blockIdx * blockSize, values.begin() + std::min(count, (blockIdx + 1) * blockSize));
+      },
+      threadCount);
+
+  for(uint64_t width = blockSize; width < count; width *= 2)
+  {
+    nvh::parallel_batches_indexed<1>(
+        (count + 2 * width - 1) / (2 * width),
+        [&](uint64_t mergeIdx, uint32_t) {
+          const uint64_t first = mergeIdx * 2 * width;
+          const uint64_t mid   = std::min(count, first + width);
+          const uint64_t last  = std::min(count, first + 2 * width);
+          std::inplace_merge(values.begin() + first, values.begin() + mid, values.begin() + last);
+        },
+        threadCount);
+  }
+}
+
+std::vector<uint32_t> computeSpatialOrder(const std::vector<float>& positions, SpatialOrder curve)
+{
+  const uint32_t        splatCount = uint32_t(positions.size() / 3);
+  std::vector<uint32_t> order(splatCount);
+
+  if(curve == E_ORDER_FILE || splatCount == 0)
+  {
+    std::iota(order.begin(), order.end(), 0);
+    return order;
+  }
+
+  // bounding cube of the centers
+  glm::vec3 minimum(FLT_MAX);
+  glm::vec3 maximum(-FLT_MAX);
+  for(uint32_t splatIdx = 0; splatIdx < splatCount; ++splatIdx)
+  {
+    const glm::vec3 center(positions[splatIdx * 3 + 0], positions[splatIdx * 3 + 1], positions[splatIdx * 3 + 2]);
+    minimum = glm::min(minimum, center);
+    maximum = glm::max(maximum, center);
+  }
+  const glm::vec3 extent    = maximum - minimum;
+  const float     maxExtent = std::max(extent.x, std::max(extent.y, extent.z));
+  const float     maxCell   = float((1u << s_curveBits) - 1);
+  const float     scale     = maxExtent > 0.0f ? maxCell / maxExtent : 0.0f;
+
+  // <key,index> pairs, the index makes the order deterministic for equal keys
+  struct KeyIndex
+  {
+    uint64_t key;
+    uint32_t index;
+    bool     operator<(const KeyIndex& other) const { return key < other.key || (key == other.key && index < other.index); }
+  };
+  std::vector<KeyIndex> pairs(splatCount);
+
+  START_PAR_LOOP(splatCount, splatIdx)
+  {
+    uint32_t cell[3];
+    for(uint32_t cmp = 0; cmp < 3; ++cmp)
+      cell[cmp] = uint32_t(std::clamp((positions[splatIdx * 3 + cmp] - minimum[cmp]) * scale, 0.0f, maxCell));
+    const uint64_t key =
+        curve == E_ORDER_HILBERT ? hilbertKey(cell[0], cell[1], cell[2]) : mortonKey(cell[0], cell[1], cell[2]);
+    pairs[splatIdx] = {key, uint32_t(splatIdx)};
+  }
+  END_PAR_LOOP()
+
+  parallelSort(pairs);
+
+  START_PAR_LOOP(splatCount, splatIdx)
+  {
+    order[splatIdx] = pairs[splatIdx].index;
+  }
+  END_PAR_LOOP()
+
+  return order;
+}
+
+void reorderSplatSet(SplatSet& set, const std::vector<uint32_t>& order)
+{
+  const uint32_t splatCount = uint32_t(order.size());
+
+  // copies the rows of view in the new order
+  auto gather = [&](const SplatAttributeView& view) {
+    std::vector<float> result(size_t(splatCount) * view.components);
+    const size_t       rowSize = view.components * sizeof(float);
+    if(rowSize)
+    {
+      START_PAR_LOOP(splatCount, splatIdx)
+      {
+        memcpy(result.data() + splatIdx * view.components, view.data + order[splatIdx] * view.stride, rowSize);
+      }
+      END_PAR_LOOP()
+    }
+    return result;
+  };
+
+  // one attribute at a time to limit the memory peak
+  set.f_dc      = gather(set.f_dcView());
+  set.f_rest    = gather(set.f_restView());
+  set.opacity   = gather(set.opacityView());
+  set.scale     = gather(set.scaleView());
+  set.rotation  = gather(set.rotationView());
+  set.positions = gather(SplatSet::vectorView(set.positions, 3));
+
+  // all the attributes are now in the vectors
+  set.mapping.reset();
+  set.mappedF_dc     = {};
+  set.mappedF_rest   = {};
+  set.mappedOpacity  = {};
+  set.mappedScale    = {};
+  set.mappedRotation = {};
+}
+
+SplatLocalityReport measureFetchLocality(const std::vector<uint32_t>& sortedIndices, const uint32_t* storageIndex)
+{
+  constexpr uint32_t warpSize      = 32;
+  constexpr uint32_t warpsPerBlock = 1024;
+  constexpr uint64_t lineSize      = 128;
+  constexpr uint64_t centerSize    = 3 * sizeof(float);
+  constexpr uint64_t shSize        = 45 * sizeof(float);
+
+  const uint64_t splatCount = sortedIndices.size();
+  const uint64_t warpCount  = (splatCount + warpSize - 1) / warpSize;
+  const uint64_t blockCount = (warpCount + warpsPerBlock - 1) / warpsPerBlock;
+
+  // per block sums, reduced at the end
+  std::vector<uint64_t> centersLines(blockCount, 0);
+  std::vector<uint64_t> shLines(blockCount, 0);
+  std::vector<double>   gaps(blockCount, 0.0);
+
+  nvh::parallel_batches_indexed<1>(
+      blockCount,
+      [&](uint64_t blockIdx, uint32_t) {
+        std::vector<uint64_t> lines;
+        auto countLines = [&](uint64_t begin, uint64_t end, uint64_t rowSize) {
+          lines.clear();
+          for(uint64_t i = begin; i < end; ++i)
+          {
+            const uint64_t splat = storageIndex ? storageIndex[sortedIndices[i]] : sortedIndices[i];
+            for(uint64_t line = splat * rowSize / lineSize; line <= (splat * rowSize + rowSize - 1) / lineSize; ++line)
+              lines.push_back(line);
+          }
+          std::sort(lines.begin(), lines.end());
+          return uint64_t(std::unique(lines.begin(), lines.end()) - lines.begin());
+        };
+
+        const uint64_t firstWarp = blockIdx * warpsPerBlock;
+        const uint64_t lastWarp  = std::min(warpCount, firstWarp + warpsPerBlock);
+        for(uint64_t warpIdx = firstWarp; warpIdx < lastWarp; ++warpIdx)
+        {
+          const uint64_t begin = warpIdx * warpSize;
+          const uint64_t end   = std::min(splatCount, begin + warpSize);
+          centersLines[blockIdx] += countLines(begin, end, centerSize);
+          shLines[blockIdx] += countLines(begin, end, shSize);
+          for(uint64_t i = std::max<uint64_t>(begin, 1); i < end; ++i)
+          {
+            const int64_t current  = storageIndex ? storageIndex[sortedIndices[i]] : sortedIndices[i];
+            const int64_t previous = storageIndex ? storageIndex[sortedIndices[i - 1]] : sortedIndices[i - 1];
+            gaps[blockIdx] += double(std::abs(current - previous));
+          }
+        }
+      },
+      std::max(1u, std::thread::hardware_concurrency()));
+
+  // DRAM traffic through an L2 like cache, set associative with LRU replacement, shared by the
+  // centers and the SH, accessed in the sorted order. Sequential, the order of the accesses matters.
+  constexpr uint64_t cacheSize = 4 * 1024 * 1024;
+  constexpr uint32_t cacheWays = 16;
+  constexpr uint64_t cacheSets = cacheSize / lineSize / cacheWays;
+  std::vector<uint64_t> tags(cacheSets * cacheWays, ~uint64_t(0));
+  std::vector<uint64_t> lastUse(cacheSets * cacheWays, 0);
+  uint64_t              misses = 0;
+  uint64_t              time   = 0;
+  auto access = [&](uint64_t line) {
+    uint64_t* setTags = tags.data() + (line % cacheSets) * cacheWays;
+    uint64_t* setUses = lastUse.data() + (line % cacheSets) * cacheWays;
+    uint32_t  victim  = 0;
+    for(uint32_t way = 0; way < cacheWays; ++way)
+    {
+      if(setTags[way] == line)
+      {
+        setUses[way] = ++time;
+        return;
+      }
+      if(setUses[way] < setUses[victim])
+        victim = way;
+    }
+    ++misses;
+    setTags[victim] = line;
+    setUses[victim] = ++time;
+  };
+  const uint64_t shFirstLine = (splatCount * centerSize) / lineSize + 1;
+  for(uint64_t i = 0; i < splatCount; ++i)
+  {
+    const uint64_t splat = storageIndex ? storageIndex[sortedIndices[i]] : sortedIndices[i];
+    for(uint64_t line = splat * centerSize / lineSize; line <= (splat * centerSize + centerSize - 1) / lineSize; ++line)
+      access(line);
+    for(uint64_t line = splat * shSize / lineSize; line <= (splat * shSize + shSize - 1) / lineSize; ++line)
+      access(shFirstLine + line);
+  }
+
+  SplatLocalityReport report;
+  if(splatCount)
+    report.memoryBytesPerSplat = double(misses * lineSize) / double(splatCount);
+  if(warpCount)
+  {
+    report.centersLinesPerWarp = double(std::accumulate(centersLines.begin(), centersLines.end(), uint64_t(0))) / warpCount;
+    report.shLinesPerWarp      = double(std::accumulate(shLines.begin(), shLines.end(), uint64_t(0))) / warpCount;
+  }
+  if(splatCount > 1)
+  {
+    report.meanIndexGap = std::accumulate(gaps.begin(), gaps.end(), 0.0) / double(splatCount - 1);
+  }
+  return report;
+}
+
+std::string benchmarkSpatialOrders(const std::vector<float>& positions,
+                                   const glm::mat4&          viewMatrix,
+                                   const glm::mat4&          projectionMatrix,
+                                   int                       keyMode)
+{
+  const uint32_t splatCount = uint32_t(positions.size() / 3);
+
+  // back to front order of the splats, with the same keys as the sorters, culling is ignored
+  std::vector<uint64_t> keys(splatCount);
+  START_PAR_LOOP(splatCount, splatIdx)
+  {
+    const glm::vec3 center(positions[splatIdx * 3 + 0], positions[splatIdx * 3 + 1], positions[splatIdx * 3 + 2]);
+    keys[splatIdx] = uint64_t(SplatSorterAsync::referenceKey(keyMode, viewMatrix, projectionMatrix, center)) << 32 | splatIdx;
+  }
+  END_PAR_LOOP()
+  parallelSort(keys);
+  std::vector<uint32_t> sortedIndices(splatCount);
+  START_PAR_LOOP(splatCount, splatIdx)
+  {
+    sortedIndices[splatIdx] = uint32_t(keys[splatIdx]);
+  }
+  END_PAR_LOOP()
+
+  std::ostringstream report;
+  report.setf(std::ios::fixed);
+  report.precision(1);
+  auto addLine = [&](const char* name, const SplatLocalityReport& locality, long long reorderTime) {
+    report << name << ": centers " << locality.centersLinesPerWarp << " lines/warp, SH " << locality.shLinesPerWarp
+           << " lines/warp, mean index gap " << locality.meanIndexGap << ", memory " << locality.memoryBytesPerSplat
+           << " B/splat";
+    if(reorderTime >= 0)
+      report << ", ordered in " << reorderTime << "ms";
+    report << "\n";
+  };
+
+  addLine("Current order", measureFetchLocality(sortedIndices), -1);
+
+  const std::pair<SpatialOrder, const char*> curves[] = {{E_ORDER_MORTON, "Morton"}, {E_ORDER_HILBERT, "Hilbert"}};
+  for(const auto& [curve, name] : curves)
+  {
+    auto                        startTime = std::chrono::high_resolution_clock::now();
+    const std::vector<uint32_t> order     = computeSpatialOrder(positions, curve);
+    auto                        endTime   = std::chrono::high_resolution_clock::now();
+    // position of each splat in memory once reordered
+    std::vector<uint32_t> storageIndex(splatCount);
+    for(uint32_t i = 0; i < splatCount; ++i)
+      storageIndex[order[i]] = i;
+    addLine(name, measureFetchLocality(sortedIndices, storageIndex.data()),
+            std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count());
+  }
+
+  return report.str();
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2023-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#ifndef _SPLAT_REORDER_H_
+#define _SPLAT_REORDER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+
+#include "splat_set.h"
+
+// Load time reordering of the splats along a 3D space filling curve over their
+// centers, so that splats close in space are also close in memory. The splats
+// drawn by a warp after sorting are then more likely to share cache lines.
+
+// space filling curves used to reorder the splats
+enum SpatialOrder
+{
+  E_ORDER_FILE,    // keep the order of the ply file
+  E_ORDER_MORTON,  // Z-order curve
+  E_ORDER_HILBERT  // Hilbert curve, better locality than Morton
+};
+
+// returns the new order of the splats, order[i] is the index in positions of the i-th splat.
+// the centers are quantized to 21 bits per axis in their bounding cube. Multi threaded.
+std::vector<uint32_t> computeSpatialOrder(const std::vector<float>& positions, SpatialOrder curve);
+
+// reorders all the attributes of set following order, mapped attributes are copied
+// to the vectors of set and the mapping is released. Multi threaded.
+void reorderSplatSet(SplatSet& set, const std::vector<uint32_t>& order);
+
+// locality of the attribute fetches made by the rasterization for a back to front order
+struct SplatLocalityReport
+{
+  double centersLinesPerWarp = 0.0;  // distinct 128 bytes segments of the fp32 centers per warp of 32 sorted splats
+  double shLinesPerWarp      = 0.0;  // same for the fp32 SH of degree 1 to 3
+  double meanIndexGap        = 0.0;  // mean absolute difference between the storage index of consecutive sorted splats
+  double memoryBytesPerSplat = 0.0;  // centers and SH bytes read from memory per splat through a simulated 4MB L2 cache
+};
+
+// sortedIndices is a back to front order of the splats, if storageIndex is not null, splat i is
+// stored at storageIndex[i] in memory instead of i.
+SplatLocalityReport measureFetchLocality(const std::vector<uint32_t>& sortedIndices, const uint32_t* storageIndex = nullptr);
+
+// sorts the splats for viewMatrix and projectionMatrix with keyMode (SORT_KEY_* of shaderio.h) then measures
+// the fetch locality of the current order, and of the Morton and Hilbert orders computed
+// from positions. returns a one line report per order, with the reordering time.
+std::string benchmarkSpatialOrders(const std::vector<float>& positions,
+                                   const glm::mat4&          viewMatrix,
+                                   const glm::mat4&          projectionMatrix,
+                                   int                       keyMode);
+
+#endif
@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2023-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "splat_residency.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <glm/geometric.hpp>
+
+void SplatResidency::init(uint32_t splatCount, const std::array<uint32_t, E_ATTRIBUTE_COUNT>& bytesPerSplat, uint64_t poolBytes)
+{
+  m_stores = {};
+  uint64_t chunkPayload = 0;
+  for(uint32_t attribute = 0; attribute < E_ATTRIBUTE_COUNT; ++attribute)
+  {
+    m_stores[attribute].bytesPerSplat = bytesPerSplat[attribute];
+    chunkPayload += uint64_t(bytesPerSplat[attribute]) * SPLAT_CHUNK_SIZE;
+  }
+  const uint32_t chunkCount = splatChunkCount(splatCount);
+  const uint64_t fitting    = chunkPayload ? std::max<uint64_t>(1, poolBytes / chunkPayload) : chunkCount;
+  const uint32_t slotCount  = uint32_t(std::min<uint64_t>(fitting, chunkCount));
+
+  m_splatCount = splatCount;
+  m_chunkSlots.assign(chunkCount, CHUNK_NOT_RESIDENT);
+  m_slotChunks.assign(slotCount, CHUNK_NOT_RESIDENT);
+  m_lastVisible.assign(chunkCount, 0);
+  m_visible.resize(chunkCount);
+  // popped from the back, so the first slots are used first
+  m_freeSlots.resize(slotCount);
+  for(uint32_t slot = 0; slot < slotCount; ++slot)
+    m_freeSlots[slot] = slotCount - 1 - slot;
+  m_updateIndex = 0;
+  m_stats       = {};
+}
+
+void SplatResidency::reset()
+{
+  m_file.reset();
+  m_filename.clear();
+  init(0, {}, 0);
+}
+
+uint8_t* SplatResidency::allocateStore(Attribute attribute)
+{
+  Store& store = m_stores[attribute];
+  store.heap.assign(size_t(m_splatCount) * store.bytesPerSplat, 0);
+  store.data = store.heap.data();
+  return store.heap.data();
+}
+
+bool SplatResidency::attachFile(Attribute attribute, const std::string& filename, uint64_t offset)
+{
+  Store&         store = m_stores[attribute];
+  const uint64_t size  = uint64_t(m_splatCount) * store.bytesPerSplat;
+
+  // one mapping for all the attributes
+  if(!m_file || m_filename != filename)
+  {
+    auto file = std::make_shared<MappedFile>();
+    if(file->open(filename))
+    {
+      m_file     = file;
+      m_filename = filename;
+    }
+  }
+  if(m_file && m_filename == filename && offset + size <= m_file->size())
+  {
+    store.heap = {};
+    store.data = reinterpret_cast<const uint8_t*>(m_file->data()) + offset;
+    return true;
+  }
+
+  // no mapping, the section is read in the heap store
+  store.heap.resize(size);
+  store.data = store.heap.data();
+  std::ifstream stream(filename, std::ios::in | std::ios::binary);
+  if(!stream.seekg((std::streamoff)offset) || !stream.read(reinterpret_cast<char*>(store.heap.data()), (std::streamsize)size))
+  {
+    std::cout << "Error: cannot read streamed attribute from " << filename << std::endl;
+    return false;
+  }
+  return true;
+}
+
+void SplatResidency::copyChunk(Attribute attribute, uint32_t chunk, uint8_t* dst) const
+{
+  const Store&   store = m_stores[attribute];
+  const uint32_t first = chunk * SPLAT_CHUNK_SIZE;
+  const uint32_t count = std::min<uint32_t>(SPLAT_CHUNK_SIZE, m_splatCount - first);
+  if(store.data)
+    std::memcpy(dst, store.data + uint64_t(first) * store.bytesPerSplat, size_t(count) * store.bytesPerSplat);
+}
+
+void SplatResidency::update(const std::vector<float>& chunkBounds,
+                            const glm::mat4&          viewProj,
+                            const glm::vec3&          cameraPosition,
+                            float                     dilation,
+                            uint32_t                  maxUploads,
+                            std::vector<Upload>&      uploads,
+                            std::vector<uint32_t>&    changedChunks)
+{
+  m_stats.frameUploads   = 0;
+  m_stats.frameEvictions = 0;
+  m_stats.visibleChunks  = 0;
+  m_stats.missingChunks  = 0;
+  if(m_chunkSlots.empty() || m_slotChunks.empty())
+    return;
+
+  ++m_updateIndex;
+
+  // visible chunks, the ones that are not resident are requested
+  const uint32_t visibleCount = cullChunks(chunkBounds, viewProj, dilation, m_visible.data());
+  std::vector<uint32_t> requests;
+  for(uint32_t i = 0; i < visibleCount; ++i)
+  {
+    const uint32_t chunk = m_visible[i];
+    m_lastVisible[chunk] = m_updateIndex;
+    if(m_chunkSlots[chunk] == CHUNK_NOT_RESIDENT)
+      requests.push_back(chunk);
+  }
+  m_stats.visibleChunks = visibleCount;
+
+  // closest first, only the ones that fit the budget need to be ordered
+  auto distance2 = [&](uint32_t chunk) {
+    const float*    bounds = chunkBounds.data() + size_t(chunk) * CHUNK_BOUNDS_FLOATS;
+    const glm::vec3 center = 0.5f * (glm::vec3(bounds[0], bounds[1], bounds[2]) + glm::vec3(bounds[3], bounds[4], bounds[5]));
+    const glm::vec3 d      = center - cameraPosition;
+    return glm::dot(d, d);
+  };
+  const uint32_t requestCount = std::min<uint32_t>(maxUploads, uint32_t(requests.size()));
+  std::partial_sort(requests.begin(), requests.begin() + requestCount, requests.end(),
+                    [&](uint32_t a, uint32_t b) { return distance2(a) < distance2(b); });
+
+  // the resident chunks not visible at this update, least recently visible first,
+  // only computed if the free slots do not suffice
+  std::vector<uint32_t> candidates;
+  size_t                nextCandidate = 0;
+  if(requestCount > m_freeSlots.size())
+  {
+    const size_t needed = requestCount - m_freeSlots.size();
+    for(uint32_t chunk : m_slotChunks)
+    {
+      if(chunk != CHUNK_NOT_RESIDENT && m_lastVisible[chunk] != m_updateIndex)
+        candidates.push_back(chunk);
+    }
+    const size_t sorted = std::min(needed, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + sorted, candidates.end(),
+                      [&](uint32_t a, uint32_t b) { return m_lastVisible[a] < m_lastVisible[b]; });
+  }
+
+  for(uint32_t i = 0; i < requestCount; ++i)
+  {
+    uint32_t slot;
+    if(!m_freeSlots.empty())
+    {
+      slot = m_freeSlots.back();
+      m_freeSlots.pop_back();
+    }
+    else if(nextCandidate < candidates.size())
+    {
+      // evicts the least recently visible chunk
+      const uint32_t evicted = candidates[nextCandidate++];
+      slot                   = m_chunkSlots[evicted];
+      m_chunkSlots[evicted]  = CHUNK_NOT_RESIDENT;
+      changedChunks.push_back(evicted);
+      ++m_stats.frameEvictions;
+    }
+    else
+    {
+      // the pools are full of visible chunks
+      break;
+    }
+    const uint32_t chunk = requests[i];
+    m_chunkSlots[chunk]  = slot;
+    m_slotChunks[slot]   = chunk;
+    uploads.push_back({chunk, slot});
+    changedChunks.push_back(chunk);
+    ++m_stats.frameUploads;
+  }
+
+  m_stats.missingChunks = uint32_t(requests.size()) - m_stats.frameUploads;
+  m_stats.totalUploads += m_stats.frameUploads;
+  m_stats.totalEvictions += m_stats.frameEvictions;
+  m_stats.totalUploadedBytes += m_stats.frameUploads * chunkPayloadBytes();
+}
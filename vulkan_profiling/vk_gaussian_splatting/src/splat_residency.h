@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2023-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#ifndef _SPLAT_RESIDENCY_H_
+#define _SPLAT_RESIDENCY_H_
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include "mapped_file.h"
+#include "splat_chunks.h"
+
+// Out of core streaming of the splat attributes. The covariances, colors and SH of
+// the chunks of SPLAT_CHUNK_SIZE splats (see splat_chunks.h) live in a host store, the
+// memory mapped splat cache if possible, and only a fixed number of chunks are resident
+// in device pools. Each frame the visible chunks that are not resident are uploaded,
+// closest first and within an upload budget, replacing the least recently visible ones
+// when the pools are full. The centers stay fully resident since sorting and culling
+// visit all of them, the shaders skip the splats of the chunks that are not resident.
+class SplatResidency
+{
+public:
+  // streamed attributes, in the order of the splat cache sections
+  enum Attribute
+  {
+    E_COVARIANCES,
+    E_COLORS,
+    E_SH,  // codes only for FORMAT_VQ, the codebook is fully resident
+    E_ATTRIBUTE_COUNT
+  };
+
+  // a chunk to copy into a slot of the pools
+  struct Upload
+  {
+    uint32_t chunk = 0;
+    uint32_t slot  = 0;
+  };
+
+  struct Stats
+  {
+    uint32_t visibleChunks      = 0;  // visible at last update
+    uint32_t missingChunks      = 0;  // visible but still not resident after last update
+    uint32_t frameUploads       = 0;  // chunks uploaded by last update
+    uint32_t frameEvictions     = 0;  // chunks evicted by last update
+    uint64_t totalUploads       = 0;
+    uint64_t totalEvictions     = 0;
+    uint64_t totalUploadedBytes = 0;
+  };
+
+public:
+  // all chunks of the splatCount splats non resident, as many slots as fit in poolBytes
+  // for the payloads of all the attributes, at least one and at most one per chunk
+  void init(uint32_t splatCount, const std::array<uint32_t, E_ATTRIBUTE_COUNT>& bytesPerSplat, uint64_t poolBytes);
+
+  // releases the store and the residency
+  void reset();
+
+  // allocates the heap store of attribute for the whole model and returns it to be filled
+  uint8_t* allocateStore(Attribute attribute);
+
+  // replaces the store of attribute by the content of filename at offset, memory mapped if
+  // possible, otherwise read in the heap store. The file is the splat cache, attribute data
+  // must then not be accessed from the pointer returned by allocateStore anymore.
+  bool attachFile(Attribute attribute, const std::string& filename, uint64_t offset);
+
+  // copies the payload of chunk for attribute to dst, the tail of the last chunk is left untouched
+  void copyChunk(Attribute attribute, uint32_t chunk, uint8_t* dst) const;
+
+  // updates the residency for the view, see class description. Appends at most maxUploads
+  // uploads and the chunks whose slot changed (evicted or uploaded) to the output vectors.
+  void update(const std::vector<float>& chunkBounds,
+              const glm::mat4&          viewProj,
+              const glm::vec3&          cameraPosition,
+              float                     dilation,
+              uint32_t                  maxUploads,
+              std::vector<Upload>&      uploads,
+              std::vector<uint32_t>&    changedChunks);
+
+  // slot of chunk in the pools, CHUNK_NOT_RESIDENT if not resident
+  [[nodiscard]] inline uint32_t slotOf(uint32_t chunk) const { return m_chunkSlots[chunk]; }
+
+  // size in bytes of the payload of SPLAT_CHUNK_SIZE splats for attribute
+  [[nodiscard]] inline uint64_t chunkBytes(Attribute attribute) const
+  {
+    return uint64_t(m_stores[attribute].bytesPerSplat) * SPLAT_CHUNK_SIZE;
+  }
+
+  // size in bytes of the payload of SPLAT_CHUNK_SIZE splats for all the attributes
+  [[nodiscard]] inline uint64_t chunkPayloadBytes() const
+  {
+    return chunkBytes(E_COVARIANCES) + chunkBytes(E_COLORS) + chunkBytes(E_SH);
+  }
+
+  // size in bytes of the pool of attribute on device
+  [[nodiscard]] inline uint64_t poolBytes(Attribute attribute) const { return uint64_t(slotCount()) * chunkBytes(attribute); }
+
+  [[nodiscard]] inline uint32_t     chunkCount() const { return uint32_t(m_chunkSlots.size()); }
+  [[nodiscard]] inline uint32_t     slotCount() const { return uint32_t(m_slotChunks.size()); }
+  [[nodiscard]] inline uint32_t     residentCount() const { return slotCount() - uint32_t(m_freeSlots.size()); }
+  [[nodiscard]] inline bool         isMapped() const { return m_file != nullptr; }
+  [[nodiscard]] inline const Stats& stats() const { return m_stats; }
+
+private:
+  struct Store
+  {
+    std::vector<uint8_t> heap;                // whole model, unless mapped
+    const uint8_t*       data          = nullptr;
+    uint32_t             bytesPerSplat = 0;
+  };
+
+  std::array<Store, E_ATTRIBUTE_COUNT> m_stores;
+  std::shared_ptr<MappedFile>          m_file;  // the mapped splat cache, shared by the stores
+  std::string                          m_filename;
+  uint32_t                             m_splatCount = 0;
+
+  std::vector<uint32_t> m_chunkSlots;    // slot per chunk, CHUNK_NOT_RESIDENT if not resident
+  std::vector<uint32_t> m_slotChunks;    // chunk per slot, CHUNK_NOT_RESIDENT if free
+  std::vector<uint32_t> m_freeSlots;     // stack of the free slots
+  std::vector<uint64_t> m_lastVisible;   // update index at which each chunk was last visible
+  std::vector<uint32_t> m_visible;       // scratch, visible chunks of the update
+  uint64_t              m_updateIndex = 0;
+
+  Stats m_stats;
+};
+
+#endif
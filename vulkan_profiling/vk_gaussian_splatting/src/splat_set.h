@@ -21,6 +21,30 @@
 #define _SPLAT_SET_H_
 
 #include <vector>
+#include <memory>
+#include <cstring>
+#include <cstdint>
+
+#include "mapped_file.h"
+
+// Read only strided view over a float attribute of a splat set.
+// Points either to one of the SplatSet vectors or directly
+// to the vertex block of a memory mapped ply file.
+struct SplatAttributeView
+{
+  const char* data       = nullptr;  // first component of the first splat
+  size_t      stride     = 0;        // in bytes, between two consecutive splats
+  uint32_t    components = 0;        // consecutive floats per splat
+
+  // returns component cmp of splat splatIdx
+  // mapped rows are not necessarily aligned, hence the memcpy
+  inline float get(size_t splatIdx, uint32_t cmp) const
+  {
+    float value;
+    std::memcpy(&value, data + splatIdx * stride + cmp * sizeof(float), sizeof(float));
+    return value;
+  }
+};
 
 // Storage for a 3D gaussian splatting (3DGS) model loaded from PLY file
 struct SplatSet
@@ -34,8 +58,43 @@ struct SplatSet
   std::vector<float> scale;     // 3 components per point in ply file
   std::vector<float> rotation;  // 4 components per point in ply file - a quaternion
 
+  // when the set is backed by a memory mapped ply file, f_dc, f_rest, opacity, scale
+  // and rotation vectors are left empty and the attributes are read in place through
+  // the mapped views. positions are always copied since the sorter works on the vector.
+  std::shared_ptr<MappedFile> mapping;
+  SplatAttributeView          mappedF_dc;
+  SplatAttributeView          mappedF_rest;
+  SplatAttributeView          mappedOpacity;
+  SplatAttributeView          mappedScale;
+  SplatAttributeView          mappedRotation;
+
+  // level of detail hierarchy, see splat_lod.h. When lodLeafCount is not zero the first
+  // lodLeafCount splats are the leaves and the following ones their merged parents.
+  uint32_t              lodLeafCount = 0;
+  std::vector<uint32_t> lodParent;  // 1 value per splat, LOD_NO_PARENT for the root
+  std::vector<float>    lodRadius;  // 1 value per splat, radius of the bounding sphere of the node
+
   // returns the number of splate in the set
   inline size_t size() const { return positions.size() / 3; }
+
+  // views to be used to read the attributes whatever the storage
+  inline SplatAttributeView f_dcView() const { return mapping ? mappedF_dc : vectorView(f_dc, 3); }
+  inline SplatAttributeView f_restView() const
+  {
+    return mapping ? mappedF_rest : vectorView(f_rest, size() ? uint32_t(f_rest.size() / size()) : 0);
+  }
+  inline SplatAttributeView opacityView() const { return mapping ? mappedOpacity : vectorView(opacity, 1); }
+  inline SplatAttributeView scaleView() const { return mapping ? mappedScale : vectorView(scale, 3); }
+  inline SplatAttributeView rotationView() const { return mapping ? mappedRotation : vectorView(rotation, 4); }
+
+  // returns the number of SH coefficients of degree 1 to 3 per splat, all channels included
+  inline uint32_t shComponentCount() const { return f_restView().components; }
+
+  // view over one of the vectors above
+  static inline SplatAttributeView vectorView(const std::vector<float>& attribute, uint32_t components)
+  {
+    return {reinterpret_cast<const char*>(attribute.data()), components * sizeof(float), components};
+  }
 };
 
 #endif
@@ -22,9 +22,25 @@
 
 // for parallel processing
 #include <algorithm>
-#include <execution>
+#include <array>
+#include <numeric>
 // mathematics
 #include <cmath>
+#include <cstring>
+// vectorization, AVX2 kernel is selected at runtime on x86
+#if defined(__x86_64__) || defined(_M_X64)
+#define SORTER_X86_SIMD
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SORTER_AVX2_FUNCTION
+#else
+#define SORTER_AVX2_FUNCTION __attribute__((target("avx2")))
+#endif
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define SORTER_NEON_SIMD
+#include <arm_neon.h>
+#endif
 #include <glm/vec4.hpp>
 
 bool SplatSorterAsync::initialize()
@@ -48,26 +64,23 @@ bool SplatSorterAsync::initialize()
       std::unique_lock<std::mutex> lock(m_mutex);
       m_sortCV.wait(lock, [this] { return m_shutdownRequested || m_startRequested; });
       bool shutdown = m_shutdownRequested;
+      // the request is taken in the same critical section so that
+      // cancelAndWait cannot miss a sort about to start
+      if(!shutdown)
+      {
+        m_status         = E_SORTING;
+        m_startRequested = false;
+      }
       lock.unlock();
       // if request is not a shutdown do the job
       if(!shutdown)
       {
-        // let's load
-        std::unique_lock<std::mutex> lock(m_mutex);
-        m_status = E_SORTING;
+        bool success = innerSort();
+        lock.lock();
+        m_status = success ? E_SORTED : E_FAILURE;
         lock.unlock();
-        if(innerSort())
-        {
-          std::lock_guard<std::mutex> lock(m_mutex);
-          m_status         = E_SORTED;
-          m_startRequested = false;
-        }
-        else
-        {
-          std::lock_guard<std::mutex> lock(m_mutex);
-          m_status         = E_FAILURE;
-          m_startRequested = false;
-        }
+        // wakeup cancelAndWait
+        m_sortCV.notify_all();
       }
       else
       {
@@ -82,48 +95,522 @@ bool SplatSorterAsync::initialize()
   return true;
 }
 
-bool SplatSorterAsync::innerSort()
+// same order preserving float to uint encoding as in dist.comp.glsl
+static inline uint32_t encodeMinMaxFp32(float val)
+{
+  uint32_t bits;
+  std::memcpy(&bits, &val, sizeof(float));
+  bits ^= uint32_t(int32_t(bits) >> 31) | 0x80000000u;
+  return bits;
+}
+
+float SplatSorterAsync::referenceDistance(int              keyMode,
+                                          const glm::mat4& viewMatrix,
+                                          const glm::mat4& projectionMatrix,
+                                          const glm::vec3& center)
+{
+  // same computation as in dist.comp.glsl
+  const glm::vec4 viewPos = viewMatrix * glm::vec4(center, 1.0f);
+  if(keyMode == SORT_KEY_PLANE_DISTANCE)
+    return std::abs(viewPos.z);
+  if(keyMode == SORT_KEY_VIEW_DEPTH)
+    return -viewPos.z;
+  if(keyMode == SORT_KEY_RADIAL_DISTANCE)
+    return glm::dot(glm::vec3(viewPos), glm::vec3(viewPos));
+  const glm::vec4 pos = projectionMatrix * viewPos;
+  return pos.z / pos.w;
+}
+
+uint32_t SplatSorterAsync::referenceKey(int              keyMode,
+                                        const glm::mat4& viewMatrix,
+                                        const glm::mat4& projectionMatrix,
+                                        const glm::vec3& center)
+{
+  return encodeMinMaxFp32(-referenceDistance(keyMode, viewMatrix, projectionMatrix, center));
+}
+
+// Distance kernels, compute the keys of splats [begin,end) for a given SORT_KEY_* mode.
+// the key is the encoded negated distance, so that sorting by increasing keys gives a
+// back to front order. plane is the normalized camera plane passing through cop.
+// the scalar kernel is the reference, the vectorized ones must give the same keys.
+
+template <int KeyMode>
+static void computeKeysScalar(const float* x, const float* y, const float* z, uint32_t begin, uint32_t end, const glm::vec4& plane, const glm::vec3& cop, uint32_t* keys)
+{
+  for(uint32_t i = begin; i < end; ++i)
+  {
+    float dist;
+    if constexpr(KeyMode == SORT_KEY_RADIAL_DISTANCE)
+    {
+      const float dx = x[i] - cop[0], dy = y[i] - cop[1], dz = z[i] - cop[2];
+      dist           = dx * dx + dy * dy + dz * dz;
+    }
+    else
+    {
+      dist = plane[0] * x[i] + plane[1] * y[i] + plane[2] * z[i] + plane[3];
+      if constexpr(KeyMode == SORT_KEY_PLANE_DISTANCE)
+        dist = std::abs(dist);
+    }
+    keys[i] = encodeMinMaxFp32(-dist);
+  }
+}
+
+#if defined(SORTER_X86_SIMD)
+template <int KeyMode>
+SORTER_AVX2_FUNCTION static void computeKeysAvx2(const float* x, const float* y, const float* z, uint32_t begin, uint32_t end, const glm::vec4& plane, const glm::vec3& cop, uint32_t* keys)
 {
-  if(m_positions == nullptr)
+  const __m256  px      = _mm256_set1_ps(plane[0]);
+  const __m256  py      = _mm256_set1_ps(plane[1]);
+  const __m256  pz      = _mm256_set1_ps(plane[2]);
+  const __m256  pw      = _mm256_set1_ps(plane[3]);
+  const __m256  cx      = _mm256_set1_ps(cop[0]);
+  const __m256  cy      = _mm256_set1_ps(cop[1]);
+  const __m256  cz      = _mm256_set1_ps(cop[2]);
+  const __m256  absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+  const __m256i signBit = _mm256_set1_epi32(int(0x80000000u));
+
+  uint32_t i = begin;
+  for(; i + 8 <= end; i += 8)
+  {
+    __m256 dist;
+    if constexpr(KeyMode == SORT_KEY_RADIAL_DISTANCE)
+    {
+      const __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(x + i), cx);
+      const __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(y + i), cy);
+      const __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(z + i), cz);
+      dist = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+    }
+    else
+    {
+      dist = _mm256_add_ps(_mm256_mul_ps(px, _mm256_loadu_ps(x + i)), _mm256_mul_ps(py, _mm256_loadu_ps(y + i)));
+      dist = _mm256_add_ps(_mm256_add_ps(dist, _mm256_mul_ps(pz, _mm256_loadu_ps(z + i))), pw);
+      if constexpr(KeyMode == SORT_KEY_PLANE_DISTANCE)
+        dist = _mm256_and_ps(dist, absMask);
+    }
+    // negate then encode
+    const __m256i bits = _mm256_xor_si256(_mm256_castps_si256(dist), signBit);
+    const __m256i mask = _mm256_or_si256(_mm256_srai_epi32(bits, 31), signBit);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(keys + i), _mm256_xor_si256(bits, mask));
+  }
+  computeKeysScalar<KeyMode>(x, y, z, i, end, plane, cop, keys);
+}
+
+// AVX2 availability is checked at runtime so that the binary still runs on older CPUs
+static bool cpuSupportsAvx2()
+{
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 1);
+  const bool osxsave = (info[2] & (1 << 27)) != 0;
+  const bool avx     = (info[2] & (1 << 28)) != 0;
+  if(!osxsave || !avx || (_xgetbv(0) & 6) != 6)
     return false;
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
 
-  auto startTime = std::chrono::high_resolution_clock::now();
-  // we do the sorting if needed
-  // find plane passing through COP and with normal dir.
-  // we use distance to plane instead of distance to COP as an approximation.
-  // https://mathinsight.org/distance_point_plane
-  const glm::vec4 plane(m_sortDir[0], m_sortDir[1], m_sortDir[2],
-                        -m_sortDir[0] * m_sortCop[0] - m_sortDir[1] * m_sortCop[1] - m_sortDir[2] * m_sortCop[2]);
-  const float     divider = 1.0f / std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+#if defined(SORTER_NEON_SIMD)
+template <int KeyMode>
+static void computeKeysNeon(const float* x, const float* y, const float* z, uint32_t begin, uint32_t end, const glm::vec4& plane, const glm::vec3& cop, uint32_t* keys)
+{
+  const float32x4_t px      = vdupq_n_f32(plane[0]);
+  const float32x4_t py      = vdupq_n_f32(plane[1]);
+  const float32x4_t pz      = vdupq_n_f32(plane[2]);
+  const float32x4_t pw      = vdupq_n_f32(plane[3]);
+  const float32x4_t cx      = vdupq_n_f32(cop[0]);
+  const float32x4_t cy      = vdupq_n_f32(cop[1]);
+  const float32x4_t cz      = vdupq_n_f32(cop[2]);
+  const uint32x4_t  signBit = vdupq_n_u32(0x80000000u);
 
+  uint32_t i = begin;
+  for(; i + 4 <= end; i += 4)
+  {
+    float32x4_t dist;
+    if constexpr(KeyMode == SORT_KEY_RADIAL_DISTANCE)
+    {
+      const float32x4_t dx = vsubq_f32(vld1q_f32(x + i), cx);
+      const float32x4_t dy = vsubq_f32(vld1q_f32(y + i), cy);
+      const float32x4_t dz = vsubq_f32(vld1q_f32(z + i), cz);
+      dist                 = vaddq_f32(vaddq_f32(vmulq_f32(dx, dx), vmulq_f32(dy, dy)), vmulq_f32(dz, dz));
+    }
+    else
+    {
+      dist = vaddq_f32(vmulq_f32(px, vld1q_f32(x + i)), vmulq_f32(py, vld1q_f32(y + i)));
+      dist = vaddq_f32(vaddq_f32(dist, vmulq_f32(pz, vld1q_f32(z + i))), pw);
+      if constexpr(KeyMode == SORT_KEY_PLANE_DISTANCE)
+        dist = vabsq_f32(dist);
+    }
+    // negate then encode
+    const uint32x4_t bits = vreinterpretq_u32_f32(vnegq_f32(dist));
+    const uint32x4_t mask = vorrq_u32(vreinterpretq_u32_s32(vshrq_n_s32(vreinterpretq_s32_u32(bits), 31)), signBit);
+    vst1q_u32(keys + i, veorq_u32(bits, mask));
+  }
+  computeKeysScalar<KeyMode>(x, y, z, i, end, plane, cop, keys);
+}
+#endif
+
+void SplatSorterAsync::buildCenters()
+{
   const auto splatCount = (uint32_t)m_positions->size() / 3;
 
-  // prepare the arrays (noop if already sized)
-  distances.resize(splatCount);
-  m_indices.resize(splatCount);
+  m_centersX.resize(splatCount);
+  m_centersY.resize(splatCount);
+  m_centersZ.resize(splatCount);
 
-  // compute distances in parallel
-  START_PAR_LOOP(distances.size(), splatIdx)
+  START_PAR_LOOP(splatCount, splatIdx)
   {
-    const auto pos = &((*m_positions)[splatIdx * 3]);
-    // distance to plane
-    const float dist    = std::abs(plane[0] * pos[0] + plane[1] * pos[1] + plane[2] * pos[2] + plane[3]) * divider;
-    distances[splatIdx] = dist;
-    m_indices[splatIdx] = (uint32_t)splatIdx;
+    m_centersX[splatIdx] = (*m_positions)[splatIdx * 3 + 0];
+    m_centersY[splatIdx] = (*m_positions)[splatIdx * 3 + 1];
+    m_centersZ[splatIdx] = (*m_positions)[splatIdx * 3 + 2];
   }
   END_PAR_LOOP()
+}
+
+void SplatSorterAsync::computeKeys(const glm::vec4& plane, const glm::vec3& cop)
+{
+  using KeysKernel = void (*)(const float*, const float*, const float*, uint32_t, uint32_t, const glm::vec4&, const glm::vec3&, uint32_t*);
+
+  // select the best kernels for the CPU, only once, one per key mode
+  static const std::array<KeysKernel, 3> kernels = []() -> std::array<KeysKernel, 3> {
+#if defined(SORTER_X86_SIMD)
+    if(cpuSupportsAvx2())
+      return {computeKeysAvx2<SORT_KEY_PLANE_DISTANCE>, computeKeysAvx2<SORT_KEY_VIEW_DEPTH>,
+              computeKeysAvx2<SORT_KEY_RADIAL_DISTANCE>};
+#elif defined(SORTER_NEON_SIMD)
+    return {computeKeysNeon<SORT_KEY_PLANE_DISTANCE>, computeKeysNeon<SORT_KEY_VIEW_DEPTH>, computeKeysNeon<SORT_KEY_RADIAL_DISTANCE>};
+#endif
+    return {computeKeysScalar<SORT_KEY_PLANE_DISTANCE>, computeKeysScalar<SORT_KEY_VIEW_DEPTH>,
+            computeKeysScalar<SORT_KEY_RADIAL_DISTANCE>};
+  }();
+  // the NDC depth increases with the view depth in front of the camera, it gives the same order
+  const int        keyMode = m_keyMode == SORT_KEY_NDC_DEPTH ? SORT_KEY_VIEW_DEPTH : m_keyMode;
+  const KeysKernel kernel  = kernels[std::clamp(keyMode, 0, (int)kernels.size() - 1)];
+
+  const uint32_t splatCount = (uint32_t)m_centersX.size();
+  const uint32_t chunkSize  = 16384;
+  const uint32_t chunkCount = (splatCount + chunkSize - 1) / chunkSize;
+
+  m_keys.resize(splatCount);
+
+  nvh::parallel_batches_indexed<1>(
+      chunkCount,
+      [&](uint64_t chunkIdx, uint32_t) {
+        const uint32_t begin = (uint32_t)chunkIdx * chunkSize;
+        const uint32_t end   = std::min(splatCount, begin + chunkSize);
+        kernel(m_centersX.data(), m_centersY.data(), m_centersZ.data(), begin, end, plane, cop, m_keys.data());
+      },
+      (uint32_t)std::thread::hardware_concurrency());
+}
+
+bool SplatSorterAsync::innerSort()
+{
+  if(m_positions == nullptr || m_output == nullptr)
+    return false;
+
+  const auto splatCount = (uint32_t)m_positions->size() / 3;
+
+  // structure of arrays copy of the centers, done once per scene
+  bool positionsChanged, coherent, incremental;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    positionsChanged   = m_positionsChanged || m_centersX.size() != splatCount;
+    m_positionsChanged = false;
+    coherent           = m_coherence.enabled;
+    // the previous order is only usable for the same scene
+    incremental = m_incremental && !positionsChanged && m_previousOrder.size() == splatCount;
+  }
+  if(positionsChanged)
+  {
+    buildCenters();
+  }
+
+  auto startTime = std::chrono::high_resolution_clock::now();
+  // we do the sorting if needed
+  // find plane passing through COP and with normal dir, normalized so that
+  // evaluating the plane gives the view space depth.
+  // https://mathinsight.org/distance_point_plane
+  const glm::vec3 dir = glm::normalize(m_sortDir);
+  const glm::vec4 plane(dir, -glm::dot(dir, m_sortCop));
+
+  // compute distance keys in parallel
+  computeKeys(plane, m_sortCop);
 
   auto time1 = std::chrono::high_resolution_clock::now();
   m_distTime = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(time1 - startTime).count();
 
-  // comparison function working on the data <dist,idex>
-  auto compare = [&](size_t i, size_t j) { return distances[i] > distances[j]; };
+  // the incremental sort gives up if the previous order is too far from sorted
+  incremental = incremental && incrementalSort();
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_lastSortIncremental = incremental;
+  }
 
-  // Sorting the array with respect to distance keys
-  std::sort(std::execution::par_unseq, m_indices.begin(), m_indices.end(), compare);
+  if(incremental)
+  {
+    // already sorted
+  }
+  else if(m_method == E_RADIX_SORT)
+  {
+    radixSort();
+  }
+  else
+  {
+    std::iota(m_output, m_output + splatCount, 0);
+
+    // comparison function working on the data <key,index>
+    auto compare = [&](uint32_t i, uint32_t j) { return m_keys[i] < m_keys[j]; };
+
+    // Sorting the array with respect to distance keys
+    std::sort(m_output, m_output + splatCount, compare);
+  }
 
   auto time2 = std::chrono::high_resolution_clock::now();
   m_sortTime = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(time2 - time1).count();
 
+  // keep the order for the next coherent sort, m_output belongs to the caller after consume
+  if(coherent)
+    m_previousOrder.assign(m_output, m_output + splatCount);
+  else
+    m_previousOrder = {};
+
+  return true;
+}
+
+bool SplatSorterAsync::incrementalSort()
+{
+  const uint32_t count = (uint32_t)m_keys.size();
+
+  // estimate the disorder on a sample of neighbors in previous order, since the sort cost
+  // grows with the number of misplaced splats it is not worth it above a few percents.
+  constexpr uint32_t sampleCount = 4096;
+  if(count > 2 * sampleCount)
+  {
+    const uint32_t step        = (count - 1) / sampleCount;
+    uint32_t       descentCount = 0;
+    for(uint32_t i = 0; i < count - 1; i += step)
+      descentCount += m_keys[m_previousOrder[i]] > m_keys[m_previousOrder[i + 1]] ? 1 : 0;
+    if(descentCount * 100 > sampleCount * s_maxDisorderPercent)
+      return false;
+  }
+
+  m_pairs.resize(count);
+  m_pairsTmp.resize(count);
+
+  const uint32_t blockCount = std::clamp((count + 65535) / 65536, 1u, std::max(1u, std::thread::hardware_concurrency()));
+  const uint32_t blockSize  = (count + blockCount - 1) / blockCount;
+
+  // gather the <key,index> pairs in previous order then sort each block with an adaptive sort.
+  // packing the index in the low bits gives the same tie order as the radix sort.
+  // a block is split in an ascending subsequence and a set of misfits by removing the
+  // pairs of elements that are out of order, misfits are then sorted and merged back.
+  // this is linear if the previous order is nearly sorted, blocks with too many
+  // misfits (large viewpoint change) fall back to std::sort.
+  m_misfits.resize(blockCount);
+  nvh::parallel_batches_indexed<1>(
+      blockCount,
+      [&](uint64_t blockIdx, uint32_t) {
+        uint64_t*      pairs   = m_pairs.data();
+        const uint32_t begin   = (uint32_t)blockIdx * blockSize;
+        const uint32_t end     = std::min(count, begin + blockSize);
+        auto&          misfits = m_misfits[blockIdx];
+        misfits.clear();
+        uint32_t keptEnd = begin;  // the ascending subsequence is compacted in place
+        for(uint32_t i = begin; i < end; ++i)
+        {
+          const uint32_t splatIdx = m_previousOrder[i];
+          const uint64_t pair     = (uint64_t(m_keys[splatIdx]) << 32) | splatIdx;
+          if(keptEnd > begin && pair < pairs[keptEnd - 1])
+          {
+            misfits.push_back(pair);
+            misfits.push_back(pairs[--keptEnd]);
+          }
+          else
+          {
+            pairs[keptEnd++] = pair;
+          }
+        }
+        if(misfits.size() > (end - begin) / 4)
+        {
+          // too far from sorted
+          std::copy(misfits.begin(), misfits.end(), pairs + keptEnd);
+          std::sort(pairs + begin, pairs + end);
+          std::copy(pairs + begin, pairs + end, m_pairsTmp.begin() + begin);
+        }
+        else
+        {
+          std::sort(misfits.begin(), misfits.end());
+          std::merge(pairs + begin, pairs + keptEnd, misfits.begin(), misfits.end(), m_pairsTmp.begin() + begin);
+        }
+      },
+      blockCount);
+  m_pairs.swap(m_pairsTmp);
+
+  // merge the sorted blocks two by two
+  for(uint64_t width = blockSize; width < count; width *= 2)
+  {
+    const uint32_t mergeCount = uint32_t((count + 2 * width - 1) / (2 * width));
+    nvh::parallel_batches_indexed<1>(
+        mergeCount,
+        [&](uint64_t mergeIdx, uint32_t) {
+          const uint64_t begin = mergeIdx * 2 * width;
+          const uint64_t mid   = std::min<uint64_t>(count, begin + width);
+          const uint64_t end   = std::min<uint64_t>(count, begin + 2 * width);
+          std::merge(m_pairs.begin() + begin, m_pairs.begin() + mid, m_pairs.begin() + mid, m_pairs.begin() + end,
+                     m_pairsTmp.begin() + begin);
+        },
+        mergeCount);
+    m_pairs.swap(m_pairsTmp);
+  }
+
+  // extract the indices
+  START_PAR_LOOP(count, i)
+  {
+    m_output[i] = uint32_t(m_pairs[i]);
+  }
+  END_PAR_LOOP()
+
   return true;
 }
+
+void SplatSorterAsync::radixSort()
+{
+  constexpr uint32_t digitBits  = 8;
+  constexpr uint32_t digitCount = 1 << digitBits;
+  constexpr uint32_t digitMask  = digitCount - 1;
+  constexpr uint32_t passCount  = 32 / digitBits;
+  static_assert(passCount == 4, "the digit census below is unrolled for four passes");
+
+  const uint32_t count = (uint32_t)m_keys.size();
+  if(count == 0)
+    return;
+
+  // each block of consecutive keys is processed by one thread,
+  // blocks are small enough for the histograms to stay in L1
+  const uint32_t blockCount = std::clamp((count + 65535) / 65536, 1u, std::max(1u, std::thread::hardware_concurrency()));
+  const uint32_t blockSize  = (count + blockCount - 1) / blockCount;
+
+  m_keysTmp.resize(count);
+  m_indices.resize(count);
+  m_indicesTmp.resize(count);
+  m_histograms.resize(blockCount * digitCount * passCount);
+
+  // count the digits of all the passes at once, the counts of the first pass are
+  // used as is, the totals tell in advance which passes can be skipped (all the
+  // keys share the digit) so that the last pass can scatter directly to m_output
+  nvh::parallel_batches_indexed<1>(
+      blockCount,
+      [&](uint64_t blockIdx, uint32_t) {
+        uint32_t*      histograms = &m_histograms[blockIdx * digitCount * passCount];
+        const uint32_t begin      = (uint32_t)blockIdx * blockSize;
+        const uint32_t end        = std::min(count, begin + blockSize);
+        std::fill(histograms, histograms + digitCount * passCount, 0);
+        uint32_t* h0 = histograms;
+        uint32_t* h1 = h0 + digitCount;
+        uint32_t* h2 = h1 + digitCount;
+        uint32_t* h3 = h2 + digitCount;
+        for(uint32_t i = begin; i < end; ++i)
+        {
+          const uint32_t key = m_keys[i];
+          h0[key & digitMask]++;
+          h1[(key >> digitBits) & digitMask]++;
+          h2[(key >> (2 * digitBits)) & digitMask]++;
+          h3[key >> (3 * digitBits)]++;
+        }
+      },
+      blockCount);
+
+  std::array<bool, passCount> skipPass{};
+  int                         lastPass = -1;
+  for(uint32_t pass = 0; pass < passCount; ++pass)
+  {
+    for(uint32_t digit = 0; digit < digitCount && !skipPass[pass]; ++digit)
+    {
+      uint32_t digitTotal = 0;
+      for(uint32_t blockIdx = 0; blockIdx < blockCount; ++blockIdx)
+        digitTotal += m_histograms[(blockIdx * passCount + pass) * digitCount + digit];
+      skipPass[pass] = digitTotal == count;
+    }
+    if(!skipPass[pass])
+      lastPass = (int)pass;
+  }
+
+  // all the passes are skipped, all the keys are equal
+  if(lastPass < 0)
+  {
+    std::iota(m_output, m_output + count, 0);
+    return;
+  }
+
+  // until a pass is done the indices are implicitly the identity
+  bool identity = true;
+
+  for(uint32_t pass = 0; pass <= (uint32_t)lastPass; ++pass)
+  {
+    if(skipPass[pass])
+      continue;
+
+    const uint32_t shift = pass * digitBits;
+
+    // count the digits of each block, already done for the first pass
+    if(pass != 0)
+    {
+      nvh::parallel_batches_indexed<1>(
+          blockCount,
+          [&](uint64_t blockIdx, uint32_t) {
+            uint32_t*      histogram = &m_histograms[(blockIdx * passCount + pass) * digitCount];
+            const uint32_t begin     = (uint32_t)blockIdx * blockSize;
+            const uint32_t end       = std::min(count, begin + blockSize);
+            std::fill(histogram, histogram + digitCount, 0);
+            for(uint32_t i = begin; i < end; ++i)
+              histogram[(m_keys[i] >> shift) & digitMask]++;
+          },
+          blockCount);
+    }
+
+    // turn counts into scatter offsets, digit major then block
+    // so that the order of equal keys is kept (stable sort)
+    uint32_t offset = 0;
+    for(uint32_t digit = 0; digit < digitCount; ++digit)
+    {
+      for(uint32_t blockIdx = 0; blockIdx < blockCount; ++blockIdx)
+      {
+        uint32_t&      bucket      = m_histograms[(blockIdx * passCount + pass) * digitCount + digit];
+        const uint32_t bucketCount = bucket;
+        bucket                     = offset;
+        offset += bucketCount;
+      }
+    }
+
+    // scatter keys and indices to their new location, the last
+    // pass writes the indices to the output and needs no keys
+    const bool last       = pass == (uint32_t)lastPass;
+    uint32_t*  dstIndices = last ? m_output : m_indicesTmp.data();
+    nvh::parallel_batches_indexed<1>(
+        blockCount,
+        [&](uint64_t blockIdx, uint32_t) {
+          uint32_t*      offsets = &m_histograms[(blockIdx * passCount + pass) * digitCount];
+          const uint32_t begin   = (uint32_t)blockIdx * blockSize;
+          const uint32_t end     = std::min(count, begin + blockSize);
+          for(uint32_t i = begin; i < end; ++i)
+          {
+            const uint32_t key = m_keys[i];
+            const uint32_t dst = offsets[(key >> shift) & digitMask]++;
+            if(!last)
+              m_keysTmp[dst] = key;
+            dstIndices[dst] = identity ? i : m_indices[i];
+          }
+        },
+        blockCount);
+
+    if(!last)
+    {
+      m_keys.swap(m_keysTmp);
+      m_indices.swap(m_indicesTmp);
+    }
+    identity = false;
+  }
+}
@@ -27,8 +27,15 @@
 #include <mutex>
 
 #include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/geometric.hpp>
+#include <glm/trigonometric.hpp>
+#include <algorithm>
+#include <cmath>
 
 #include "splat_set.h"
+#include "shaders/shaderio.h"
 
 class SplatSorterAsync
 {
@@ -42,6 +49,25 @@ public:
     E_FAILURE    // an error eccured. call consume before another load.
   };
 
+  // CPU sorting algorithm
+  enum Method
+  {
+    E_STD_SORT,   // std::sort on the distances, mono thread
+    E_RADIX_SORT  // LSD radix sort on encoded distance keys, multi thread
+  };
+
+  // Temporal coherence settings. When enabled, small viewpoint changes
+  // either skip the sort (lazy mode only) or re-sort starting from the
+  // previous order with an adaptive sort instead of sorting from scratch.
+  struct CoherenceSettings
+  {
+    bool  enabled      = false;
+    float skipAngle    = 0.05f;  // in degrees, no new sort below this and skipDistance
+    float skipDistance = 0.001f;  // in world units
+    float maxAngle     = 5.0f;    // in degrees, a full sort is done above this or maxDistance
+    float maxDistance  = 0.1f;    // in world units
+  };
+
 public:
   // starts the loader thread
   bool initialize();
@@ -65,30 +91,93 @@ public:
   // position or orientation did change since last run
   // return false if sorter not in READY state or if camera did not move
   // positions must not be accessed while sorting
+  // the sorted indices are written directly in indices, an array of positions.size()/3
+  // entries provided by the caller (e.g. a mapped buffer), that must not be accessed
+  // until the sort is consumed
   // if lazy is set, a new sort will be started only if viewpoint changed,
   // otherwise a new sort is systematically started if sorter is ready
-  inline bool sortAsync(const glm::vec3& camDir, const glm::vec3& camCop, std::vector<float>& positions, bool lazy = true)
+  // a change of method, of keyMode (one of SORT_KEY_* in shaderio.h) or of positions also triggers a new sort.
+  inline bool sortAsync(const glm::vec3&    camDir,
+                        const glm::vec3&    camCop,
+                        std::vector<float>& positions,
+                        uint32_t*           indices,
+                        bool                lazy    = true,
+                        Method              method  = E_RADIX_SORT,
+                        int                 keyMode = SORT_KEY_NDC_DEPTH)
   {
     std::lock_guard<std::mutex> lock(m_mutex);
     if(m_status != E_READY)
     {
       return false;
     }
-    if(lazy && m_sortDir == camDir && m_sortCop == camCop)
+    // a new order is not comparable with the previous one if the method, the key or the positions change
+    const bool sameSort = m_method == method && m_keyMode == keyMode && !m_positionsChanged;
+    if(lazy && m_sortDir == camDir && m_sortCop == camCop && sameSort)
+    {
+      return false;
+    }
+    // how much did the viewpoint move since last sort
+    const float angle    = glm::degrees(std::acos(std::clamp(glm::dot(camDir, m_sortDir), -1.0f, 1.0f)));
+    const float distance = glm::length(camCop - m_sortCop);
+    if(m_coherence.enabled && lazy && sameSort && angle <= m_coherence.skipAngle && distance <= m_coherence.skipDistance)
     {
       return false;
     }
+    m_incremental = m_coherence.enabled && sameSort && angle <= m_coherence.maxAngle
+                    && distance <= m_coherence.maxDistance;
     m_sortDir        = camDir;
     m_sortCop        = camCop;
+    m_method         = method;
+    m_keyMode        = keyMode;
     m_startRequested = true;
     m_positions      = &positions;
+    m_output         = indices;
     // wakeup the thread
     m_sortCV.notify_all();
 
     return true;
   }
-  // Fill indices with sorted values (call std::swap) and stats
-  inline bool consume(std::vector<uint32_t>& indices, double& distTime, double& sortTime)
+  // sets the temporal coherence settings, used from next sortAsync
+  inline void setCoherence(const CoherenceSettings& settings)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_coherence = settings;
+  }
+  // true if the last sort started from the previous order
+  inline bool lastSortWasIncremental()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_lastSortIncremental;
+  }
+  // to be invoked when the content of the positions array changes (new scene),
+  // the sorter then rebuilds its internal copy of the centers at next sort,
+  // which is started even if lazy and the viewpoint did not change.
+  inline void positionsChanged()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_positionsChanged = true;
+  }
+  // drops a sort requested by sortAsync and not yet started, then waits for
+  // the sort in progress if any. The indices and positions given to sortAsync
+  // are no longer accessed by the sorter on return. A result that is available
+  // is kept, call consume to get the sorter back to READY state.
+  inline void cancelAndWait()
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_startRequested = false;
+    m_sortCV.wait(lock, [this] { return m_status != E_SORTING; });
+  }
+  // CPU reference of the distance and key computed by dist.comp.glsl for a splat center,
+  // used to check that the CPU and the GPU sorts give the same order.
+  // the projection is only used by SORT_KEY_NDC_DEPTH.
+  static float    referenceDistance(int              keyMode,
+                                    const glm::mat4& viewMatrix,
+                                    const glm::mat4& projectionMatrix,
+                                    const glm::vec3& center);
+  static uint32_t referenceKey(int keyMode, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, const glm::vec3& center);
+  // the indices array given to sortAsync is filled with the sorted values,
+  // gives it back to the caller with the stats
+  inline bool consume(double& distTime, double& sortTime)
   {
     std::lock_guard<std::mutex> lock(m_mutex);
     if(m_status == E_SORTED || m_status == E_FAILURE)
@@ -96,7 +185,6 @@ public:
       m_status = E_READY;
       distTime = m_distTime;
       sortTime = m_sortTime;
-      indices.swap(m_indices);
       return true;
     }
     else
@@ -108,6 +196,25 @@ public:
 private:
   bool innerSort();
 
+  // copies m_positions into m_centersX/Y/Z (structure of arrays)
+  // so that the distance kernels can use aligned vector loads
+  void buildCenters();
+
+  // computes the sort key of each splat into m_keys, multi threaded and vectorized
+  // plane is the normalized camera plane passing through cop.
+  void computeKeys(const glm::vec4& plane, const glm::vec3& cop);
+
+  // sorts the splat indices by increasing m_keys starting from the
+  // order of the previous sort in m_previousOrder. Adaptive, faster
+  // than the radix sort if the previous order is nearly sorted, returns
+  // false without sorting if m_previousOrder is too disordered.
+  bool incrementalSort();
+
+  // sorts the splat indices by increasing m_keys into m_output, stable, multi threaded.
+  // the indices are generated by the first pass, the last pass writes m_output.
+  // m_keys content is swapped with internal buffers.
+  void radixSort();
+
 private:
   State       m_status = E_SHUTDOWN;
   std::thread m_sorter;
@@ -124,10 +231,33 @@ private:
   glm::vec3           m_sortDir   = {0.0f, 0.0f, 0.0f};  // camera direction
   glm::vec3           m_sortCop   = {0.0f, 0.0f, 0.0f};  // camera position
   std::vector<float>* m_positions = nullptr;             // points positions provided by caller
+  uint32_t*           m_output    = nullptr;             // sorted indices result, provided by caller
+  Method              m_method    = E_RADIX_SORT;        // sorting algorithm
+  int                 m_keyMode   = SORT_KEY_NDC_DEPTH;  // sort key, SORT_KEY_* of shaderio.h
+
+  // centers in structure of arrays layout, built once per scene
+  std::vector<float> m_centersX;
+  std::vector<float> m_centersY;
+  std::vector<float> m_centersZ;
+  bool               m_positionsChanged = true;
+
+  // temporal coherence
+  static constexpr uint32_t s_maxDisorderPercent = 4;  // above, the incremental sort falls back to a full sort
+  CoherenceSettings     m_coherence;
+  bool                  m_incremental         = false;  // next sort shall start from previous order
+  bool                  m_lastSortIncremental = false;  // for reporting
+  std::vector<uint32_t> m_previousOrder;                // copy of the last sort result
+  std::vector<uint64_t> m_pairs;                        // <key,index> pairs for the incremental sort
+  std::vector<uint64_t> m_pairsTmp;                     // ping pong buffer for the merges
+  std::vector<std::vector<uint64_t>> m_misfits;         // per block out of order pairs
 
-  std::vector<float> distances;  // points distances, internal buffer
+  // radix sort internal buffers
+  std::vector<uint32_t> m_keys;        // encoded distances
+  std::vector<uint32_t> m_keysTmp;     // ping pong buffer for the keys
+  std::vector<uint32_t> m_indices;     // indices after each pass but the last
+  std::vector<uint32_t> m_indicesTmp;  // ping pong buffer for the indices
+  std::vector<uint32_t> m_histograms;  // per block and per pass digit counts then offsets
 
-  std::vector<uint32_t> m_indices;       // sorted indices result
   double                m_distTime = 0;  // distance update timer
   double                m_sortTime = 0;  // distance sorting timer
 };
@@ -0,0 +1,347 @@
+/*
+ * Copyright (c) 2023-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "splat_uploader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include <nvvk/error_vk.hpp>
+
+void SplatUploader::init(VkDevice          device,
+                         VkPhysicalDevice  physicalDevice,
+                         nvvkhl::AllocVma* alloc,
+                         VkQueue           transferQueue,
+                         uint32_t          transferFamily,
+                         VkQueue           graphicsQueue,
+                         uint32_t          graphicsFamily,
+                         uint64_t          slotSize,
+                         uint32_t          slotCount)
+{
+  m_device         = device;
+  m_alloc          = alloc;
+  m_graphicsQueue  = graphicsQueue;
+  m_graphicsFamily = graphicsFamily;
+  m_transferQueue  = transferQueue;
+  m_transferFamily = transferFamily;
+
+  // images are copied by blocks of rows, the transfer family must allow it
+  uint32_t familyCount = 0;
+  vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+  std::vector<VkQueueFamilyProperties> families(familyCount);
+  vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, families.data());
+  m_rowGranularity = transferFamily < familyCount ? families[transferFamily].minImageTransferGranularity.height : 0;
+  if(transferQueue == VK_NULL_HANDLE || m_rowGranularity == 0)
+  {
+    m_transferQueue  = graphicsQueue;
+    m_transferFamily = graphicsFamily;
+    m_rowGranularity = 1;
+  }
+
+  VkSemaphoreTypeCreateInfo timelineInfo{VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO};
+  timelineInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+  timelineInfo.initialValue  = 0;
+  VkSemaphoreCreateInfo semaphoreInfo{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO, &timelineInfo};
+  NVVK_CHECK(vkCreateSemaphore(m_device, &semaphoreInfo, nullptr, &m_timeline));
+  m_timelineValue = 0;
+
+  VkCommandPoolCreateInfo poolInfo{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+  poolInfo.flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+  poolInfo.queueFamilyIndex = m_transferFamily;
+  NVVK_CHECK(vkCreateCommandPool(m_device, &poolInfo, nullptr, &m_transferPool));
+  poolInfo.queueFamilyIndex = m_graphicsFamily;
+  NVVK_CHECK(vkCreateCommandPool(m_device, &poolInfo, nullptr, &m_graphicsPool));
+
+  // the staging slots stay mapped for the lifetime of the uploader
+  m_slotSize = slotSize;
+  m_nextSlot = 0;
+  m_slots.resize(std::max(1u, slotCount));
+  for(Slot& slot : m_slots)
+  {
+    slot.staging = m_alloc->createBuffer(m_slotSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    slot.mapped  = static_cast<uint8_t*>(m_alloc->map(slot.staging));
+    slot.value   = 0;
+
+    VkCommandBufferAllocateInfo allocInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+    allocInfo.commandPool        = m_transferPool;
+    allocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
+    NVVK_CHECK(vkAllocateCommandBuffers(m_device, &allocInfo, &slot.cmd));
+  }
+
+  VkCommandBufferAllocateInfo allocInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+  allocInfo.commandPool        = m_graphicsPool;
+  allocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  allocInfo.commandBufferCount = 1;
+  NVVK_CHECK(vkAllocateCommandBuffers(m_device, &allocInfo, &m_graphicsCmd));
+  VkFenceCreateInfo fenceInfo{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+  fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+  NVVK_CHECK(vkCreateFence(m_device, &fenceInfo, nullptr, &m_graphicsFence));
+
+  m_pendingBuffers.clear();
+  m_pendingImages.clear();
+  m_stats = {};
+}
+
+void SplatUploader::deinit()
+{
+  if(m_device == VK_NULL_HANDLE)
+    return;
+
+  // pending uploads
+  if(m_timelineValue != 0)
+  {
+    VkSemaphoreWaitInfo waitInfo{VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO};
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores    = &m_timeline;
+    waitInfo.pValues        = &m_timelineValue;
+    vkWaitSemaphores(m_device, &waitInfo, UINT64_MAX);
+  }
+  vkWaitForFences(m_device, 1, &m_graphicsFence, VK_TRUE, UINT64_MAX);
+
+  for(Slot& slot : m_slots)
+  {
+    m_alloc->unmap(slot.staging);
+    m_alloc->destroy(slot.staging);
+  }
+  m_slots.clear();
+
+  vkDestroyFence(m_device, m_graphicsFence, nullptr);
+  vkDestroyCommandPool(m_device, m_graphicsPool, nullptr);
+  vkDestroyCommandPool(m_device, m_transferPool, nullptr);
+  vkDestroySemaphore(m_device, m_timeline, nullptr);
+  m_graphicsFence = VK_NULL_HANDLE;
+  m_graphicsCmd   = VK_NULL_HANDLE;
+  m_graphicsPool  = VK_NULL_HANDLE;
+  m_transferPool  = VK_NULL_HANDLE;
+  m_timeline      = VK_NULL_HANDLE;
+  m_timelineValue = 0;
+  m_pendingBuffers.clear();
+  m_pendingImages.clear();
+  m_device = VK_NULL_HANDLE;
+}
+
+SplatUploader::Slot& SplatUploader::acquireSlot()
+{
+  Slot& slot = m_slots[m_nextSlot];
+  m_nextSlot = (m_nextSlot + 1) % uint32_t(m_slots.size());
+
+  // the copy from the previous use of the slot must be done
+  uint64_t completed = 0;
+  vkGetSemaphoreCounterValue(m_device, m_timeline, &completed);
+  if(completed < slot.value)
+  {
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    VkSemaphoreWaitInfo waitInfo{VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO};
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores    = &m_timeline;
+    waitInfo.pValues        = &slot.value;
+    NVVK_CHECK(vkWaitSemaphores(m_device, &waitInfo, UINT64_MAX));
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    m_stats.hostWaitTime += std::chrono::duration<double, std::milli>(endTime - startTime).count();
+  }
+
+  vkResetCommandBuffer(slot.cmd, 0);
+  VkCommandBufferBeginInfo beginInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  vkBeginCommandBuffer(slot.cmd, &beginInfo);
+  return slot;
+}
+
+void SplatUploader::submitSlot(Slot& slot)
+{
+  vkEndCommandBuffer(slot.cmd);
+
+  slot.value = ++m_timelineValue;
+  VkTimelineSemaphoreSubmitInfo timelineInfo{VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO};
+  timelineInfo.signalSemaphoreValueCount = 1;
+  timelineInfo.pSignalSemaphoreValues    = &slot.value;
+
+  VkSubmitInfo submitInfo{VK_STRUCTURE_TYPE_SUBMIT_INFO, &timelineInfo};
+  submitInfo.commandBufferCount   = 1;
+  submitInfo.pCommandBuffers      = &slot.cmd;
+  submitInfo.signalSemaphoreCount = 1;
+  submitInfo.pSignalSemaphores    = &m_timeline;
+  NVVK_CHECK(vkQueueSubmit(m_transferQueue, 1, &submitInfo, VK_NULL_HANDLE));
+
+  ++m_stats.blocks;
+}
+
+void SplatUploader::uploadBuffer(VkBuffer buffer, VkDeviceSize dstOffset, uint64_t size, uint64_t granularity, const FillFunc& fill)
+{
+  granularity              = std::max<uint64_t>(1, granularity);
+  const uint64_t blockSize = std::max(granularity, m_slotSize / granularity * granularity);
+
+  for(uint64_t offset = 0; offset < size; offset += blockSize)
+  {
+    const uint64_t bytes = std::min(blockSize, size - offset);
+    Slot&          slot  = acquireSlot();
+
+    fill(slot.mapped, offset, bytes);
+
+    VkBufferCopy region{.srcOffset = 0, .dstOffset = dstOffset + offset, .size = bytes};
+    vkCmdCopyBuffer(slot.cmd, slot.staging.buffer, buffer, 1, &region);
+    submitSlot(slot);
+
+    m_stats.bytes += bytes;
+  }
+  m_pendingBuffers.push_back(buffer);
+}
+
+void SplatUploader::uploadBuffer(VkBuffer buffer, const void* data, uint64_t size)
+{
+  uploadBuffer(buffer, 0, size, 1, [data](void* dst, uint64_t offset, uint64_t bytes) {
+    memcpy(dst, static_cast<const uint8_t*>(data) + offset, bytes);
+  });
+}
+
+void SplatUploader::uploadImage(VkImage image, VkExtent2D extent, uint32_t texelBytes, const FillFunc& fill)
+{
+  const uint64_t rowBytes = uint64_t(extent.width) * texelBytes;
+  // whole rows per block, a multiple of the transfer granularity except for the last block
+  uint32_t rowsPerBlock = uint32_t(std::max<uint64_t>(1, m_slotSize / rowBytes));
+  rowsPerBlock          = std::max(m_rowGranularity, rowsPerBlock / m_rowGranularity * m_rowGranularity);
+
+  const VkImageSubresourceRange range{VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+
+  for(uint32_t row = 0; row < extent.height; row += rowsPerBlock)
+  {
+    const uint32_t rows = std::min(rowsPerBlock, extent.height - row);
+    Slot&          slot = acquireSlot();
+
+    fill(slot.mapped, row * rowBytes, rows * rowBytes);
+
+    // the following blocks are ordered after the layout transition by the queue
+    if(row == 0)
+    {
+      VkImageMemoryBarrier barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+      barrier.srcAccessMask       = 0;
+      barrier.dstAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+      barrier.oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED;
+      barrier.newLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+      barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      barrier.image               = image;
+      barrier.subresourceRange    = range;
+      vkCmdPipelineBarrier(slot.cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr,
+                           0, nullptr, 1, &barrier);
+    }
+
+    VkBufferImageCopy region{};
+    region.bufferOffset     = 0;
+    region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    region.imageOffset      = {0, int32_t(row), 0};
+    region.imageExtent      = {extent.width, rows, 1};
+    vkCmdCopyBufferToImage(slot.cmd, slot.staging.buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+    submitSlot(slot);
+
+    m_stats.bytes += rows * rowBytes;
+  }
+  m_pendingImages.push_back(image);
+}
+
+void SplatUploader::recordOwnership(VkCommandBuffer cmd, bool release)
+{
+  // with distinct families, a release on the transfer queue then an acquire on the graphics queue,
+  // otherwise a single barrier on the graphics queue for the layout of the images
+  const bool     transferOwnership = m_transferFamily != m_graphicsFamily;
+  const uint32_t srcFamily         = transferOwnership ? m_transferFamily : VK_QUEUE_FAMILY_IGNORED;
+  const uint32_t dstFamily         = transferOwnership ? m_graphicsFamily : VK_QUEUE_FAMILY_IGNORED;
+  const VkAccessFlags srcAccess = release || !transferOwnership ? VK_ACCESS_TRANSFER_WRITE_BIT : VkAccessFlags(0);
+  const VkAccessFlags dstAccess = release ? VkAccessFlags(0) : VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+  std::vector<VkBufferMemoryBarrier> bufferBarriers;
+  for(VkBuffer buffer : m_pendingBuffers)
+  {
+    VkBufferMemoryBarrier barrier{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+    barrier.srcAccessMask       = srcAccess;
+    barrier.dstAccessMask       = dstAccess;
+    barrier.srcQueueFamilyIndex = srcFamily;
+    barrier.dstQueueFamilyIndex = dstFamily;
+    barrier.buffer              = buffer;
+    barrier.offset              = 0;
+    barrier.size                = VK_WHOLE_SIZE;
+    bufferBarriers.push_back(barrier);
+  }
+  std::vector<VkImageMemoryBarrier> imageBarriers;
+  for(VkImage image : m_pendingImages)
+  {
+    VkImageMemoryBarrier barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+    barrier.srcAccessMask       = srcAccess;
+    barrier.dstAccessMask       = dstAccess;
+    barrier.oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcQueueFamilyIndex = srcFamily;
+    barrier.dstQueueFamilyIndex = dstFamily;
+    barrier.image               = image;
+    barrier.subresourceRange    = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    imageBarriers.push_back(barrier);
+  }
+
+  // the graphics side is ordered after the wait on the timeline, done for all the stages
+  const VkPipelineStageFlags srcStage = release ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+  const VkPipelineStageFlags dstStage = release ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+  vkCmdPipelineBarrier(cmd, srcStage, dstStage, 0, 0, nullptr, uint32_t(bufferBarriers.size()), bufferBarriers.data(),
+                       uint32_t(imageBarriers.size()), imageBarriers.data());
+}
+
+void SplatUploader::flush()
+{
+  if(m_pendingBuffers.empty() && m_pendingImages.empty())
+    return;
+
+  // release, after the copies in the order of the transfer queue
+  if(m_transferFamily != m_graphicsFamily)
+  {
+    Slot& slot = acquireSlot();
+    recordOwnership(slot.cmd, true);
+    submitSlot(slot);
+  }
+
+  // acquire, before the next frames in the order of the graphics queue
+  vkWaitForFences(m_device, 1, &m_graphicsFence, VK_TRUE, UINT64_MAX);
+  vkResetFences(m_device, 1, &m_graphicsFence);
+  vkResetCommandBuffer(m_graphicsCmd, 0);
+  VkCommandBufferBeginInfo beginInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  vkBeginCommandBuffer(m_graphicsCmd, &beginInfo);
+  recordOwnership(m_graphicsCmd, false);
+  vkEndCommandBuffer(m_graphicsCmd);
+
+  const uint64_t             waitValue = m_timelineValue;
+  const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+  VkTimelineSemaphoreSubmitInfo timelineInfo{VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO};
+  timelineInfo.waitSemaphoreValueCount = 1;
+  timelineInfo.pWaitSemaphoreValues    = &waitValue;
+
+  VkSubmitInfo submitInfo{VK_STRUCTURE_TYPE_SUBMIT_INFO, &timelineInfo};
+  submitInfo.waitSemaphoreCount = 1;
+  submitInfo.pWaitSemaphores    = &m_timeline;
+  submitInfo.pWaitDstStageMask  = &waitStage;
+  submitInfo.commandBufferCount = 1;
+  submitInfo.pCommandBuffers    = &m_graphicsCmd;
+  NVVK_CHECK(vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, m_graphicsFence));
+
+  m_pendingBuffers.clear();
+  m_pendingImages.clear();
+}
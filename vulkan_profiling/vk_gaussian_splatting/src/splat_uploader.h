@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2023-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _SPLAT_UPLOADER_H_
+#define _SPLAT_UPLOADER_H_
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include <nvvkhl/alloc_vma.hpp>
+
+// Uploads of the splat data to device buffers and images through a ring of fixed
+// size staging slots, on a dedicated transfer queue when the device exposes one.
+// Each block of a payload is produced by a callback directly in a mapped slot and
+// submitted at once, so the host conversion of a block overlaps the copy of the
+// previous ones and the staging memory does not depend on the size of the model.
+// Every submission signals a timeline semaphore. flush() hands the uploaded resources
+// over to the graphics queue, that waits for the last value on the device only. The
+// host only waits when a slot is reused before its copy completed.
+class SplatUploader
+{
+public:
+  // writes the size bytes of the payload starting at byte offset to dst
+  using FillFunc = std::function<void(void* dst, uint64_t offset, uint64_t size)>;
+
+  struct Stats
+  {
+    uint64_t bytes        = 0;    // uploaded since the last resetStats
+    uint32_t blocks       = 0;    // submissions since the last resetStats
+    double   hostWaitTime = 0.0;  // in ms, waiting for free slots since the last resetStats
+  };
+
+  static constexpr uint64_t s_defaultSlotSize  = 16ull << 20;
+  static constexpr uint32_t s_defaultSlotCount = 4;
+
+public:
+  // the transfer queue may be the graphics queue, uploads are then only asynchronous for the host.
+  // falls back to the graphics queue if the transfer family cannot copy to images by rows
+  void init(VkDevice          device,
+            VkPhysicalDevice  physicalDevice,
+            nvvkhl::AllocVma* alloc,
+            VkQueue           transferQueue,
+            uint32_t          transferFamily,
+            VkQueue           graphicsQueue,
+            uint32_t          graphicsFamily,
+            uint64_t          slotSize  = s_defaultSlotSize,
+            uint32_t          slotCount = s_defaultSlotCount);
+
+  // waits for the pending uploads then releases the resources
+  void deinit();
+
+  // uploads size bytes to buffer at dstOffset, in blocks of a multiple of granularity bytes
+  // (except the last one), granularity must not exceed the slot size
+  void uploadBuffer(VkBuffer buffer, VkDeviceSize dstOffset, uint64_t size, uint64_t granularity, const FillFunc& fill);
+
+  // uploads size bytes of data to buffer at offset 0
+  void uploadBuffer(VkBuffer buffer, const void* data, uint64_t size);
+
+  // uploads the level 0 of a 2D color image created with VK_IMAGE_USAGE_TRANSFER_DST_BIT, in blocks of whole
+  // rows of texelBytes texels. The image is in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL once flushed
+  void uploadImage(VkImage image, VkExtent2D extent, uint32_t texelBytes, const FillFunc& fill);
+
+  // makes the resources uploaded since the last flush available to the commands submitted
+  // afterward on the graphics queue, without waiting on the host
+  void flush();
+
+  // true if uploads run on another queue than the graphics one
+  [[nodiscard]] inline bool isAsynchronous() const { return m_transferQueue != m_graphicsQueue; }
+  [[nodiscard]] inline uint64_t stagingBytes() const { return m_slotSize * m_slots.size(); }
+  [[nodiscard]] inline const Stats& stats() const { return m_stats; }
+  inline void resetStats() { m_stats = {}; }
+
+private:
+  // a staging buffer and the command buffer copying from it
+  struct Slot
+  {
+    nvvk::Buffer    staging;
+    uint8_t*        mapped = nullptr;
+    VkCommandBuffer cmd    = VK_NULL_HANDLE;
+    uint64_t        value  = 0;  // timeline value signaled once the copy from staging is done
+  };
+
+  // next slot of the ring, waits for its previous copy then begins its command buffer
+  Slot& acquireSlot();
+
+  // ends and submits the command buffer of slot, signals the next timeline value
+  void submitSlot(Slot& slot);
+
+  // on the transfer queue then the graphics queue, the barriers of the pending resources
+  void recordOwnership(VkCommandBuffer cmd, bool release);
+
+  VkDevice          m_device         = VK_NULL_HANDLE;
+  nvvkhl::AllocVma* m_alloc          = nullptr;
+  VkQueue           m_transferQueue  = VK_NULL_HANDLE;
+  uint32_t          m_transferFamily = 0;
+  VkQueue           m_graphicsQueue  = VK_NULL_HANDLE;
+  uint32_t          m_graphicsFamily = 0;
+
+  VkSemaphore       m_timeline      = VK_NULL_HANDLE;
+  uint64_t          m_timelineValue = 0;  // last value submitted for signaling
+  VkCommandPool     m_transferPool  = VK_NULL_HANDLE;
+  std::vector<Slot> m_slots;
+  uint64_t          m_slotSize       = 0;
+  uint32_t          m_nextSlot       = 0;
+  uint32_t          m_rowGranularity = 1;  // image rows copied at once must be a multiple of it
+
+  // acquisition by the graphics queue, reused once its fence is signaled
+  VkCommandPool   m_graphicsPool  = VK_NULL_HANDLE;
+  VkCommandBuffer m_graphicsCmd   = VK_NULL_HANDLE;
+  VkFence         m_graphicsFence = VK_NULL_HANDLE;
+
+  // uploaded since the last flush
+  std::vector<VkBuffer> m_pendingBuffers;
+  std::vector<VkImage>  m_pendingImages;
+
+  Stats m_stats;
+};
+
+#endif
@@ -0,0 +1,388 @@
+/*
+ * Copyright (c) 2023-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string_view>
+
+#include "stage_profiler.h"
+
+void StageProfiler::Accumulator::add(double ms)
+{
+  min = count ? std::min(min, ms) : ms;
+  max = count ? std::max(max, ms) : ms;
+  sum += ms;
+  count++;
+  if(samples.size() < s_maxSamples)
+  {
+    samples.push_back((float)ms);
+    return;
+  }
+  // reservoir sampling, the count-th duration replaces a sample with probability s_maxSamples / count
+  // so that the percentiles cover the same durations as the average (splitmix64 generator)
+  rng += 0x9e3779b97f4a7c15ull;
+  uint64_t z = rng;
+  z          = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z          = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  z          = z ^ (z >> 31);
+  const uint64_t slot = z % count;
+  if(slot < s_maxSamples)
+    samples[slot] = (float)ms;
+}
+
+StageProfiler::Stats StageProfiler::Accumulator::stats(const std::string& name) const
+{
+  Stats stats;
+  stats.name  = name;
+  stats.count = count;
+  if(!count)
+    return stats;
+  stats.min = min;
+  stats.max = max;
+  stats.avg = sum / double(count);
+
+  // nearest rank percentiles
+  std::vector<float> sorted = samples;
+  std::sort(sorted.begin(), sorted.end());
+  auto percentile = [&](double p) {
+    const size_t rank = (size_t)std::ceil(p * double(sorted.size()));
+    return (double)sorted[std::min(sorted.size() - 1, rank ? rank - 1 : 0)];
+  };
+  stats.p50 = percentile(0.50);
+  stats.p99 = percentile(0.99);
+  return stats;
+}
+
+bool StageProfiler::init(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t queueFamilyIndex)
+{
+  deinit();
+
+  uint32_t familyCount = 0;
+  vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+  std::vector<VkQueueFamilyProperties> families(familyCount);
+  vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, families.data());
+  const uint32_t validBits = queueFamilyIndex < familyCount ? families[queueFamilyIndex].timestampValidBits : 0;
+  if(validBits == 0)
+  {
+    std::cout << "Warning: no timestamp support on the graphics queue, stage profiler disabled" << std::endl;
+    return false;
+  }
+
+  VkPhysicalDeviceProperties properties;
+  vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+  m_period = properties.limits.timestampPeriod;
+  m_mask   = validBits >= 64 ? ~0ull : ((1ull << validBits) - 1);
+
+  VkQueryPoolCreateInfo info{
+      .sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+      .queryType  = VK_QUERY_TYPE_TIMESTAMP,
+      .queryCount = s_ringSize * s_queriesPerFrame,
+  };
+  if(vkCreateQueryPool(device, &info, nullptr, &m_queryPool) != VK_SUCCESS)
+  {
+    m_queryPool = VK_NULL_HANDLE;
+    return false;
+  }
+  m_device = device;
+  m_slots.assign(s_ringSize, {});
+  return true;
+}
+
+void StageProfiler::deinit()
+{
+  if(m_queryPool != VK_NULL_HANDLE)
+    vkDestroyQueryPool(m_device, m_queryPool, nullptr);
+  m_queryPool = VK_NULL_HANDLE;
+  m_device    = VK_NULL_HANDLE;
+  m_slots.clear();
+  m_current = nullptr;
+}
+
+uint32_t StageProfiler::stageIndex(const char* name)
+{
+  // few stages, compared by content since the same literal may have several addresses
+  for(uint32_t i = 0; i < (uint32_t)m_stageNames.size(); ++i)
+  {
+    if(m_stageNames[i] == name || std::string_view(m_stageNames[i]) == name)
+      return i;
+  }
+  m_stageNames.push_back(name);
+  m_total.resize(m_stageNames.size());
+  m_recentSums.resize(m_stageNames.size(), 0.0);
+  m_recentCounts.resize(m_stageNames.size(), 0);
+  return (uint32_t)m_stageNames.size() - 1;
+}
+
+void StageProfiler::beginFrame(VkCommandBuffer cmd)
+{
+  if(!isEnabled())
+    return;
+
+  m_frame++;
+  Slot& slot = m_slots[m_frame % s_ringSize];
+  if(slot.pending)
+    collect(slot);
+
+  const uint32_t base = uint32_t(m_frame % s_ringSize) * s_queriesPerFrame;
+  vkCmdResetQueryPool(cmd, m_queryPool, base, s_queriesPerFrame);
+
+  slot.frame   = m_frame;
+  slot.pending = true;
+  slot.stages.assign(1, stageIndex("Frame"));
+  slot.used = 2;  // the end of the frame goes to the second query
+  m_current = &slot;
+  vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_queryPool, base);
+}
+
+void StageProfiler::endFrame(VkCommandBuffer cmd)
+{
+  if(!m_current)
+    return;
+  const uint32_t base = uint32_t(m_frame % s_ringSize) * s_queriesPerFrame;
+  vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_queryPool, base + 1);
+  m_current = nullptr;
+}
+
+StageProfiler::Section StageProfiler::section(VkCommandBuffer cmd, const char* name)
+{
+  if(!m_current || m_current->used + 2 > s_queriesPerFrame)
+  {
+    if(m_current)
+      m_droppedSamples++;
+    return Section(nullptr, cmd, 0);
+  }
+  const uint32_t query = uint32_t(m_frame % s_ringSize) * s_queriesPerFrame + m_current->used;
+  m_current->stages.push_back(stageIndex(name));
+  m_current->used += 2;
+  vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_queryPool, query);
+  return Section(this, cmd, query + 1);
+}
+
+void StageProfiler::endSection(VkCommandBuffer cmd, uint32_t query)
+{
+  vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_queryPool, query);
+}
+
+void StageProfiler::collect(Slot& slot)
+{
+  slot.pending = false;
+
+  // value and availability of each timestamp, never waits: the timestamps
+  // of a frame still executing are reported as not available and dropped
+  const uint32_t        base = uint32_t(slot.frame % s_ringSize) * s_queriesPerFrame;
+  std::vector<uint64_t> data(slot.used * 2, 0);
+  const VkResult        result = vkGetQueryPoolResults(m_device, m_queryPool, base, slot.used, data.size() * sizeof(uint64_t),
+                                                       data.data(), 2 * sizeof(uint64_t),
+                                                       VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+  if(result != VK_SUCCESS && result != VK_NOT_READY)
+  {
+    m_droppedSamples += slot.stages.size();
+    return;
+  }
+
+  // sections of a same stage in a frame are summed
+  std::vector<double> durations(m_stageNames.size(), -1.0);
+  for(size_t i = 0; i < slot.stages.size(); ++i)
+  {
+    const uint64_t* begin = &data[4 * i];
+    const uint64_t* end   = &data[4 * i + 2];
+    if(!begin[1] || !end[1])
+    {
+      m_droppedSamples++;
+      continue;
+    }
+    const double ms = double((end[0] - begin[0]) & m_mask) * m_period * 1e-6;
+    double&      sum = durations[slot.stages[i]];
+    sum              = (sum < 0.0 ? 0.0 : sum) + ms;
+  }
+
+  for(auto& step : m_pendingSteps)
+  {
+    if(slot.frame < step.firstFrame || slot.frame > step.lastFrame)
+      continue;
+    step.frames++;
+    step.stages.resize(m_stageNames.size());
+    for(size_t stage = 0; stage < durations.size(); ++stage)
+    {
+      if(durations[stage] >= 0.0)
+        step.stages[stage].add(durations[stage]);
+    }
+  }
+  for(size_t stage = 0; stage < durations.size(); ++stage)
+  {
+    if(durations[stage] < 0.0)
+      continue;
+    m_total[stage].add(durations[stage]);
+    m_recentSums[stage] += durations[stage];
+    m_recentCounts[stage]++;
+  }
+  m_collectedFrames++;
+
+  if(++m_recentFrameCount == s_recentFrames)
+  {
+    m_recent.clear();
+    for(size_t stage = 0; stage < m_stageNames.size(); ++stage)
+    {
+      if(m_recentCounts[stage])
+        m_recent.emplace_back(m_stageNames[stage], m_recentSums[stage] / m_recentCounts[stage]);
+      m_recentSums[stage]   = 0.0;
+      m_recentCounts[stage] = 0;
+    }
+    m_recentFrameCount = 0;
+  }
+
+  finishSteps(slot.frame);
+}
+
+void StageProfiler::beginStep(const std::string& name)
+{
+  endStep();
+  PendingStep step;
+  step.name       = name;
+  step.firstFrame = m_frame;
+  m_pendingSteps.push_back(std::move(step));
+}
+
+void StageProfiler::endStep()
+{
+  if(m_pendingSteps.empty() || m_pendingSteps.back().lastFrame != UINT64_MAX)
+    return;
+  // the current frame is being recorded when the step ends, it is not part of it
+  m_pendingSteps.back().lastFrame = m_frame - 1;
+}
+
+void StageProfiler::finishSteps(uint64_t collectedFrame)
+{
+  while(!m_pendingSteps.empty() && m_pendingSteps.front().lastFrame <= collectedFrame)
+  {
+    const PendingStep& pending = m_pendingSteps.front();
+    m_steps.push_back(makeStep(pending.name, pending.frames, pending.stages));
+    m_pendingSteps.pop_front();
+    if(m_stepCallback)
+      m_stepCallback(m_steps.back());
+  }
+}
+
+void StageProfiler::flush()
+{
+  if(!isEnabled())
+    return;
+  // oldest frame first, the steps are filled in order
+  for(uint64_t frame = m_frame >= s_ringSize ? m_frame - s_ringSize + 1 : 1; frame <= m_frame; ++frame)
+  {
+    Slot& slot = m_slots[frame % s_ringSize];
+    if(slot.pending && slot.frame == frame)
+      collect(slot);
+  }
+  // the last frame is complete, a running step includes it
+  if(!m_pendingSteps.empty() && m_pendingSteps.back().lastFrame == UINT64_MAX)
+    m_pendingSteps.back().lastFrame = m_frame;
+  finishSteps(m_frame);
+}
+
+StageProfiler::Step StageProfiler::makeStep(const std::string& name, uint64_t frames, const std::vector<Accumulator>& stages) const
+{
+  Step step;
+  step.name   = name;
+  step.frames = frames;
+  for(size_t i = 0; i < stages.size(); ++i)
+  {
+    if(stages[i].count)
+      step.stages.push_back(stages[i].stats(m_stageNames[i]));
+  }
+  return step;
+}
+
+StageProfiler::Step StageProfiler::summary() const
+{
+  return makeStep("all", m_collectedFrames, m_total);
+}
+
+std::string StageProfiler::toCsv() const
+{
+  std::ostringstream out;
+  out << "step,stage,count,min_ms,avg_ms,p50_ms,p99_ms,max_ms\n";
+  auto writeStep = [&](const Step& step) {
+    for(const auto& s : step.stages)
+      out << step.name << "," << s.name << "," << s.count << "," << s.min << "," << s.avg << "," << s.p50 << ","
+          << s.p99 << "," << s.max << "\n";
+  };
+  for(const auto& step : m_steps)
+    writeStep(step);
+  writeStep(summary());
+  return out.str();
+}
+
+std::string StageProfiler::toJson() const
+{
+  std::ostringstream out;
+  auto writeStep = [&](const Step& step) {
+    out << "{\"name\": \"" << step.name << "\", \"frames\": " << step.frames << ", \"stages\": [";
+    for(size_t i = 0; i < step.stages.size(); ++i)
+    {
+      const Stats& s = step.stages[i];
+      out << (i ? ", " : "") << "{\"name\": \"" << s.name << "\", \"count\": " << s.count << ", \"min\": " << s.min
+          << ", \"avg\": " << s.avg << ", \"p50\": " << s.p50 << ", \"p99\": " << s.p99 << ", \"max\": " << s.max << "}";
+    }
+    out << "]}";
+  };
+  out << "{\"unit\": \"ms\", \"droppedSamples\": " << m_droppedSamples << ", \"steps\": [";
+  for(size_t i = 0; i < m_steps.size(); ++i)
+  {
+    out << (i ? ", " : "");
+    writeStep(m_steps[i]);
+  }
+  out << "], \"summary\": ";
+  writeStep(summary());
+  out << "}\n";
+  return out.str();
+}
+
+bool StageProfiler::writeFile(const std::string& filename) const
+{
+  const bool    json = filename.size() >= 5 && filename.compare(filename.size() - 5, 5, ".json") == 0;
+  std::ofstream file(filename, std::ios::trunc);
+  if(!file)
+  {
+    std::cerr << "Error: cannot write stage times to " << filename << std::endl;
+    return false;
+  }
+  file << (json ? toJson() : toCsv());
+  return (bool)file;
+}
+
+void StageProfiler::printStep(const Step& step, uint32_t id)
+{
+  // the CPU column is required by the format, the CPU stages are reported by the statistics panel instead
+  auto us = [](double ms) { return (long long)std::llround(ms * 1000.0); };
+  std::cout << "BENCHMARK " << id << " \"" << step.name << "\" {" << std::endl;
+  for(const auto& s : step.stages)
+  {
+    char line[256];
+    snprintf(line, sizeof(line), " Timer %s;\t VK %8lld; CPU %8d; min %lld; p50 %lld; p99 %lld; (microseconds, avg %llu)",
+             s.name.c_str(), us(s.avg), 0, us(s.min), us(s.p50), us(s.p99), (unsigned long long)s.count);
+    std::cout << line << std::endl;
+  }
+  std::cout << "}" << std::endl;
+}
@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2023-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#ifndef _STAGE_PROFILER_H_
+#define _STAGE_PROFILER_H_
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <cstdint>
+
+#include <vulkan/vulkan_core.h>
+
+// GPU time of the stages of a frame, measured with timestamp queries
+// and independent of the nvvkhl profiler and of any external tool.
+// Each frame writes its timestamps in its own slot of a ring of query ranges. A slot
+// is read back without waiting when it is reused, s_ringSize frames later, so the
+// results of a frame are only known once the frames in flight after it were submitted.
+// The durations are aggregated on the host into min, average, median and 99th percentile,
+// for the whole run and for steps (e.g. the timed frames of a viewpoint of a --views batch).
+class StageProfiler
+{
+public:
+  // aggregated durations of a stage, in milliseconds
+  struct Stats
+  {
+    std::string name;
+    uint64_t    count = 0;
+    double      min   = 0.0;
+    double      avg   = 0.0;
+    double      p50   = 0.0;
+    double      p99   = 0.0;
+    double      max   = 0.0;
+  };
+
+  // stats of the frames of a step, in the order the stages were first met
+  struct Step
+  {
+    std::string        name;
+    uint64_t           frames = 0;
+    std::vector<Stats> stages;
+  };
+
+  // writes the end timestamp of a section when going out of scope
+  class Section
+  {
+  public:
+    Section(StageProfiler* profiler, VkCommandBuffer cmd, uint32_t query)
+        : m_profiler(profiler)
+        , m_cmd(cmd)
+        , m_query(query)
+    {
+    }
+    Section(Section&& other) noexcept
+        : m_profiler(other.m_profiler)
+        , m_cmd(other.m_cmd)
+        , m_query(other.m_query)
+    {
+      other.m_profiler = nullptr;
+    }
+    Section(const Section&)            = delete;
+    Section& operator=(const Section&) = delete;
+    ~Section()
+    {
+      if(m_profiler)
+        m_profiler->endSection(m_cmd, m_query);
+    }
+
+  private:
+    StageProfiler*  m_profiler;
+    VkCommandBuffer m_cmd;
+    uint32_t        m_query;
+  };
+
+  // invoked with each step once all its frames are read back
+  using StepCallback = std::function<void(const Step&)>;
+
+public:
+  // returns false if the queue family has no timestamp support, the profiler does nothing then
+  bool init(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t queueFamilyIndex);
+
+  // the results not read back are lost, see flush
+  void deinit();
+
+  // to be invoked first in the command buffer of each frame, outside of any render pass:
+  // reads back the slot of the frame that used it last, resets it and starts the "Frame" stage
+  void beginFrame(VkCommandBuffer cmd);
+
+  // ends the "Frame" stage, last in the command buffer of the frame
+  void endFrame(VkCommandBuffer cmd);
+
+  // times the commands recorded until the returned section is destroyed,
+  // name shall be a string literal or outlive the profiler
+  [[nodiscard]] Section section(VkCommandBuffer cmd, const char* name);
+
+  // the frames from the current one on go to a new step, ending the previous one if any
+  void beginStep(const std::string& name);
+
+  // the frames before the current one end the step begun
+  void endStep();
+
+  // reads back all the frames, the device must be idle. The step begun if any is ended.
+  void flush();
+
+  // stats of the whole run, of the frames read back so far
+  [[nodiscard]] Step summary() const;
+
+  // steps done, in order
+  [[nodiscard]] inline const std::vector<Step>& steps() const { return m_steps; }
+
+  // average duration of each stage over the last frames read back, for display
+  [[nodiscard]] inline const std::vector<std::pair<std::string, double>>& recentAverages() const { return m_recent; }
+
+  inline void setStepCallback(StepCallback callback) { m_stepCallback = std::move(callback); }
+
+  [[nodiscard]] inline bool     isEnabled() const { return m_queryPool != VK_NULL_HANDLE; }
+  [[nodiscard]] inline uint64_t droppedSamples() const { return m_droppedSamples; }
+
+  // the steps and the summary as a json document or as csv lines, one per step and stage
+  std::string toJson() const;
+  std::string toCsv() const;
+
+  // writes json if filename ends with .json, csv otherwise
+  bool writeFile(const std::string& filename) const;
+
+  // nvpro benchmark format parsed by benchmark.py, one "Timer" line per stage in microseconds
+  static void printStep(const Step& step, uint32_t id);
+
+private:
+  // frames in the ring, more than the frames in flight so that the read back never waits
+  static constexpr uint32_t s_ringSize = 5;
+  // timestamps per frame, begin and end of each section
+  static constexpr uint32_t s_queriesPerFrame = 64;
+  // durations kept per stage for the percentiles, a uniform reservoir sample of all the
+  // durations once exceeded, min, max and average account for all of them exactly
+  static constexpr size_t s_maxSamples = 1 << 20;
+  // frames averaged by recentAverages
+  static constexpr uint32_t s_recentFrames = 64;
+
+  struct Accumulator
+  {
+    uint64_t           count = 0;
+    double             sum   = 0.0;
+    double             min   = 0.0;
+    double             max   = 0.0;
+    std::vector<float> samples;
+    uint64_t           rng = 0;  // state of the reservoir sampling generator
+
+    void  add(double ms);
+    Stats stats(const std::string& name) const;
+  };
+
+  struct PendingStep
+  {
+    std::string              name;
+    uint64_t                 firstFrame = 0;
+    uint64_t                 lastFrame  = UINT64_MAX;  // included, UINT64_MAX while running
+    uint64_t                 frames     = 0;
+    std::vector<Accumulator> stages;  // indexed like m_stageNames
+  };
+
+  struct Slot
+  {
+    uint64_t              frame   = 0;
+    bool                  pending = false;
+    uint32_t              used    = 0;  // timestamps written
+    std::vector<uint32_t> stages;       // stage of each begin timestamp, even queries
+  };
+
+  void     endSection(VkCommandBuffer cmd, uint32_t query);
+  uint32_t stageIndex(const char* name);
+  void     collect(Slot& slot);
+  void     finishSteps(uint64_t collectedFrame);
+  Step     makeStep(const std::string& name, uint64_t frames, const std::vector<Accumulator>& stages) const;
+
+  VkDevice    m_device    = VK_NULL_HANDLE;
+  VkQueryPool m_queryPool = VK_NULL_HANDLE;
+  double      m_period    = 1.0;   // nanoseconds per tick
+  uint64_t    m_mask      = ~0ull;  // valid bits of the timestamps
+
+  std::vector<Slot> m_slots;
+  uint64_t          m_frame = 0;  // current frame, starts at 1
+  Slot*             m_current = nullptr;
+
+  std::vector<const char*> m_stageNames;
+  std::vector<Accumulator> m_total;
+  std::deque<PendingStep>  m_pendingSteps;
+  std::vector<Step>        m_steps;
+  uint64_t                 m_collectedFrames = 0;
+  uint64_t                 m_droppedSamples  = 0;
+
+  // running sums of the last frames for recentAverages
+  std::vector<double>                           m_recentSums;
+  std::vector<uint32_t>                         m_recentCounts;
+  uint32_t                                      m_recentFrameCount = 0;
+  std::vector<std::pair<std::string, double>>   m_recent;
+
+  StepCallback m_stepCallback;
+};
+
+#endif
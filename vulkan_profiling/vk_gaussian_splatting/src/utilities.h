@@ -31,7 +31,7 @@
 #define START_PAR_LOOP(SIZE, INDEX)                                                                                    \
   {                                                                                                                    \
     nvh::parallel_batches_indexed<8192>(                                                                               \
-        SIZE, [&](int INDEX, int tidx) {
+        SIZE, [&](uint64_t INDEX, int tidx) {
 
 #define END_PAR_LOOP()                                                                                                 \
   }, (uint32_t)std::thread::hardware_concurrency());                                                                   \
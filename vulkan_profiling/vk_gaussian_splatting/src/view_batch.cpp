@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2023-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include "view_batch.h"
+
+bool ViewBatch::load(const std::string& filename)
+{
+  m_poses.clear();
+
+  std::ifstream file(filename);
+  if(!file.is_open())
+  {
+    std::cout << "Error: cannot open views file " << filename << std::endl;
+    return false;
+  }
+
+  std::string line;
+  int         lineNumber = 0;
+  while(std::getline(file, line))
+  {
+    lineNumber++;
+    std::istringstream stream(line);
+    Pose               pose;
+    if(!(stream >> pose.name) || pose.name[0] == '#')
+      continue;
+
+    std::vector<float> values;
+    float              value;
+    while(stream >> value)
+      values.push_back(value);
+    if(!stream.eof() || (values.size() != 16 && values.size() != 32))
+    {
+      std::cout << "Error: " << filename << " line " << lineNumber << ", expected a name followed by 16 or 32 floats"
+                << std::endl;
+      return false;
+    }
+    pose.view = glm::make_mat4(values.data());
+    if(values.size() == 32)
+    {
+      pose.proj    = glm::make_mat4(values.data() + 16);
+      pose.hasProj = true;
+    }
+    m_poses.push_back(pose);
+  }
+
+  if(m_poses.empty())
+  {
+    std::cout << "Error: no view in " << filename << std::endl;
+    return false;
+  }
+
+  m_timings.assign(m_poses.size(), Timing());
+  m_phase     = E_START;
+  m_poseIndex = 0;
+  std::cout << "Loaded " << m_poses.size() << " views from " << filename << std::endl;
+  return true;
+}
+
+void ViewBatch::setFrameCounts(int warmupFrames, int timedFrames)
+{
+  m_warmupFrames = std::max(warmupFrames, 0);
+  m_timedFrames  = std::max(timedFrames, 1);
+}
+
+std::string ViewBatch::currentImageFilename() const
+{
+  return (std::filesystem::path(m_outputDir) / (currentPose().name + ".png")).string();
+}
+
+ViewBatch::Action ViewBatch::frame(bool newSort, double distTime, double sortTime)
+{
+  const auto   now       = std::chrono::high_resolution_clock::now();
+  const double frameTime = std::chrono::duration<double, std::milli>(now - m_lastFrameTime).count();
+  m_lastFrameTime        = now;
+
+  switch(m_phase)
+  {
+    case E_START: {
+      std::error_code ec;
+      std::filesystem::create_directories(m_outputDir, ec);
+      m_phase      = E_WARMUP;
+      m_phaseFrame = 0;
+      return E_SET_POSE;
+    }
+    case E_WARMUP:
+      // the time of the first frame of the pose is measured from the previous pose, skip it
+      if(++m_phaseFrame > m_warmupFrames)
+      {
+        m_phase      = E_TIMED;
+        m_phaseFrame = 0;
+        return E_BEGIN_TIMING;
+      }
+      return E_NONE;
+    case E_TIMED: {
+      Timing& timing = m_timings[m_poseIndex];
+      timing.frameMin = timing.frames ? std::min(timing.frameMin, frameTime) : frameTime;
+      timing.frameMax = timing.frames ? std::max(timing.frameMax, frameTime) : frameTime;
+      timing.frameSum += frameTime;
+      timing.frames++;
+      // the stats of a CPU sort are kept until the next one, counted once
+      if(newSort)
+      {
+        timing.distSum += distTime;
+        timing.sortSum += sortTime;
+        timing.sorts++;
+      }
+      if(++m_phaseFrame == m_timedFrames)
+      {
+        m_phase      = E_SETTLE;
+        m_phaseFrame = 0;
+        return E_SCREENSHOT;
+      }
+      return E_NONE;
+    }
+    case E_SETTLE:
+      if(++m_phaseFrame < s_settleFrames)
+        return E_NONE;
+      if(++m_poseIndex < m_poses.size())
+      {
+        m_phase      = E_WARMUP;
+        m_phaseFrame = 0;
+        return E_SET_POSE;
+      }
+      m_poseIndex = m_poses.size() - 1;
+      m_phase     = E_FINISHED;
+      writeTimings();
+      return E_DONE;
+    case E_FINISHED:
+    default:
+      return E_DONE;
+  }
+}
+
+bool ViewBatch::writeTimings() const
+{
+  const std::string filename = (std::filesystem::path(m_outputDir) / "timings.csv").string();
+  std::ofstream     file(filename);
+  if(!file.is_open())
+  {
+    std::cout << "Error: cannot write " << filename << std::endl;
+    return false;
+  }
+  file << "view,frames,frame_avg_ms,frame_min_ms,frame_max_ms,cpu_sorts,cpu_dist_avg_ms,cpu_sort_avg_ms" << std::endl;
+  for(size_t i = 0; i < m_poses.size(); ++i)
+  {
+    const Timing& timing = m_timings[i];
+    const double  count  = std::max(timing.frames, 1);
+    const double  sorts  = std::max(timing.sorts, 1);
+    file << m_poses[i].name << "," << timing.frames << "," << timing.frameSum / count << "," << timing.frameMin << ","
+         << timing.frameMax << "," << timing.sorts << "," << timing.distSum / sorts << "," << timing.sortSum / sorts
+         << std::endl;
+  }
+  std::cout << "Timings of " << m_poses.size() << " views written to " << filename << std::endl;
+  return true;
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2023-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#ifndef _VIEW_BATCH_H_
+#define _VIEW_BATCH_H_
+
+#include <string>
+#include <vector>
+#include <chrono>
+
+#include <glm/mat4x4.hpp>
+
+// Renders a list of viewpoints in one run (--views <file>) instead of one
+// process launch and one model load per viewpoint. Each pose is rendered
+// warmupFrames times without being measured, then timedFrames times while
+// the frame times are accumulated, then its image is written.
+//
+// The file holds one pose per line, lines starting with # are ignored:
+//   name v0 ... v15 [p0 ... p15]
+// name is used for the image file name, v and p are laid out as the values
+// of the --view and --proj arguments. The projection given on the command
+// line is used when p is missing.
+class ViewBatch
+{
+public:
+  struct Pose
+  {
+    std::string name;
+    glm::mat4   view    = glm::mat4(1.0f);
+    glm::mat4   proj    = glm::mat4(1.0f);
+    bool        hasProj = false;
+  };
+
+  // what the renderer shall do at the current frame
+  enum Action
+  {
+    E_NONE,          // keep rendering the current pose
+    E_SET_POSE,      // apply currentPose() before rendering
+    E_BEGIN_TIMING,  // warmup done, this frame is the first timed frame of the current pose
+    E_SCREENSHOT,    // timed frames done, write the image of the current pose
+    E_DONE           // all poses rendered, timings written, the app can be closed
+  };
+
+public:
+  // parses the views file, returns false on failure
+  bool load(const std::string& filename);
+
+  // image and timings files are written in outputDir, created if needed
+  void setOutput(const std::string& outputDir) { m_outputDir = outputDir; }
+  [[nodiscard]] inline const std::string& outputDir() const { return m_outputDir; }
+  void setFrameCounts(int warmupFrames, int timedFrames);
+
+  [[nodiscard]] inline bool empty() const { return m_poses.empty(); }
+  [[nodiscard]] inline const Pose& currentPose() const { return m_poses[m_poseIndex]; }
+  [[nodiscard]] inline const std::vector<Pose>& poses() const { return m_poses; }
+
+  // image file name of the current pose
+  std::string currentImageFilename() const;
+
+  // to be invoked once per rendered frame once the scene is loaded, newSort is true
+  // if the frame consumed a new CPU sort whose stats in ms are distTime and sortTime
+  Action frame(bool newSort, double distTime, double sortTime);
+
+private:
+  // timings of one pose over its timed frames, in ms
+  struct Timing
+  {
+    int    frames   = 0;
+    double frameSum = 0.0;
+    double frameMin = 0.0;
+    double frameMax = 0.0;
+    int    sorts    = 0;  // CPU sorts consumed, averaged by distSum and sortSum
+    double distSum  = 0.0;
+    double sortSum  = 0.0;
+  };
+
+  // writes timings.csv in the output directory
+  bool writeTimings() const;
+
+private:
+  enum Phase
+  {
+    E_START,    // first frame, pose not applied yet
+    E_WARMUP,   // rendering without measuring
+    E_TIMED,    // rendering and measuring
+    E_SETTLE,   // waiting for the screenshot to be captured
+    E_FINISHED
+  };
+
+  // frames rendered after the screenshot request before switching pose,
+  // so the captured image is the one of the current pose
+  static constexpr int s_settleFrames = 5;
+
+  std::vector<Pose>   m_poses;
+  std::vector<Timing> m_timings;
+  std::string         m_outputDir    = ".";
+  int                 m_warmupFrames = 10;
+  int                 m_timedFrames  = 10;
+
+  Phase  m_phase      = E_START;
+  size_t m_poseIndex  = 0;
+  int    m_phaseFrame = 0;  // frames rendered in the current phase
+
+  std::chrono::high_resolution_clock::time_point m_lastFrameTime;
+};
+
+#endif